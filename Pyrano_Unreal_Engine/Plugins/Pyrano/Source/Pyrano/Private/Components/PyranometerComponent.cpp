@@ -3,6 +3,7 @@
 #include "Components/PyranometerComponent.h"
 #include "GameFramework/Actor.h"
 #include "Engine/World.h"
+#include "Subsystems/PyranometerRegistry.h"
 
 UPyranometerComponent::UPyranometerComponent()
 {
@@ -52,6 +53,28 @@ void UPyranometerComponent::OnRegister()
 	Super::OnRegister();
 	EnsureGuid(false);	
 	InvalidateSkyViewFactor();
+
+	if (UWorld* World = GetWorld())
+	{
+		if (UPyranometerRegistry* Registry = World->GetSubsystem<UPyranometerRegistry>())
+		{
+			Registry->RegisterSensor(this);
+		}
+	}
+}
+
+
+void UPyranometerComponent::OnUnregister()
+{
+	if (UWorld* World = GetWorld())
+	{
+		if (UPyranometerRegistry* Registry = World->GetSubsystem<UPyranometerRegistry>())
+		{
+			Registry->UnregisterSensor(this);
+		}
+	}
+
+	Super::OnUnregister();
 }
 
 
@@ -60,6 +83,15 @@ void UPyranometerComponent::PostEditImport()
 {
 	Super::PostEditImport();
 	EnsureGuid(true);
+
+	// Re-key in the registry if already registered
+	if (IsRegistered() && GetWorld())
+	{
+		if (UPyranometerRegistry* Registry = GetWorld()->GetSubsystem<UPyranometerRegistry>())
+		{
+			Registry->RegisterSensor(this);
+		}
+	}
 }
 
 
@@ -80,6 +112,17 @@ void UPyranometerComponent::InvalidateSkyViewFactor()
 {
 	bSkyViewFactorValid = false;
 	SkyViewFactor = -1.0f;
+	HorizonMap.Reset();
+}
+
+
+FSensorHorizonMapPtr UPyranometerComponent::GetHorizonMapCached() const
+{
+	if (HorizonMap.IsValid() && HorizonMap->MatchesPose(GetWorldPosition(), GetNormalWS()))
+	{
+		return HorizonMap;
+	}
+	return nullptr;
 }
 
 #if WITH_EDITOR
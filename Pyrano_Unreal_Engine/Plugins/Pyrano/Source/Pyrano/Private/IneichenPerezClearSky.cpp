@@ -28,6 +28,11 @@ double UClearSkyService::AirMassKastenYoung(double SolarZenithRad)
 }
 
 FPyranoClearSkyIrradiance UClearSkyService::Compute(const FDateTime& WhenUTC, double SolarZenithRad) const
+{
+	return ComputeWithConfig(Config, WhenUTC, SolarZenithRad);
+}
+
+FPyranoClearSkyIrradiance UClearSkyService::ComputeWithConfig(const FPyranoClearSkyConfig& InConfig, const FDateTime& WhenUTC, double SolarZenithRad)
 {
 	FPyranoClearSkyIrradiance Out;
 	Out.DNI_Wm2 = 0.0;
@@ -55,8 +60,8 @@ FPyranoClearSkyIrradiance UClearSkyService::Compute(const FDateTime& WhenUTC, do
 		return Out;
 	}
 
-	const double Alt = FMath::Clamp(Config.AltitudeMeters, -500.0, 9000.0);
-	const double TL = FMath::Clamp(Config.LinkeTurbidity, 1.0, 10.0);
+	const double Alt = FMath::Clamp(InConfig.AltitudeMeters, -500.0, 9000.0);
+	const double TL = FMath::Clamp(InConfig.LinkeTurbidity, 1.0, 10.0);
 
 	// Absolute air mass (pressure correction)
 	const double AM = AM_rel * FMath::Exp(-Alt / 8434.5);
@@ -0,0 +1,211 @@
+﻿// IrradianceCaptureRig.cpp
+
+#include "Irradiance/IrradianceCaptureRig.h"
+
+#include "Components/SceneCaptureComponent2D.h"
+#include "Engine/TextureRenderTarget2D.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "RenderGraphBuilder.h"
+#include "RenderGraphUtils.h"
+#include "RenderingThread.h"
+#include "TextureResource.h"
+#include "Logging/IrradianceLog.h"
+
+
+// -----------------------------------------------------------------------------
+//  Rig
+// -----------------------------------------------------------------------------
+
+bool FIrradianceCaptureRig::Ensure(UWorld* World, TConstArrayView<FQuat> FaceRots)
+{
+    if (RigActor.IsValid())
+        return true;
+
+    if (!World || FaceRots.Num() != IrradianceCommon::NumFaces)
+        return false;
+
+    FActorSpawnParameters Params;
+    Params.ObjectFlags |= RF_Transient;
+    Params.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+    AActor* Actor = World->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, Params);
+    if (!Actor)
+    {
+        PYRANO_ERR(TEXT("[CaptureRig] Could not spawn the rig actor"));
+        return false;
+    }
+
+    USceneComponent* Root = NewObject<USceneComponent>(Actor, TEXT("RigRoot"));
+    Actor->SetRootComponent(Root);
+    Root->RegisterComponent();
+
+    for (int32 f = 0; f < IrradianceCommon::NumFaces; ++f)
+    {
+        // Target owned by the component (UPROPERTY), resized per capture
+        UTextureRenderTarget2D* RT = NewObject<UTextureRenderTarget2D>(Actor);
+        RT->RenderTargetFormat = RTF_RGBA16f;
+        RT->ClearColor = FLinearColor::Black;
+        RT->bAutoGenerateMips = false;
+        RT->InitAutoFormat(IrradianceCommon::Defaults::MinFaceSidePx, IrradianceCommon::Defaults::MinFaceSidePx);
+
+        USceneCaptureComponent2D* Capture = NewObject<USceneCaptureComponent2D>(Actor, *FString::Printf(TEXT("RigFace%d"), f));
+        Capture->SetupAttachment(Root);
+        Capture->SetRelativeRotation(FaceRots[f]);   // actor rotation stays identity: face rotations are world space
+        Capture->FOVAngle = 90.f;
+        Capture->CaptureSource = ESceneCaptureSource::SCS_SceneColorHDR;
+        Capture->TextureTarget = RT;
+        Capture->bCaptureEveryFrame = false;
+        Capture->bCaptureOnMovement = false;
+        Capture->bAlwaysPersistRenderingState = true;   // keeps view state (e.g. Lumen) between captures
+
+        // Same signal as the hijacked view: fixed exposure, no temporal AA / motion blur
+        Capture->PostProcessSettings.bOverride_AutoExposureMethod = true;
+        Capture->PostProcessSettings.AutoExposureMethod = EAutoExposureMethod::AEM_Manual;
+        Capture->PostProcessSettings.bOverride_AutoExposureBias = true;
+        Capture->PostProcessSettings.AutoExposureBias = 0.f;
+        Capture->PostProcessSettings.bOverride_AutoExposureApplyPhysicalCameraExposure = true;
+        Capture->PostProcessSettings.AutoExposureApplyPhysicalCameraExposure = false;
+        Capture->ShowFlags.SetTemporalAA(false);
+        Capture->ShowFlags.SetMotionBlur(false);
+
+        Capture->RegisterComponent();
+        Captures[f] = Capture;
+    }
+
+    RigActor = Actor;
+    PYRANO_VERBOSE(TEXT("[CaptureRig] Rig spawned (%d scene captures)"), IrradianceCommon::NumFaces);
+    return true;
+}
+
+
+void FIrradianceCaptureRig::Destroy()
+{
+    CancelCapture();
+
+    if (AActor* Actor = RigActor.Get())
+    {
+        Actor->Destroy();
+    }
+    RigActor.Reset();
+
+    for (TWeakObjectPtr<USceneCaptureComponent2D>& Capture : Captures)
+    {
+        Capture.Reset();
+    }
+}
+
+
+// -----------------------------------------------------------------------------
+//  Capture
+// -----------------------------------------------------------------------------
+
+bool FIrradianceCaptureRig::CaptureFaces(const FVector& PosWS, TConstArrayView<int32> FaceSidePx, int32 NumFrames, bool bPathTracing)
+{
+    AActor* Actor = RigActor.Get();
+    if (!Actor || FaceSidePx.Num() != IrradianceCommon::NumFaces)
+        return false;
+
+    Actor->SetActorLocation(PosWS);
+
+    for (int32 f = 0; f < IrradianceCommon::NumFaces; ++f)
+    {
+        const int32 Side = FaceSidePx[f];
+        USceneCaptureComponent2D* Capture = Captures[f].Get();
+        FacePlanned[f] = Side > 0 && Capture && Capture->TextureTarget;
+        if (!FacePlanned[f])
+            continue;
+
+        UTextureRenderTarget2D* RT = Capture->TextureTarget;
+        if (RT->SizeX != Side || RT->SizeY != Side)
+        {
+            RT->ResizeTarget(Side, Side);
+        }
+
+        // Path tracing accumulates in the persistent view state of the capture
+        Capture->ShowFlags.SetPathTracing(bPathTracing);
+    }
+
+    PendingFrame = MakeShared<FRigFrame, ESPMode::ThreadSafe>();
+    FramesLeft = FMath::Max(1, NumFrames);
+    RenderFrame();
+    return true;
+}
+
+
+void FIrradianceCaptureRig::Tick()
+{
+    if (FramesLeft > 0)
+    {
+        RenderFrame();
+    }
+}
+
+
+void FIrradianceCaptureRig::RenderFrame()
+{
+    TStaticArray<FTextureRenderTargetResource*, IrradianceCommon::NumFaces> Resources;
+    for (int32 f = 0; f < IrradianceCommon::NumFaces; ++f)
+    {
+        Resources[f] = nullptr;
+
+        USceneCaptureComponent2D* Capture = Captures[f].Get();
+        if (!FacePlanned[f] || !Capture)
+            continue;
+
+        // Queues the scene render of this face now: all faces render in this frame
+        Capture->CaptureScene();
+        Resources[f] = Capture->TextureTarget->GameThread_GetRenderTargetResource();
+    }
+
+    if (--FramesLeft > 0 || !PendingFrame.IsValid())
+        return;
+
+    // Targets are reused by the next capture: copy the faces out right after they render
+    TSharedPtr<FRigFrame, ESPMode::ThreadSafe> Frame = PendingFrame;
+
+    ENQUEUE_RENDER_COMMAND(CopyIrradianceRigFaces)(
+        [Frame, Resources](FRHICommandListImmediate& RHICmdList)
+        {
+            FRDGBuilder GraphBuilder(RHICmdList);
+            for (int32 f = 0; f < IrradianceCommon::NumFaces; ++f)
+            {
+                FTextureRenderTargetResource* Resource = Resources[f];
+                if (!Resource || !Resource->GetRenderTargetTexture())
+                    continue;
+
+                FRDGTextureRef Src = RegisterExternalTexture(GraphBuilder, Resource->GetRenderTargetTexture(), TEXT("Irr.RigTarget"));
+
+                FRDGTextureDesc Desc = FRDGTextureDesc::Create2D(
+                    Src->Desc.Extent,
+                    PF_FloatRGBA,
+                    FClearValueBinding::Transparent,
+                    TexCreate_ShaderResource | TexCreate_RenderTargetable);
+                FRDGTextureRef Dst = GraphBuilder.CreateTexture(Desc, TEXT("SceneColor_OutTexture"));
+
+                AddCopyTexturePass(GraphBuilder, Src, Dst);
+                GraphBuilder.QueueTextureExtraction(Dst, &Frame->Faces[f]);
+            }
+            GraphBuilder.Execute();
+
+            Frame->bReady.store(true, std::memory_order_release);
+        });
+}
+
+
+bool FIrradianceCaptureRig::ConsumeFaces(FFaceRTs& OutFaces)
+{
+    if (!PendingFrame.IsValid() || !PendingFrame->bReady.load(std::memory_order_acquire))
+        return false;
+
+    OutFaces = MoveTemp(PendingFrame->Faces);
+    PendingFrame.Reset();
+    return true;
+}
+
+
+void FIrradianceCaptureRig::CancelCapture()
+{
+    PendingFrame.Reset();
+    FramesLeft = 0;
+}
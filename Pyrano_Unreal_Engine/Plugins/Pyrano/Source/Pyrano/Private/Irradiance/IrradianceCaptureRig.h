@@ -0,0 +1,69 @@
+/*=============================================================================
+    IrradianceCaptureRig.h
+  Off-screen capture of a whole cubemap: six 90 deg scene captures on a
+  plugin-owned actor, copied out as standalone face render targets.
+/============================================================================*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/StaticArray.h"
+#include "RendererInterface.h"
+#include "Irradiance/IrradianceCommon.h"
+
+class AActor;
+class UWorld;
+class USceneCaptureComponent2D;
+
+/**
+ * Faces render into their own targets at any size, independent of the viewport and window
+ * (works with -RenderOffscreen), with linear HDR scene color (same signal the view extension
+ * reads before the tonemapper). Raster faces all render in the frame CaptureFaces is called;
+ * path-traced faces accumulate one pass per frame, all faces at once. Game thread only.
+ */
+class FIrradianceCaptureRig
+{
+public:
+
+    using FFaceRTs = TStaticArray<TRefCountPtr<IPooledRenderTarget>, IrradianceCommon::NumFaces>;
+
+    /** Spawns the rig actor and its six scene captures in World if needed. */
+    bool Ensure(UWorld* World, TConstArrayView<FQuat> FaceRots);
+
+    /**
+     * Renders the faces with FaceSidePx > 0 from PosWS (culled faces are skipped) for NumFrames
+     * frames (this one, then one per Tick), then queues the copy of every face out of its reusable
+     * target. Faces are available from ConsumeFaces.
+     */
+    bool CaptureFaces(const FVector& PosWS, TConstArrayView<int32> FaceSidePx, int32 NumFrames = 1, bool bPathTracing = false);
+
+    /** Renders the next frame of a multi-frame capture. Call once per frame while a capture is running. */
+    void Tick();
+
+    /** Faces of the last CaptureFaces once the RT has copied them (one-time consume). */
+    bool ConsumeFaces(FFaceRTs& OutFaces);
+
+    /** Drops a capture in flight (its faces are released when the copy completes). */
+    void CancelCapture();
+
+    /** Destroys the rig actor. */
+    void Destroy();
+
+private:
+
+    /** Copies of the faces, filled on the RT. */
+    struct FRigFrame
+    {
+        FFaceRTs            Faces;
+        std::atomic<bool>   bReady{ false };
+    };
+
+    /** Renders the planned faces once; after the last frame, queues the copy. */
+    void RenderFrame();
+
+    TWeakObjectPtr<AActor>                                                              RigActor;
+    TStaticArray<TWeakObjectPtr<USceneCaptureComponent2D>, IrradianceCommon::NumFaces>  Captures;
+    TSharedPtr<FRigFrame, ESPMode::ThreadSafe>                                          PendingFrame;
+    TStaticArray<bool, IrradianceCommon::NumFaces>                                      FacePlanned;
+    int32                                                                               FramesLeft = 0;
+};
@@ -0,0 +1,368 @@
+﻿// IrradianceColumnarFile.cpp
+
+#include "Irradiance/IrradianceColumnarFile.h"
+
+#include "Irradiance/IrradianceResultWriter.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "Logging/IrradianceLog.h"
+
+namespace
+{
+    constexpr uint32 Alignment = 64;
+    constexpr char FileMagic[4] = { 'P', 'Y', 'R', 'B' };
+    constexpr char ChunkMagic[4] = { 'P', 'Y', 'C', 'K' };
+
+    constexpr int64 UnixEpochTicks = 621355968000000000LL;     // FDateTime(1970, 1, 1).GetTicks()
+
+    void AppendU32(TArray<uint8>& Out, uint32 V)   { Out.Append(reinterpret_cast<const uint8*>(&V), sizeof(V)); }
+    void AppendU64(TArray<uint8>& Out, uint64 V)   { Out.Append(reinterpret_cast<const uint8*>(&V), sizeof(V)); }
+    void AppendF64(TArray<uint8>& Out, double V)   { Out.Append(reinterpret_cast<const uint8*>(&V), sizeof(V)); }
+
+    void AppendString(TArray<uint8>& Out, const FString& S)
+    {
+        const FTCHARToUTF8 Utf8(*S, S.Len());
+        AppendU32(Out, (uint32)Utf8.Length());
+        Out.Append(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+    }
+}
+
+// Same content and order as the CSV columns (name and GUID -> sensor_index)
+const FIrradianceColumnarFile::FColumnDesc FIrradianceColumnarFile::Columns[] =
+{
+    { TEXT("sensor_index"),             EColumnType::UInt32  },
+    { TEXT("utc"),                      EColumnType::Int64   },
+    { TEXT("pos_x"),                    EColumnType::Float64 },
+    { TEXT("pos_y"),                    EColumnType::Float64 },
+    { TEXT("pos_z"),                    EColumnType::Float64 },
+    { TEXT("n_x"),                      EColumnType::Float32 },
+    { TEXT("n_y"),                      EColumnType::Float32 },
+    { TEXT("n_z"),                      EColumnType::Float32 },
+    { TEXT("side_px"),                  EColumnType::Int32   },
+    { TEXT("warmup"),                   EColumnType::UInt32  },
+    { TEXT("azimuth_deg"),              EColumnType::Float32 },
+    { TEXT("altitude_deg"),             EColumnType::Float32 },
+    { TEXT("geometric_factor"),         EColumnType::Float32 },
+    { TEXT("clearsky_ghi_wm2"),         EColumnType::Float32 },
+    { TEXT("clearsky_dni_wm2"),         EColumnType::Float32 },
+    { TEXT("clearsky_dhi_wm2"),         EColumnType::Float32 },
+    { TEXT("sun_occluded"),             EColumnType::Int8    },
+    { TEXT("sun_hit_distance_m"),       EColumnType::Float32 },
+    { TEXT("sun_visibility"),           EColumnType::Float32 },
+    { TEXT("sky_view_factor"),          EColumnType::Float32 },
+    { TEXT("raw_r_lux"),                EColumnType::Float32 },
+    { TEXT("raw_g_lux"),                EColumnType::Float32 },
+    { TEXT("raw_b_lux"),                EColumnType::Float32 },
+    { TEXT("sim_comp_amb_lux"),         EColumnType::Float32 },
+    { TEXT("sim_comp_direct_lux"),      EColumnType::Float32 },
+    { TEXT("irr_final_normalized_wm2"), EColumnType::Float32 },
+};
+
+const int32 FIrradianceColumnarFile::NumColumns = UE_ARRAY_COUNT(FIrradianceColumnarFile::Columns);
+
+
+// -----------------------------------------------------------------------------
+//  Life Cycle
+// -----------------------------------------------------------------------------
+
+FIrradianceColumnarFile::~FIrradianceColumnarFile()
+{
+    // Without Close() the file has no footer, but its chunks can still be scanned
+    FileHandle.Reset();
+}
+
+
+bool FIrradianceColumnarFile::Open(const FString& InPathAbs, uint32 InChunkRows)
+{
+    PathAbs = InPathAbs;
+    ChunkRows = FMath::Max<uint32>(InChunkRows, 1u);
+
+    const FString Dir = FPaths::GetPath(PathAbs);
+    if (!Dir.IsEmpty() && !IFileManager::Get().DirectoryExists(*Dir))
+    {
+        IFileManager::Get().MakeDirectory(*Dir, true);
+    }
+
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    FileHandle.Reset(PlatformFile.OpenWrite(*PathAbs, /*bAppend*/ false, /*bAllowRead*/ true));
+    if (!FileHandle)
+    {
+        PYRANO_ERR(TEXT("[Columnar] Cannot open '%s' for writing."), *PathAbs);
+        return false;
+    }
+
+    FileOffset = 0;
+    GoodOffset = 0;
+    PendingRows = 0;
+    ChunkIndex.Reset();
+    bWriteFailed = false;
+
+    Pending.SetNum(NumColumns);
+    for (int32 c = 0; c < NumColumns; ++c)
+    {
+        Pending[c] = FColumnChunk();
+        Pending[c].Data.Reserve((int64)ChunkRows * TypeSize(Columns[c].Type));
+    }
+
+    // Header
+    TArray<uint8> Header;
+    Header.Append(reinterpret_cast<const uint8*>(FileMagic), 4);
+    AppendU32(Header, Version);
+    AppendU32(Header, (uint32)NumColumns);
+    AppendU32(Header, ChunkRows);
+    WriteBytes(Header.GetData(), Header.Num());
+    PadTo64();
+    GoodOffset = FileOffset;
+
+    return !bWriteFailed;
+}
+
+
+bool FIrradianceColumnarFile::Close(TConstArrayView<FSensor> Sensors)
+{
+    if (!FileHandle)
+        return false;
+
+    FlushChunk();
+
+    // A footer indexing chunks that are not on disk would be read as valid data
+    if (bWriteFailed)
+    {
+        FileHandle->Truncate(GoodOffset);
+        FileHandle->Flush(true);
+        FileHandle.Reset();
+        PYRANO_ERR(TEXT("[Columnar] '%s' is incomplete after a write error: no footer, %d whole chunk(s) kept (%llu bytes)."),
+            *PathAbs, ChunkIndex.Num(), GoodOffset);
+        return false;
+    }
+
+    // Footer
+    TArray<uint8> Footer;
+
+    AppendU32(Footer, (uint32)NumColumns);
+    for (int32 c = 0; c < NumColumns; ++c)
+    {
+        Footer.Add((uint8)Columns[c].Type);
+        AppendString(Footer, Columns[c].Name);
+    }
+
+    AppendU32(Footer, (uint32)Sensors.Num());
+    for (const FSensor& Sensor : Sensors)
+    {
+        AppendU32(Footer, Sensor.Id.A);
+        AppendU32(Footer, Sensor.Id.B);
+        AppendU32(Footer, Sensor.Id.C);
+        AppendU32(Footer, Sensor.Id.D);
+        AppendString(Footer, Sensor.Name);
+    }
+
+    AppendU32(Footer, (uint32)ChunkIndex.Num());
+    for (const FChunkIndex& Chunk : ChunkIndex)
+    {
+        AppendU64(Footer, Chunk.Offset);
+        AppendU32(Footer, Chunk.NumRows);
+        for (int32 c = 0; c < NumColumns; ++c)
+        {
+            AppendU64(Footer, Chunk.BufferOffsets[c]);
+            AppendF64(Footer, Chunk.Min[c]);
+            AppendF64(Footer, Chunk.Max[c]);
+        }
+    }
+
+    const uint64 FooterOffset = FileOffset;
+    WriteBytes(Footer.GetData(), Footer.Num());
+
+    // Trailer
+    TArray<uint8> Trailer;
+    AppendU64(Trailer, FooterOffset);
+    AppendU32(Trailer, (uint32)Footer.Num());
+    Trailer.Append(reinterpret_cast<const uint8*>(FileMagic), 4);
+    WriteBytes(Trailer.GetData(), Trailer.Num());
+
+    FileHandle->Flush(true);
+    FileHandle.Reset();
+
+    PYRANO_INFO(TEXT("[Columnar] Closed '%s' (chunks=%d, bytes=%llu)."), *PathAbs, ChunkIndex.Num(), FileOffset);
+    return !bWriteFailed;
+}
+
+
+// -----------------------------------------------------------------------------
+//  Rows
+// -----------------------------------------------------------------------------
+
+template<typename T>
+void FIrradianceColumnarFile::Put(int32 ColIdx, T Value)
+{
+    checkSlow(TypeSize(Columns[ColIdx].Type) == sizeof(T));
+
+    FColumnChunk& Col = Pending[ColIdx];
+    Col.Data.Append(reinterpret_cast<const uint8*>(&Value), sizeof(T));
+    Col.Min = FMath::Min(Col.Min, (double)Value);
+    Col.Max = FMath::Max(Col.Max, (double)Value);
+}
+
+
+void FIrradianceColumnarFile::AddRow(const FIrradianceResultRow& Row, uint32 SensorIndex)
+{
+    if (!FileHandle || bWriteFailed)
+        return;
+
+    // Same order as Columns[]
+    int32 c = 0;
+    Put<uint32>(c++, SensorIndex);
+    Put<int64>(c++, (Row.TimestampTicks - UnixEpochTicks) / ETimespan::TicksPerMicrosecond);
+    Put<double>(c++, Row.PosWS.X);
+    Put<double>(c++, Row.PosWS.Y);
+    Put<double>(c++, Row.PosWS.Z);
+    Put<float>(c++, (float)Row.NormalWS.X);
+    Put<float>(c++, (float)Row.NormalWS.Y);
+    Put<float>(c++, (float)Row.NormalWS.Z);
+    Put<int32>(c++, Row.SidePx);
+    Put<uint32>(c++, Row.WarmupFrames);
+    Put<float>(c++, Row.AzimuthDeg);
+    Put<float>(c++, Row.AltitudeDeg);
+    Put<float>(c++, Row.GeometricFactor);
+    Put<float>(c++, (float)Row.ClearSkyGHI);
+    Put<float>(c++, (float)Row.ClearSkyDNI);
+    Put<float>(c++, (float)Row.ClearSkyDHI);
+    Put<int8>(c++, (int8)FMath::Clamp(Row.SunOccluded, -1, 1));
+    Put<float>(c++, Row.SunHitDistanceM);
+    Put<float>(c++, Row.SunVisibility);
+    Put<float>(c++, Row.SkyViewFactor);
+    Put<float>(c++, Row.IrrR);
+    Put<float>(c++, Row.IrrG);
+    Put<float>(c++, Row.IrrB);
+    Put<float>(c++, Row.IrrMean);
+    Put<float>(c++, Row.IrrDir);
+    Put<float>(c++, Row.TotalIrradiance);
+    check(c == NumColumns);
+
+    if (++PendingRows >= ChunkRows)
+    {
+        FlushChunk();
+    }
+}
+
+
+void FIrradianceColumnarFile::FlushChunk()
+{
+    if (!FileHandle || PendingRows == 0)
+        return;
+
+    // Rows after a write error are dropped (see Close)
+    if (bWriteFailed)
+    {
+        ResetPending();
+        return;
+    }
+
+    FChunkIndex& Chunk = ChunkIndex.AddDefaulted_GetRef();
+    Chunk.Offset = FileOffset;
+    Chunk.NumRows = PendingRows;
+    Chunk.BufferOffsets.SetNumUninitialized(NumColumns);
+    Chunk.Min.SetNumUninitialized(NumColumns);
+    Chunk.Max.SetNumUninitialized(NumColumns);
+
+    TArray<uint8> ChunkHeader;
+    ChunkHeader.Append(reinterpret_cast<const uint8*>(ChunkMagic), 4);
+    AppendU32(ChunkHeader, PendingRows);
+    WriteBytes(ChunkHeader.GetData(), ChunkHeader.Num());
+    PadTo64();
+
+    for (int32 c = 0; c < NumColumns; ++c)
+    {
+        FColumnChunk& Col = Pending[c];
+        Chunk.BufferOffsets[c] = FileOffset;
+        Chunk.Min[c] = Col.Min;
+        Chunk.Max[c] = Col.Max;
+
+        WriteBytes(Col.Data.GetData(), Col.Data.Num());
+        PadTo64();
+    }
+
+    // A torn chunk is not indexed; the file is cut back to the previous one on Close
+    if (bWriteFailed)
+    {
+        ChunkIndex.Pop();
+    }
+    else
+    {
+        GoodOffset = FileOffset;
+    }
+
+    ResetPending();
+}
+
+
+void FIrradianceColumnarFile::ResetPending()
+{
+    for (FColumnChunk& Col : Pending)
+    {
+        Col.Data.Reset();
+        Col.Min = TNumericLimits<double>::Max();
+        Col.Max = TNumericLimits<double>::Lowest();
+    }
+    PendingRows = 0;
+}
+
+
+void FIrradianceColumnarFile::FlushToDisk()
+{
+    if (FileHandle)
+    {
+        FileHandle->Flush(true);
+    }
+}
+
+
+// -----------------------------------------------------------------------------
+//  Helpers
+// -----------------------------------------------------------------------------
+
+int32 FIrradianceColumnarFile::TypeSize(EColumnType Type)
+{
+    switch (Type)
+    {
+    case EColumnType::Int8:     return 1;
+    case EColumnType::Int32:    return 4;
+    case EColumnType::UInt32:   return 4;
+    case EColumnType::Int64:    return 8;
+    case EColumnType::Float32:  return 4;
+    case EColumnType::Float64:  return 8;
+    default:                    return 0;
+    }
+}
+
+
+bool FIrradianceColumnarFile::WriteBytes(const void* Data, int64 Size)
+{
+    if (Size <= 0)
+        return true;
+
+    // Offsets past a failed write would be wrong: nothing else is written
+    if (bWriteFailed)
+        return false;
+
+    if (!FileHandle->Write(static_cast<const uint8*>(Data), Size))
+    {
+        if (!bWriteFailed)
+        {
+            PYRANO_ERR(TEXT("[Columnar] Write failed on '%s' at offset %llu."), *PathAbs, FileOffset);
+        }
+        bWriteFailed = true;
+        return false;
+    }
+
+    FileOffset += (uint64)Size;
+    return true;
+}
+
+
+bool FIrradianceColumnarFile::PadTo64()
+{
+    static const uint8 Zeros[Alignment] = {};
+    const uint32 Rem = (uint32)(FileOffset % Alignment);
+    return Rem == 0 || WriteBytes(Zeros, Alignment - Rem);
+}
\ No newline at end of file
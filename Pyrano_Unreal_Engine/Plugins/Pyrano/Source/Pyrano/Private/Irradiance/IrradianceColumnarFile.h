@@ -0,0 +1,132 @@
+/*=============================================================================
+    IrradianceColumnarFile.h
+  Columnar binary output (.pyrb) with the same content as the irradiance CSV.
+  Written incrementally in chunks, readable with a memory map.
+/============================================================================*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class IFileHandle;
+struct FIrradianceResultRow;
+
+/**
+ * .pyrb layout (little-endian, every block 64-byte aligned):
+ *
+ *  Header   (64 B)  "PYRB", uint32 Version, uint32 NumColumns, uint32 ChunkRows, zero padding.
+ *  Chunk    (xN)    "PYCK", uint32 NumRows, zero padding to 64 B, then one buffer per column
+ *                   (NumRows values of the column type), each starting 64-byte aligned.
+ *                   Chunk headers make the file recoverable by a linear scan if the footer is missing.
+ *  Footer           uint32 NumColumns;  per column: uint8 Type, uint32 NameLen, UTF-8 name.
+ *                   uint32 NumSensors;  per sensor: uint32 GUID[A,B,C,D], uint32 NameLen, UTF-8 name.
+ *                   uint32 NumChunks;   per chunk:  uint64 Offset, uint32 NumRows,
+ *                                                   per column: uint64 BufferOffset, float64 Min, float64 Max.
+ *  Trailer  (16 B)  uint64 FooterOffset, uint32 FooterSize, "PYRB".
+ *
+ * Strings are dictionary-encoded: sensor_index points into the footer's sensor table
+ * (GUID string = the four words as %08X). utc is int64 microseconds since the Unix epoch.
+ * A column buffer maps directly to an array, e.g. numpy.frombuffer(mm, dtype, NumRows, BufferOffset).
+ */
+class FIrradianceColumnarFile
+{
+public:
+
+    /** Column element types, as stored in the footer. */
+    enum class EColumnType : uint8
+    {
+        Int8    = 0,
+        Int32   = 1,
+        UInt32  = 2,
+        Int64   = 3,
+        Float32 = 4,
+        Float64 = 5,
+    };
+
+    /** Sensor of the dictionary (index = position in the table). */
+    struct FSensor
+    {
+        FGuid   Id;
+        FString Name;
+    };
+
+    static constexpr uint32 Version = 1;
+    static constexpr uint32 DefaultChunkRows = 65536;
+
+    ~FIrradianceColumnarFile();
+
+    /** Creates (truncates) the file and writes the header. */
+    bool Open(const FString& InPathAbs, uint32 InChunkRows = DefaultChunkRows);
+
+    /** Adds a row; the chunk is written once full. */
+    void AddRow(const FIrradianceResultRow& Row, uint32 SensorIndex);
+
+    /** Writes the rows buffered so far as a (possibly short) chunk. */
+    void FlushChunk();
+
+    /** Flushes the OS buffers of the file. */
+    void FlushToDisk();
+
+    /**
+     * Writes the last chunk, the footer and the trailer, and closes the file.
+     * After a write error nothing more is written: the file is cut back to its last whole
+     * chunk, left without footer (linear scan only) and false is returned.
+     */
+    bool Close(TConstArrayView<FSensor> Sensors);
+
+    bool IsOpen() const { return FileHandle.IsValid(); }
+    const FString& GetPath() const { return PathAbs; }
+
+private:
+
+    struct FColumnDesc
+    {
+        const TCHAR*    Name;
+        EColumnType     Type;
+    };
+
+    /** Rows of the current chunk, one byte buffer per column, plus its stats. */
+    struct FColumnChunk
+    {
+        TArray<uint8>   Data;
+        double          Min = TNumericLimits<double>::Max();
+        double          Max = TNumericLimits<double>::Lowest();
+    };
+
+    /** Footer entry of a written chunk. */
+    struct FChunkIndex
+    {
+        uint64          Offset = 0;
+        uint32          NumRows = 0;
+        TArray<uint64>  BufferOffsets;
+        TArray<double>  Min;
+        TArray<double>  Max;
+    };
+
+    static const FColumnDesc Columns[];
+    static const int32 NumColumns;
+
+    static int32 TypeSize(EColumnType Type);
+
+    template<typename T>
+    void Put(int32 ColIdx, T Value);
+
+    /** Appends bytes to the file, tracking the offset. */
+    bool WriteBytes(const void* Data, int64 Size);
+
+    /** Zero padding up to the next 64-byte boundary. */
+    bool PadTo64();
+
+    /** Empties the column buffers of the current chunk. */
+    void ResetPending();
+
+    FString                     PathAbs;
+    TUniquePtr<IFileHandle>     FileHandle;
+    uint64                      FileOffset = 0;
+    uint64                      GoodOffset = 0;     // end of the header / last chunk written whole
+    uint32                      ChunkRows = DefaultChunkRows;
+    uint32                      PendingRows = 0;
+    TArray<FColumnChunk>        Pending;
+    TArray<FChunkIndex>         ChunkIndex;
+    bool                        bWriteFailed = false;
+};
@@ -30,6 +30,37 @@ TArray<FQuat> IrradianceCommon::Utils::GenerateCubemapFaceQuats()
 }
 
 
+TStaticArray<int32, IrradianceCommon::NumFaces> IrradianceCommon::Utils::PlanCubemapFaces(const FVector& NormalWS, int32 SidePx)
+{
+    TStaticArray<int32, NumFaces> Sides;
+
+    // Grazing size: multiple of 8 (integrate groups), never above the full side
+    const int32 Scaled = FMath::RoundToInt(SidePx * Defaults::GrazingFaceScale / 8.f) * 8;
+    const int32 GrazingPx = FMath::Min(SidePx, FMath::Max(Defaults::MinFaceSidePx, Scaled));
+
+    // Face f spans the directions with component Axis = Sign and the other two in [-1, 1]
+    // (same parametrization as AFromFaceUV), so dot(N, dir) over the face lies in
+    // [Sign*N[Axis] - Rest, Sign*N[Axis] + Rest], Rest = sum of |N| on the other axes.
+    const FVector N = NormalWS.GetSafeNormal();
+    for (int32 f = 0; f < NumFaces; ++f)
+    {
+        const int32 Axis = f / 2;
+        const double Sign = (f % 2 == 0) ? 1.0 : -1.0;
+        const double Center = Sign * N[Axis];
+        const double Rest = FMath::Abs(N[(Axis + 1) % 3]) + FMath::Abs(N[(Axis + 2) % 3]);
+
+        if (Center + Rest <= 0.0)
+            Sides[f] = 0;                   // no texel above the sensor plane
+        else if (Center - Rest >= 0.0)
+            Sides[f] = SidePx;              // whole face in the hemisphere
+        else
+            Sides[f] = GrazingPx;
+    }
+
+    return Sides;
+}
+
+
 bool IrradianceCommon::Utils::IsPIEClientWorld(const UWorld* W)
 {
     if (!W) 
@@ -0,0 +1,428 @@
+﻿// IrradianceCubemapArchive.cpp
+
+#include "Irradiance/IrradianceCubemapArchive.h"
+
+#include "HAL/PlatformFileManager.h"
+#include "HAL/FileManager.h"
+#include "Misc/Compression.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "Logging/IrradianceLog.h"
+
+using namespace PyranoCubemapArchive;
+
+namespace
+{
+    constexpr char ArchiveMagic[4] = { 'P', 'Y', 'C', 'A' };
+    constexpr char EntryMagic[4] = { 'P', 'Y', 'C', 'E' };
+
+    constexpr int64 HeaderSize = 32;
+    constexpr int64 EntryHeaderSize = 32;
+    constexpr int64 IndexEntrySize = 36;
+    constexpr int64 TrailerSize = 16;
+
+    /** Little-endian field writer. */
+    struct FByteWriter
+    {
+        TArray<uint8>& Out;
+
+        template<typename T>
+        FByteWriter& operator<<(T V)
+        {
+            Out.Append(reinterpret_cast<const uint8*>(&V), sizeof(T));
+            return *this;
+        }
+
+        void Magic(const char (&M)[4]) { Out.Append(reinterpret_cast<const uint8*>(M), 4); }
+    };
+
+    /** Little-endian field reader (bounds-checked). */
+    struct FByteReader
+    {
+        const uint8* Data;
+        int64 Size;
+        int64 Pos = 0;
+        bool bOk = true;
+
+        template<typename T>
+        T Get()
+        {
+            T V{};
+            if (Pos + (int64)sizeof(T) > Size)
+            {
+                bOk = false;
+                return V;
+            }
+            FMemory::Memcpy(&V, Data + Pos, sizeof(T));
+            Pos += sizeof(T);
+            return V;
+        }
+
+        bool Magic(const char (&M)[4])
+        {
+            if (Pos + 4 > Size || FMemory::Memcmp(Data + Pos, M, 4) != 0)
+            {
+                bOk = false;
+                return false;
+            }
+            Pos += 4;
+            return true;
+        }
+    };
+
+    void WriteEntryFields(FByteWriter& W, const FEntry& E)
+    {
+        W << E.TimestampTicks << E.Face << (uint8)E.Codec << (uint16)0 << E.Width << E.Height;
+    }
+
+    void ReadEntryFields(FByteReader& R, FEntry& E)
+    {
+        E.TimestampTicks = R.Get<int64>();
+        E.Face = R.Get<uint8>();
+        E.Codec = (ECodec)R.Get<uint8>();
+        R.Get<uint16>();
+        E.Width = R.Get<int32>();
+        E.Height = R.Get<int32>();
+    }
+}
+
+
+FString PyranoCubemapArchive::MakeFileName(const FGuid& SensorId, const FDateTime& UTC)
+{
+    return FString::Printf(TEXT("%s_%s.pyca"), *SensorId.ToString(), *UTC.ToString(TEXT("%Y%m%d")));
+}
+
+
+// -----------------------------------------------------------------------------
+//  Writer
+// -----------------------------------------------------------------------------
+
+FIrradianceCubemapArchiveWriter::~FIrradianceCubemapArchiveWriter()
+{
+    Close();
+}
+
+
+bool FIrradianceCubemapArchiveWriter::Open(const FString& InPathAbs, const FGuid& InSensorId)
+{
+    FScopeLock Lock(&Mutex);
+
+    PathAbs = InPathAbs;
+    SensorId = InSensorId;
+    Entries.Reset();
+
+    const FString Dir = FPaths::GetPath(PathAbs);
+    if (!Dir.IsEmpty() && !IFileManager::Get().DirectoryExists(*Dir))
+    {
+        IFileManager::Get().MakeDirectory(*Dir, true);
+    }
+
+    // Existing archive of the same sensor: keep its entries, append after them
+    uint64 AppendAt = 0;
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    if (PlatformFile.FileSize(*PathAbs) > 0)
+    {
+        FIrradianceCubemapArchiveReader Existing;
+        if (Existing.Open(PathAbs) && Existing.GetSensorId() == SensorId)
+        {
+            Entries = Existing.GetEntries();
+            AppendAt = HeaderSize;
+            for (const FEntry& E : Entries)
+            {
+                AppendAt = FMath::Max<uint64>(AppendAt, E.DataOffset + E.StoredSize);
+            }
+        }
+        else
+        {
+            PYRANO_WARN(TEXT("[Archive] '%s' is not a readable archive of this sensor. Overwriting."), *PathAbs);
+        }
+    }
+
+    FileHandle.Reset(PlatformFile.OpenWrite(*PathAbs, /*bAppend*/ AppendAt > 0, /*bAllowRead*/ true));
+    if (!FileHandle)
+    {
+        PYRANO_ERR(TEXT("[Archive] Cannot open '%s' for writing."), *PathAbs);
+        return false;
+    }
+
+    if (AppendAt > 0)
+    {
+        // The old index and trailer get overwritten by the new entries
+        FileHandle->Seek((int64)AppendAt);
+        FileOffset = AppendAt;
+        return true;
+    }
+
+    FileOffset = 0;
+    TArray<uint8> Header;
+    FByteWriter W{ Header };
+    W.Magic(ArchiveMagic);
+    W << Version << SensorId.A << SensorId.B << SensorId.C << SensorId.D << (uint64)0;
+    return WriteBytes(Header.GetData(), Header.Num());
+}
+
+
+bool FIrradianceCubemapArchiveWriter::AddFace(int64 TimestampTicks, uint8 Face, int32 Width, int32 Height,
+    TConstArrayView64<FFloat16> RGBHalf, bool bCompress)
+{
+    const int64 RawSize = RGBHalf.Num() * (int64)sizeof(FFloat16);
+    if (RGBHalf.Num() != (int64)Width * Height * 3 || RawSize > MAX_int32)
+    {
+        PYRANO_WARN(TEXT("[Archive] Face %d of %dx%d has %lld values. Skipped."), Face, Width, Height, RGBHalf.Num());
+        return false;
+    }
+
+    FEntry Entry;
+    Entry.TimestampTicks = TimestampTicks;
+    Entry.Face = Face;
+    Entry.Width = Width;
+    Entry.Height = Height;
+    Entry.RawSize = (uint32)RawSize;
+
+    // Compression happens before taking the lock
+    TArray<uint8> Stored;
+    if (bCompress)
+    {
+        int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Zlib, (int32)RawSize);
+        Stored.SetNumUninitialized(CompressedSize);
+        if (FCompression::CompressMemory(NAME_Zlib, Stored.GetData(), CompressedSize, RGBHalf.GetData(), (int32)RawSize)
+            && CompressedSize < RawSize)
+        {
+            Stored.SetNum(CompressedSize, EAllowShrinking::No);
+            Entry.Codec = ECodec::Zlib;
+        }
+    }
+    if (Entry.Codec == ECodec::Raw)
+    {
+        Stored.Reset();
+        Stored.Append(reinterpret_cast<const uint8*>(RGBHalf.GetData()), RawSize);
+    }
+    Entry.StoredSize = (uint32)Stored.Num();
+
+    TArray<uint8> EntryHeader;
+    FByteWriter W{ EntryHeader };
+    W.Magic(EntryMagic);
+    WriteEntryFields(W, Entry);
+    W << Entry.StoredSize << Entry.RawSize;
+
+    FScopeLock Lock(&Mutex);
+    if (!FileHandle)
+        return false;
+
+    Entry.DataOffset = FileOffset + EntryHeader.Num();
+    if (!WriteBytes(EntryHeader.GetData(), EntryHeader.Num()) || !WriteBytes(Stored.GetData(), Stored.Num()))
+        return false;
+
+    Entries.Add(Entry);
+    return true;
+}
+
+
+bool FIrradianceCubemapArchiveWriter::Close()
+{
+    FScopeLock Lock(&Mutex);
+    if (!FileHandle)
+        return false;
+
+    TArray<uint8> Tail;
+    Tail.Reserve(Entries.Num() * IndexEntrySize + TrailerSize);
+    FByteWriter W{ Tail };
+
+    const uint64 IndexOffset = FileOffset;
+    for (const FEntry& E : Entries)
+    {
+        WriteEntryFields(W, E);
+        W << E.DataOffset << E.StoredSize << E.RawSize;
+    }
+
+    W << IndexOffset << (uint32)Entries.Num();
+    W.Magic(ArchiveMagic);
+
+    const bool bOk = WriteBytes(Tail.GetData(), Tail.Num());
+
+    // A recovered archive may have had a cut entry past the new end
+    FileHandle->Truncate((int64)FileOffset);
+    FileHandle->Flush(true);
+    FileHandle.Reset();
+
+    PYRANO_VERBOSE(TEXT("[Archive] Closed '%s' (entries=%d, bytes=%llu)."), *PathAbs, Entries.Num(), FileOffset);
+    return bOk;
+}
+
+
+bool FIrradianceCubemapArchiveWriter::WriteBytes(const void* Data, int64 Size)
+{
+    if (Size <= 0)
+        return true;
+
+    if (!FileHandle->Write(static_cast<const uint8*>(Data), Size))
+    {
+        PYRANO_ERR(TEXT("[Archive] Write failed on '%s' at offset %llu."), *PathAbs, FileOffset);
+        return false;
+    }
+    FileOffset += (uint64)Size;
+    return true;
+}
+
+
+// -----------------------------------------------------------------------------
+//  Reader
+// -----------------------------------------------------------------------------
+
+FIrradianceCubemapArchiveReader::~FIrradianceCubemapArchiveReader()
+{
+    Close();
+}
+
+
+bool FIrradianceCubemapArchiveReader::Open(const FString& InPathAbs, bool bScanIfNoIndex)
+{
+    Close();
+    PathAbs = InPathAbs;
+
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    FileHandle.Reset(PlatformFile.OpenRead(*PathAbs, /*bAllowWrite*/ true));
+    if (!FileHandle)
+        return false;
+
+    const int64 FileSize = FileHandle->Size();
+
+    // Header
+    uint8 HeaderBytes[HeaderSize];
+    if (FileSize < HeaderSize || !ReadAt(0, HeaderBytes, HeaderSize))
+        return false;
+
+    FByteReader H{ HeaderBytes, HeaderSize };
+    if (!H.Magic(ArchiveMagic) || H.Get<uint32>() != Version)
+    {
+        PYRANO_WARN(TEXT("[Archive] '%s' is not a cubemap archive (v%u)."), *PathAbs, Version);
+        return false;
+    }
+    SensorId.A = H.Get<uint32>();
+    SensorId.B = H.Get<uint32>();
+    SensorId.C = H.Get<uint32>();
+    SensorId.D = H.Get<uint32>();
+
+    // Trailer + index
+    bool bIndexOk = false;
+    uint8 TrailerBytes[TrailerSize];
+    if (FileSize >= HeaderSize + TrailerSize && ReadAt(FileSize - TrailerSize, TrailerBytes, TrailerSize))
+    {
+        FByteReader T{ TrailerBytes, TrailerSize };
+        const uint64 IndexOffset = T.Get<uint64>();
+        const uint32 NumEntries = T.Get<uint32>();
+
+        if (T.Magic(ArchiveMagic) && IndexOffset + (uint64)NumEntries * IndexEntrySize + TrailerSize == (uint64)FileSize)
+        {
+            TArray<uint8> Index;
+            Index.SetNumUninitialized(NumEntries * IndexEntrySize);
+            if (ReadAt(IndexOffset, Index.GetData(), Index.Num()))
+            {
+                FByteReader R{ Index.GetData(), Index.Num() };
+                Entries.SetNum(NumEntries);
+                for (FEntry& E : Entries)
+                {
+                    ReadEntryFields(R, E);
+                    E.DataOffset = R.Get<uint64>();
+                    E.StoredSize = R.Get<uint32>();
+                    E.RawSize = R.Get<uint32>();
+                }
+                bIndexOk = R.bOk;
+            }
+        }
+    }
+
+    if (!bIndexOk)
+    {
+        Entries.Reset();
+        if (!bScanIfNoIndex || !ScanEntries((uint64)FileSize))
+            return false;
+
+        PYRANO_WARN(TEXT("[Archive] '%s' has no index (interrupted run?). Recovered %d entries by scanning."),
+            *PathAbs, Entries.Num());
+    }
+
+    for (int32 i = 0; i < Entries.Num(); ++i)
+    {
+        Lookup.Add(TPair<int64, uint8>(Entries[i].TimestampTicks, Entries[i].Face), i);
+    }
+    return true;
+}
+
+
+void FIrradianceCubemapArchiveReader::Close()
+{
+    FileHandle.Reset();
+    Entries.Reset();
+    Lookup.Reset();
+    SensorId.Invalidate();
+}
+
+
+int32 FIrradianceCubemapArchiveReader::FindEntry(const FDateTime& UTC, uint8 Face) const
+{
+    const int32* Found = Lookup.Find(TPair<int64, uint8>(UTC.GetTicks(), Face));
+    return Found ? *Found : INDEX_NONE;
+}
+
+
+bool FIrradianceCubemapArchiveReader::ReadFace(int32 EntryIdx, TArray64<FFloat16>& OutRGBHalf) const
+{
+    if (!Entries.IsValidIndex(EntryIdx))
+        return false;
+
+    const FEntry& E = Entries[EntryIdx];
+    if (E.RawSize != (uint32)((int64)E.Width * E.Height * 3 * sizeof(FFloat16)))
+        return false;
+
+    OutRGBHalf.SetNumUninitialized((int64)E.Width * E.Height * 3);
+
+    if (E.Codec == ECodec::Raw)
+    {
+        return E.StoredSize == E.RawSize && ReadAt(E.DataOffset, OutRGBHalf.GetData(), E.RawSize);
+    }
+
+    TArray<uint8> Stored;
+    Stored.SetNumUninitialized(E.StoredSize);
+    if (!ReadAt(E.DataOffset, Stored.GetData(), E.StoredSize))
+        return false;
+
+    return FCompression::UncompressMemory(NAME_Zlib, OutRGBHalf.GetData(), (int32)E.RawSize, Stored.GetData(), (int32)E.StoredSize);
+}
+
+
+bool FIrradianceCubemapArchiveReader::ReadAt(uint64 Offset, void* Dst, int64 Size) const
+{
+    FScopeLock Lock(&ReadMutex);
+    return FileHandle
+        && FileHandle->Seek((int64)Offset)
+        && FileHandle->Read(static_cast<uint8*>(Dst), Size);
+}
+
+
+bool FIrradianceCubemapArchiveReader::ScanEntries(uint64 FileSize)
+{
+    uint64 Offset = HeaderSize;
+    uint8 HeaderBytes[EntryHeaderSize];
+
+    while (Offset + EntryHeaderSize <= FileSize && ReadAt(Offset, HeaderBytes, EntryHeaderSize))
+    {
+        FByteReader R{ HeaderBytes, EntryHeaderSize };
+        if (!R.Magic(EntryMagic))
+            break;
+
+        FEntry E;
+        ReadEntryFields(R, E);
+        E.StoredSize = R.Get<uint32>();
+        E.RawSize = R.Get<uint32>();
+        E.DataOffset = Offset + EntryHeaderSize;
+
+        // Last entry cut short by the interruption
+        if (!R.bOk || E.DataOffset + E.StoredSize > FileSize)
+            break;
+
+        Entries.Add(E);
+        Offset = E.DataOffset + E.StoredSize;
+    }
+    return true;
+}
\ No newline at end of file
@@ -9,41 +9,88 @@
 #include "RenderTargetPool.h"
 #include "Logging/IrradianceLog.h"
 #include "Simulation/CaptureRequest.h" 
+#include "Simulation/SimulationShard.h"
 
 #include "ImageWriteQueue.h"
 #include "ImageWriteTask.h"
 #include "ImagePixelData.h"
 #include "Modules/ModuleManager.h"
+#include "Tasks/Task.h"
 #include "HAL/FileManager.h"
-#include "Misc/FileHelper.h"
 #include "Misc/Paths.h"
 
+/** A cubemap face copied to a staging texture, waiting to be read and encoded. */
+struct UIrradianceExporter::FFaceReadback
+{
+    TUniquePtr<FRHIGPUTextureReadback> Readback;
+    FIntPoint           Size = FIntPoint::ZeroValue;
+    FString             OutEXR;
+    bool                bCompress = true;
+    IImageWriteQueue*   WriteQueue = nullptr;
+
+    // Archive mode (OutEXR is unused)
+    TSharedPtr<FIrradianceCubemapArchiveWriter, ESPMode::ThreadSafe> Archive;
+    int64               TimestampTicks = 0;
+    uint8               Face = 0;
+
+    // Set on the RT once the copy is in the command list (Readback is null if it was skipped)
+    std::atomic<bool>   bCopyEnqueued{ false };
+};
+
+
 // -----------------------------------------------------------------------------
 //  Init
 // -----------------------------------------------------------------------------
 
 void UIrradianceExporter::Init(const FExportOptions& InOpts)
 {
-    // Base dir
-    FString Base = InOpts.OutputDir.Path;
-    if (Base.IsEmpty())
-        Base = FPaths::ProjectSavedDir() / TEXT("Irradiance");
+    // A new Init starts a new file
+    CloseCSV();
 
+    // Base dir
+    const FString Base = ResolveOutputDir(InOpts);
     IFileManager::Get().MakeDirectory(*Base, true);
 
-    // CSV
-    const FString Stamp = FDateTime::UtcNow().ToString(TEXT("%Y%m%d_%H%M%S"));
-    const FString CSVName = FPaths::GetBaseFilename(InOpts.CSVFilename) + TEXT("_") + Stamp + TEXT(".csv");
+    // CSV: shards of a run need names every instance and the merge agree on (a re-run appends, the merge de-duplicates)
+    const FString Suffix = InOpts.ShardCount > 1
+        ? FSimShard::MakeFileSuffix(InOpts.ShardIndex, InOpts.ShardCount)
+        : TEXT("_") + FDateTime::UtcNow().ToString(TEXT("%Y%m%d_%H%M%S"));
+    const FString CSVName = InOpts.ResumeCSVFile.IsEmpty()
+        ? FPaths::GetBaseFilename(InOpts.CSVFilename) + Suffix + TEXT(".csv")
+        : InOpts.ResumeCSVFile;
     CSVPathAbs = FPaths::Combine(Base, CSVName);
+    ResumeCSVBytes = InOpts.ResumeCSVFile.IsEmpty() ? -1 : InOpts.ResumeCSVBytes;
+    bCompressImages = InOpts.bCompressImages;
+    bArchiveImages = InOpts.bArchiveImages;
+    CloseArchives();
+    BinaryPathAbs = FPaths::ChangeExtension(CSVPathAbs, TEXT(".pyrb"));
+    SHPathAbs = FPaths::Combine(Base, FPaths::GetBaseFilename(CSVName) + TEXT("_sh.csv"));
+    bWriteCSV = InOpts.bExportCSV;
+    bWriteBinary = InOpts.bExportBinary;
 
     // Images
     ImagesPathAbs = FPaths::Combine(Base, InOpts.ImagesSubdir);
     IFileManager::Get().MakeDirectory(*ImagesPathAbs, true);
 
-    PYRANO_INFO(TEXT("[Exporter] Init: this=%p outer=%s CSVPathAbs='%s'"),
+    PYRANO_INFO(TEXT("[Exporter] Init: this=%p outer=%s CSVPathAbs='%s' Binary=%s"),
         this,
         *GetNameSafe(GetOuter()),
-        *CSVPathAbs);
+        *CSVPathAbs,
+        bWriteBinary ? TEXT("true") : TEXT("false"));
+}
+
+
+FString UIrradianceExporter::ResolveOutputDir(const FExportOptions& InOpts)
+{
+    return InOpts.OutputDir.Path.IsEmpty()
+        ? FPaths::ProjectSavedDir() / TEXT("Irradiance")
+        : InOpts.OutputDir.Path;
+}
+
+
+bool UIrradianceExporter::GetDurablePoint(uint64& OutRows, int64& OutCSVBytes) const
+{
+    return ResultWriter && ResultWriter->GetDurablePoint(OutRows, OutCSVBytes);
 }
 
 
@@ -62,7 +109,7 @@ bool UIrradianceExporter::EnsureCSVWritable() const
         return false;
     }
 
-    // Directory existence check (do not create here since this is const; creation in EnsureCSVHeader/Flush)
+    // Directory existence check (do not create here since this is const; the writer creates it)
     return true;
 }
 
@@ -79,269 +126,297 @@ void UIrradianceExporter::AppendIrradianceRow(const FCaptureRequest& Req,
     float Azimuth, float Altitude, float GeometricFactor,
     int32 SunOccluded, float SunHitDistanceM, float SunVisibility)
 {
-    if (!EnsureCSVWritable())
+    if (!EnsureResultWriter())
         return;
 
-    EnsureCSVHeader();
+    // Names are sent once per sensor; rows only carry plain values
+    if (!DeclaredSensors.Contains(Req.SensorId))
+    {
+        ResultWriter->DeclareSensor(Req.SensorId, Req.SensorName);
+        DeclaredSensors.Add(Req.SensorId);
+    }
+
+    FIrradianceResultRow Row;
 
     // Time / ID
-    const FString& SensorName = Req.SensorName;
-    const FString  SensorIdStr = Req.SensorId.ToString();
-    const FString  TimeStr = Req.TimestampUTC.ToIso8601();
+    Row.SensorId = Req.SensorId;
+    Row.TimestampTicks = Req.TimestampUTC.GetTicks();
 
     // Sensor
-    const FVector& Pos = Req.PosWS;
-    const FVector& N = Req.NormalWS;
+    Row.PosWS = Req.PosWS;
+    Row.NormalWS = Req.NormalWS;
+    Row.SidePx = Req.SidePx;
+    Row.WarmupFrames = Req.WarmupFrames;
 
     // Solar Geometry
-    const float SunAzDeg = Azimuth;
-    const float SunAltDeg = Altitude;
-    const float GeomF = GeometricFactor;
+    Row.AzimuthDeg = Azimuth;
+    Row.AltitudeDeg = Altitude;
+    Row.GeometricFactor = GeometricFactor;
 
     // Clear-sky
-    const double CS_GHI = ClearSkyGHI;
-    const double CS_DNI = ClearSkyDNI;
-    const double CS_DHI = ClearSkyDHI;
+    Row.ClearSkyGHI = ClearSkyGHI;
+    Row.ClearSkyDNI = ClearSkyDNI;
+    Row.ClearSkyDHI = ClearSkyDHI;
 
     // Occlusion
-    const int32  Occluded = SunOccluded;
-    const float HitDistM = SunHitDistanceM;
-    const float Visibility = SunVisibility;
+    Row.SunOccluded = SunOccluded;
+    Row.SunHitDistanceM = SunHitDistanceM;
+    Row.SunVisibility = SunVisibility;
+
+    // Sky View Factor
+    Row.SkyViewFactor = Req.SkyViewFactor;
 
     // Irradiance
-    const float DiffR_Lux = IrrR;
-    const float DiffG_Lux = IrrG;
-    const float DiffB_Lux = IrrB;
-    const float Diff_Lux = IrrMean;
-    const float Dir_Lux = IrrDir;
-    const float Irradiance_wm2 = TotalIrradiance;
-
-    const FString Line = FString::Printf(
-        TEXT(
-                // SensorName, SensorId, Timestamp
-                "%s,%s,%s,"
-
-                // --- Sensor ---
-                "%.6f,%.6f,%.6f,"
-                "%.6f,%.6f,%.6f,"
-                "%d,%u,"
-
-                // --- Solar Geometry ---
-                "%.3f,%.3f,%.6f,"
-
-                // --- Clear-sky ---
-                "%.6f,%.6f,%.6f,"
-
-                // --- Occlusion ---
-                "%d,%.3f,%.3f,"
-
-                // --- Sky View Factor ---
-                "%.6f,"
-
-                // --- Ambient (RGB + mean) ---
-                "%.9f,%.9f,%.9f,%.9f,"
-
-                // --- Direct ---
-                "%.9f,"
-
-                // -- Total (Normalized) --
-                "%.9f\n"
-            ),
-
-            // SensorName, SensorId, Timestamp  
-            *SensorName,
-            *SensorIdStr,
-            *TimeStr,
-
-            // --- Sensor ---
-            (double)Pos.X,
-            (double)Pos.Y,
-            (double)Pos.Z,
-            (double)N.X,
-            (double)N.Y,
-            (double)N.Z,
-            (int32)Req.SidePx,
-            (uint32)Req.WarmupFrames,
-
-            // --- Solar Geometry ---
-            (double)SunAzDeg,
-            (double)SunAltDeg,
-            (double)GeomF,
-
-            // --- Clear-sky ---
-            (double)CS_GHI,
-            (double)CS_DNI,
-            (double)CS_DHI,
-
-            // --- Occlusion ---
-            (int32)Occluded,
-            (double)HitDistM,
-            (double)Visibility,
-
-            // --- Sky View Factor ---
-            (double)Req.SkyViewFactor,
-
-            // --- Diffuse (RGB + mean) ---
-            (double)DiffR_Lux,
-            (double)DiffG_Lux,
-            (double)DiffB_Lux,
-            (double)Diff_Lux,
-
-            // --- Direct ---
-            (double)Dir_Lux,
-            
-            // --- Total normalized ---
-            (double)Irradiance_wm2
-    );
-
-    // Buffer instead of writing every row
-    PendingCSV += Line;
-    PendingLineCount++;
+    Row.IrrR = IrrR;
+    Row.IrrG = IrrG;
+    Row.IrrB = IrrB;
+    Row.IrrMean = IrrMean;
+    Row.IrrDir = IrrDir;
+    Row.TotalIrradiance = TotalIrradiance;
+
+    ResultWriter->Enqueue(Row);
     TotalRowsAppended++;
-
-    // Periodic flush
-    FlushCSVIfNeeded(false);
 }
 
 
-
-void UIrradianceExporter::FlushCSVIfNeeded(bool bForce)
+void UIrradianceExporter::AppendSHRow(const FCaptureRequest& Req, const FIrradianceSH& SH)
 {
-    if (!EnsureCSVWritable())
+    if (!SH.IsValid() || !EnsureResultWriter())
         return;
 
-    if (PendingLineCount <= 0)
-        return;
+    FIrradianceSHRow Row;
+    Row.SensorId = Req.SensorId;
+    Row.TimestampTicks = Req.TimestampUTC.GetTicks();
+    Row.SH = SH;
+    ResultWriter->EnqueueSH(Row);
+}
 
-    if (!bForce && PendingLineCount < FlushThresholdLines)
-        return;
 
-    const FString Dir = FPaths::GetPath(CSVPathAbs);
-    if (!IFileManager::Get().DirectoryExists(*Dir))
+void UIrradianceExporter::FlushCSVIfNeeded(bool bForce)
+{
+    // The writer thread writes on its own; only explicit durability points are forwarded
+    if (bForce && ResultWriter)
     {
-        const bool bDirOk = IFileManager::Get().MakeDirectory(*Dir, true);
-        if (!bDirOk)
-        {
-            PYRANO_ERR(TEXT("[Exporter] Failed to create CSV directory '%s'. Skipping flush."), *Dir);
-            // Drop buffer to avoid unbounded growth
-            PendingCSV.Reset();
-            PendingLineCount = 0;
-            return;
-        }
-        PYRANO_WARN(TEXT("[Exporter] CSV directory was missing; created '%s'."), *Dir);
+        ResultWriter->RequestFlush();
+        PYRANO_INFO(TEXT("[Exporter] CSV flush requested (total_rows=%llu) -> '%s'."),
+            TotalRowsAppended, *CSVPathAbs);
     }
+}
 
-    const bool bOk = FFileHelper::SaveStringToFile(
-        PendingCSV,
-        *CSVPathAbs,
-        FFileHelper::EEncodingOptions::AutoDetect,
-        &IFileManager::Get(),
-        FILEWRITE_Append);
 
-    if (!bOk)
+void UIrradianceExporter::CloseCSV()
+{
+    if (ResultWriter)
     {
-        PYRANO_ERR(TEXT("[Exporter] Failed to flush CSV buffer (lines=%d, total_rows=%llu) to '%s'."),
-            PendingLineCount, TotalRowsAppended, *CSVPathAbs);
-
-        // Drop buffer to avoid repeated attempts + memory growth
-        PendingCSV.Reset();
-        PendingLineCount = 0;
-        return;
+        ResultWriter->Shutdown();
+        ResultWriter.Reset();
     }
+    DeclaredSensors.Reset();
+    bResultWriterFailed = false;
+}
 
-    // Success
-    PYRANO_INFO(TEXT("[Exporter] Flushed CSV buffer (lines=%d, total_rows=%llu) -> '%s'."),
-        PendingLineCount, TotalRowsAppended, *CSVPathAbs);
 
-    PendingCSV.Reset();
-    PendingLineCount = 0;
+void UIrradianceExporter::BeginDestroy()
+{
+    CloseCSV();
 
+    // Copies already on the RT keep their job alive; the rest is dropped
+    FaceReadbacks.Reset();
+    CloseArchives();
+    Super::BeginDestroy();
 }
 
 
-void UIrradianceExporter::EnqueueFaceEXR(const FCaptureRequest& Req, int32 FaceIdx,
-    TRefCountPtr<IPooledRenderTarget> FaceRT, FIntPoint Size)
+void UIrradianceExporter::EnqueueFaceImage(const FCaptureRequest& Req, int32 FaceIdx,
+    TRefCountPtr<IPooledRenderTarget> FaceRT, FIntPoint Size, int32 SourceSlice)
 {
     if (!FaceRT.IsValid()) 
         return;
 
-    // Little sync readback -> make RHI texture and read
-    ENQUEUE_RENDER_COMMAND(Pyrano_ReadFaceToEXR)(
-        [this, Req, FaceIdx, FaceRT, Size](FRHICommandListImmediate& RHICmdList)
+    TSharedPtr<FFaceReadback, ESPMode::ThreadSafe> Job = MakeShared<FFaceReadback, ESPMode::ThreadSafe>();
+    Job->Readback = MakeUnique<FRHIGPUTextureReadback>(TEXT("PyranoFaceEXRReadback"));
+    Job->Size = Size;
+    Job->bCompress = bCompressImages;
+    Job->WriteQueue = &FModuleManager::LoadModuleChecked<IImageWriteQueueModule>("ImageWriteQueue").GetWriteQueue();
+
+    const FDateTime UTC = Req.TimestampUTC.GetTicks() > 0 ? Req.TimestampUTC : FDateTime::UtcNow();
+    Job->TimestampTicks = UTC.GetTicks();
+    Job->Face = (uint8)FaceIdx;
+
+    // One archive per sensor-day; loose EXR if disabled or the archive cannot be opened
+    if (bArchiveImages)
+    {
+        Job->Archive = GetArchive(Req);
+    }
+
+    // Output name
+    const FString Stamp = MakeTimestampForFile(UTC);
+    const FString BaseName = FString::Printf(TEXT("%s_%s_%dx%d"),
+        *Req.SensorId.ToString(), *FaceToString(FaceIdx), Size.X, Size.Y);
+    Job->OutEXR = FPaths::Combine(ImagesPathAbs, FString::Printf(TEXT("%s_%s.exr"), *BaseName, *Stamp));
+
+    FaceReadbacks.Add(Job);
+
+    // Async copy to a staging texture: the RT does not wait for the GPU
+    ENQUEUE_RENDER_COMMAND(Pyrano_CopyFaceForEXR)(
+        [Job, FaceRT, SourceSlice](FRHICommandListImmediate& RHICmdList)
         {
             FRHITexture* Tex = FaceRT->GetRHI();
-            if (!Tex) 
-                return;
-
-            const int32 W = Size.X;
-            const int32 H = Size.Y;
-
-            TArray<FFloat16Color> Raw;
-            Raw.SetNumUninitialized(W * H);
-
-            RHICmdList.ReadSurfaceFloatData(
-                Tex,
-                FIntRect(0, 0, W, H),
-                Raw,          // out
-                (ECubeFace)0, // no cubemap
-                 0,
-                 0            // mip
-            );
-
-            // To LinealColor
-            TArray64<FLinearColor> Pixels;
-            Pixels.SetNumUninitialized((int64)W * (int64)H);
-            for (int32 i = 0; i < W* H; ++i)
+            if (Tex && Tex->GetFormat() == PF_FloatRGBA)
             {
-                const FFloat16Color& C = Raw[i];
-                Pixels[i] = FLinearColor(C.R.GetFloat(), C.G.GetFloat(), C.B.GetFloat(), 1.f);
+                Job->Readback->EnqueueCopy(RHICmdList, Tex, FIntVector::ZeroValue, SourceSlice, FIntVector(Job->Size.X, Job->Size.Y, 1));
             }
-
-            // Output name
-            const FString Stamp = MakeTimestampForFile(Req.TimestampUTC.GetTicks() > 0 ? Req.TimestampUTC : FDateTime::UtcNow());
-            const FString BaseName = FString::Printf(TEXT("%s_%s_%dx%d"),
-                *Req.SensorId.ToString(), *FaceToString(FaceIdx), W, H);
-
-            const FString OutEXR = FPaths::Combine(ImagesPathAbs, FString::Printf(TEXT("%s_%s.exr"), *BaseName, *Stamp));
-
-            // EXR
-            IImageWriteQueueModule& ImgModule = FModuleManager::LoadModuleChecked<IImageWriteQueueModule>("ImageWriteQueue");
-            TUniquePtr<FImageWriteTask> Task = MakeUnique<FImageWriteTask>();
-            Task->Filename = OutEXR;
-            Task->Format = EImageFormat::EXR;
-            Task->bOverwriteFile = true;
-            Task->CompressionQuality = (int32)EImageCompressionQuality::Uncompressed;
-            Task->PixelData = MakeUnique<TImagePixelData<FLinearColor>>(FIntPoint(W, H), MoveTemp(Pixels), nullptr);
-            ImgModule.GetWriteQueue().Enqueue(MoveTemp(Task));
+            else
+            {
+                PYRANO_WARN(TEXT("[Exporter] Face texture is not PF_FloatRGBA. Skipping '%s'."), *Job->OutEXR);
+                Job->Readback.Reset();
+            }
+            Job->bCopyEnqueued.store(true, std::memory_order_release);
         });
 }
 
 
+void UIrradianceExporter::TickImageReadbacks()
+{
+    for (int32 i = FaceReadbacks.Num() - 1; i >= 0; --i)
+    {
+        const TSharedPtr<FFaceReadback, ESPMode::ThreadSafe> Job = FaceReadbacks[i];
+        if (!Job->bCopyEnqueued.load(std::memory_order_acquire))
+            continue;
+
+        // Single fence check per frame; the RT is only involved once the data is there
+        if (Job->Readback && !Job->Readback->IsReady())
+            continue;
+
+        FaceReadbacks.RemoveAtSwap(i, 1, EAllowShrinking::No);
+        if (!Job->Readback)
+            continue;
+
+        ENQUEUE_RENDER_COMMAND(Pyrano_ReadFaceForEXR)(
+            [Job](FRHICommandListImmediate& RHICmdList)
+            {
+                const int32 W = Job->Size.X;
+                const int32 H = Job->Size.Y;
+
+                // Already half floats: only the row pitch is removed, no widening
+                TArray64<FFloat16Color> Pixels;
+                Pixels.SetNumUninitialized((int64)W * (int64)H);
+
+                int32 RowPitchPx = 0;
+                const uint8* Src = static_cast<const uint8*>(Job->Readback->Lock(RowPitchPx));
+                if (Src)
+                {
+                    for (int32 y = 0; y < H; ++y)
+                    {
+                        FMemory::Memcpy(&Pixels[(int64)y * W], Src + (int64)y * RowPitchPx * sizeof(FFloat16Color), W * sizeof(FFloat16Color));
+                    }
+                }
+                Job->Readback->Unlock();
+                Job->Readback.Reset();
+
+                if (!Src)
+                {
+                    PYRANO_WARN(TEXT("[Exporter] Face readback lock failed. Skipping '%s'."), *Job->OutEXR);
+                    return;
+                }
+
+                // Alpha and encoding on workers (the image write queue compresses on its own threads)
+                UE::Tasks::Launch(UE_SOURCE_LOCATION,
+                    [Pixels = MoveTemp(Pixels), W, H, OutEXR = Job->OutEXR, bCompress = Job->bCompress, WriteQueue = Job->WriteQueue,
+                     Archive = MoveTemp(Job->Archive), Ticks = Job->TimestampTicks, Face = Job->Face]() mutable
+                    {
+                        if (Archive)
+                        {
+                            // RGB only: alpha carries nothing
+                            TArray64<FFloat16> RGB;
+                            RGB.SetNumUninitialized(Pixels.Num() * 3);
+                            for (int64 i = 0; i < Pixels.Num(); ++i)
+                            {
+                                RGB[i * 3 + 0] = Pixels[i].R;
+                                RGB[i * 3 + 1] = Pixels[i].G;
+                                RGB[i * 3 + 2] = Pixels[i].B;
+                            }
+                            Archive->AddFace(Ticks, Face, W, H, RGB, bCompress);
+                            return;
+                        }
+
+                        const FFloat16 One(1.f);
+                        for (FFloat16Color& C : Pixels)
+                        {
+                            C.A = One;
+                        }
+
+                        TUniquePtr<FImageWriteTask> Task = MakeUnique<FImageWriteTask>();
+                        Task->Filename = OutEXR;
+                        Task->Format = EImageFormat::EXR;
+                        Task->bOverwriteFile = true;
+                        Task->CompressionQuality = bCompress
+                            ? (int32)EImageCompressionQuality::Default
+                            : (int32)EImageCompressionQuality::Uncompressed;
+                        Task->PixelData = MakeUnique<TImagePixelData<FFloat16Color>>(FIntPoint(W, H), MoveTemp(Pixels), nullptr);
+                        WriteQueue->Enqueue(MoveTemp(Task));
+                    });
+            });
+    }
+}
+
+
+TSharedPtr<FIrradianceCubemapArchiveWriter, ESPMode::ThreadSafe> UIrradianceExporter::GetArchive(const FCaptureRequest& Req)
+{
+    const FDateTime UTC = Req.TimestampUTC.GetTicks() > 0 ? Req.TimestampUTC : FDateTime::UtcNow();
+    const FString Path = FPaths::Combine(ImagesPathAbs, PyranoCubemapArchive::MakeFileName(Req.SensorId, UTC));
+
+    TSharedPtr<FIrradianceCubemapArchiveWriter, ESPMode::ThreadSafe>& Slot = OpenArchives.FindOrAdd(Req.SensorId);
+    if (Slot.IsValid() && Slot->GetPath() == Path)
+        return Slot;
+
+    // Previous day: closed by the last face that still references it
+    Slot.Reset();
+
+    TSharedPtr<FIrradianceCubemapArchiveWriter, ESPMode::ThreadSafe> Archive = MakeShared<FIrradianceCubemapArchiveWriter, ESPMode::ThreadSafe>();
+    if (!Archive->Open(Path, Req.SensorId))
+    {
+        OpenArchives.Remove(Req.SensorId);
+        return nullptr;
+    }
+
+    Slot = Archive;
+    return Archive;
+}
+
+
+void UIrradianceExporter::CloseArchives()
+{
+    OpenArchives.Reset();
+}
+
+
 // -----------------------------------------------------------------------------
 //  Helpers
 // -----------------------------------------------------------------------------
 
-void UIrradianceExporter::EnsureCSVHeader()
+bool UIrradianceExporter::EnsureResultWriter()
 {
-    if (bCSVHeaderWritten)
-        return;
+    if (ResultWriter)
+        return true;
+
+    if (bResultWriterFailed || !EnsureCSVWritable())
+        return false;
 
-    const FString Header =
-        TEXT("sensor_name,sensor_guid,utc,")
-        TEXT("pos_x,pos_y,pos_z,")
-        TEXT("n_x,n_y,n_z,")
-        TEXT("side_px,warmup,")
-        TEXT("azimuth_deg,altitude_deg,geometric_factor,")
-        TEXT("clearsky_ghi_wm2,clearsky_dni_wm2,clearsky_dhi_wm2,")
-        TEXT("sun_occluded,sun_hit_distance_m,sun_visibility,")
-        TEXT("sky_view_factor,")
-        TEXT("raw_r_lux,raw_g_lux,raw_b_lux,")
-        TEXT("sim_comp_amb_lux,sim_comp_direct_lux,")
-        TEXT("irr_final_normalized_wm2\n");
-
-    FFileHelper::SaveStringToFile(Header, *CSVPathAbs, FFileHelper::EEncodingOptions::AutoDetect,
-        &IFileManager::Get(), FILEWRITE_Append);
-    bCSVHeaderWritten = true;
+    // CSV header is written by the writer when the file is new
+    ResultWriter = MakeUnique<FIrradianceResultWriter>(
+        bWriteCSV ? CSVPathAbs : FString(),
+        bWriteBinary ? BinaryPathAbs : FString(),
+        SHPathAbs);
+    ResultWriter->SetResumeCSVBytes(ResumeCSVBytes);
+    if (!ResultWriter->Start())
+    {
+        PYRANO_ERR(TEXT("[Exporter] Result writer could not start. Row export disabled for '%s'."), *CSVPathAbs);
+        ResultWriter.Reset();
+        bResultWriterFailed = true;
+        return false;
+    }
+    return true;
 }
 
 
@@ -1,12 +1,17 @@
 /*=============================================================================
     IrradianceExporter.h
   Handles exporting irradiance capture results for debugging and data analysis.
-  Supports saving cubemap face images (EXR) and irradiance values to CSV files.
+  Supports saving cubemap face images (packed .pyca archives or loose EXR)
+  and irradiance values to CSV files.
+  Rows go to CSV and/or a columnar binary file (.pyrb), written by a
+  background thread (see IrradianceResultWriter.h).
 /============================================================================*/
 
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Irradiance/IrradianceResultWriter.h"
+#include "Irradiance/IrradianceCubemapArchive.h"
 #include "IrradianceExporter.generated.h"
 
 struct FCaptureRequest;
@@ -32,13 +37,42 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite)
     FDirectoryPath OutputDir;      
 
+    /** Packs faces into one archive per sensor and UTC day (.pyca) instead of six loose EXR files per capture */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite)
+    bool bArchiveImages = true;
+
+    /** Lossless compression of exported faces (zlib in archives, ZIP in EXR); false writes them uncompressed */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite)
+    bool bCompressImages = true;
+
     /** Subdirectory inside OutputDir used for image exports */
     UPROPERTY(EditAnywhere, BlueprintReadWrite)
     FString ImagesSubdir = TEXT("Images");
 
+    /** Enables exporting irradiance results to a columnar binary file (.pyrb, next to the CSV) */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite)
+    bool bExportBinary = false;
+
     /** Base CSV file name */
     UPROPERTY(EditAnywhere, BlueprintReadWrite)
     FString CSVFilename = TEXT("irradiance.csv");
+
+    /** Shard written by this instance; with ShardCount > 1 files are named per shard instead of per start time */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite)
+    int32 ShardIndex = 0;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite)
+    int32 ShardCount = 1;
+
+    /** Resume: CSV (file name in OutputDir) to continue, cut back to ResumeCSVBytes first. Empty starts a new file */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite)
+    FString ResumeCSVFile;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite)
+    int64 ResumeCSVBytes = 0;
+
+    /** True if result rows are exported in any format */
+    bool ExportsRows() const { return bExportCSV || bExportBinary; }
 };
 
 
@@ -51,6 +85,15 @@ public:
 
     void Init(const FExportOptions& InOpts);
 
+    /** Absolute path of the CSV (set by Init, even if rows go to the binary file only) */
+    const FString& GetCSVPath() const { return CSVPathAbs; }
+
+    /** Directory the files of these options go to (OutputDir, or Saved/Irradiance) */
+    static FString ResolveOutputDir(const FExportOptions& InOpts);
+
+    /** Rows appended since Init that are on disk for good, and the CSV size right after them (CSV export only) */
+    bool GetDurablePoint(uint64& OutRows, int64& OutCSVBytes) const;
+
     /** CSV export utils */
     void AppendIrradianceRow(const FCaptureRequest& Req, float TotalIrradiance,
         float IrrMean, float IrrR, float IrrG, float IrrB,
@@ -59,33 +102,74 @@ public:
         float Azimuth, float Altitude, float GeometricFactor,
         int32 SunOccluded, float SunHitDistanceM, float SunVisibility);
 
+    /** SH projection of a capture, to the sidecar CSV. Call after AppendIrradianceRow of the same capture. */
+    void AppendSHRow(const FCaptureRequest& Req, const FIrradianceSH& SH);
+
+    /** Rows are written in the background; bForce requests a durability point (never blocks). */
     void FlushCSVIfNeeded(bool bForce = false);
 
-    /** Image export */
-    void EnqueueFaceEXR(const FCaptureRequest& Req, int32 FaceIdx,
-        TRefCountPtr<IPooledRenderTarget> FaceRT, FIntPoint Size);
+    /** Writes the remaining rows and closes the CSV / binary files. Blocks until the writer thread is done. */
+    void CloseCSV();
+
+    /** Image export: queues an async GPU copy of the face (no render thread stall). SourceSlice: face atlas slice */
+    void EnqueueFaceImage(const FCaptureRequest& Req, int32 FaceIdx,
+        TRefCountPtr<IPooledRenderTarget> FaceRT, FIntPoint Size, int32 SourceSlice = 0);
+
+    /** Polls face copies once per frame; ready ones are read on the RT and encoded on workers */
+    void TickImageReadbacks();
+
+    /** Face copies still waiting for the GPU */
+    int32 GetNumPendingImages() const { return FaceReadbacks.Num(); }
+
+    /** Releases the open archives; each one writes its index once its last face is in */
+    void CloseArchives();
+
+    // UObject
+    virtual void BeginDestroy() override;
 
 private:
 
     // Absolute path to the CSV file
     FString CSVPathAbs;
 
+    // Absolute path to the binary file (CSV path with .pyrb)
+    FString BinaryPathAbs;
+
+    // Absolute path to the SH sidecar (CSV path with _sh.csv), created by the first SH row
+    FString SHPathAbs;
+
+    // Outputs selected at Init
+    bool bWriteCSV = false;
+    bool bWriteBinary = false;
+
+    // Size the resumed CSV is cut back to (-1: new file)
+    int64 ResumeCSVBytes = -1;
+
     // Absolute path to the images folder
     FString ImagesPathAbs;
 
-    // Ensures header is written once
-    bool bCSVHeaderWritten = false;
+    // --- Image export ---
+    struct FFaceReadback;
+    TArray<TSharedPtr<FFaceReadback, ESPMode::ThreadSafe>> FaceReadbacks;
+    bool bCompressImages = true;
+    bool bArchiveImages = true;
+
+    // Archive of the current UTC day per sensor (a new day releases the previous one)
+    TMap<FGuid, TSharedPtr<FIrradianceCubemapArchiveWriter, ESPMode::ThreadSafe>> OpenArchives;
+
+    // Archive for the sensor / day of a request, opened on first use (null on failure)
+    TSharedPtr<FIrradianceCubemapArchiveWriter, ESPMode::ThreadSafe> GetArchive(const FCaptureRequest& Req);
 
-    // Writes the CSV header 
-    void EnsureCSVHeader();
+    // Starts the writer thread on the first row
+    bool EnsureResultWriter();
 
     // Ensures CSV file is still writable
     bool EnsureCSVWritable() const;
 
-    // --- Buffering ---
-    FString PendingCSV;                 // accumulated CSV lines
-    int32   PendingLineCount = 0;       // number of buffered rows
-    int32   FlushThresholdLines = 64;   // flush every N rows 
+    // --- Background writer ---
+    TUniquePtr<FIrradianceResultWriter> ResultWriter;
+    TSet<FGuid> DeclaredSensors;        // sensor names already sent to the writer
+    bool    bResultWriterFailed = false;    // do not retry opening every row
     uint64  TotalRowsAppended = 0;      // diagnostics only
 
     /** Returns a short name for a cubemap face (PosX, NegX...) */
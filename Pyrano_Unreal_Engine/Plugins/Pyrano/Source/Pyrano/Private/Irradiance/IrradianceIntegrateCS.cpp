@@ -11,14 +11,24 @@
 #include "RHI.h"
 #include "Logging/IrradianceLog.h"
 #include "Irradiance/IrradianceCommon.h"
+#include "Irradiance/IrradianceKernelTuner.h"
+#include "Simulation/IrradianceSH.h"
 
 IMPLEMENT_GLOBAL_SHADER(FIrradianceIntegrateCS, "/Plugin/Pyrano/Private/IrradianceIntegrate.usf", "CS", SF_Compute);
 IMPLEMENT_GLOBAL_SHADER(FIrradianceReduceCS, "/Plugin/Pyrano/Private/IrradianceIntegrate.usf", "ReduceCS", SF_Compute);
+IMPLEMENT_GLOBAL_SHADER(FIrradianceFaceResolveCS, "/Plugin/Pyrano/Private/IrradianceIntegrate.usf", "FaceResolveCS", SF_Compute);
+IMPLEMENT_GLOBAL_SHADER(FIrradianceSHProjectCS, "/Plugin/Pyrano/Private/IrradianceIntegrate.usf", "SHProjectCS", SF_Compute);
+IMPLEMENT_GLOBAL_SHADER(FIrradianceSHReduceCS, "/Plugin/Pyrano/Private/IrradianceIntegrate.usf", "SHReduceCS", SF_Compute);
 
-/** Creates a 2D texture array from the six cubemap face render targets. */
-static FRDGTextureRef BuildFacesArray(FRDGBuilder& GraphBuilder, TRefCountPtr<IPooledRenderTarget> InFaces[6], int32 L)
+// 'stat gpu' / ProfileGPU: compare the integration paths (faces array, atlas, streamed; fused or not)
+DECLARE_GPU_STAT_NAMED(PyranoIrradianceIntegrate, TEXT("Pyrano Irradiance Integrate"));
+DECLARE_GPU_STAT_NAMED(PyranoFaceResolve, TEXT("Pyrano Face Resolve"));
+DECLARE_GPU_STAT_NAMED(PyranoSHProject, TEXT("Pyrano SH Project"));
+
+/** Creates a 2D texture array from the cubemap face render targets (6 per capture). */
+static FRDGTextureRef BuildFacesArray(FRDGBuilder& GraphBuilder, TConstArrayView<TRefCountPtr<IPooledRenderTarget>> InFaces, int32 L)
 {
-    if (!InFaces[0].IsValid())
+    if (InFaces.Num() == 0 || !InFaces[0].IsValid())
     {
         PYRANO_ERR(TEXT("[Compute] Missing face 0 when building faces array"));
         return nullptr;
@@ -26,15 +36,16 @@ static FRDGTextureRef BuildFacesArray(FRDGBuilder& GraphBuilder, TRefCountPtr<IP
 
     const EPixelFormat FaceFmt = InFaces[0]->GetDesc().Format;
     const FIntPoint Size(L, L);
+    const int32 NumSlices = InFaces.Num();
 
     FRDGTextureDesc Desc = FRDGTextureDesc::Create2DArray(
         Size, FaceFmt, FClearValueBinding::None,
-        TexCreate_ShaderResource /* | UAV? */, IrradianceCommon::NumFaces, 1);
+        TexCreate_ShaderResource /* | UAV? */, NumSlices, 1);
 
     FRDGTextureRef ArrayTex = GraphBuilder.CreateTexture(Desc, TEXT("Irr.FacesArray"));
 
     // Faces check
-    for (int32 i = 0; i < IrradianceCommon::NumFaces; ++i)
+    for (int32 i = 0; i < NumSlices; ++i)
     {
         check(InFaces[i].IsValid());
         const auto& D = InFaces[i]->GetDesc();
@@ -42,15 +53,15 @@ static FRDGTextureRef BuildFacesArray(FRDGBuilder& GraphBuilder, TRefCountPtr<IP
         check(D.Format == InFaces[0]->GetDesc().Format);
     }
 
-    for (int32 Face = 0; Face < IrradianceCommon::NumFaces; ++Face)
+    for (int32 Slice = 0; Slice < NumSlices; ++Slice)
     {
-        check(InFaces[Face].IsValid());
+        check(InFaces[Slice].IsValid());
         FRDGTextureRef Src = GraphBuilder.RegisterExternalTexture(
-            InFaces[Face],
-            *FString::Printf(TEXT("Irr.Face.%d"), Face));
+            InFaces[Slice],
+            *FString::Printf(TEXT("Irr.Face.%d"), Slice));
 
         FRHICopyTextureInfo Info;
-        Info.DestSliceIndex = Face;
+        Info.DestSliceIndex = Slice;
         AddCopyTexturePass(GraphBuilder, Src, ArrayTex, Info);
     }
 
@@ -58,132 +69,800 @@ static FRDGTextureRef BuildFacesArray(FRDGBuilder& GraphBuilder, TRefCountPtr<IP
 }
 
 
+/** Integrate shader permutation for this platform. */
+static TShaderMapRef<FIrradianceIntegrateCS> GetIntegrateShader(bool bSingleFace, bool bFusedReduce, const FIrradianceKernelConfig& Config)
+{
+    // Wave ops when this RHI runs them; the permutation is then remapped to one that was compiled
+    FIrradianceIntegrateCS::FPermutationDomain PermutationVector;
+    PermutationVector.Set<FIrradianceIntegrateCS::FUseWaveOps>(GRHISupportsWaveOperations);
+    PermutationVector.Set<FIrradianceIntegrateCS::FSingleFace>(bSingleFace);
+    PermutationVector.Set<FIrradianceIntegrateCS::FFusedReduce>(bFusedReduce);
+    PermutationVector.Set<FIrradianceIntegrateCS::FStride>(Config.Stride);
+    PermutationVector.Set<FIrradianceIntegrateCS::FGroupShape>(Config.GroupShape);
+    PermutationVector = FIrradianceIntegrateCS::RemapPermutation(PermutationVector, GMaxRHIShaderPlatform);
+
+    return TShaderMapRef<FIrradianceIntegrateCS>(GetGlobalShaderMap(GMaxRHIFeatureLevel), PermutationVector);
+}
+
+
+/** SH projection shader permutation. */
+static TShaderMapRef<FIrradianceSHProjectCS> GetSHProjectShader(bool bSingleFace, int32 SHOrder)
+{
+    FIrradianceSHProjectCS::FPermutationDomain PermutationVector;
+    PermutationVector.Set<FIrradianceSHProjectCS::FSingleFace>(bSingleFace);
+    PermutationVector.Set<FIrradianceSHProjectCS::FOrder>(SHOrder);
+
+    return TShaderMapRef<FIrradianceSHProjectCS>(GetGlobalShaderMap(GMaxRHIFeatureLevel), PermutationVector);
+}
+
+
+/** SH projection partials of NumFaceSlots faces, as written by SHProjectCS. */
+static FRDGBufferRef CreateSHPartials(FRDGBuilder& GraphBuilder, uint32 GroupsPerFace, int32 NumFaceSlots, int32 SHOrder)
+{
+    return GraphBuilder.CreateBuffer(
+        FRDGBufferDesc::CreateStructuredDesc(sizeof(FVector4f), GroupsPerFace * NumFaceSlots * FIrradianceSH::GetNumCoeffs(SHOrder)),
+        TEXT("Irr.SHPartials"));
+}
+
+
+/** Sums the SH partials of NumFaceSlots faces into OutSH, from OutputOffset (float4 entries). */
+static void AddSHReducePass(FRDGBuilder& GraphBuilder, FRDGBufferRef Partials, uint32 GroupsPerFace,
+    int32 NumFaceSlots, int32 SHOrder, uint32 OutputOffset, FRDGBufferRef OutSH)
+{
+    FIrradianceSHReduceCS::FPermutationDomain PermutationVector;
+    PermutationVector.Set<FIrradianceSHReduceCS::FOrder>(SHOrder);
+    TShaderMapRef<FIrradianceSHReduceCS> ReduceShader(GetGlobalShaderMap(GMaxRHIFeatureLevel), PermutationVector);
+
+    FIrradianceSHReduceCS::FParameters* Params =
+        GraphBuilder.AllocParameters<FIrradianceSHReduceCS::FParameters>();
+    Params->SHGroupsPerFace = GroupsPerFace;
+    Params->OutputOffset = OutputOffset;
+    Params->InSHPartials = GraphBuilder.CreateSRV(Partials);
+    Params->OutSH = GraphBuilder.CreateUAV(OutSH);
+
+    // One group per face slot
+    FComputeShaderUtils::AddPass(
+        GraphBuilder,
+        RDG_EVENT_NAME("IrradianceSHReduce (Faces=%d, Order=%d)", NumFaceSlots, SHOrder),
+        ReduceShader,
+        Params,
+        FIntVector(NumFaceSlots, 1, 1));
+}
+
+
+/** Groups-done counters of the fused reduce, zeroed. */
+static FRDGBufferRef CreateDoneCounters(FRDGBuilder& GraphBuilder, uint32 NumCaptures)
+{
+    FRDGBufferRef DoneCounters = GraphBuilder.CreateBuffer(
+        FRDGBufferDesc::CreateStructuredDesc(sizeof(uint32), NumCaptures),
+        TEXT("IrradianceDoneCounters"));
+    AddClearUAVPass(GraphBuilder, GraphBuilder.CreateUAV(DoneCounters), 0u);
+    return DoneCounters;
+}
+
+
+/**
+ * Integrate (+ reduce) K cubemaps read from a faces array. FaceSlots[c] is the slot
+ * of capture c in the array (6 slices per slot). Returns a buffer with K results.
+ */
+static FRDGBufferRef AddIntegratePasses(
+    FRDGBuilder& GraphBuilder,
+    FRDGTextureSRVRef FacesSRV,
+    uint32 L,
+    TConstArrayView<FVector3f> SensorNormals,
+    TConstArrayView<int32> FaceSlots)
+{
+    const int32 NumCaptures = SensorNormals.Num();
+    const bool bFused = IrradianceCommon::Settings::bFusedIrradianceReduce;
+    const FIrradianceKernelConfig Config = FIrradianceKernelTuner::Get().GetConfig(L);
+
+    // Calculate necessary groups (Stride x Stride texels per thread)
+    const FIntPoint Groups = Config.GetGroups(L);
+    const uint32 GroupsX = Groups.X;
+    const uint32 GroupsY = Groups.Y;
+    const uint32 PartialsPerCapture = GroupsX * GroupsY * IrradianceCommon::NumFaces;
+    const uint32 TotalPartials = PartialsPerCapture * NumCaptures;
+    const uint32 NumSlices = NumCaptures * IrradianceCommon::NumFaces;
+
+    // Solid angle weight for each texel in a cubemap.
+    // A cubemap face spans exactly 4 steradians. With L x L texels per face,
+    // each texel represents:
+    //     dOmega = 4.0 / (L * L)
+    // This converts the discrete sum of (radiance * cosTheta) into a proper
+    // approximation of the hemispherical irradiance integral.
+    const float k = 4.0f / (L * L);
+
+    PYRANO_VERBOSE(TEXT("[Compute] L=%d, K=%d, GroupsX=%d, GroupsY=%d, TotalPartials=%d, k=%f, Fused=%d, Stride=%d, Shape=%d"),
+        L, NumCaptures, GroupsX, GroupsY, TotalPartials, k, bFused ? 1 : 0, Config.Stride, Config.GroupShape);
+
+    // ------- STEP 1: INTEGRATE - Calculate subtotals by group -------
+
+    // Sensor normals (float4 for structured buffer alignment), w = faces slot
+    TArray<FVector4f> Normals4;
+    Normals4.Reserve(NumCaptures);
+    for (int32 i = 0; i < NumCaptures; ++i)
+    {
+        Normals4.Add(FVector4f(SensorNormals[i], (float)FaceSlots[i]));
+    }
+
+    FRDGBufferRef NormalsBuffer = CreateStructuredBuffer(
+        GraphBuilder,
+        TEXT("Irr.SensorNormals"),
+        sizeof(FVector4f),
+        NumCaptures,
+        Normals4.GetData(),
+        sizeof(FVector4f) * NumCaptures);
+
+    // Subtotals buffer
+    FRDGBufferRef PartialSumsBuffer = GraphBuilder.CreateBuffer(
+        FRDGBufferDesc::CreateStructuredDesc(sizeof(FVector4f), TotalPartials),
+        TEXT("IrradiancePartialSums"));
+
+    FRDGBufferRef OutputBuffer = GraphBuilder.CreateBuffer(
+        FRDGBufferDesc::CreateStructuredDesc(sizeof(FVector4f), NumCaptures),
+        TEXT("IrradianceOutput"));
+
+    // Set shader parameters
+    FIrradianceIntegrateCS::FParameters* IntegrateParams =
+        GraphBuilder.AllocParameters<FIrradianceIntegrateCS::FParameters>();
+    IntegrateParams->L = L;
+    IntegrateParams->GroupsX = GroupsX;
+    IntegrateParams->GroupsY = GroupsY;
+    IntegrateParams->NumCaptures = NumCaptures;
+    IntegrateParams->k = k;
+    IntegrateParams->SensorNormals = GraphBuilder.CreateSRV(NormalsBuffer);
+    IntegrateParams->Faces = FacesSRV;
+    IntegrateParams->PartialSums = GraphBuilder.CreateUAV(PartialSumsBuffer);
+    IntegrateParams->PartialsPerCapture = PartialsPerCapture;
+    IntegrateParams->GroupsPerCapture = PartialsPerCapture;
+    IntegrateParams->OutputOffset = 0;
+    if (bFused)
+    {
+        IntegrateParams->DoneCounters = GraphBuilder.CreateUAV(CreateDoneCounters(GraphBuilder, NumCaptures));
+        IntegrateParams->OutRGBMean = GraphBuilder.CreateUAV(OutputBuffer);
+    }
+
+    // Queue RDG Pass (Gid.z = capture * 6 + face)
+    FComputeShaderUtils::AddPass(
+        GraphBuilder,
+        RDG_EVENT_NAME("IrradianceIntegrate (K=%d)", NumCaptures),
+        GetIntegrateShader(false, bFused, Config),
+        IntegrateParams,
+        FIntVector(GroupsX, GroupsY, NumSlices));
+
+    PYRANO_VERBOSE(TEXT("[Compute] Step 1 (Integrate) queued"));
+
+    // Fused: the last group of each capture already wrote its result
+    if (bFused)
+        return OutputBuffer;
+
+    // ------- STEP 2: REDUCE --------
+
+    TShaderMapRef<FIrradianceReduceCS> ReduceShader(GetGlobalShaderMap(GMaxRHIFeatureLevel));
+
+    FIrradianceReduceCS::FParameters* ReduceParams =
+        GraphBuilder.AllocParameters<FIrradianceReduceCS::FParameters>();
+    ReduceParams->PartialsPerCapture = PartialsPerCapture;
+    ReduceParams->OutputOffset = 0;
+    ReduceParams->InPartialSums = GraphBuilder.CreateSRV(PartialSumsBuffer);
+    ReduceParams->OutRGBMean = GraphBuilder.CreateUAV(OutputBuffer);
+
+    // One group per capture
+    FComputeShaderUtils::AddPass(
+        GraphBuilder,
+        RDG_EVENT_NAME("IrradianceReduce (K=%d)", NumCaptures),
+        ReduceShader,
+        ReduceParams,
+        FIntVector(NumCaptures, 1, 1));
+
+    PYRANO_VERBOSE(TEXT("[IrradianceCompute] Step 2 (Reduce) queued"));
+
+    return OutputBuffer;
+}
+
+
 namespace IrradianceCompute
 {
-    FRDGBufferRef ComputeIrradiance(
+    FRDGBufferRef ComputeIrradianceBatch(
         FRDGBuilder& GraphBuilder,
-        TRefCountPtr<IPooledRenderTarget> FaceRTs[6],
+        TConstArrayView<TRefCountPtr<IPooledRenderTarget>> FaceRTs,
         int32 CubemapSize,
-        const FVector3f& SensorNormal)
+        TConstArrayView<FVector3f> SensorNormals,
+        int32 SHOrder,
+        FRDGBufferRef* OutSH)
     {
+        const int32 NumCaptures = SensorNormals.Num();
+        if (NumCaptures <= 0 || NumCaptures > MaxBatchCaptures)
+        {
+            PYRANO_ERR(TEXT("[Compute] Invalid batch size %d (max %d)"), NumCaptures, MaxBatchCaptures);
+            return nullptr;
+        }
+
+        if (FaceRTs.Num() != NumCaptures * IrradianceCommon::NumFaces)
+        {
+            PYRANO_ERR(TEXT("[Compute] Expected %d faces for %d captures, got %d"),
+                NumCaptures * IrradianceCommon::NumFaces, NumCaptures, FaceRTs.Num());
+            return nullptr;
+        }
+
         // Faces check
-        for (int32 i = 0; i < IrradianceCommon::NumFaces; ++i)
+        for (int32 i = 0; i < FaceRTs.Num(); ++i)
         {
             if (!FaceRTs[i].IsValid())
             {
-                PYRANO_ERR(TEXT("[Compute] Face %d not valid"), i);
+                PYRANO_ERR(TEXT("[Compute] Face %d (capture %d) not valid"),
+                    i % IrradianceCommon::NumFaces, i / IrradianceCommon::NumFaces);
                 return nullptr;
             }
         }
 
+        RDG_GPU_STAT_SCOPE(GraphBuilder, PyranoIrradianceIntegrate);
+
+        // Build array textures
+        FRDGTextureRef FacesArray = BuildFacesArray(GraphBuilder, FaceRTs, CubemapSize);
+        FRDGTextureSRVRef FacesSRV = GraphBuilder.CreateSRV(
+            FRDGTextureSRVDesc::Create(FacesArray));
+
+        // Capture c sits in slot c of the array
+        TArray<int32> FaceSlots;
+        FaceSlots.SetNumUninitialized(NumCaptures);
+        for (int32 i = 0; i < NumCaptures; ++i)
+        {
+            FaceSlots[i] = i;
+        }
+
+        if (SHOrder > 0 && OutSH)
+        {
+            *OutSH = AddSHProjectPasses(GraphBuilder, FacesSRV, CubemapSize, FaceSlots, SHOrder);
+        }
+
+        return AddIntegratePasses(GraphBuilder, FacesSRV, CubemapSize, SensorNormals, FaceSlots);
+    }
+
+
+    void ComputeAndExtractIrradianceAtlas(
+        FRDGBuilder& GraphBuilder,
+        const TRefCountPtr<IPooledRenderTarget>& FaceAtlas,
+        TConstArrayView<int32> AtlasSlots,
+        int32 CubemapSize,
+        TConstArrayView<FVector3f> SensorNormals,
+        TRefCountPtr<FRDGPooledBuffer>* OutResultBuffer,
+        int32 SHOrder,
+        TRefCountPtr<FRDGPooledBuffer>* OutSHBuffer)
+    {
+        const int32 NumCaptures = SensorNormals.Num();
+        if (NumCaptures <= 0 || NumCaptures > MaxBatchCaptures || AtlasSlots.Num() != NumCaptures)
+        {
+            PYRANO_ERR(TEXT("[Compute] Invalid batch size %d (max %d, slots %d)"), NumCaptures, MaxBatchCaptures, AtlasSlots.Num());
+            return;
+        }
+
+        if (!FaceAtlas.IsValid() || FaceAtlas->GetDesc().Extent != FIntPoint(CubemapSize, CubemapSize))
+        {
+            PYRANO_ERR(TEXT("[Compute] Face atlas missing or not %dx%d"), CubemapSize, CubemapSize);
+            return;
+        }
+
+        RDG_GPU_STAT_SCOPE(GraphBuilder, PyranoIrradianceIntegrate);
+
+        // Faces are read in place: no copy
+        FRDGTextureRef AtlasTex = GraphBuilder.RegisterExternalTexture(FaceAtlas, TEXT("Irr.FaceAtlas"));
+        FRDGTextureSRVRef FacesSRV = GraphBuilder.CreateSRV(FRDGTextureSRVDesc::Create(AtlasTex));
+
+        FRDGBufferRef ResultBuffer = AddIntegratePasses(GraphBuilder, FacesSRV, CubemapSize, SensorNormals, AtlasSlots);
+        GraphBuilder.QueueBufferExtraction(ResultBuffer, OutResultBuffer);
+        PYRANO_VERBOSE(TEXT("[Compute] Result buffer extracted (%d captures, face atlas)"), NumCaptures);
+
+        if (SHOrder > 0 && OutSHBuffer)
+        {
+            FRDGBufferRef SHBuffer = AddSHProjectPasses(GraphBuilder, FacesSRV, CubemapSize, AtlasSlots, SHOrder);
+            if (SHBuffer)
+                GraphBuilder.QueueBufferExtraction(SHBuffer, OutSHBuffer);
+        }
+    }
+
+
+    FRDGBufferRef AddSHProjectPasses(
+        FRDGBuilder& GraphBuilder,
+        FRDGTextureSRVRef FacesSRV,
+        int32 CubemapSize,
+        TConstArrayView<int32> FaceSlots,
+        int32 SHOrder)
+    {
+        const int32 NumCaptures = FaceSlots.Num();
+        if (!FIrradianceSH::IsValidOrder(SHOrder) || NumCaptures <= 0)
+        {
+            PYRANO_ERR(TEXT("[Compute] Invalid SH projection (order %d, %d captures)"), SHOrder, NumCaptures);
+            return nullptr;
+        }
+
+        RDG_GPU_STAT_SCOPE(GraphBuilder, PyranoSHProject);
+
         const uint32 L = CubemapSize;
+        const int32 NumCoeffs = FIrradianceSH::GetNumCoeffs(SHOrder);
 
-        // Calculate necessary groups (2x2 striding)
-        const uint32 GroupsX = FMath::DivideAndRoundUp(L, FIrradianceIntegrateCS::ThreadGroupSizeX * 2);
-        const uint32 GroupsY = FMath::DivideAndRoundUp(L, FIrradianceIntegrateCS::ThreadGroupSizeY * 2);
-        const uint32 TotalPartials = GroupsX * GroupsY * IrradianceCommon::NumFaces;
+        // Only the faces slot (w) is read by the projection
+        TArray<FVector4f> Slots4;
+        Slots4.Reserve(NumCaptures);
+        for (int32 i = 0; i < NumCaptures; ++i)
+        {
+            Slots4.Add(FVector4f(0.f, 0.f, 0.f, (float)FaceSlots[i]));
+        }
 
-        // Solid angle weight for each texel in a cubemap.
-        // A cubemap face spans exactly 4 steradians. With L x L texels per face,
-        // each texel represents:
-        //     dOmega = 4.0 / (L * L)
-        // This converts the discrete sum of (radiance * cosTheta) into a proper
-        // approximation of the hemispherical irradiance integral.
-        const float k = 4.0f / (L * L);
+        FRDGBufferRef SlotsBuffer = CreateStructuredBuffer(
+            GraphBuilder,
+            TEXT("Irr.SHSlots"),
+            sizeof(FVector4f),
+            NumCaptures,
+            Slots4.GetData(),
+            sizeof(FVector4f) * NumCaptures);
+
+        const int32 NumFaceSlots = NumCaptures * IrradianceCommon::NumFaces;
+        FRDGBufferRef SHBuffer = GraphBuilder.CreateBuffer(
+            FRDGBufferDesc::CreateStructuredDesc(sizeof(FVector4f), NumFaceSlots * NumCoeffs),
+            TEXT("IrradianceSH"));
+
+        // Step 1: grid over the texels of every face, one partial per group and coefficient
+        const uint32 GroupsPerFace = FIrradianceSHProjectCS::GetGroupsPerFace(L);
+        FRDGBufferRef Partials = CreateSHPartials(GraphBuilder, GroupsPerFace, NumFaceSlots, SHOrder);
+
+        FIrradianceSHProjectCS::FParameters* Params =
+            GraphBuilder.AllocParameters<FIrradianceSHProjectCS::FParameters>();
+        Params->L = L;
+        Params->k = 4.0f / (L * L);   // see AddIntegratePasses
+        Params->SensorNormals = GraphBuilder.CreateSRV(SlotsBuffer);
+        Params->Faces = FacesSRV;
+        Params->SHGroupsPerFace = GroupsPerFace;
+        Params->SHPartials = GraphBuilder.CreateUAV(Partials);
+
+        // Gid.x = texel group, Gid.y = face, Gid.z = capture
+        FComputeShaderUtils::AddPass(
+            GraphBuilder,
+            RDG_EVENT_NAME("IrradianceSHProject (K=%d, Order=%d)", NumCaptures, SHOrder),
+            GetSHProjectShader(false, SHOrder),
+            Params,
+            FIntVector(GroupsPerFace, IrradianceCommon::NumFaces, NumCaptures));
 
-        PYRANO_VERBOSE(TEXT("[Compute] L=%d, GroupsX=%d, GroupsY=%d, TotalPartials=%d, k=%f"),
-            L, GroupsX, GroupsY, TotalPartials, k);
-        
-        // ------- STEP 1: INTEGRATE - Calculate subtotals by group -------
+        // Step 2: one group per face sums its partials
+        AddSHReducePass(GraphBuilder, Partials, GroupsPerFace, NumFaceSlots, SHOrder, 0, SHBuffer);
 
-        // Build array textures
-        FRDGTextureRef FacesArray = BuildFacesArray(GraphBuilder, FaceRTs, L);
-        FRDGTextureSRVRef FacesSRV = GraphBuilder.CreateSRV(
-            FRDGTextureSRVDesc::Create(FacesArray));
+        return SHBuffer;
+    }
 
-        // Subtotals buffer
-        FRDGBufferRef PartialSumsBuffer = GraphBuilder.CreateBuffer(
-            FRDGBufferDesc::CreateStructuredDesc(sizeof(FVector4f), TotalPartials),
-            TEXT("IrradiancePartialSums"));
 
-        // Determine whether to use wave-ops or not
-        const EShaderPlatform Platform = GMaxRHIShaderPlatform;
-        const bool bSupportsWaveOps = RHISupportsWaveOperations(Platform);  
+    bool ProjectFaceSH(
+        FRDGBuilder& GraphBuilder,
+        const TRefCountPtr<IPooledRenderTarget>& FaceRT,
+        int32 FaceIndex,
+        int32 SHOrder,
+        TRefCountPtr<FRDGPooledBuffer>& InOutSH)
+    {
+        if (!FaceRT.IsValid() || FaceIndex < 0 || FaceIndex >= IrradianceCommon::NumFaces || !FIrradianceSH::IsValidOrder(SHOrder))
+        {
+            PYRANO_ERR(TEXT("[Compute] Face %d not valid for SH projection (order %d)"), FaceIndex, SHOrder);
+            return false;
+        }
 
-        FIrradianceIntegrateCS::FPermutationDomain PermutationVector;
-        PermutationVector.Set<FIrradianceIntegrateCS::FUseWaveOps>(bSupportsWaveOps);
+        RDG_GPU_STAT_SCOPE(GraphBuilder, PyranoSHProject);
 
-        TShaderMapRef<FIrradianceIntegrateCS> IntegrateShader(
-            GetGlobalShaderMap(GMaxRHIFeatureLevel),
-            PermutationVector);
+        // Every face writes its own Order^2 entries: no clear needed
+        const int32 NumCoeffs = FIrradianceSH::GetNumCoeffs(SHOrder);
+        const uint32 NumEntries = IrradianceCommon::NumFaces * NumCoeffs;
+
+        FRDGBufferRef SHBuffer = nullptr;
+        if (InOutSH.IsValid())
+        {
+            if (InOutSH->Desc.NumElements != NumEntries)
+            {
+                PYRANO_ERR(TEXT("[Compute] Face %d: SH buffer holds %d entries, expected %d"),
+                    FaceIndex, InOutSH->Desc.NumElements, NumEntries);
+                return false;
+            }
+            SHBuffer = GraphBuilder.RegisterExternalBuffer(InOutSH, TEXT("IrradianceSH"));
+        }
+        else
+        {
+            SHBuffer = GraphBuilder.CreateBuffer(
+                FRDGBufferDesc::CreateStructuredDesc(sizeof(FVector4f), NumEntries),
+                TEXT("IrradianceSH"));
+            InOutSH = GraphBuilder.ConvertToExternalBuffer(SHBuffer);
+        }
+
+        const uint32 L = FaceRT->GetDesc().Extent.X;
+        FRDGTextureRef FaceTex = GraphBuilder.RegisterExternalTexture(FaceRT, TEXT("Irr.Face"));
+
+        // Step 1: grid over the face texels, partials of this face only
+        const uint32 GroupsPerFace = FIrradianceSHProjectCS::GetGroupsPerFace(L);
+        FRDGBufferRef Partials = CreateSHPartials(GraphBuilder, GroupsPerFace, 1, SHOrder);
+
+        FIrradianceSHProjectCS::FParameters* Params =
+            GraphBuilder.AllocParameters<FIrradianceSHProjectCS::FParameters>();
+        Params->L = L;
+        Params->k = 4.0f / (L * L);   // see AddIntegratePasses
+        Params->FaceIndex = FaceIndex;
+        Params->Face = GraphBuilder.CreateSRV(FRDGTextureSRVDesc::Create(FaceTex));
+        Params->SHGroupsPerFace = GroupsPerFace;
+        Params->SHPartials = GraphBuilder.CreateUAV(Partials);
 
-        // Set shader parameters
-        FIrradianceIntegrateCS::FParameters* IntegrateParams =
-            GraphBuilder.AllocParameters<FIrradianceIntegrateCS::FParameters>();
-        IntegrateParams->L = L;
-        IntegrateParams->GroupsX = GroupsX;
-        IntegrateParams->GroupsY = GroupsY;
-        IntegrateParams->SensorN = SensorNormal;
-        IntegrateParams->k = k;
-        IntegrateParams->Faces = FacesSRV;
-        IntegrateParams->PartialSums = GraphBuilder.CreateUAV(PartialSumsBuffer);
-
-        // Queue RDG Pass
         FComputeShaderUtils::AddPass(
             GraphBuilder,
-            RDG_EVENT_NAME("IrradianceIntegrate"),
-            IntegrateShader,
-            IntegrateParams,
-            FIntVector(GroupsX, GroupsY, IrradianceCommon::NumFaces));
+            RDG_EVENT_NAME("IrradianceSHProjectFace (Face=%d, Order=%d)", FaceIndex, SHOrder),
+            GetSHProjectShader(true, SHOrder),
+            Params,
+            FIntVector(GroupsPerFace, 1, 1));
+
+        // Step 2: the face's sums land at FaceIndex * Order^2 in the capture's buffer
+        AddSHReducePass(GraphBuilder, Partials, GroupsPerFace, 1, SHOrder, FaceIndex * NumCoeffs, SHBuffer);
+
+        return true;
+    }
+
+
+    void GatherAndExtractSHBatch(
+        FRDGBuilder& GraphBuilder,
+        TConstArrayView<TRefCountPtr<FRDGPooledBuffer>> SHBuffers,
+        int32 SHOrder,
+        TRefCountPtr<FRDGPooledBuffer>* OutSHBuffer)
+    {
+        const int32 NumCaptures = SHBuffers.Num();
+        if (NumCaptures <= 0 || NumCaptures > MaxBatchCaptures || !FIrradianceSH::IsValidOrder(SHOrder))
+        {
+            PYRANO_ERR(TEXT("[Compute] Invalid SH batch (%d captures, order %d)"), NumCaptures, SHOrder);
+            return;
+        }
+
+        const uint32 BytesPerCapture = IrradianceCommon::NumFaces * FIrradianceSH::GetNumCoeffs(SHOrder) * sizeof(FVector4f);
+
+        FRDGBufferRef OutputBuffer = GraphBuilder.CreateBuffer(
+            FRDGBufferDesc::CreateStructuredDesc(sizeof(FVector4f), NumCaptures * BytesPerCapture / sizeof(FVector4f)),
+            TEXT("IrradianceSHOutput"));
+
+        for (int32 i = 0; i < NumCaptures; ++i)
+        {
+            if (!SHBuffers[i].IsValid())
+            {
+                PYRANO_ERR(TEXT("[Compute] SH buffer of capture %d not valid"), i);
+                return;
+            }
+
+            FRDGBufferRef SHBuffer = GraphBuilder.RegisterExternalBuffer(SHBuffers[i], TEXT("IrradianceSH"));
+            AddCopyBufferPass(GraphBuilder, OutputBuffer, i * BytesPerCapture, SHBuffer, 0, BytesPerCapture);
+        }
+
+        GraphBuilder.QueueBufferExtraction(OutputBuffer, OutSHBuffer);
+        PYRANO_VERBOSE(TEXT("[Compute] Streamed SH gathered, buffer extracted (%d captures, order %d)"), NumCaptures, SHOrder);
+    }
+
+
+    bool AccumulateFace(
+        FRDGBuilder& GraphBuilder,
+        const TRefCountPtr<IPooledRenderTarget>& FaceRT,
+        int32 FaceIndex,
+        int32 CubemapSize,
+        TConstArrayView<int32> FaceSidePx,
+        const FVector3f& SensorNormal,
+        FIrradianceKernelConfig& InOutConfig,
+        TRefCountPtr<FRDGPooledBuffer>& InOutPartialSums,
+        TRefCountPtr<FRDGPooledBuffer>& InOutDoneCounter,
+        TRefCountPtr<FRDGPooledBuffer>& InOutResult)
+    {
+        if (!FaceRT.IsValid() || FaceIndex < 0 || FaceIndex >= IrradianceCommon::NumFaces)
+        {
+            PYRANO_ERR(TEXT("[Compute] Face %d not valid for streamed integration"), FaceIndex);
+            return false;
+        }
+
+        const bool bPlanned = (FaceSidePx.Num() == IrradianceCommon::NumFaces);
+        const int32 L = bPlanned ? FaceSidePx[FaceIndex] : CubemapSize;
+        const FIntPoint FaceExtent = FaceRT->GetDesc().Extent;
+        if (L <= 0 || L > CubemapSize || FaceExtent.X != L || FaceExtent.Y != L)
+        {
+            PYRANO_ERR(TEXT("[Compute] Face %d is %dx%d, expected %d"), FaceIndex, FaceExtent.X, FaceExtent.Y, L);
+            return false;
+        }
+
+        RDG_GPU_STAT_SCOPE(GraphBuilder, PyranoIrradianceIntegrate);
+
+        // One kernel configuration (the full size one) for every face, so any face fits its slice
+        const bool bFused = IrradianceCommon::Settings::bFusedIrradianceReduce;
+        if (!InOutPartialSums.IsValid())
+        {
+            InOutConfig = FIrradianceKernelTuner::Get().GetConfig(CubemapSize);
+        }
+        const FIrradianceKernelConfig Config = InOutConfig;
+        const FIntPoint Groups = Config.GetGroups(CubemapSize);
+        const uint32 PartialsPerFace = Groups.X * Groups.Y;
+        const uint32 PartialsPerCapture = PartialsPerFace * IrradianceCommon::NumFaces;
+
+        // Groups that will run over the whole capture (target of the fused done counter)
+        uint32 GroupsPerCapture = PartialsPerCapture;
+        bool bFullCapture = true;
+        if (bPlanned)
+        {
+            GroupsPerCapture = 0;
+            for (int32 Side : FaceSidePx)
+            {
+                if (Side > 0)
+                {
+                    const FIntPoint FaceGroups = Config.GetGroups(Side);
+                    GroupsPerCapture += FaceGroups.X * FaceGroups.Y;
+                }
+                bFullCapture &= (Side == CubemapSize);
+            }
+        }
 
-        PYRANO_VERBOSE(TEXT("[Compute] Step 1 (Integrate) queued"));
+        // Partial sums of the capture, one slice per face. Full faces write their whole slice;
+        // with culled or smaller faces the buffer is cleared once so the unwritten entries sum to zero.
+        FRDGBufferRef PartialSumsBuffer = nullptr;
+        if (InOutPartialSums.IsValid())
+        {
+            if (InOutPartialSums->Desc.NumElements != PartialsPerCapture)
+            {
+                PYRANO_ERR(TEXT("[Compute] Face %d: partial sums hold %d entries, expected %d"),
+                    FaceIndex, InOutPartialSums->Desc.NumElements, PartialsPerCapture);
+                return false;
+            }
+            PartialSumsBuffer = GraphBuilder.RegisterExternalBuffer(InOutPartialSums, TEXT("IrradiancePartialSums"));
+        }
+        else
+        {
+            PartialSumsBuffer = GraphBuilder.CreateBuffer(
+                FRDGBufferDesc::CreateStructuredDesc(sizeof(FVector4f), PartialsPerCapture),
+                TEXT("IrradiancePartialSums"));
+            InOutPartialSums = GraphBuilder.ConvertToExternalBuffer(PartialSumsBuffer);
+
+            if (!bFullCapture)
+                AddClearUAVPass(GraphBuilder, GraphBuilder.CreateUAV(PartialSumsBuffer), 0u);
+        }
+
+        // Fused: the counter runs across the 6 face dispatches; the last group done reduces into InOutResult
+        FRDGBufferRef DoneCounter = nullptr;
+        FRDGBufferRef Result = nullptr;
+        if (bFused)
+        {
+            if (InOutDoneCounter.IsValid() && InOutResult.IsValid())
+            {
+                DoneCounter = GraphBuilder.RegisterExternalBuffer(InOutDoneCounter, TEXT("IrradianceDoneCounters"));
+                Result = GraphBuilder.RegisterExternalBuffer(InOutResult, TEXT("IrradianceOutput"));
+            }
+            else
+            {
+                DoneCounter = CreateDoneCounters(GraphBuilder, 1);
+                Result = GraphBuilder.CreateBuffer(FRDGBufferDesc::CreateStructuredDesc(sizeof(FVector4f), 1), TEXT("IrradianceOutput"));
+                InOutDoneCounter = GraphBuilder.ConvertToExternalBuffer(DoneCounter);
+                InOutResult = GraphBuilder.ConvertToExternalBuffer(Result);
+            }
+        }
 
-        // ------- STEP 2: REDUCE --------
+        FRDGTextureRef FaceTex = GraphBuilder.RegisterExternalTexture(FaceRT, TEXT("Irr.Face"));
+        AddIntegrateFacePass(GraphBuilder, FaceTex, FaceIndex, CubemapSize, SensorNormal, Config,
+            PartialSumsBuffer, DoneCounter, Result, GroupsPerCapture);
+
+        PYRANO_VERBOSE(TEXT("[Compute] Face %d accumulated (L=%d of %d, Partials=%d)"), FaceIndex, L, CubemapSize, PartialsPerFace);
+        return true;
+    }
+
+
+    void ReduceAndExtractIrradianceBatch(
+        FRDGBuilder& GraphBuilder,
+        TConstArrayView<TRefCountPtr<FRDGPooledBuffer>> PartialSums,
+        TConstArrayView<TRefCountPtr<FRDGPooledBuffer>> Results,
+        int32 CubemapSize,
+        TRefCountPtr<FRDGPooledBuffer>* OutResultBuffer)
+    {
+        const int32 NumCaptures = PartialSums.Num();
+        if (NumCaptures <= 0 || NumCaptures > MaxBatchCaptures)
+        {
+            PYRANO_ERR(TEXT("[Compute] Invalid batch size %d (max %d)"), NumCaptures, MaxBatchCaptures);
+            return;
+        }
+
+        for (int32 i = 0; i < NumCaptures; ++i)
+        {
+            if (!PartialSums[i].IsValid())
+            {
+                PYRANO_ERR(TEXT("[Compute] Partial sums of capture %d not valid"), i);
+                return;
+            }
+        }
+
+        RDG_GPU_STAT_SCOPE(GraphBuilder, PyranoIrradianceIntegrate);
 
         FRDGBufferRef OutputBuffer = GraphBuilder.CreateBuffer(
-            FRDGBufferDesc::CreateStructuredDesc(sizeof(FVector4f), 1),
+            FRDGBufferDesc::CreateStructuredDesc(sizeof(FVector4f), NumCaptures),
             TEXT("IrradianceOutput"));
 
+        // Fused: the captures are already reduced, only gather them for a single readback
+        if (Results.Num() == NumCaptures)
+        {
+            for (int32 i = 0; i < NumCaptures; ++i)
+            {
+                if (!Results[i].IsValid())
+                {
+                    PYRANO_ERR(TEXT("[Compute] Result of capture %d not valid"), i);
+                    return;
+                }
+
+                FRDGBufferRef Result = GraphBuilder.RegisterExternalBuffer(Results[i], TEXT("IrradianceOutput"));
+                AddCopyBufferPass(GraphBuilder, OutputBuffer, i * sizeof(FVector4f), Result, 0, sizeof(FVector4f));
+            }
+
+            GraphBuilder.QueueBufferExtraction(OutputBuffer, OutResultBuffer);
+            PYRANO_VERBOSE(TEXT("[Compute] Streamed results gathered, result buffer extracted (%d captures)"), NumCaptures);
+            return;
+        }
+
+        FRDGBufferUAVRef OutputUAV = GraphBuilder.CreateUAV(OutputBuffer);
+
         TShaderMapRef<FIrradianceReduceCS> ReduceShader(GetGlobalShaderMap(GMaxRHIFeatureLevel));
 
-        FIrradianceReduceCS::FParameters* ReduceParams =
-            GraphBuilder.AllocParameters<FIrradianceReduceCS::FParameters>();
-        ReduceParams->TotalPartials = TotalPartials;
-        ReduceParams->InPartialSums = GraphBuilder.CreateSRV(PartialSumsBuffer);
-        ReduceParams->OutRGBMean = GraphBuilder.CreateUAV(OutputBuffer);
+        // One single-group dispatch per capture, each reading its own partial sums
+        for (int32 i = 0; i < NumCaptures; ++i)
+        {
+            FRDGBufferRef PartialSumsBuffer = GraphBuilder.RegisterExternalBuffer(PartialSums[i], TEXT("IrradiancePartialSums"));
+
+            FIrradianceReduceCS::FParameters* ReduceParams =
+                GraphBuilder.AllocParameters<FIrradianceReduceCS::FParameters>();
+            ReduceParams->PartialsPerCapture = PartialSums[i]->Desc.NumElements;
+            ReduceParams->OutputOffset = i;
+            ReduceParams->InPartialSums = GraphBuilder.CreateSRV(PartialSumsBuffer);
+            ReduceParams->OutRGBMean = OutputUAV;
+
+            FComputeShaderUtils::AddPass(
+                GraphBuilder,
+                RDG_EVENT_NAME("IrradianceReduce (Capture=%d)", i),
+                ReduceShader,
+                ReduceParams,
+                FIntVector(1, 1, 1));
+        }
+
+        GraphBuilder.QueueBufferExtraction(OutputBuffer, OutResultBuffer);
+        PYRANO_VERBOSE(TEXT("[Compute] Streamed reduce queued, result buffer extracted (%d captures)"), NumCaptures);
+    }
+
+
+    void AddIntegrateFacePass(
+        FRDGBuilder& GraphBuilder,
+        FRDGTextureRef Face,
+        int32 FaceIndex,
+        int32 CubemapSize,
+        const FVector3f& SensorNormal,
+        const FIrradianceKernelConfig& Config,
+        FRDGBufferRef PartialSums,
+        FRDGBufferRef DoneCounters,
+        FRDGBufferRef Result,
+        uint32 GroupsPerCapture)
+    {
+        // Each face is weighted by its own texel solid angle; partial slices keep the full size layout
+        const uint32 L = Face->Desc.Extent.X;
+        const FIntPoint Groups = Config.GetGroups(L);
+        const FIntPoint SlotGroups = Config.GetGroups(CubemapSize);
+        const uint32 PartialsPerCapture = SlotGroups.X * SlotGroups.Y * IrradianceCommon::NumFaces;
+        const bool bFused = DoneCounters && Result;
+
+        FIrradianceIntegrateCS::FParameters* IntegrateParams =
+            GraphBuilder.AllocParameters<FIrradianceIntegrateCS::FParameters>();
+        IntegrateParams->L = L;
+        IntegrateParams->GroupsX = Groups.X;
+        IntegrateParams->GroupsY = Groups.Y;
+        IntegrateParams->NumCaptures = 1;
+        IntegrateParams->k = 4.0f / (L * L);   // see AddIntegratePasses
+        IntegrateParams->FaceIndex = FaceIndex;
+        IntegrateParams->SensorNormal = SensorNormal;
+        IntegrateParams->Face = GraphBuilder.CreateSRV(FRDGTextureSRVDesc::Create(Face));
+        IntegrateParams->PartialSums = GraphBuilder.CreateUAV(PartialSums);
+        IntegrateParams->PartialsPerCapture = PartialsPerCapture;
+        IntegrateParams->GroupsPerCapture = GroupsPerCapture > 0 ? GroupsPerCapture : PartialsPerCapture;
+        IntegrateParams->OutputOffset = 0;
+        if (bFused)
+        {
+            IntegrateParams->DoneCounters = GraphBuilder.CreateUAV(DoneCounters);
+            IntegrateParams->OutRGBMean = GraphBuilder.CreateUAV(Result);
+        }
 
         FComputeShaderUtils::AddPass(
             GraphBuilder,
-            RDG_EVENT_NAME("IrradianceReduce"),
-            ReduceShader,
-            ReduceParams,
-            FIntVector(1, 1, 1));
+            RDG_EVENT_NAME("IrradianceIntegrateFace (Face=%d)", FaceIndex),
+            GetIntegrateShader(true, bFused, Config),
+            IntegrateParams,
+            FIntVector(Groups.X, Groups.Y, 1));
+    }
 
-        PYRANO_VERBOSE(TEXT("[IrradianceCompute] Step 2 (Reduce) queued"));
 
-        return OutputBuffer;
+    void AddFaceResolvePass(
+        FRDGBuilder& GraphBuilder,
+        FRDGTextureRef SceneColor,
+        const FIntRect& ViewRect,
+        FRDGTextureRef FaceAtlas,
+        int32 AtlasSlice,
+        int32 CubemapSize)
+    {
+        RDG_GPU_STAT_SCOPE(GraphBuilder, PyranoFaceResolve);
+
+        const FVector2f Extent(SceneColor->Desc.Extent);
+
+        FIrradianceFaceResolveCS::FParameters* Params =
+            GraphBuilder.AllocParameters<FIrradianceFaceResolveCS::FParameters>();
+        Params->L = CubemapSize;
+        Params->SceneColorTex = SceneColor;
+        Params->SceneColorSampler = TStaticSamplerState<SF_Bilinear, AM_Clamp, AM_Clamp, AM_Clamp>::GetRHI();
+        Params->SceneColorUVMin = FVector2f(ViewRect.Min) / Extent;
+        Params->SceneColorUVSize = FVector2f(ViewRect.Size()) / Extent;
+        Params->AtlasSlice = AtlasSlice;
+        Params->FaceAtlas = GraphBuilder.CreateUAV(FRDGTextureUAVDesc(FaceAtlas));
+
+        TShaderMapRef<FIrradianceFaceResolveCS> ResolveShader(GetGlobalShaderMap(GMaxRHIFeatureLevel));
+
+        FComputeShaderUtils::AddPass(
+            GraphBuilder,
+            RDG_EVENT_NAME("IrradianceFaceResolve (Slice=%d)", AtlasSlice),
+            ResolveShader,
+            Params,
+            FComputeShaderUtils::GetGroupCount(FIntPoint(CubemapSize, CubemapSize),
+                FIntPoint(FIrradianceFaceResolveCS::ThreadGroupSizeX, FIrradianceFaceResolveCS::ThreadGroupSizeY)));
     }
 
 
-    void ComputeAndExtractIrradiance(
+    FRDGBufferRef ComputeIrradiance(
         FRDGBuilder& GraphBuilder,
         TRefCountPtr<IPooledRenderTarget> FaceRTs[6],
         int32 CubemapSize,
-        const FVector3f& SensorNormal,
-        TRefCountPtr<FRDGPooledBuffer>* OutResultBuffer)
+        const FVector3f& SensorNormal)
+    {
+        // Single capture = batch of one
+        return ComputeIrradianceBatch(
+            GraphBuilder,
+            TConstArrayView<TRefCountPtr<IPooledRenderTarget>>(FaceRTs, IrradianceCommon::NumFaces),
+            CubemapSize,
+            TConstArrayView<FVector3f>(&SensorNormal, 1));
+    }
+
+
+    void ComputeAndExtractIrradianceBatch(
+        FRDGBuilder& GraphBuilder,
+        TConstArrayView<TRefCountPtr<IPooledRenderTarget>> FaceRTs,
+        int32 CubemapSize,
+        TConstArrayView<FVector3f> SensorNormals,
+        TRefCountPtr<FRDGPooledBuffer>* OutResultBuffer,
+        int32 SHOrder,
+        TRefCountPtr<FRDGPooledBuffer>* OutSHBuffer)
     {
         // Run shader
-        FRDGBufferRef ResultBuffer = ComputeIrradiance(
+        FRDGBufferRef SHBuffer = nullptr;
+        FRDGBufferRef ResultBuffer = ComputeIrradianceBatch(
             GraphBuilder,
             FaceRTs,
             CubemapSize,
-            SensorNormal);
+            SensorNormals,
+            SHOrder,
+            &SHBuffer);
 
         // Extract buffer
         if (ResultBuffer)
         {
             GraphBuilder.QueueBufferExtraction(ResultBuffer, OutResultBuffer);
-            PYRANO_VERBOSE(TEXT("[Compute] Result buffer extracted"));
+            PYRANO_VERBOSE(TEXT("[Compute] Result buffer extracted (%d captures)"), SensorNormals.Num());
         }
+
+        if (SHBuffer && OutSHBuffer)
+        {
+            GraphBuilder.QueueBufferExtraction(SHBuffer, OutSHBuffer);
+        }
+    }
+
+
+    void ComputeAndExtractIrradiance(
+        FRDGBuilder& GraphBuilder,
+        TRefCountPtr<IPooledRenderTarget> FaceRTs[6],
+        int32 CubemapSize,
+        const FVector3f& SensorNormal,
+        TRefCountPtr<FRDGPooledBuffer>* OutResultBuffer)
+    {
+        ComputeAndExtractIrradianceBatch(
+            GraphBuilder,
+            TConstArrayView<TRefCountPtr<IPooledRenderTarget>>(FaceRTs, IrradianceCommon::NumFaces),
+            CubemapSize,
+            TConstArrayView<FVector3f>(&SensorNormal, 1),
+            OutResultBuffer);
     }
 }
\ No newline at end of file
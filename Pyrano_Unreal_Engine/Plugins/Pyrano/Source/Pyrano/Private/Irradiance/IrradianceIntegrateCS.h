@@ -1,5 +1,6 @@
 /*=============================================================================
     IrradianceIntegrateCS.h: Compute shaders to integrate/reduce irradiance
+    and to resolve captured faces into the face atlas
 /============================================================================*/
 
 #pragma once
@@ -8,6 +9,8 @@
 #include "GlobalShader.h"
 #include "ShaderParameterStruct.h"
 #include "RenderGraphResources.h"
+#include "DataDrivenShaderPlatformInfo.h"
+#include "Irradiance/IrradianceCommon.h"
 
 //------ INTEGRATE C++ SHADER IMPLEMENTATION ------
 class FIrradianceIntegrateCS : public FGlobalShader
@@ -18,28 +21,71 @@ public:
     DECLARE_GLOBAL_SHADER(FIrradianceIntegrateCS);
     SHADER_USE_PARAMETER_STRUCT(FIrradianceIntegrateCS, FGlobalShader);
 
-    static constexpr uint32 ThreadGroupSizeX = 8;
-    static constexpr uint32 ThreadGroupSizeY = 8;
+    /** Thread-group shapes (TGX x TGY) selectable with FGroupShape. */
+    static constexpr int32 NumGroupShapes = 3;
+    static FIntPoint GetGroupShape(int32 Shape)
+    {
+        static const FIntPoint Shapes[NumGroupShapes] = { FIntPoint(8, 8), FIntPoint(16, 8), FIntPoint(16, 16) };
+        return Shapes[FMath::Clamp(Shape, 0, NumGroupShapes - 1)];
+    }
 
     class FUseWaveOps : SHADER_PERMUTATION_BOOL("USE_WAVE_OPS");
-    using FPermutationDomain = TShaderPermutationDomain<FUseWaveOps>;
+    class FSingleFace : SHADER_PERMUTATION_BOOL("SINGLE_FACE");
+    class FFusedReduce : SHADER_PERMUTATION_BOOL("FUSED_REDUCE");
+    class FStride : SHADER_PERMUTATION_SPARSE_INT("IRR_STRIDE", 1, 2, 4);
+    class FGroupShape : SHADER_PERMUTATION_INT("IRR_GROUP_SHAPE", NumGroupShapes);
+    using FPermutationDomain = TShaderPermutationDomain<FUseWaveOps, FSingleFace, FFusedReduce, FStride, FGroupShape>;
 
     BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
         SHADER_PARAMETER(uint32, L)
         SHADER_PARAMETER(uint32, GroupsX)
         SHADER_PARAMETER(uint32, GroupsY)
-        SHADER_PARAMETER(FVector3f, SensorN)
+        SHADER_PARAMETER(uint32, NumCaptures)
         SHADER_PARAMETER(float, k)
+        SHADER_PARAMETER_RDG_BUFFER_SRV(StructuredBuffer<FVector4f>, SensorNormals)
         SHADER_PARAMETER_RDG_TEXTURE_SRV(Texture2DArray<float4>, Faces)
+        SHADER_PARAMETER(uint32, FaceIndex)
+        SHADER_PARAMETER(FVector3f, SensorNormal)
+        SHADER_PARAMETER_RDG_TEXTURE_SRV(Texture2D<float4>, Face)
         SHADER_PARAMETER_RDG_BUFFER_UAV(RWStructuredBuffer<FVector4f>, PartialSums)
+        SHADER_PARAMETER(uint32, PartialsPerCapture)
+        SHADER_PARAMETER(uint32, GroupsPerCapture)
+        SHADER_PARAMETER(uint32, OutputOffset)
+        SHADER_PARAMETER_RDG_BUFFER_UAV(RWStructuredBuffer<uint>, DoneCounters)
+        SHADER_PARAMETER_RDG_BUFFER_UAV(RWStructuredBuffer<FVector4f>, OutRGBMean)
 
     END_SHADER_PARAMETER_STRUCT()
 
+    /** Permutation that actually runs on Platform: wave ops only where the platform has them (SM6). */
+    static FPermutationDomain RemapPermutation(FPermutationDomain PermutationVector, EShaderPlatform Platform)
+    {
+        if (!RHISupportsWaveOperations(Platform))
+        {
+            PermutationVector.Set<FUseWaveOps>(false);
+        }
+        return PermutationVector;
+    }
+
+    static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+    {
+        const FPermutationDomain PermutationVector(Parameters.PermutationId);
+        return RemapPermutation(PermutationVector, Parameters.Platform) == PermutationVector;
+    }
+
     static void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
     {
         FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
-        OutEnvironment.SetDefine(TEXT("TGX"), ThreadGroupSizeX);
-        OutEnvironment.SetDefine(TEXT("TGY"), ThreadGroupSizeY);
+
+        const FPermutationDomain PermutationVector = RemapPermutation(FPermutationDomain(Parameters.PermutationId), Parameters.Platform);
+        const FIntPoint Shape = GetGroupShape(PermutationVector.Get<FGroupShape>());
+        OutEnvironment.SetDefine(TEXT("TGX"), Shape.X);
+        OutEnvironment.SetDefine(TEXT("TGY"), Shape.Y);
+
+        // WaveActiveSum needs the SM6 compiler
+        if (PermutationVector.Get<FUseWaveOps>())
+        {
+            OutEnvironment.CompilerFlags.Add(CFLAG_WaveOperations);
+        }
     }
 };
 
@@ -56,7 +102,8 @@ public:
     static constexpr uint32 ThreadGroupSize = 256;
 
     BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
-        SHADER_PARAMETER(uint32, TotalPartials)
+        SHADER_PARAMETER(uint32, PartialsPerCapture)
+        SHADER_PARAMETER(uint32, OutputOffset)
         SHADER_PARAMETER_RDG_BUFFER_SRV(StructuredBuffer<FVector4f>, InPartialSums)
         SHADER_PARAMETER_RDG_BUFFER_UAV(RWStructuredBuffer<FVector4f>, OutRGBMean)
     END_SHADER_PARAMETER_STRUCT()
@@ -68,9 +115,244 @@ public:
 };
 
 
+//------ SH PROJECTION SHADER C++ IMPLEMENTATION ------
+class FIrradianceSHProjectCS : public FGlobalShader
+{
+
+public:
+
+    DECLARE_GLOBAL_SHADER(FIrradianceSHProjectCS);
+    SHADER_USE_PARAMETER_STRUCT(FIrradianceSHProjectCS, FGlobalShader);
+
+    class FSingleFace : SHADER_PERMUTATION_BOOL("SINGLE_FACE");
+    class FOrder : SHADER_PERMUTATION_RANGE_INT("SH_ORDER", 2, 3);     // 2..4 bands
+    using FPermutationDomain = TShaderPermutationDomain<FSingleFace, FOrder>;
+
+    static constexpr uint32 ThreadGroupSize = 256;     // SH_GROUP_SIZE
+    static constexpr uint32 TexelsPerThread = 4;       // SH_TEXELS_PER_THREAD
+
+    /** Groups of the texel grid over one face of side L (partials per face and coefficient). */
+    static uint32 GetGroupsPerFace(uint32 L)
+    {
+        return FMath::DivideAndRoundUp(L * L, ThreadGroupSize * TexelsPerThread);
+    }
+
+    BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+        SHADER_PARAMETER(uint32, L)
+        SHADER_PARAMETER(float, k)
+        SHADER_PARAMETER_RDG_BUFFER_SRV(StructuredBuffer<FVector4f>, SensorNormals)
+        SHADER_PARAMETER_RDG_TEXTURE_SRV(Texture2DArray<float4>, Faces)
+        SHADER_PARAMETER(uint32, FaceIndex)
+        SHADER_PARAMETER_RDG_TEXTURE_SRV(Texture2D<float4>, Face)
+        SHADER_PARAMETER(uint32, SHGroupsPerFace)
+        SHADER_PARAMETER_RDG_BUFFER_UAV(RWStructuredBuffer<FVector4f>, SHPartials)
+    END_SHADER_PARAMETER_STRUCT()
+
+    static void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+    {
+        FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+    }
+};
+
+
+//------ SH REDUCE SHADER C++ IMPLEMENTATION ------
+class FIrradianceSHReduceCS : public FGlobalShader
+{
+
+public:
+
+    DECLARE_GLOBAL_SHADER(FIrradianceSHReduceCS);
+    SHADER_USE_PARAMETER_STRUCT(FIrradianceSHReduceCS, FGlobalShader);
+
+    class FOrder : SHADER_PERMUTATION_RANGE_INT("SH_ORDER", 2, 3);     // 2..4 bands
+    using FPermutationDomain = TShaderPermutationDomain<FOrder>;
+
+    static constexpr uint32 ThreadGroupSize = 256;     // one group per face slot (SH_GROUP_SIZE)
+
+    BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+        SHADER_PARAMETER(uint32, SHGroupsPerFace)
+        SHADER_PARAMETER(uint32, OutputOffset)
+        SHADER_PARAMETER_RDG_BUFFER_SRV(StructuredBuffer<FVector4f>, InSHPartials)
+        SHADER_PARAMETER_RDG_BUFFER_UAV(RWStructuredBuffer<FVector4f>, OutSH)
+    END_SHADER_PARAMETER_STRUCT()
+
+    static void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+    {
+        FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+    }
+};
+
+
+//------ FACE RESOLVE SHADER C++ IMPLEMENTATION ------
+class FIrradianceFaceResolveCS : public FGlobalShader
+{
+
+public:
+
+    DECLARE_GLOBAL_SHADER(FIrradianceFaceResolveCS);
+    SHADER_USE_PARAMETER_STRUCT(FIrradianceFaceResolveCS, FGlobalShader);
+
+    static constexpr uint32 ThreadGroupSizeX = 8;
+    static constexpr uint32 ThreadGroupSizeY = 8;
+
+    BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+        SHADER_PARAMETER(uint32, L)
+        SHADER_PARAMETER_RDG_TEXTURE(Texture2D, SceneColorTex)
+        SHADER_PARAMETER_SAMPLER(SamplerState, SceneColorSampler)
+        SHADER_PARAMETER(FVector2f, SceneColorUVMin)
+        SHADER_PARAMETER(FVector2f, SceneColorUVSize)
+        SHADER_PARAMETER(uint32, AtlasSlice)
+        SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2DArray<float4>, FaceAtlas)
+    END_SHADER_PARAMETER_STRUCT()
+
+    static void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+    {
+        FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+        OutEnvironment.SetDefine(TEXT("TGX"), ThreadGroupSizeX);
+        OutEnvironment.SetDefine(TEXT("TGY"), ThreadGroupSizeY);
+    }
+};
+
+
+//------ KERNEL CONFIGURATION ------
+
+/** Stride and thread-group shape of the integrate kernel (see FIrradianceKernelTuner). */
+struct FIrradianceKernelConfig
+{
+    /** Texels per thread and axis: 1, 2 or 4. */
+    int32 Stride = IrradianceCommon::Defaults::IntegrateStride;
+
+    /** Index into FIrradianceIntegrateCS::GetGroupShape. */
+    int32 GroupShape = IrradianceCommon::Defaults::IntegrateGroupShape;
+
+    /** Integrate groups per face side. */
+    FIntPoint GetGroups(int32 CubemapSize) const
+    {
+        const FIntPoint Shape = FIrradianceIntegrateCS::GetGroupShape(GroupShape);
+        return FIntPoint(
+            FMath::DivideAndRoundUp(CubemapSize, Shape.X * Stride),
+            FMath::DivideAndRoundUp(CubemapSize, Shape.Y * Stride));
+    }
+};
+
+
 //------ HELPERS ------
 namespace IrradianceCompute
 {
+    // Max cubemaps per batch (6*K slices must fit in a Texture2DArray)
+    static constexpr int32 MaxBatchCaptures = 256;
+
+    // Runs the shader over K cubemaps in one dispatch and returns a buffer with K results.
+    // FaceRTs holds 6*K faces (capture-major), SensorNormals holds K normals.
+    // With SHOrder > 0, OutSH receives the SH projection of every face (see AddSHProjectPasses).
+    FRDGBufferRef ComputeIrradianceBatch(
+        FRDGBuilder& GraphBuilder,
+        TConstArrayView<TRefCountPtr<IPooledRenderTarget>> FaceRTs,
+        int32 CubemapSize,
+        TConstArrayView<FVector3f> SensorNormals,
+        int32 SHOrder = 0,
+        FRDGBufferRef* OutSH = nullptr);
+
+    // Same as ComputeAndExtractIrradianceBatch, reading the faces in place from the face atlas.
+    // AtlasSlots holds the atlas slot (6 slices each) of every capture.
+    void ComputeAndExtractIrradianceAtlas(
+        FRDGBuilder& GraphBuilder,
+        const TRefCountPtr<IPooledRenderTarget>& FaceAtlas,
+        TConstArrayView<int32> AtlasSlots,
+        int32 CubemapSize,
+        TConstArrayView<FVector3f> SensorNormals,
+        TRefCountPtr<FRDGPooledBuffer>* OutResultBuffer,
+        int32 SHOrder = 0,
+        TRefCountPtr<FRDGPooledBuffer>* OutSHBuffer = nullptr);
+
+    // Batched variant of ComputeAndExtractIrradiance (single readback for K results)
+    void ComputeAndExtractIrradianceBatch(
+        FRDGBuilder& GraphBuilder,
+        TConstArrayView<TRefCountPtr<IPooledRenderTarget>> FaceRTs,
+        int32 CubemapSize,
+        TConstArrayView<FVector3f> SensorNormals,
+        TRefCountPtr<FRDGPooledBuffer>* OutResultBuffer,
+        int32 SHOrder = 0,
+        TRefCountPtr<FRDGPooledBuffer>* OutSHBuffer = nullptr);
+
+    // SH projection of K cubemaps read from a faces array (slot of capture c in FaceSlots[c]).
+    // Returns 6 * SHOrder^2 float4 per capture (capture-major, then face), to be summed on the CPU.
+    FRDGBufferRef AddSHProjectPasses(
+        FRDGBuilder& GraphBuilder,
+        FRDGTextureSRVRef FacesSRV,
+        int32 CubemapSize,
+        TConstArrayView<int32> FaceSlots,
+        int32 SHOrder);
+
+    // Streaming: projects one face into the SH buffer of its capture (6 * SHOrder^2 float4),
+    // created by the first face.
+    bool ProjectFaceSH(
+        FRDGBuilder& GraphBuilder,
+        const TRefCountPtr<IPooledRenderTarget>& FaceRT,
+        int32 FaceIndex,
+        int32 SHOrder,
+        TRefCountPtr<FRDGPooledBuffer>& InOutSH);
+
+    // Streaming: gathers the SH buffers of K captures into one buffer for a single readback.
+    void GatherAndExtractSHBatch(
+        FRDGBuilder& GraphBuilder,
+        TConstArrayView<TRefCountPtr<FRDGPooledBuffer>> SHBuffers,
+        int32 SHOrder,
+        TRefCountPtr<FRDGPooledBuffer>* OutSHBuffer);
+
+    // Streaming: integrates one face into the persistent partial sums of its capture, so the
+    // face RT can be released right away. InOutPartialSums is created by the first face.
+    // With the fused reduce, the last face also writes the capture's result to InOutResult.
+    // FaceSidePx holds the side of the 6 faces of the capture (0 = culled, empty = all CubemapSize).
+    // InOutConfig is picked by the first face and kept by the others (the tuner may move on meanwhile).
+    bool AccumulateFace(
+        FRDGBuilder& GraphBuilder,
+        const TRefCountPtr<IPooledRenderTarget>& FaceRT,
+        int32 FaceIndex,
+        int32 CubemapSize,
+        TConstArrayView<int32> FaceSidePx,
+        const FVector3f& SensorNormal,
+        FIrradianceKernelConfig& InOutConfig,
+        TRefCountPtr<FRDGPooledBuffer>& InOutPartialSums,
+        TRefCountPtr<FRDGPooledBuffer>& InOutDoneCounter,
+        TRefCountPtr<FRDGPooledBuffer>& InOutResult);
+
+    // Streaming: reduces the partial sums of K captures (all 6 faces accumulated)
+    // and extracts a buffer with K results. With the fused reduce, Results already
+    // holds one result per capture and they are only gathered. Each capture is reduced
+    // with the partial count of its own buffer (its kernel configuration).
+    void ReduceAndExtractIrradianceBatch(
+        FRDGBuilder& GraphBuilder,
+        TConstArrayView<TRefCountPtr<FRDGPooledBuffer>> PartialSums,
+        TConstArrayView<TRefCountPtr<FRDGPooledBuffer>> Results,
+        int32 CubemapSize,
+        TRefCountPtr<FRDGPooledBuffer>* OutResultBuffer);
+
+    // Integrates one face (Texture2D) into slice FaceIndex of PartialSums with an explicit kernel configuration.
+    // The face may be smaller than CubemapSize (grazing faces); slices are always sized for CubemapSize.
+    // GroupsPerCapture is the fused done target (0 = 6 faces at CubemapSize).
+    // Used by AccumulateFace and by the kernel tuner.
+    void AddIntegrateFacePass(
+        FRDGBuilder& GraphBuilder,
+        FRDGTextureRef Face,
+        int32 FaceIndex,
+        int32 CubemapSize,
+        const FVector3f& SensorNormal,
+        const FIrradianceKernelConfig& Config,
+        FRDGBufferRef PartialSums,
+        FRDGBufferRef DoneCounters = nullptr,
+        FRDGBufferRef Result = nullptr,
+        uint32 GroupsPerCapture = 0);
+
+    // Face atlas: resolves SceneColor (view rect) into slice AtlasSlice of the atlas
+    void AddFaceResolvePass(
+        FRDGBuilder& GraphBuilder,
+        FRDGTextureRef SceneColor,
+        const FIntRect& ViewRect,
+        FRDGTextureRef FaceAtlas,
+        int32 AtlasSlice,
+        int32 CubemapSize);
+
     // Runs the shader and returns a buffer with the result
     FRDGBufferRef ComputeIrradiance(
         FRDGBuilder& GraphBuilder,
@@ -0,0 +1,258 @@
+﻿// IrradianceKernelTuner.cpp
+
+#include "Irradiance/IrradianceKernelTuner.h"
+
+#include "RenderGraphBuilder.h"
+#include "RenderGraphUtils.h"
+#include "RHICommandList.h"
+#include "RHIResources.h"
+#include "DynamicRHI.h"
+#include "Misc/FileHelper.h"
+#include "Tasks/Task.h"
+#include "Misc/Paths.h"
+#include "Logging/IrradianceLog.h"
+
+namespace
+{
+    const TCHAR* DeviceHeaderPrefix = TEXT("# device=");
+
+    /** Writes a GPU timestamp between the passes around it. */
+    void AddTimestampPass(FRDGBuilder& GraphBuilder, FRHIRenderQuery* Query)
+    {
+        GraphBuilder.AddPass(RDG_EVENT_NAME("IrradianceKernelTimestamp"), ERDGPassFlags::NeverCull,
+            [Query](FRHICommandListImmediate& RHICmdList)
+            {
+                RHICmdList.EndRenderQuery(Query);
+            });
+    }
+}
+
+
+FIrradianceKernelTuner& FIrradianceKernelTuner::Get()
+{
+    static FIrradianceKernelTuner Instance;
+    return Instance;
+}
+
+
+FString FIrradianceKernelTuner::GetDeviceKey()
+{
+    return FString::Printf(TEXT("%s/%s"), GDynamicRHI ? GDynamicRHI->GetName() : TEXT("None"), *GRHIAdapterName);
+}
+
+
+FString FIrradianceKernelTuner::GetCachePath()
+{
+    return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Pyrano"), TEXT("IntegrateKernelTuning.csv"));
+}
+
+
+FIrradianceKernelConfig FIrradianceKernelTuner::GetConfig(int32 CubemapSize) const
+{
+    const FWinner* Winner = Winners.Find(CubemapSize);
+    return Winner ? Winner->Config : FIrradianceKernelConfig();
+}
+
+
+void FIrradianceKernelTuner::EnsureTuned(FRHICommandListImmediate& RHICmdList, int32 CubemapSize)
+{
+    check(IsInRenderingThread());
+
+    if (!IrradianceCommon::Settings::bAutoTuneIntegrateKernel || CubemapSize <= 0)
+        return;
+
+    if (!bCacheLoaded)
+    {
+        LoadCache();
+        bCacheLoaded = true;
+    }
+
+    if (PendingBenchmarks.Num() > 0)
+    {
+        CollectBenchmarks();
+    }
+
+    if (Winners.Contains(CubemapSize) || FailedSizes.Contains(CubemapSize) || PendingBenchmarks.Contains(CubemapSize))
+        return;
+
+    SubmitBenchmark(RHICmdList, CubemapSize);
+}
+
+
+void FIrradianceKernelTuner::SubmitBenchmark(FRHICommandListImmediate& RHICmdList, int32 CubemapSize)
+{
+    FPendingBenchmark& Benchmark = PendingBenchmarks.Add(CubemapSize);
+    Benchmark.SubmitSeconds = FPlatformTime::Seconds();
+
+    for (const int32 Stride : { 1, 2, 4 })
+    {
+        for (int32 Shape = 0; Shape < FIrradianceIntegrateCS::NumGroupShapes; ++Shape)
+        {
+            FVariant& V = Benchmark.Variants.AddDefaulted_GetRef();
+            V.Config.Stride = Stride;
+            V.Config.GroupShape = Shape;
+            V.Begin = RHICreateRenderQuery(RQT_AbsoluteTime);
+            V.End = RHICreateRenderQuery(RQT_AbsoluteTime);
+        }
+    }
+
+    // Same work as a streamed capture: one face per dispatch, constant radiance
+    for (FVariant& V : Benchmark.Variants)
+    {
+        FRDGBuilder GraphBuilder(RHICmdList);
+
+        FRDGTextureRef Face = GraphBuilder.CreateTexture(
+            FRDGTextureDesc::Create2D(FIntPoint(CubemapSize, CubemapSize), PF_FloatRGBA, FClearValueBinding::None,
+                TexCreate_ShaderResource | TexCreate_UAV),
+            TEXT("Irr.TunerFace"));
+        AddClearUAVPass(GraphBuilder, GraphBuilder.CreateUAV(Face), FLinearColor::White);
+
+        const FIntPoint Groups = V.Config.GetGroups(CubemapSize);
+        FRDGBufferRef PartialSums = GraphBuilder.CreateBuffer(
+            FRDGBufferDesc::CreateStructuredDesc(sizeof(FVector4f), Groups.X * Groups.Y * IrradianceCommon::NumFaces),
+            TEXT("Irr.TunerPartialSums"));
+
+        // First dispatch untimed (pipeline creation, caches)
+        IrradianceCompute::AddIntegrateFacePass(GraphBuilder, Face, 0, CubemapSize, FVector3f::UpVector, V.Config, PartialSums);
+
+        AddTimestampPass(GraphBuilder, V.Begin);
+        for (int32 i = 0; i < TimedFaces; ++i)
+        {
+            IrradianceCompute::AddIntegrateFacePass(GraphBuilder, Face, i % IrradianceCommon::NumFaces,
+                CubemapSize, FVector3f::UpVector, V.Config, PartialSums);
+        }
+        AddTimestampPass(GraphBuilder, V.End);
+
+        // Extraction keeps the integrate passes from being culled
+        TRefCountPtr<FRDGPooledBuffer> Discard;
+        GraphBuilder.QueueBufferExtraction(PartialSums, &Discard);
+        GraphBuilder.Execute();
+    }
+
+    PYRANO_VERBOSE(TEXT("[KernelTuner] L=%d: %d variants submitted"), CubemapSize, Benchmark.Variants.Num());
+}
+
+
+void FIrradianceKernelTuner::CollectBenchmarks()
+{
+    bool bNewWinner = false;
+    const double Now = FPlatformTime::Seconds();
+
+    for (auto It = PendingBenchmarks.CreateIterator(); It; ++It)
+    {
+        const int32 CubemapSize = It.Key();
+        const FPendingBenchmark& Benchmark = It.Value();
+
+        // Non-blocking: the last timestamp written means the whole benchmark is done
+        uint64 LastUs = 0;
+        const bool bReady = RHIGetRenderQueryResult(Benchmark.Variants.Last().End, LastUs, false);
+        if (!bReady && Now - Benchmark.SubmitSeconds < MaxWaitSeconds)
+            continue;
+
+        FWinner Best;
+        Best.MicrosecondsPerFace = TNumericLimits<double>::Max();
+        for (const FVariant& V : Benchmark.Variants)
+        {
+            uint64 BeginUs = 0;
+            uint64 EndUs = 0;
+            if (!bReady || !RHIGetRenderQueryResult(V.Begin, BeginUs, false) || !RHIGetRenderQueryResult(V.End, EndUs, false) || EndUs <= BeginUs)
+                continue;
+
+            const double UsPerFace = double(EndUs - BeginUs) / TimedFaces;
+            const FIntPoint Shape = FIrradianceIntegrateCS::GetGroupShape(V.Config.GroupShape);
+            PYRANO_VERBOSE(TEXT("[KernelTuner] L=%d stride %d, %dx%d groups: %.2f us/face"),
+                CubemapSize, V.Config.Stride, Shape.X, Shape.Y, UsPerFace);
+
+            if (UsPerFace < Best.MicrosecondsPerFace)
+            {
+                Best.Config = V.Config;
+                Best.MicrosecondsPerFace = UsPerFace;
+            }
+        }
+        It.RemoveCurrent();
+
+        if (Best.MicrosecondsPerFace == TNumericLimits<double>::Max())
+        {
+            // No timestamps on this RHI: keep the default kernel, do not retry
+            PYRANO_WARN(TEXT("[KernelTuner] GPU timing unavailable, default kernel kept for L=%d"), CubemapSize);
+            FailedSizes.Add(CubemapSize);
+            continue;
+        }
+
+        // Captures already integrating keep the kernel they started with (see AccumulateFace)
+        const FIntPoint Shape = FIrradianceIntegrateCS::GetGroupShape(Best.Config.GroupShape);
+        PYRANO_INFO(TEXT("[KernelTuner] L=%d: stride %d, %dx%d groups (%.2f us/face)"),
+            CubemapSize, Best.Config.Stride, Shape.X, Shape.Y, Best.MicrosecondsPerFace);
+
+        Winners.Add(CubemapSize, Best);
+        bNewWinner = true;
+    }
+
+    if (bNewWinner)
+    {
+        SaveCache();
+    }
+}
+
+
+void FIrradianceKernelTuner::LoadCache()
+{
+    TArray<FString> Lines;
+    if (!FFileHelper::LoadFileToStringArray(Lines, *GetCachePath()) || Lines.Num() == 0)
+        return;
+
+    // Timings of another GPU / RHI: nothing to reuse
+    if (Lines[0] != FString(DeviceHeaderPrefix) + GetDeviceKey())
+    {
+        PYRANO_VERBOSE(TEXT("[KernelTuner] Cache belongs to another device, ignored (%s)"), *Lines[0]);
+        return;
+    }
+
+    // L,Stride,GroupShape,MicrosecondsPerFace
+    for (int32 i = 1; i < Lines.Num(); ++i)
+    {
+        TArray<FString> Cols;
+        Lines[i].ParseIntoArray(Cols, TEXT(","), /*CullEmpty*/ true);
+        if (Cols.Num() != 4)
+            continue;
+
+        FWinner W;
+        W.Config.Stride = FCString::Atoi(*Cols[1]);
+        W.Config.GroupShape = FCString::Atoi(*Cols[2]);
+        W.MicrosecondsPerFace = FCString::Atod(*Cols[3]);
+
+        const bool bValidStride = W.Config.Stride == 1 || W.Config.Stride == 2 || W.Config.Stride == 4;
+        const bool bValidShape = W.Config.GroupShape >= 0 && W.Config.GroupShape < FIrradianceIntegrateCS::NumGroupShapes;
+        if (bValidStride && bValidShape)
+        {
+            Winners.Add(FCString::Atoi(*Cols[0]), W);
+        }
+    }
+
+    PYRANO_VERBOSE(TEXT("[KernelTuner] Cache loaded: %d resolution(s)"), Winners.Num());
+}
+
+
+void FIrradianceKernelTuner::SaveCache()
+{
+    TArray<FString> Lines;
+    Lines.Reserve(Winners.Num() + 1);
+    Lines.Add(FString(DeviceHeaderPrefix) + GetDeviceKey());
+
+    for (const TPair<int32, FWinner>& It : Winners)
+    {
+        Lines.Add(FString::Printf(TEXT("%d,%d,%d,%.3f"),
+            It.Key, It.Value.Config.Stride, It.Value.Config.GroupShape, It.Value.MicrosecondsPerFace));
+    }
+
+    // Chained on the previous write: the last snapshot always lands last
+    SaveTask = UE::Tasks::Launch(UE_SOURCE_LOCATION,
+        [Lines = MoveTemp(Lines), Path = GetCachePath()]()
+        {
+            if (!FFileHelper::SaveStringArrayToFile(Lines, *Path))
+            {
+                PYRANO_WARN(TEXT("[KernelTuner] Could not write cache: %s"), *Path);
+            }
+        },
+        SaveTask);
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+/*=============================================================================
+    IrradianceKernelTuner.h
+  Picks the fastest stride / thread-group shape of the integrate kernel for
+  each cubemap resolution, timing every variant on its first use.
+/============================================================================*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RHIResources.h"
+#include "Tasks/Task.h"
+#include "Irradiance/IrradianceIntegrateCS.h"
+
+class FRHICommandListImmediate;
+
+/**
+ * Winners are persisted per RHI and adapter in Saved/Pyrano/IntegrateKernelTuning.csv,
+ * so a machine only benchmarks a resolution once. Render thread only.
+ *
+ * The benchmark never stalls the GPU: its timestamps are read back by later calls once the
+ * GPU has written them, and the default configuration is used until then.
+ */
+class FIrradianceKernelTuner
+{
+public:
+
+    static FIrradianceKernelTuner& Get();
+
+    /**
+     * Queues the benchmark of every variant for this resolution if it has none yet, and collects
+     * the benchmarks whose timings are back. Call outside any RDG builder.
+     */
+    void EnsureTuned(FRHICommandListImmediate& RHICmdList, int32 CubemapSize);
+
+    /** Winner for this resolution, or the default configuration. Never benchmarks. */
+    FIrradianceKernelConfig GetConfig(int32 CubemapSize) const;
+
+private:
+
+    struct FWinner
+    {
+        FIrradianceKernelConfig Config;
+        double                  MicrosecondsPerFace = 0.0;
+    };
+
+    struct FVariant
+    {
+        FIrradianceKernelConfig Config;
+        FRenderQueryRHIRef      Begin;
+        FRenderQueryRHIRef      End;
+    };
+
+    /** Benchmark submitted to the GPU, timings not read back yet. */
+    struct FPendingBenchmark
+    {
+        TArray<FVariant>    Variants;
+        double              SubmitSeconds = 0.0;
+    };
+
+    /** Integrate dispatches timed per variant (4 cubemaps). */
+    static constexpr int32 TimedFaces = 24;
+
+    /** A benchmark whose timings are still missing after this long is given up. */
+    static constexpr double MaxWaitSeconds = 10.0;
+
+    /** "RHI/Adapter" of this device. */
+    static FString GetDeviceKey();
+
+    static FString GetCachePath();
+
+    /** Queues the timed dispatches of every variant for this resolution. */
+    void SubmitBenchmark(FRHICommandListImmediate& RHICmdList, int32 CubemapSize);
+
+    /** Picks the winners of the benchmarks whose timestamps are available, without waiting. */
+    void CollectBenchmarks();
+
+    void LoadCache();
+
+    /** Writes the winners on a background task (file I/O stays off the render thread). */
+    void SaveCache();
+
+    bool                            bCacheLoaded = false;
+    TMap<int32, FWinner>            Winners;
+    TSet<int32>                     FailedSizes;
+    TMap<int32, FPendingBenchmark>  PendingBenchmarks;
+    UE::Tasks::FTask                SaveTask;       // last cache write, the next one runs after it
+};
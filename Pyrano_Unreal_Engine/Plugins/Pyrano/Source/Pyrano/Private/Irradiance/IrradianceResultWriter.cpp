@@ -0,0 +1,533 @@
+﻿// IrradianceResultWriter.cpp
+
+#include "Irradiance/IrradianceResultWriter.h"
+
+#include "HAL/PlatformFileManager.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/Event.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "Misc/StringBuilder.h"
+#include "Logging/IrradianceLog.h"
+
+namespace
+{
+    /** Wake-up period of the writer thread when nobody asks for a flush. */
+    constexpr uint32 WakeIntervalMs = 100;
+
+    /** Formatted bytes kept in memory before a write. */
+    constexpr int32 WriteBufferBytes = 64 * 1024;
+
+    /** Longest time rows may stay only in OS buffers without an explicit flush. */
+    constexpr double DurableIntervalSeconds = 2.0;
+
+    const TCHAR* CSVHeader =
+        TEXT("sensor_name,sensor_guid,utc,")
+        TEXT("pos_x,pos_y,pos_z,")
+        TEXT("n_x,n_y,n_z,")
+        TEXT("side_px,warmup,")
+        TEXT("azimuth_deg,altitude_deg,geometric_factor,")
+        TEXT("clearsky_ghi_wm2,clearsky_dni_wm2,clearsky_dhi_wm2,")
+        TEXT("sun_occluded,sun_hit_distance_m,sun_visibility,")
+        TEXT("sky_view_factor,")
+        TEXT("raw_r_lux,raw_g_lux,raw_b_lux,")
+        TEXT("sim_comp_amb_lux,sim_comp_direct_lux,")
+        TEXT("irr_final_normalized_wm2\n");
+
+    /** Header of the SH sidecar: sh<i>_r, sh<i>_g, sh<i>_b for the Order^2 coefficients. */
+    FString MakeSHHeader(int32 Order)
+    {
+        FString Header(TEXT("sensor_guid,utc,sh_order"));
+        for (int32 i = 0; i < FIrradianceSH::GetNumCoeffs(Order); ++i)
+        {
+            Header += FString::Printf(TEXT(",sh%d_r,sh%d_g,sh%d_b"), i, i, i);
+        }
+        Header += TEXT("\n");
+        return Header;
+    }
+
+    void AppendUTF8(TArray<uint8>& Buffer, const TCHAR* Str, int32 Len)
+    {
+        const FTCHARToUTF8 Utf8(Str, Len);
+        Buffer.Append(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+    }
+}
+
+
+// -----------------------------------------------------------------------------
+//  Life Cycle
+// -----------------------------------------------------------------------------
+
+FIrradianceResultWriter::FIrradianceResultWriter(const FString& InCSVPathAbs, const FString& InBinaryPathAbs, const FString& InSHPathAbs)
+    : CSVPathAbs(InCSVPathAbs)
+    , BinaryPathAbs(InBinaryPathAbs)
+    , SHPathAbs(InSHPathAbs)
+{
+    WriteBuffer.Reserve(WriteBufferBytes + 1024);
+}
+
+
+FIrradianceResultWriter::~FIrradianceResultWriter()
+{
+    Shutdown();
+}
+
+
+bool FIrradianceResultWriter::Start()
+{
+    if (Thread)
+        return true;
+
+    if (!CSVPathAbs.IsEmpty())
+    {
+        const FString Dir = FPaths::GetPath(CSVPathAbs);
+        if (!Dir.IsEmpty() && !IFileManager::Get().DirectoryExists(*Dir))
+        {
+            IFileManager::Get().MakeDirectory(*Dir, true);
+        }
+
+        IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+        FileHandle.Reset(PlatformFile.OpenWrite(*CSVPathAbs, /*bAppend*/ true, /*bAllowRead*/ true));
+        if (!FileHandle)
+        {
+            PYRANO_ERR(TEXT("[ResultWriter] Cannot open '%s' for writing."), *CSVPathAbs);
+        }
+
+        // Resume: rows after the checkpoint (and a torn last line) are written again
+        else if (ResumeCSVBytes > 0 && FileHandle->Size() > ResumeCSVBytes)
+        {
+            if (!FileHandle->Truncate(ResumeCSVBytes) || !FileHandle->Seek(ResumeCSVBytes))
+            {
+                PYRANO_ERR(TEXT("[ResultWriter] Cannot cut '%s' back to %lld bytes."), *CSVPathAbs, ResumeCSVBytes);
+                FileHandle.Reset();
+            }
+        }
+
+        if (FileHandle)
+        {
+            GoodCSVBytes = FileHandle->Size();
+        }
+
+        // Header only for a new file
+        if (FileHandle && FileHandle->Size() == 0)
+        {
+            const FString Header(CSVHeader);
+            AppendUTF8(WriteBuffer, *Header, Header.Len());
+            WriteBufferToDisk(true);
+        }
+    }
+
+    if (!BinaryPathAbs.IsEmpty())
+    {
+        Columnar = MakeUnique<FIrradianceColumnarFile>();
+        if (!Columnar->Open(BinaryPathAbs))
+        {
+            Columnar.Reset();
+        }
+    }
+
+    if (!FileHandle && !Columnar)
+        return false;
+
+    bStopRequested.store(false);
+    LastDurableTime = FPlatformTime::Seconds();
+    WakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+    Thread = FRunnableThread::Create(this, TEXT("PyranoResultWriter"), 0, TPri_BelowNormal);
+    if (!Thread)
+    {
+        PYRANO_ERR(TEXT("[ResultWriter] Failed to create the writer thread."));
+        FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+        WakeEvent = nullptr;
+        FileHandle.Reset();
+        Columnar.Reset();
+        return false;
+    }
+
+    PYRANO_INFO(TEXT("[ResultWriter] Writing CSV='%s' Binary='%s'."),
+        FileHandle ? *CSVPathAbs : TEXT("-"),
+        Columnar ? *BinaryPathAbs : TEXT("-"));
+    return true;
+}
+
+
+void FIrradianceResultWriter::Shutdown()
+{
+    if (!Thread)
+        return;
+
+    // Run() drains the queues and flushes before returning
+    Stop();
+    Thread->WaitForCompletion();
+    delete Thread;
+    Thread = nullptr;
+
+    FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+    WakeEvent = nullptr;
+
+    FileHandle.Reset();
+    SHFileHandle.Reset();
+    if (Columnar)
+    {
+        Columnar->Close(Sensors);
+        Columnar.Reset();
+    }
+
+    PYRANO_INFO(TEXT("[ResultWriter] Closed (rows=%llu)."), GetRowsWritten());
+}
+
+
+void FIrradianceResultWriter::Stop()
+{
+    bStopRequested.store(true);
+    if (WakeEvent)
+    {
+        WakeEvent->Trigger();
+    }
+}
+
+
+// -----------------------------------------------------------------------------
+//  Producer API
+// -----------------------------------------------------------------------------
+
+void FIrradianceResultWriter::DeclareSensor(const FGuid& SensorId, const FString& SensorName)
+{
+    SensorQueue.Enqueue(FSensorDecl{ SensorId, SensorName });
+}
+
+
+void FIrradianceResultWriter::Enqueue(const FIrradianceResultRow& Row)
+{
+    // No wake-up per row: the thread polls every WakeIntervalMs
+    RowQueue.Enqueue(Row);
+}
+
+
+void FIrradianceResultWriter::EnqueueSH(const FIrradianceSHRow& Row)
+{
+    SHQueue.Enqueue(Row);
+}
+
+
+void FIrradianceResultWriter::RequestFlush()
+{
+    FlushRequests.fetch_add(1);
+    if (WakeEvent)
+    {
+        WakeEvent->Trigger();
+    }
+}
+
+
+bool FIrradianceResultWriter::GetDurablePoint(uint64& OutRows, int64& OutCSVBytes) const
+{
+    FScopeLock Lock(&DurableLock);
+    OutRows = DurableRows;
+    OutCSVBytes = DurableBytes;
+    return DurableBytes >= 0;
+}
+
+
+// -----------------------------------------------------------------------------
+//  Writer thread
+// -----------------------------------------------------------------------------
+
+uint32 FIrradianceResultWriter::Run()
+{
+    while (!bStopRequested.load())
+    {
+        WakeEvent->Wait(WakeIntervalMs);
+
+        DrainQueues();
+
+        // Durability points: explicit requests, or periodically
+        const uint32 Requests = FlushRequests.load();
+        const double Now = FPlatformTime::Seconds();
+        if (Requests != FlushRequestsServed)
+        {
+            // Explicit request: also cut the pending binary chunk
+            FlushRequestsServed = Requests;
+            WriteBufferToDisk(true);
+            if (Columnar)
+            {
+                Columnar->FlushChunk();
+                Columnar->FlushToDisk();
+            }
+        }
+        else if (Now - LastDurableTime >= DurableIntervalSeconds)
+        {
+            WriteBufferToDisk(true);
+        }
+    }
+
+    // Everything queued before Stop() is written (the binary footer is written by Shutdown)
+    DrainQueues();
+    WriteBufferToDisk(true);
+    return 0;
+}
+
+
+void FIrradianceResultWriter::DrainSensorDecls()
+{
+    FSensorDecl Decl;
+    while (SensorQueue.Dequeue(Decl))
+    {
+        const uint32 Index = FindOrAddSensor(Decl.SensorId);
+        Sensors[Index].Name = MoveTemp(Decl.SensorName);
+    }
+}
+
+
+uint32 FIrradianceResultWriter::FindOrAddSensor(const FGuid& SensorId)
+{
+    if (const uint32* Found = SensorIndices.Find(SensorId))
+        return *Found;
+
+    const uint32 Index = (uint32)Sensors.Num();
+    Sensors.Add({ SensorId, FString() });
+    SensorGuidStrings.Add(SensorId.ToString());
+    SensorIndices.Add(SensorId, Index);
+    return Index;
+}
+
+
+void FIrradianceResultWriter::DrainQueues()
+{
+    DrainSensorDecls();
+
+    FIrradianceResultRow Row;
+    while (RowQueue.Dequeue(Row))
+    {
+        if (!SensorIndices.Contains(Row.SensorId))
+        {
+            // Declared after our first drain of the sensor queue
+            DrainSensorDecls();
+        }
+        const uint32 SensorIndex = FindOrAddSensor(Row.SensorId);
+
+        if (FileHandle)
+        {
+            FormatRow(Row, SensorIndex);
+            if (WriteBuffer.Num() >= WriteBufferBytes)
+            {
+                WriteBufferToDisk(false);
+            }
+        }
+
+        if (Columnar)
+        {
+            Columnar->AddRow(Row, SensorIndex);
+        }
+
+        RowsWritten.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    DrainSHQueue();
+}
+
+
+void FIrradianceResultWriter::DrainSHQueue()
+{
+    FIrradianceSHRow Row;
+    while (SHQueue.Dequeue(Row))
+    {
+        if (!Row.SH.IsValid() || SHPathAbs.IsEmpty() || bSHOpenFailed)
+            continue;
+
+        // Opened on the first row: runs without SH leave no sidecar behind
+        if (!SHFileHandle)
+        {
+            IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+            SHFileHandle.Reset(PlatformFile.OpenWrite(*SHPathAbs, /*bAppend*/ true, /*bAllowRead*/ true));
+            if (!SHFileHandle)
+            {
+                PYRANO_ERR(TEXT("[ResultWriter] Cannot open '%s' for writing. SH rows dropped."), *SHPathAbs);
+                bSHOpenFailed = true;
+                continue;
+            }
+
+            if (SHFileHandle->Size() == 0)
+            {
+                const FString Header = MakeSHHeader(Row.SH.Order);
+                AppendUTF8(SHWriteBuffer, *Header, Header.Len());
+            }
+        }
+
+        TStringBuilder<1024> Line;
+        Line.Appendf(TEXT("%s,%s,%d"),
+            *Row.SensorId.ToString(),
+            *FDateTime(Row.TimestampTicks).ToIso8601(),
+            Row.SH.Order);
+        for (const FVector3f& Coeff : Row.SH.Coeffs)
+        {
+            Line.Appendf(TEXT(",%.9g,%.9g,%.9g"), (double)Coeff.X, (double)Coeff.Y, (double)Coeff.Z);
+        }
+        Line.AppendChar(TEXT('\n'));
+        AppendUTF8(SHWriteBuffer, Line.ToString(), Line.Len());
+
+        if (SHWriteBuffer.Num() >= WriteBufferBytes)
+        {
+            WriteSHBufferToDisk(false);
+        }
+    }
+}
+
+
+void FIrradianceResultWriter::WriteSHBufferToDisk(bool bDurable)
+{
+    if (!SHFileHandle)
+        return;
+
+    if (SHWriteBuffer.Num() > 0)
+    {
+        if (!SHFileHandle->Write(SHWriteBuffer.GetData(), SHWriteBuffer.Num()))
+        {
+            PYRANO_ERR(TEXT("[ResultWriter] Write failed on '%s' (%d bytes dropped)."), *SHPathAbs, SHWriteBuffer.Num());
+        }
+        SHWriteBuffer.Reset();
+        bSHUnflushedWrites = true;
+    }
+
+    if (bDurable && bSHUnflushedWrites)
+    {
+        SHFileHandle->Flush(true);
+        bSHUnflushedWrites = false;
+    }
+}
+
+
+void FIrradianceResultWriter::FormatRow(const FIrradianceResultRow& Row, uint32 SensorIndex)
+{
+    TStringBuilder<512> Line;
+    Line.Appendf(
+        TEXT(
+            // SensorName, SensorId, Timestamp
+            "%s,%s,%s,"
+
+            // --- Sensor ---
+            "%.6f,%.6f,%.6f,"
+            "%.6f,%.6f,%.6f,"
+            "%d,%u,"
+
+            // --- Solar Geometry ---
+            "%.3f,%.3f,%.6f,"
+
+            // --- Clear-sky ---
+            "%.6f,%.6f,%.6f,"
+
+            // --- Occlusion ---
+            "%d,%.3f,%.3f,"
+
+            // --- Sky View Factor ---
+            "%.6f,"
+
+            // --- Ambient (RGB + mean) ---
+            "%.9f,%.9f,%.9f,%.9f,"
+
+            // --- Direct ---
+            "%.9f,"
+
+            // -- Total (Normalized) --
+            "%.9f\n"
+        ),
+
+        // SensorName, SensorId, Timestamp
+        *Sensors[SensorIndex].Name,
+        *SensorGuidStrings[SensorIndex],
+        *FDateTime(Row.TimestampTicks).ToIso8601(),
+
+        // --- Sensor ---
+        Row.PosWS.X,
+        Row.PosWS.Y,
+        Row.PosWS.Z,
+        Row.NormalWS.X,
+        Row.NormalWS.Y,
+        Row.NormalWS.Z,
+        Row.SidePx,
+        Row.WarmupFrames,
+
+        // --- Solar Geometry ---
+        (double)Row.AzimuthDeg,
+        (double)Row.AltitudeDeg,
+        (double)Row.GeometricFactor,
+
+        // --- Clear-sky ---
+        Row.ClearSkyGHI,
+        Row.ClearSkyDNI,
+        Row.ClearSkyDHI,
+
+        // --- Occlusion ---
+        Row.SunOccluded,
+        (double)Row.SunHitDistanceM,
+        (double)Row.SunVisibility,
+
+        // --- Sky View Factor ---
+        (double)Row.SkyViewFactor,
+
+        // --- Diffuse (RGB + mean) ---
+        (double)Row.IrrR,
+        (double)Row.IrrG,
+        (double)Row.IrrB,
+        (double)Row.IrrMean,
+
+        // --- Direct ---
+        (double)Row.IrrDir,
+
+        // --- Total normalized ---
+        (double)Row.TotalIrradiance
+    );
+
+    AppendUTF8(WriteBuffer, Line.ToString(), Line.Len());
+}
+
+
+void FIrradianceResultWriter::WriteBufferToDisk(bool bDurable)
+{
+    // The sidecar follows the durability points of the results
+    WriteSHBufferToDisk(bDurable);
+
+    if (!FileHandle)
+        return;
+
+    // After a failure rows are dropped rather than piling up in memory
+    if (WriteBuffer.Num() > 0 && !bWriteFailed)
+    {
+        if (FileHandle->Write(WriteBuffer.GetData(), WriteBuffer.Num()))
+        {
+            GoodCSVBytes = FileHandle->Tell();
+        }
+        else
+        {
+            // A partial write may leave half a line: cut back to the last whole one
+            PYRANO_ERR(TEXT("[ResultWriter] Write failed on '%s' (%d bytes dropped, CSV kept up to %lld bytes)."),
+                *CSVPathAbs, WriteBuffer.Num(), GoodCSVBytes);
+            bWriteFailed = true;
+            if (!FileHandle->Truncate(GoodCSVBytes) || !FileHandle->Seek(GoodCSVBytes))
+            {
+                PYRANO_ERR(TEXT("[ResultWriter] Cannot cut '%s' back to %lld bytes; resume from its last checkpoint."), *CSVPathAbs, GoodCSVBytes);
+            }
+        }
+        bUnflushedWrites = true;
+    }
+    WriteBuffer.Reset();
+
+    if (bDurable && bUnflushedWrites)
+    {
+        const bool bFlushed = FileHandle->Flush(true);
+        bUnflushedWrites = false;
+        LastDurableTime = FPlatformTime::Seconds();
+
+        // Every drained row is formatted and written at this point; the durable point only
+        // moves after a complete flush, so a resume always cuts back to a whole line
+        if (bFlushed && !bWriteFailed)
+        {
+            FScopeLock Lock(&DurableLock);
+            DurableRows = RowsWritten.load(std::memory_order_relaxed);
+            DurableBytes = GoodCSVBytes;
+        }
+        else if (!bFlushed && !bWriteFailed)
+        {
+            PYRANO_WARN(TEXT("[ResultWriter] Flush failed on '%s'; durable point kept at %lld bytes."), *CSVPathAbs, DurableBytes);
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,185 @@
+/*=============================================================================
+    IrradianceResultWriter.h
+  Background writer for irradiance results (CSV and/or columnar binary).
+  The game thread only queues rows as plain values; a dedicated thread
+  formats them and appends them through file handles kept open for the run.
+/============================================================================*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "Containers/Queue.h"
+#include "Irradiance/IrradianceColumnarFile.h"
+#include "Simulation/IrradianceSH.h"
+#include <atomic>
+
+class FRunnableThread;
+class FEvent;
+class IFileHandle;
+
+/** One result row as plain values. Formatted on the writer thread. */
+struct FIrradianceResultRow
+{
+    // Time / ID (the name is declared once per sensor, see DeclareSensor)
+    FGuid       SensorId;
+    int64       TimestampTicks      = 0;
+
+    // Sensor
+    FVector3d   PosWS               = FVector3d::ZeroVector;
+    FVector3d   NormalWS            = FVector3d::UpVector;
+    int32       SidePx              = 0;
+    uint32      WarmupFrames        = 0;
+
+    // Solar Geometry
+    float       AzimuthDeg          = 0.f;
+    float       AltitudeDeg         = 0.f;
+    float       GeometricFactor     = 0.f;
+
+    // Clear-sky
+    double      ClearSkyGHI         = 0.0;
+    double      ClearSkyDNI         = 0.0;
+    double      ClearSkyDHI         = 0.0;
+
+    // Occlusion
+    int32       SunOccluded         = -1;
+    float       SunHitDistanceM     = -1.f;
+    float       SunVisibility       = 0.f;
+
+    // Sky View Factor
+    float       SkyViewFactor       = -1.f;
+
+    // Irradiance
+    float       IrrR                = 0.f;
+    float       IrrG                = 0.f;
+    float       IrrB                = 0.f;
+    float       IrrMean             = 0.f;
+    float       IrrDir              = 0.f;
+    float       TotalIrradiance     = 0.f;
+};
+
+
+/** SH projection of a capture, written to the sidecar CSV (see FIrradianceSH). */
+struct FIrradianceSHRow
+{
+    FGuid           SensorId;
+    int64           TimestampTicks      = 0;
+    FIrradianceSH   SH;
+};
+
+
+class FIrradianceResultWriter : public FRunnable
+{
+public:
+
+    /** Either path may be empty to skip that output. The SH sidecar is only created by the first SH row. */
+    FIrradianceResultWriter(const FString& InCSVPathAbs, const FString& InBinaryPathAbs, const FString& InSHPathAbs = FString());
+    virtual ~FIrradianceResultWriter() override;
+
+    /** Opens the files (CSV header written if empty) and starts the thread. False if no file could be opened. */
+    bool Start();
+
+    /** Before Start: cuts an existing CSV back to this size (resume after the last durable row). */
+    void SetResumeCSVBytes(int64 InBytes) { ResumeCSVBytes = InBytes; }
+
+    /** Writes everything still queued, flushes to disk, closes the files and joins the thread. */
+    void Shutdown();
+
+    /** Registers the name of a sensor; rows only carry its GUID. Must precede its first row. */
+    void DeclareSensor(const FGuid& SensorId, const FString& SensorName);
+
+    /** Queues a row. Lock-free, never touches the disk. */
+    void Enqueue(const FIrradianceResultRow& Row);
+
+    /**
+     * Queues the SH projection of a capture for the sidecar CSV. Same rules as Enqueue.
+     * The sidecar is append-only: a resumed run may repeat rows, the last one of a sensor / time wins.
+     */
+    void EnqueueSH(const FIrradianceSHRow& Row);
+
+    /** Durability point: everything queued so far gets written and flushed to disk. Non-blocking. */
+    void RequestFlush();
+
+    bool IsRunning() const { return Thread != nullptr; }
+    const FString& GetCSVPath() const { return CSVPathAbs; }
+    const FString& GetBinaryPath() const { return BinaryPathAbs; }
+    uint64 GetRowsWritten() const { return RowsWritten.load(std::memory_order_relaxed); }
+
+    /** Rows of this writer on disk for good, and the CSV size right after them. False before the first one. */
+    bool GetDurablePoint(uint64& OutRows, int64& OutCSVBytes) const;
+
+    // FRunnable
+    virtual uint32 Run() override;
+    virtual void Stop() override;
+
+private:
+
+    /** Sensor name, sent once per sensor. */
+    struct FSensorDecl
+    {
+        FGuid   SensorId;
+        FString SensorName;
+    };
+
+
+    /** Pops every queued row into the CSV buffer and the binary chunk. */
+    void DrainQueues();
+
+    /** Moves pending sensor declarations into the writer's table. */
+    void DrainSensorDecls();
+
+    /** Appends one formatted CSV line to WriteBuffer. */
+    void FormatRow(const FIrradianceResultRow& Row, uint32 SensorIndex);
+
+    /** Index of a sensor in the dictionary, added on first use. */
+    uint32 FindOrAddSensor(const FGuid& SensorId);
+
+    /** Writes WriteBuffer to the CSV; bDurable also flushes the OS buffers. */
+    void WriteBufferToDisk(bool bDurable);
+
+    /** Pops queued SH rows into SHWriteBuffer, opening the sidecar on the first one. */
+    void DrainSHQueue();
+
+    /** Writes SHWriteBuffer to the sidecar; bDurable also flushes the OS buffers. */
+    void WriteSHBufferToDisk(bool bDurable);
+
+    FString CSVPathAbs;
+    FString BinaryPathAbs;
+    FString SHPathAbs;
+
+    // --- Producer side ---
+    TQueue<FIrradianceResultRow, EQueueMode::Mpsc> RowQueue;
+    TQueue<FSensorDecl, EQueueMode::Mpsc>       SensorQueue;
+    TQueue<FIrradianceSHRow, EQueueMode::Mpsc>  SHQueue;
+    std::atomic<uint32>                         FlushRequests{ 0 };
+    std::atomic<bool>                           bStopRequested{ false };
+
+    // --- Writer thread ---
+    TUniquePtr<IFileHandle>             FileHandle;         // CSV
+    TUniquePtr<FIrradianceColumnarFile> Columnar;           // binary
+    TMap<FGuid, uint32>                 SensorIndices;
+    TArray<FIrradianceColumnarFile::FSensor> Sensors;       // dictionary (index = position)
+    TArray<FString>                     SensorGuidStrings;  // CSV column, per dictionary entry
+    TArray<uint8>                       WriteBuffer;
+    uint32                              FlushRequestsServed = 0;
+    double                              LastDurableTime = 0.0;
+    std::atomic<uint64>                 RowsWritten{ 0 };
+    bool                                bUnflushedWrites = false;
+    bool                                bWriteFailed = false;
+    int64                               ResumeCSVBytes = -1;
+    int64                               GoodCSVBytes = 0;   // CSV size after the last complete write
+
+    // SH sidecar (writer thread)
+    TUniquePtr<IFileHandle>             SHFileHandle;
+    TArray<uint8>                       SHWriteBuffer;
+    bool                                bSHUnflushedWrites = false;
+    bool                                bSHOpenFailed = false;
+
+    // Last durable point of the CSV (read by the game thread)
+    mutable FCriticalSection            DurableLock;
+    uint64                              DurableRows = 0;
+    int64                               DurableBytes = -1;
+
+    FRunnableThread*                    Thread = nullptr;
+    FEvent*                             WakeEvent = nullptr;
+};
@@ -10,6 +10,7 @@
 #include "RenderGraphUtils.h" // fwd
 #include "RenderGraphBuilder.h" // fwd
 #include "Logging/IrradianceLog.h"
+#include "Irradiance/IrradianceIntegrateCS.h"
 
 
 // -----------------------------------------------------------------------------
@@ -32,13 +33,20 @@ bool FIrradianceViewExtension::IsActiveThisFrame_Internal(const FSceneViewExtens
 //  Capture
 // -----------------------------------------------------------------------------
 
-void FIrradianceViewExtension::ArmSingleShot(uint32 InWarmupFrames, uint32 Res)
+void FIrradianceViewExtension::ArmSingleShot(uint32 InWarmupFrames, uint32 Res, int32 InAtlasSlice)
 {
 	ResolutionPx.store(Res);
+	AtlasSlice.store(InAtlasSlice);
 	FramesUntilCapture.store(InWarmupFrames); 
 }
 
 
+void FIrradianceViewExtension::SetFaceAtlasSlices(int32 NumSlices)
+{
+	FaceAtlasSlices.store(FMath::Max(0, NumSlices));
+}
+
+
 bool FIrradianceViewExtension::TryConsumeCapturedSceneRT(TRefCountPtr<IPooledRenderTarget>& OutRT, FIntPoint& OutSize)
 {
 	if (!CapturedSceneRT.IsValid())
@@ -104,6 +112,13 @@ void FIrradianceViewExtension::Capture(FRDGBuilder& GraphBuilder, const FSceneVi
 
 	PYRANO_VERBOSE(TEXT("[IrradianceVE] CAPTURE SHOT"));
 
+	const int32 Slice = AtlasSlice.load();
+	if (Slice >= 0)
+	{
+		CaptureToAtlas(GraphBuilder, SceneColor, Res, Slice);
+		return;
+	}
+
 	 // --- OUTPUT ---
 
 	// Output texture size
@@ -119,7 +134,8 @@ void FIrradianceViewExtension::Capture(FRDGBuilder& GraphBuilder, const FSceneVi
 	const FIntRect OutRect(FIntPoint(0, 0), OutSize);
 	FScreenPassViewInfo SPView(View);
 	AddClearRenderTargetPass(GraphBuilder, OutTex, FLinearColor(0, 0, 0, 1)); // avoid alpha channel = 0
-	AddDrawTexturePass(GraphBuilder, SPView, SceneColor.Texture, OutTex, OutRect);
+	// View rect -> output: a reduced screen percentage (grazing faces) renders exactly Res x Res
+	AddDrawTexturePass(GraphBuilder, SPView, SceneColor, FScreenPassRenderTarget(OutTex, OutRect, ERenderTargetLoadAction::ELoad));
 
 	// Callback has RDG_TASK_ASYNC flag, but readback = sync
 	// Solution --> extract persistent texture and read outside the callback
@@ -127,3 +143,36 @@ void FIrradianceViewExtension::Capture(FRDGBuilder& GraphBuilder, const FSceneVi
 	CapturedSceneSize = OutSize;
 	GraphBuilder.QueueTextureExtraction(OutTex, &CapturedSceneRT);
 }
+
+
+void FIrradianceViewExtension::CaptureToAtlas(FRDGBuilder& GraphBuilder, const FScreenPassTexture& SceneColor, uint32 Res, int32 Slice)
+{
+	const FIntPoint OutSize(Res, Res);
+	const int32 NumSlices = FMath::Max(FaceAtlasSlices.load(), Slice + 1);
+
+	// (Re)created on size change only: faces of the other slots stay in place
+	FRDGTextureRef AtlasTex = nullptr;
+	if (FaceAtlas.IsValid() && FaceAtlas->GetDesc().Extent == OutSize && FaceAtlas->GetDesc().ArraySize == NumSlices)
+	{
+		AtlasTex = GraphBuilder.RegisterExternalTexture(FaceAtlas, TEXT("Irr.FaceAtlas"));
+	}
+	else
+	{
+		FRDGTextureDesc AtlasDesc = FRDGTextureDesc::Create2DArray(
+			OutSize,
+			PF_FloatRGBA,
+			FClearValueBinding::None,
+			TexCreate_ShaderResource | TexCreate_UAV,
+			NumSlices);
+		AtlasTex = GraphBuilder.CreateTexture(AtlasDesc, TEXT("Irr.FaceAtlas"));
+		FaceAtlas = GraphBuilder.ConvertToExternalTexture(AtlasTex);
+
+		PYRANO_VERBOSE(TEXT("[IrradianceVE] Face atlas created (%dx%d, %d slices)"), Res, Res, NumSlices);
+	}
+
+	IrradianceCompute::AddFaceResolvePass(GraphBuilder, SceneColor.Texture, SceneColor.ViewRect, AtlasTex, Slice, Res);
+
+	// The consumer gets the whole atlas; the slice is known by whoever armed the capture
+	CapturedSceneSize = OutSize;
+	CapturedSceneRT = FaceAtlas;
+}
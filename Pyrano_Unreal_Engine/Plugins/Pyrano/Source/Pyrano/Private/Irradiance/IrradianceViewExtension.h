@@ -40,8 +40,15 @@ public:
 
 // --- Public API ---
 
-	/** Schedule a one-shot capture after a warmup period. */
-	void ArmSingleShot(uint32 InWarmupFrames, uint32 Res);
+	/**
+	 * Schedule a one-shot capture after a warmup period.
+	 * With InAtlasSlice >= 0 the face is resolved into that slice of the face atlas,
+	 * and the atlas is what TryConsumeCapturedSceneRT returns.
+	 */
+	void ArmSingleShot(uint32 InWarmupFrames, uint32 Res, int32 InAtlasSlice = INDEX_NONE);
+
+	/** Number of slices of the face atlas (6 per capture slot). The atlas is (re)created on the RT when needed. */
+	void SetFaceAtlasSlices(int32 NumSlices);
 
 	/** Retrieve the captured SceneColor RT if available (one-time consume). */
 	bool TryConsumeCapturedSceneRT(TRefCountPtr<IPooledRenderTarget>& OutRT, FIntPoint& OutSize);
@@ -62,6 +69,12 @@ private:
 	/** Desired capture resolution. */
 	std::atomic<uint32> ResolutionPx{ 1024 };
 
+	/** Face atlas slice of the armed capture, or INDEX_NONE for a standalone RT. */
+	std::atomic<int32> AtlasSlice{ INDEX_NONE };
+
+	/** Requested face atlas slices. */
+	std::atomic<int32> FaceAtlasSlices{ 0 };
+
 // --- Capture ---
 
 	/** Stored captured render target. */
@@ -70,8 +83,14 @@ private:
 	/** Resolution of CapturedSceneRT. */
 	FIntPoint CapturedSceneSize = FIntPoint::ZeroValue;
 
+	/** Persistent face atlas (RT only). Captures still reading an older atlas keep it alive. */
+	TRefCountPtr<IPooledRenderTarget> FaceAtlas;
+
 	/** Copy SceneColor into CapturedSceneRT at the given resolution. */
 	void Capture(FRDGBuilder& GraphBuilder, const FSceneView& View, const FPostProcessMaterialInputs& Inputs, uint32 Res);
+
+	/** Resolve SceneColor straight into a slice of the face atlas (no intermediate RT). */
+	void CaptureToAtlas(FRDGBuilder& GraphBuilder, const FScreenPassTexture& SceneColor, uint32 Res, int32 Slice);
 };
 
 
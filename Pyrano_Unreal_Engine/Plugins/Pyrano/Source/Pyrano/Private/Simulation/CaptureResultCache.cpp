@@ -0,0 +1,199 @@
+﻿// CaptureResultCache.cpp
+
+#include "Simulation/CaptureResultCache.h"
+#include "Engine/Level.h"
+#include "Engine/World.h"
+#include "Irradiance/IrradianceCommon.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "Misc/StringBuilder.h"
+#include "Logging/IrradianceLog.h"
+
+namespace
+{
+    const TCHAR* CacheHeader = TEXT("# pyrano-capture-cache v1");
+}
+
+
+FString FCaptureResultCache::GetDefaultPath()
+{
+    return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Pyrano"), TEXT("CaptureResultCache.csv"));
+}
+
+
+FString FCaptureResultCache::MakeSceneHash(const UWorld* World)
+{
+    if (!World)
+        return FString();
+
+    // Sorted, so the streaming order of the levels does not matter
+    TArray<FString> LevelHashes;
+    for (const ULevel* Level : World->GetLevels())
+    {
+        if (!Level)
+            continue;
+
+        const FString PackageName = UWorld::RemovePIEPrefix(Level->GetOutermost()->GetName());
+        FString FileName;
+        if (!FPackageName::DoesPackageExist(PackageName, &FileName))
+        {
+            // Never saved: nothing stable to key on
+            LevelHashes.Add(PackageName + TEXT("=unsaved"));
+            continue;
+        }
+        LevelHashes.Add(PackageName + TEXT("=") + LexToString(FMD5Hash::HashFile(*FileName)));
+    }
+    LevelHashes.Sort();
+
+    const FString Joined = FString::Join(LevelHashes, TEXT("|"));
+    FSHAHash Hash;
+    FSHA1::HashBuffer(*Joined, Joined.Len() * sizeof(TCHAR), Hash.Hash);
+    return Hash.ToString();
+}
+
+
+FSHAHash FCaptureResultCache::MakeKey(const FString& SceneHash, const FString& RenderKey, const FCaptureRequest& Req, const FCaptureSunState& Sun)
+{
+    // Rounded like the values they come from (sensor placement, ephemeris), so equal setups hit
+    TStringBuilder<512> Key;
+    Key.Appendf(TEXT("%s|%s|%.2f,%.2f,%.2f|%.5f,%.5f,%.5f|%d|%u|%.5f,%.5f,%.5f|%.3f"),
+        *SceneHash, *RenderKey,
+        Req.PosWS.X, Req.PosWS.Y, Req.PosWS.Z,
+        Req.NormalWS.X, Req.NormalWS.Y, Req.NormalWS.Z,
+        Req.SidePx, Req.WarmupFrames,
+        Sun.ToSunDir.X, Sun.ToSunDir.Y, Sun.ToSunDir.Z,
+        (double)Sun.IlluminanceLux);
+
+    FSHAHash Hash;
+    FSHA1::HashBuffer(Key.ToString(), Key.Len() * sizeof(TCHAR), Hash.Hash);
+    return Hash;
+}
+
+
+bool FCaptureResultCache::Load(const FString& Path)
+{
+    Entries.Reset();
+    bDirty = false;
+
+    TArray<FString> Lines;
+    if (!FFileHelper::LoadFileToStringArray(Lines, *Path) || Lines.Num() == 0 || Lines[0] != CacheHeader)
+        return false;
+
+    // Key,R,G,B,M,LastUsedTicks
+    Entries.Reserve(Lines.Num() - 1);
+    for (int32 i = 1; i < Lines.Num(); ++i)
+    {
+        TArray<FString> Cols;
+        Lines[i].ParseIntoArray(Cols, TEXT(","), /*CullEmpty*/ true);
+        if (Cols.Num() != 6)
+            continue;
+
+        FSHAHash Key;
+        Key.FromString(Cols[0]);
+
+        FEntry E;
+        E.RawRGBM = FVector4f(FCString::Atof(*Cols[1]), FCString::Atof(*Cols[2]), FCString::Atof(*Cols[3]), FCString::Atof(*Cols[4]));
+        E.LastUsedTicks = FCString::Atoi64(*Cols[5]);
+        Entries.Add(Key, E);
+    }
+
+    PYRANO_VERBOSE(TEXT("[CaptureCache] Loaded: %d entries"), Entries.Num());
+    return true;
+}
+
+
+bool FCaptureResultCache::Save(const FString& Path)
+{
+    Evict();
+
+    TArray<FString> Lines;
+    Lines.Reserve(Entries.Num() + 1);
+    Lines.Add(CacheHeader);
+
+    // %.9g: floats read back bit-exact
+    for (const TPair<FSHAHash, FEntry>& It : Entries)
+    {
+        const FEntry& E = It.Value;
+        Lines.Add(FString::Printf(TEXT("%s,%.9g,%.9g,%.9g,%.9g,%lld"),
+            *It.Key.ToString(),
+            (double)E.RawRGBM.X, (double)E.RawRGBM.Y, (double)E.RawRGBM.Z, (double)E.RawRGBM.W,
+            E.LastUsedTicks));
+    }
+
+    if (!FFileHelper::SaveStringArrayToFile(Lines, *Path))
+    {
+        PYRANO_WARN(TEXT("[CaptureCache] Could not write cache: %s"), *Path);
+        return false;
+    }
+
+    bDirty = false;
+    return true;
+}
+
+
+bool FCaptureResultCache::Find(const FSHAHash& Key, FVector4f& OutRawRGBM)
+{
+    FEntry* E = Entries.Find(Key);
+    if (!E)
+    {
+        ++Stats.Misses;
+        return false;
+    }
+
+    ++Stats.Hits;
+    E->LastUsedTicks = FDateTime::UtcNow().GetTicks();
+    OutRawRGBM = E->RawRGBM;
+    bDirty = true;
+    return true;
+}
+
+
+void FCaptureResultCache::Store(const FSHAHash& Key, const FVector4f& RawRGBM)
+{
+    FEntry& E = Entries.FindOrAdd(Key);
+    E.RawRGBM = RawRGBM;
+    E.LastUsedTicks = FDateTime::UtcNow().GetTicks();
+    ++Stats.Stored;
+    bDirty = true;
+}
+
+
+int32 FCaptureResultCache::Evict()
+{
+    const int32 Before = Entries.Num();
+
+    const int64 MinTicks = (FDateTime::UtcNow() - FTimespan::FromDays(IrradianceCommon::Defaults::CaptureCacheMaxAgeDays)).GetTicks();
+    for (auto It = Entries.CreateIterator(); It; ++It)
+    {
+        if (It.Value().LastUsedTicks < MinTicks)
+        {
+            It.RemoveCurrent();
+        }
+    }
+
+    if (Entries.Num() > IrradianceCommon::Defaults::CaptureCacheMaxEntries)
+    {
+        // Most recently used first, the tail goes
+        Entries.ValueSort([](const FEntry& A, const FEntry& B) { return A.LastUsedTicks > B.LastUsedTicks; });
+
+        int32 Index = 0;
+        for (auto It = Entries.CreateIterator(); It; ++It)
+        {
+            if (Index++ >= IrradianceCommon::Defaults::CaptureCacheMaxEntries)
+            {
+                It.RemoveCurrent();
+            }
+        }
+        Entries.Compact();
+    }
+
+    const int32 Evicted = Before - Entries.Num();
+    if (Evicted > 0)
+    {
+        Stats.Evicted += Evicted;
+        bDirty = true;
+        PYRANO_VERBOSE(TEXT("[CaptureCache] Evicted %d entries (%d left)"), Evicted, Entries.Num());
+    }
+    return Evicted;
+}
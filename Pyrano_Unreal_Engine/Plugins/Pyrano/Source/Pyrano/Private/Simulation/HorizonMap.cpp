@@ -0,0 +1,156 @@
+﻿// HorizonMap.cpp
+
+#include "Simulation/HorizonMap.h"
+#include "Async/ParallelFor.h"
+#include "Irradiance/IrradianceCommon.h"
+
+// -----------------------------------------------------------------------------
+//  Build
+// -----------------------------------------------------------------------------
+
+FSensorHorizonMapPtr FSensorHorizonMap::Build(
+    const FVector& InPosWS,
+    const FVector& InNormalWS,
+    TFunctionRef<float(const FVector& DirWS)> TraceHitDistanceM)
+{
+    TSharedRef<FSensorHorizonMap, ESPMode::ThreadSafe> Map = MakeShared<FSensorHorizonMap, ESPMode::ThreadSafe>();
+
+    Map->PosWS          = InPosWS;
+    Map->NormalWS       = InNormalWS.GetSafeNormal();
+    Map->AzimuthBins    = IrradianceCommon::Defaults::HorizonAzimuthBins;
+    Map->MaskMinDeg     = IrradianceCommon::Defaults::HorizonMaskMinDeg;
+    Map->MaskMaxDeg     = IrradianceCommon::Defaults::HorizonMaskMaxDeg;
+    Map->MaskStepDeg    = IrradianceCommon::Defaults::HorizonMaskStepDeg;
+    Map->ProfileStepDeg = IrradianceCommon::Defaults::HorizonProfileStepDeg;
+    Map->MaskRows       = FMath::FloorToInt((Map->MaskMaxDeg - Map->MaskMinDeg) / Map->MaskStepDeg) + 1;
+
+    // Coarse rows above the mask, up to the zenith
+    const int32 ProfileRows = FMath::FloorToInt((90.f - Map->MaskMaxDeg) / Map->ProfileStepDeg);
+
+    Map->MaskHitDistanceM.SetNumUninitialized(Map->AzimuthBins * Map->MaskRows);
+    Map->HorizonElevationDeg.SetNumUninitialized(Map->AzimuthBins);
+    Map->HorizonHitDistanceM.SetNumUninitialized(Map->AzimuthBins);
+
+    // One azimuth column per task; every cell is written by exactly one task
+    FSensorHorizonMap& M = Map.Get();
+    ParallelFor(M.AzimuthBins, [&M, ProfileRows, &TraceHitDistanceM](int32 AzBin)
+    {
+        const double AzDeg = (AzBin + 0.5) * 360.0 / M.AzimuthBins;
+
+        float TopDeg = -90.f;
+        float TopDistM = -1.f;
+
+        for (int32 Row = 0; Row < M.MaskRows; ++Row)
+        {
+            const float ElDeg = M.MaskMinDeg + Row * M.MaskStepDeg;
+            const float DistM = TraceHitDistanceM(DirectionFromAzEl(AzDeg, ElDeg));
+
+            M.MaskHitDistanceM[AzBin * M.MaskRows + Row] = DistM;
+            if (DistM >= 0.f)
+            {
+                TopDeg = ElDeg;
+                TopDistM = DistM;
+            }
+        }
+
+        for (int32 Row = 1; Row <= ProfileRows; ++Row)
+        {
+            const float ElDeg = M.MaskMaxDeg + Row * M.ProfileStepDeg;
+            const float DistM = TraceHitDistanceM(DirectionFromAzEl(AzDeg, ElDeg));
+            if (DistM >= 0.f)
+            {
+                TopDeg = ElDeg;
+                TopDistM = DistM;
+            }
+        }
+
+        M.HorizonElevationDeg[AzBin] = TopDeg;
+        M.HorizonHitDistanceM[AzBin] = TopDistM;
+    });
+
+    return Map;
+}
+
+
+FVector FSensorHorizonMap::DirectionFromAzEl(double AzDeg, double ElDeg)
+{
+    const double Az = FMath::DegreesToRadians(AzDeg);
+    const double El = FMath::DegreesToRadians(ElDeg);
+    const double CosEl = FMath::Cos(El);
+
+    return FVector(CosEl * FMath::Cos(Az), CosEl * FMath::Sin(Az), FMath::Sin(El));
+}
+
+
+// -----------------------------------------------------------------------------
+//  Lookup
+// -----------------------------------------------------------------------------
+
+bool FSensorHorizonMap::MatchesPose(const FVector& InPosWS, const FVector& InNormalWS) const
+{
+    return IsBuilt()
+        && PosWS.Equals(InPosWS, 1.0)                       // 1 cm
+        && NormalWS.Equals(InNormalWS.GetSafeNormal(), 1e-3);
+}
+
+
+float FSensorHorizonMap::LookupHitDistanceM(const FVector& DirWS) const
+{
+    const FVector D = DirWS.GetSafeNormal();
+    if (!IsBuilt() || D.IsNearlyZero())
+        return -1.f;
+
+    const double ElDeg = FMath::RadiansToDegrees(FMath::Asin(FMath::Clamp(D.Z, -1.0, 1.0)));
+    double AzDeg = FMath::RadiansToDegrees(FMath::Atan2(D.Y, D.X));
+    if (AzDeg < 0.0)
+    {
+        AzDeg += 360.0;
+    }
+
+    const int32 AzBin = FMath::Clamp(FMath::FloorToInt(AzDeg / 360.0 * AzimuthBins), 0, AzimuthBins - 1);
+
+    // Below the mapped band: ground
+    if (ElDeg < MaskMinDeg - 0.5 * MaskStepDeg)
+        return 0.f;
+
+    // Fine band: nearest row
+    const int32 Row = FMath::RoundToInt((ElDeg - MaskMinDeg) / MaskStepDeg);
+    if (Row < MaskRows)
+    {
+        return MaskHitDistanceM[AzBin * MaskRows + Row];
+    }
+
+    // Above the band: skyline profile
+    return ElDeg > HorizonElevationDeg[AzBin] ? -1.f : HorizonHitDistanceM[AzBin];
+}
+
+
+float FSensorHorizonMap::SunVisibility(const FVector& ToSunDir, int32 NumSamples, int32 Seed) const
+{
+    if (NumSamples <= 0 || ToSunDir.IsNearlyZero())
+        return 0.0f;
+
+    // Same cone and seed as the traced version, so both paths agree
+    const float ConeAngleRad = FMath::DegreesToRadians(0.5f);
+    const FQuat Rot = FQuat::FindBetweenNormals(FVector::UpVector, ToSunDir);
+    FRandomStream RNG(Seed);
+
+    int32 ClearCount = 0;
+    for (int32 i = 0; i < NumSamples; ++i)
+    {
+        const float U = RNG.GetFraction();
+        const float V = RNG.GetFraction();
+
+        const float Theta = 2.0f * PI * U;
+        const float CosPhi = 1.0f - V * (1.0f - FMath::Cos(ConeAngleRad));
+        const float SinPhi = FMath::Sqrt(1.0f - CosPhi * CosPhi);
+
+        const FVector LocalDir(SinPhi * FMath::Cos(Theta), SinPhi * FMath::Sin(Theta), CosPhi);
+        if (!IsOccluded(Rot.RotateVector(LocalDir)))
+        {
+            ClearCount++;
+        }
+    }
+
+    return float(ClearCount) / float(NumSamples);
+}
\ No newline at end of file
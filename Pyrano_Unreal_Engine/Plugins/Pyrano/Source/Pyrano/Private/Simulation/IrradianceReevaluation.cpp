@@ -0,0 +1,497 @@
+﻿// IrradianceReevaluation.cpp
+
+#include "Simulation/IrradianceReevaluation.h"
+#include "Irradiance/IrradianceResultWriter.h"
+#include "Async/ParallelFor.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/PlatformProcess.h"
+#include "Misc/Paths.h"
+#include "Logging/IrradianceLog.h"
+#include <atomic>
+
+namespace
+{
+    /** Columns of the exported CSV, in file order (see the header of IrradianceResultWriter.cpp). */
+    enum EColumn : int32
+    {
+        SensorNameCol, SensorGuidCol, UTCCol,
+        PosXCol, PosYCol, PosZCol,
+        NormalXCol, NormalYCol, NormalZCol,
+        SidePxCol, WarmupCol,
+        AzimuthCol, AltitudeCol, GeometricCol,
+        ClearSkyGHICol, ClearSkyDNICol, ClearSkyDHICol,
+        SunOccludedCol, SunHitDistanceCol, SunVisibilityCol,
+        SkyViewFactorCol,
+        RawRCol, RawGCol, RawBCol, RawMeanCol,
+        DirectCol,
+        TotalCol,
+        NumColumns
+    };
+
+    const TCHAR* ColumnNames[NumColumns] =
+    {
+        TEXT("sensor_name"), TEXT("sensor_guid"), TEXT("utc"),
+        TEXT("pos_x"), TEXT("pos_y"), TEXT("pos_z"),
+        TEXT("n_x"), TEXT("n_y"), TEXT("n_z"),
+        TEXT("side_px"), TEXT("warmup"),
+        TEXT("azimuth_deg"), TEXT("altitude_deg"), TEXT("geometric_factor"),
+        TEXT("clearsky_ghi_wm2"), TEXT("clearsky_dni_wm2"), TEXT("clearsky_dhi_wm2"),
+        TEXT("sun_occluded"), TEXT("sun_hit_distance_m"), TEXT("sun_visibility"),
+        TEXT("sky_view_factor"),
+        TEXT("raw_r_lux"), TEXT("raw_g_lux"), TEXT("raw_b_lux"), TEXT("sim_comp_amb_lux"),
+        TEXT("sim_comp_direct_lux"),
+        TEXT("irr_final_normalized_wm2"),
+    };
+
+    /** Bytes of the input read per step; a step ends on a line end, the rest carries over. */
+    constexpr int64 ReadBlockBytes = 32 * 1024 * 1024;
+
+    /** Bytes of a step parsed / evaluated per parallel task (also cut on line ends). */
+    constexpr int32 TaskBytes = 1024 * 1024;
+
+    /** Longest header line accepted. */
+    constexpr int32 MaxHeaderBytes = 64 * 1024;
+
+    /** Rows the writer thread may lag behind before the producer waits (bounds the queue memory). */
+    constexpr int64 MaxQueuedRows = 256 * 1024;
+
+    /**
+     * Inputs and outputs of the evaluation kernel, one array per column.
+     * Everything else of a row is passed through unchanged.
+     */
+    struct FKernelColumns
+    {
+        TArray<float> Azimuth;
+        TArray<float> Altitude;
+        TArray<float> RawMean;
+        TArray<float> Direct;
+        TArray<float> Geometric;
+        TArray<float> Visibility;
+        TArray<float> Total;
+
+        void SetNum(int32 Num)
+        {
+            Azimuth.SetNumZeroed(Num);
+            Altitude.SetNumZeroed(Num);
+            RawMean.SetNumZeroed(Num);
+            Direct.SetNumZeroed(Num);
+            Geometric.SetNumZeroed(Num);
+            Visibility.SetNumZeroed(Num);
+            Total.SetNumZeroed(Num);
+        }
+    };
+
+    /** Rows of one parallel task of a read step, in file order. */
+    struct FTaskRows
+    {
+        TArray<FIrradianceResultRow> Rows;
+        FKernelColumns K;
+        TArray<TPair<FGuid, FString>> Sensors;     // in order of appearance
+        int32 BadRows = 0;
+        int32 RowsCutOff = 0;
+        int32 ClearSkyEvaluations = 0;
+    };
+
+    bool CheckHeader(FStringView Line)
+    {
+        int32 Col = 0;
+        while (Col < NumColumns)
+        {
+            int32 Comma = INDEX_NONE;
+            const FStringView Field = Line.FindChar(TEXT(','), Comma) ? Line.Left(Comma) : Line;
+            if (!Field.TrimEnd().Equals(ColumnNames[Col]))
+                return false;
+
+            ++Col;
+            if (Comma == INDEX_NONE)
+                break;
+            Line.RightChopInline(Comma + 1);
+        }
+        return Col == NumColumns;
+    }
+
+    /**
+     * Splits one line into its fields. Sensor names are written verbatim and may contain commas:
+     * the other columns are located from the end (as the shard merge does). False if fields are missing.
+     */
+    bool SplitFields(FStringView Line, FStringView (&OutFields)[NumColumns])
+    {
+        TArray<FStringView, TInlineAllocator<NumColumns + 8>> Split;
+        for (;;)
+        {
+            int32 Comma = INDEX_NONE;
+            if (!Line.FindChar(TEXT(','), Comma))
+            {
+                Split.Add(Line);
+                break;
+            }
+            Split.Add(Line.Left(Comma));
+            Line.RightChopInline(Comma + 1);
+        }
+
+        if (Split.Num() < NumColumns)
+            return false;
+
+        // Extra fields belong to the name: it spans from the line start to the end of its last part
+        const int32 Offset = Split.Num() - NumColumns;
+        const FStringView& NameEnd = Split[Offset];
+        OutFields[SensorNameCol] = FStringView(Split[0].GetData(), (int32)(NameEnd.GetData() - Split[0].GetData()) + NameEnd.Len());
+        for (int32 Col = SensorNameCol + 1; Col < NumColumns; ++Col)
+        {
+            OutFields[Col] = Split[Col + Offset];
+        }
+        return true;
+    }
+
+    /** Fields stop at the next comma: the numeric parsers read in place. */
+    double ToDouble(FStringView Field) { return FCString::Atod(Field.GetData()); }
+    int32 ToInt(FStringView Field) { return FCString::Atoi(Field.GetData()); }
+
+    /** Parses a data line into the pass-through row and the kernel columns. */
+    bool ParseRow(FStringView Line, FIrradianceResultRow& Row, FKernelColumns& K, int32 Index, FString& OutName)
+    {
+        FStringView F[NumColumns];
+        if (!SplitFields(Line, F))
+            return false;
+
+        FDateTime UTC;
+        if (!FGuid::Parse(FString(F[SensorGuidCol]), Row.SensorId) || !FDateTime::ParseIso8601(*FString(F[UTCCol]), UTC))
+            return false;
+
+        OutName = FString(F[SensorNameCol]);
+        Row.TimestampTicks = UTC.GetTicks();
+
+        Row.PosWS = FVector3d(ToDouble(F[PosXCol]), ToDouble(F[PosYCol]), ToDouble(F[PosZCol]));
+        Row.NormalWS = FVector3d(ToDouble(F[NormalXCol]), ToDouble(F[NormalYCol]), ToDouble(F[NormalZCol]));
+        Row.SidePx = ToInt(F[SidePxCol]);
+        Row.WarmupFrames = (uint32)ToInt(F[WarmupCol]);
+
+        Row.AzimuthDeg = (float)ToDouble(F[AzimuthCol]);
+        Row.AltitudeDeg = (float)ToDouble(F[AltitudeCol]);
+
+        Row.SunOccluded = ToInt(F[SunOccludedCol]);
+        Row.SunHitDistanceM = (float)ToDouble(F[SunHitDistanceCol]);
+        Row.SkyViewFactor = (float)ToDouble(F[SkyViewFactorCol]);
+
+        Row.IrrR = (float)ToDouble(F[RawRCol]);
+        Row.IrrG = (float)ToDouble(F[RawGCol]);
+        Row.IrrB = (float)ToDouble(F[RawBCol]);
+
+        K.Azimuth[Index] = Row.AzimuthDeg;
+        K.Altitude[Index] = Row.AltitudeDeg;
+        K.RawMean[Index] = (float)ToDouble(F[RawMeanCol]);
+        K.Direct[Index] = (float)ToDouble(F[DirectCol]);
+        K.Geometric[Index] = (float)ToDouble(F[GeometricCol]);
+        K.Visibility[Index] = (float)ToDouble(F[SunVisibilityCol]);
+        return true;
+    }
+
+    /** Parses the whole lines of Bytes (UTF-8) into Out. */
+    void ParseTask(const uint8* Bytes, int32 Len, FTaskRows& Out)
+    {
+        const FUTF8ToTCHAR Text(reinterpret_cast<const ANSICHAR*>(Bytes), Len);
+        const FStringView All(Text.Get(), Text.Length());
+
+        int32 NumLines = 0;
+        for (const TCHAR C : All)
+        {
+            NumLines += C == TEXT('\n') ? 1 : 0;
+        }
+        Out.Rows.SetNum(NumLines + 1);
+        Out.K.SetNum(NumLines + 1);
+
+        int32 NumRows = 0;
+        FGuid LastSensor;
+        FString Name;
+        int32 Begin = 0;
+        for (int32 i = 0; i <= All.Len(); ++i)
+        {
+            if (i < All.Len() && All[i] != TEXT('\n'))
+                continue;
+
+            const FStringView Line = All.Mid(Begin, i - Begin).TrimEnd();
+            Begin = i + 1;
+            if (Line.IsEmpty())
+                continue;
+
+            FIrradianceResultRow& Row = Out.Rows[NumRows];
+            if (!ParseRow(Line, Row, Out.K, NumRows, Name))
+            {
+                ++Out.BadRows;
+                continue;
+            }
+            ++NumRows;
+
+            if (Row.SensorId != LastSensor)
+            {
+                LastSensor = Row.SensorId;
+                if (!Out.Sensors.ContainsByPredicate([&LastSensor](const TPair<FGuid, FString>& S) { return S.Key == LastSensor; }))
+                {
+                    Out.Sensors.Emplace(LastSensor, Name);
+                }
+            }
+        }
+
+        Out.Rows.SetNum(NumRows);
+        Out.K.SetNum(NumRows);
+    }
+
+    /** Same post-processing as UIrradianceSubsystem::ComputePostProcess, over the task's column arrays. */
+    void EvaluateTask(FTaskRows& Task, const FIrradianceReevaluationOptions& Options)
+    {
+        const FIrradianceNormalization Norm = Options.Normalization;
+        const float MinAltitude = Options.MinSunAltitudeDeg;
+        const int32 Num = Task.Rows.Num();
+
+        // Branch-free so the compiler can vectorize it
+        const float* RESTRICT Azimuth = Task.K.Azimuth.GetData();
+        const float* RESTRICT Altitude = Task.K.Altitude.GetData();
+        const float* RESTRICT RawMean = Task.K.RawMean.GetData();
+        float* RESTRICT Direct = Task.K.Direct.GetData();
+        float* RESTRICT Geometric = Task.K.Geometric.GetData();
+        float* RESTRICT Visibility = Task.K.Visibility.GetData();
+        float* RESTRICT Total = Task.K.Total.GetData();
+
+        int32 CutOff = 0;
+        for (int32 i = 0; i < Num; ++i)
+        {
+            // Rows without a sun state are exported with zero angles: no cutoff, no normalization
+            const bool bSunValid = Azimuth[i] != 0.f || Altitude[i] != 0.f;
+            const float Above = (!bSunValid || Altitude[i] > MinAltitude) ? 1.f : 0.f;
+            const float DirectLux = Direct[i] * Above;
+            const float AmbientLux = RawMean[i] * Norm.AmbientIrradianceScale * Above;
+
+            Direct[i] = DirectLux;
+            Geometric[i] *= Above;
+            Visibility[i] *= Above;
+            Total[i] = bSunValid ? Norm.Apply(DirectLux, AmbientLux) : RawMean[i];
+            CutOff += Above == 0.f ? 1 : 0;
+        }
+        Task.RowsCutOff = CutOff;
+
+        // Clear-sky reference: rows of a time slot are contiguous and share it
+        int64 LastTicks = -1;
+        FPyranoClearSkyIrradiance ClearSky;
+        for (FIrradianceResultRow& Row : Task.Rows)
+        {
+            if (Row.TimestampTicks != LastTicks)
+            {
+                LastTicks = Row.TimestampTicks;
+                ClearSky = FPyranoClearSkyIrradiance();
+
+                const float AltDegPhys = FMath::Clamp(Row.AltitudeDeg, -90.0f, 90.0f);
+                if (Options.bClearSky && AltDegPhys > 0.0f)
+                {
+                    const double SolarZenithRad = FMath::DegreesToRadians(90.0 - static_cast<double>(AltDegPhys));
+                    ClearSky = UClearSkyService::ComputeWithConfig(Options.ClearSkyConfig, FDateTime(LastTicks), SolarZenithRad);
+                    ++Task.ClearSkyEvaluations;
+                }
+            }
+            Row.ClearSkyGHI = ClearSky.GHI_Wm2;
+            Row.ClearSkyDNI = ClearSky.DNI_Wm2;
+            Row.ClearSkyDHI = ClearSky.DHI_Wm2;
+        }
+    }
+}
+
+
+// -----------------------------------------------------------------------------
+//  Options
+// -----------------------------------------------------------------------------
+
+FIrradianceReevaluationOptions FIrradianceReevaluationOptions::FromSimConfig(const FSimConfig& Sim)
+{
+    FIrradianceReevaluationOptions Options;
+    Options.Normalization = Sim.Normalization;
+    Options.MinSunAltitudeDeg = Sim.MinSunAltitudeDeg;
+    Options.ClearSkyConfig.LinkeTurbidity = Sim.LinkeTurbidity;
+    Options.ClearSkyConfig.AltitudeMeters = Sim.AltitudeMeters;
+    Options.bExportBinary = Sim.bExportBinary;
+    return Options;
+}
+
+
+// -----------------------------------------------------------------------------
+//  Re-evaluation
+// -----------------------------------------------------------------------------
+
+bool PyranoReevaluation::ReevaluateCSV(const FString& InCSVPath, const FString& OutCSVPath,
+    const FIrradianceReevaluationOptions& Options, FIrradianceReevaluationReport& OutReport)
+{
+    OutReport = FIrradianceReevaluationReport();
+
+    if (FPaths::IsSamePath(InCSVPath, OutCSVPath))
+    {
+        OutReport.Errors.Add(TEXT("The output must not overwrite the input CSV"));
+        return false;
+    }
+    if (!Options.Normalization.IsValid())
+    {
+        OutReport.Errors.Add(TEXT("Normalization coefficients are not finite"));
+        return false;
+    }
+
+    TUniquePtr<IFileHandle> In(FPlatformFileManager::Get().GetPlatformFile().OpenRead(*InCSVPath));
+    if (!In)
+    {
+        OutReport.Errors.Add(FString::Printf(TEXT("Cannot read '%s'"), *InCSVPath));
+        return false;
+    }
+    const int64 FileSize = In->Size();
+
+    // --- Header ---
+    int64 DataOffset = 0;
+    {
+        TArray<uint8> Head;
+        Head.SetNumUninitialized((int32)FMath::Clamp<int64>(FileSize, 0, MaxHeaderBytes));
+        const int32 LineEnd = In->Read(Head.GetData(), Head.Num()) ? Head.Find((uint8)'\n') : INDEX_NONE;
+        const int32 Skip = (Head.Num() >= 3 && Head[0] == 0xEF && Head[1] == 0xBB && Head[2] == 0xBF) ? 3 : 0;
+
+        const FUTF8ToTCHAR Header(reinterpret_cast<const ANSICHAR*>(Head.GetData() + Skip), FMath::Max(0, LineEnd - Skip));
+        if (LineEnd == INDEX_NONE || !CheckHeader(FStringView(Header.Get(), Header.Length()).TrimEnd()))
+        {
+            OutReport.Errors.Add(FString::Printf(TEXT("'%s' is not an irradiance CSV (unexpected header)"), *InCSVPath));
+            return false;
+        }
+
+        DataOffset = LineEnd + 1;
+        In->Seek(DataOffset);
+    }
+
+    // --- Output (same format as a simulation export) ---
+    const FString BinaryPath = Options.bExportBinary ? FPaths::ChangeExtension(OutCSVPath, TEXT(".pyrb")) : FString();
+    IFileManager::Get().Delete(*OutCSVPath, false, true, true);   // the writer appends
+
+    FIrradianceResultWriter Writer(OutCSVPath, BinaryPath);
+    if (!Writer.Start())
+    {
+        OutReport.Errors.Add(FString::Printf(TEXT("Cannot write '%s'"), *OutCSVPath));
+        return false;
+    }
+
+    // --- Steps: read a block of whole lines, parse and evaluate it in parallel tasks, queue its rows ---
+    TSet<FGuid> DeclaredSensors;
+    TArray<uint8> Buffer;       // lines of the current step, after the partial line carried from the previous one
+    TArray<FTaskRows> Tasks;
+    TArray<int32> TaskBegin;
+    int64 Enqueued = 0;
+
+    for (int64 Offset = DataOffset; Offset < FileSize || Buffer.Num() > 0; )
+    {
+        double StartTime = FPlatformTime::Seconds();
+
+        const int64 ToRead = FMath::Min(ReadBlockBytes, FileSize - Offset);
+        const int32 Carried = Buffer.Num();
+        Buffer.SetNumUninitialized(Carried + (int32)ToRead, EAllowShrinking::No);
+        if (ToRead > 0 && !In->Read(Buffer.GetData() + Carried, ToRead))
+        {
+            OutReport.Errors.Add(FString::Printf(TEXT("Cannot read '%s' at %lld"), *InCSVPath, Offset));
+            Writer.Shutdown();
+            return false;
+        }
+        Offset += ToRead;
+
+        // Whole lines only: the tail goes with the next step
+        int32 StepLen = Buffer.Num();
+        if (Offset < FileSize)
+        {
+            while (StepLen > 0 && Buffer[StepLen - 1] != '\n')
+            {
+                --StepLen;
+            }
+            if (StepLen == 0)
+                continue;   // a line longer than a block: read on
+        }
+
+        // Task ranges, each ending on a line end
+        TaskBegin.Reset();
+        for (int32 Pos = 0; Pos < StepLen; )
+        {
+            TaskBegin.Add(Pos);
+            Pos = FMath::Min(StepLen, Pos + TaskBytes);
+            while (Pos < StepLen && Buffer[Pos - 1] != '\n')
+            {
+                ++Pos;
+            }
+        }
+        TaskBegin.Add(StepLen);
+
+        const int32 NumTasks = TaskBegin.Num() - 1;
+        Tasks.Reset();
+        Tasks.SetNum(NumTasks);
+
+        ParallelFor(NumTasks, [&](int32 t)
+        {
+            ParseTask(Buffer.GetData() + TaskBegin[t], TaskBegin[t + 1] - TaskBegin[t], Tasks[t]);
+        });
+        Buffer.RemoveAt(0, StepLen, EAllowShrinking::No);
+
+        OutReport.ParseSeconds += FPlatformTime::Seconds() - StartTime;
+        StartTime = FPlatformTime::Seconds();
+
+        ParallelFor(NumTasks, [&](int32 t)
+        {
+            EvaluateTask(Tasks[t], Options);
+        });
+
+        OutReport.ComputeSeconds += FPlatformTime::Seconds() - StartTime;
+        StartTime = FPlatformTime::Seconds();
+
+        for (FTaskRows& Task : Tasks)
+        {
+            OutReport.Rows += Task.Rows.Num();
+            OutReport.BadRows += Task.BadRows;
+            OutReport.RowsCutOff += Task.RowsCutOff;
+            OutReport.ClearSkyEvaluations += Task.ClearSkyEvaluations;
+
+            // A sensor is declared before its first row
+            for (const TPair<FGuid, FString>& Sensor : Task.Sensors)
+            {
+                if (!DeclaredSensors.Contains(Sensor.Key))
+                {
+                    DeclaredSensors.Add(Sensor.Key);
+                    Writer.DeclareSensor(Sensor.Key, Sensor.Value);
+                }
+            }
+
+            for (int32 i = 0; i < Task.Rows.Num(); ++i)
+            {
+                FIrradianceResultRow& Row = Task.Rows[i];
+                Row.GeometricFactor = Task.K.Geometric[i];
+                Row.SunVisibility = Task.K.Visibility[i];
+                Row.IrrMean = Task.K.RawMean[i];
+                Row.IrrDir = Task.K.Direct[i];
+                Row.TotalIrradiance = Task.K.Total[i];
+                Writer.Enqueue(Row);
+            }
+            Enqueued += Task.Rows.Num();
+        }
+
+        // Keep the queue bounded: the writer formats slower than rows are produced.
+        // No flush requests: they would cut short binary chunks.
+        while (Enqueued - (int64)Writer.GetRowsWritten() > MaxQueuedRows)
+        {
+            FPlatformProcess::Sleep(0.001f);
+        }
+
+        OutReport.WriteSeconds += FPlatformTime::Seconds() - StartTime;
+    }
+
+    const double StartTime = FPlatformTime::Seconds();
+    Writer.Shutdown();
+    OutReport.WriteSeconds += FPlatformTime::Seconds() - StartTime;
+    OutReport.Sensors = DeclaredSensors.Num();
+
+    if ((int64)Writer.GetRowsWritten() != Enqueued || !IFileManager::Get().FileExists(*OutCSVPath))
+    {
+        OutReport.Errors.Add(FString::Printf(TEXT("Only %llu of %lld rows were written to '%s'"),
+            Writer.GetRowsWritten(), Enqueued, *OutCSVPath));
+        return false;
+    }
+
+    PYRANO_INFO(TEXT("[Reevaluation] %d rows (%d sensors) -> '%s' (parse %.2fs, evaluate %.2fs, write %.2fs)"),
+        OutReport.Rows, OutReport.Sensors, *OutCSVPath,
+        OutReport.ParseSeconds, OutReport.ComputeSeconds, OutReport.WriteSeconds);
+    return true;
+}
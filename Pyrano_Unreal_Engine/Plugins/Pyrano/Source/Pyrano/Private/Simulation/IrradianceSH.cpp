@@ -0,0 +1,125 @@
+﻿// IrradianceSH.cpp
+
+#include "Simulation/IrradianceSH.h"
+#include "Irradiance/IrradianceCommon.h"
+
+namespace
+{
+    /** Clamped cosine lobe in SH, per band (Ramamoorthi & Hanrahan): pi, 2pi/3, pi/4, 0. */
+    constexpr float CosineLobe[FIrradianceSH::MaxOrder] = { PI, 2.f * PI / 3.f, 0.25f * PI, 0.f };
+
+    FVector4f ToRGBM(const FVector3f& RGB)
+    {
+        // Same mean as RGBtoMeanSpectralRadiance (IrradianceCommon.ush)
+        return FVector4f(RGB.X, RGB.Y, RGB.Z, (RGB.X + RGB.Y + RGB.Z) * (1.f / 3.f));
+    }
+}
+
+
+void FIrradianceSH::EvaluateBasis(const FVector3f& Dir, int32 InOrder, float* OutBasis)
+{
+    // Keep in sync with SHBasis (IrradianceCommon.ush)
+    const float x = Dir.X, y = Dir.Y, z = Dir.Z;
+
+    OutBasis[0] = 0.282094792f;
+    if (InOrder < 2)
+        return;
+
+    OutBasis[1] = 0.488602512f * y;
+    OutBasis[2] = 0.488602512f * z;
+    OutBasis[3] = 0.488602512f * x;
+    if (InOrder < 3)
+        return;
+
+    OutBasis[4] = 1.092548431f * x * y;
+    OutBasis[5] = 1.092548431f * y * z;
+    OutBasis[6] = 0.315391565f * (3.f * z * z - 1.f);
+    OutBasis[7] = 1.092548431f * x * z;
+    OutBasis[8] = 0.546274215f * (x * x - y * y);
+    if (InOrder < 4)
+        return;
+
+    OutBasis[9]  = 0.590043589f * y * (3.f * x * x - y * y);
+    OutBasis[10] = 2.890611442f * x * y * z;
+    OutBasis[11] = 0.457045799f * y * (5.f * z * z - 1.f);
+    OutBasis[12] = 0.373176333f * z * (5.f * z * z - 3.f);
+    OutBasis[13] = 0.457045799f * x * (5.f * z * z - 1.f);
+    OutBasis[14] = 1.445305721f * z * (x * x - y * y);
+    OutBasis[15] = 0.590043589f * x * (x * x - 3.f * y * y);
+}
+
+
+FIrradianceSH FIrradianceSH::FromFaceSums(int32 InOrder, TConstArrayView<FVector4f> FaceSums)
+{
+    FIrradianceSH SH;
+    const int32 NumCoeffs = GetNumCoeffs(InOrder);
+    if (!IsValidOrder(InOrder) || FaceSums.Num() != IrradianceCommon::NumFaces * NumCoeffs)
+        return SH;
+
+    SH.Order = InOrder;
+    SH.Coeffs.SetNumZeroed(NumCoeffs);
+    for (int32 Face = 0; Face < IrradianceCommon::NumFaces; ++Face)
+    {
+        for (int32 i = 0; i < NumCoeffs; ++i)
+        {
+            const FVector4f& Sum = FaceSums[Face * NumCoeffs + i];
+            SH.Coeffs[i] += FVector3f(Sum.X, Sum.Y, Sum.Z);
+        }
+    }
+    return SH;
+}
+
+
+void FIrradianceSH::GetIrradianceCoeffs(FVector3f* OutCoeffs) const
+{
+    for (int32 l = 0; l < Order; ++l)
+    {
+        for (int32 i = l * l; i < (l + 1) * (l + 1); ++i)
+        {
+            OutCoeffs[i] = Coeffs[i] * CosineLobe[l];
+        }
+    }
+}
+
+
+FVector4f FIrradianceSH::EvaluateIrradiance(const FVector& NormalWS) const
+{
+    FVector4f RGBM(0, 0, 0, 0);
+    EvaluateIrradiance(TConstArrayView<FVector>(&NormalWS, 1), TArrayView<FVector4f>(&RGBM, 1));
+    return RGBM;
+}
+
+
+void FIrradianceSH::EvaluateIrradiance(TConstArrayView<FVector> NormalsWS, TArrayView<FVector4f> OutRGBM) const
+{
+    check(OutRGBM.Num() == NormalsWS.Num());
+
+    if (!IsValid())
+    {
+        for (FVector4f& RGBM : OutRGBM)
+        {
+            RGBM = FVector4f(0, 0, 0, 0);
+        }
+        return;
+    }
+
+    // Convolved once: each normal is then a dot product with the basis
+    const int32 NumCoeffs = Coeffs.Num();
+    FVector3f Convolved[MaxCoeffs];
+    GetIrradianceCoeffs(Convolved);
+
+    float Basis[MaxCoeffs];
+    for (int32 n = 0; n < NormalsWS.Num(); ++n)
+    {
+        EvaluateBasis(FVector3f(NormalsWS[n].GetSafeNormal()), Order, Basis);
+
+        FVector3f RGB = FVector3f::ZeroVector;
+        for (int32 i = 0; i < NumCoeffs; ++i)
+        {
+            RGB += Convolved[i] * Basis[i];
+        }
+
+        // Ringing of the truncated projection can dip below zero behind bright sources
+        OutRGBM[n] = ToRGBM(FVector3f(FMath::Max(RGB.X, 0.f), FMath::Max(RGB.Y, 0.f), FMath::Max(RGB.Z, 0.f)));
+    }
+}
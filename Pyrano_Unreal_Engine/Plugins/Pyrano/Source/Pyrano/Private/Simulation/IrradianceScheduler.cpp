@@ -7,7 +7,12 @@
 #include "IneichenPerezClearSky.h"
 #include "Irradiance/IrradianceCommon.h"
 #include "Subsystems/SunSkyController.h"
+#include "Subsystems/PyranometerRegistry.h"
+#include "Simulation/SolarPosition.h"
+#include "Simulation/SkyViewFactorCache.h"
 #include "Logging/IrradianceLog.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
 
 // -----------------------------------------------------------------------------
 //  Public API
@@ -18,29 +23,23 @@ void UIrradianceScheduler::CaptureOnce(const FSimConfig& Sim)
     PYRANO_INFO(TEXT("[Scheduler] CaptureOnce requested"));
 
     ClearQueue();
-    PrepareSimulation(Sim, Sim.StartTime);
+    NumResults         = 0;
+    NumCapturedResults = 0;
 
-    // One request per sensor
     TArray<UPyranometerComponent*> LocalSensors;
     GetActiveSensors(LocalSensors);
-    for (UPyranometerComponent* S : LocalSensors)
-    {
-        FCaptureRequest Req = MakeRequest(Sim, S);
-
-        // Compute once per sensor (cache)
-        if (!S->bSkyViewFactorValid)
-        {
-            S->SkyViewFactor = Irr->ComputeSkyViewFactor(Req, IrradianceCommon::Defaults::SVFSamples);
-            S->bSkyViewFactorValid = true;
-        }
 
-        // Copy to request (exporter reads it from here)
-        Req.SkyViewFactor = S->SkyViewFactor;
+    // SVF traces run while SunSky / export / viewport are set up
+    EnsureSubsystem();
+    BeginSkyViewFactorPrepass(Sim, LocalSensors);
+    PrepareSimulation(Sim, Sim.StartTime);
 
-        Queue.Enqueue(Req);
+    // One request per sensor (SVF and horizon map are attached at launch)
+    for (UPyranometerComponent* S : LocalSensors)
+    {
+        Queue.Enqueue(MakeRequest(Sim, S));
     }
 
-
     PYRANO_INFO(TEXT("[Scheduler] CaptureOnce queued for %d sensors"), LocalSensors.Num());
     LaunchNextOneShotCapture();
 }
@@ -50,30 +49,47 @@ void UIrradianceScheduler::StartSimulation(const FSimConfig& Sim)
 {
     PYRANO_INFO(TEXT("[Scheduler] StartSimulation requested"));
     ClearQueue();
+    NumResults         = 0;
+    NumCapturedResults = 0;
 
-    // Get active sensors
+    // Get active sensors, in serial order (GUID: the same in every instance of a sharded run)
     Sensors.Reset();
     GetActiveSensors(Sensors);
+    Sensors.Sort([](const UPyranometerComponent& A, const UPyranometerComponent& B) { return A.SensorGuid < B.SensorGuid; });
 
     // Time slots
     BuildTimeSlots(Sim.StartTime, Sim.EndTime, Sim.SampleInterval);
+    if (Sim.GetShardCount() > 1)
+    {
+        ApplyShard(Sim);
+    }
+    ComputeSlotSunAngles(Sim);
     TimeIndex   = 0;
     SensorIndex = 0;
 
+    if (IrradianceCommon::Settings::bResumeSimulations && Sim.bExportCSV && TimeSlots.Num() > 0 && Sensors.Num() > 0)
+    {
+        BeginCheckpointing(Sim);
+    }
+
     if (TimeSlots.Num() == 0 || Sensors.Num() == 0)
     {
         // Nothing to simulate
-        PYRANO_WARN(TEXT("[Scheduler] Simulation aborted (Sensors=%d, TimeSlots=%d)"),
-            Sensors.Num(), TimeSlots.Num());
+        PYRANO_WARN(TEXT("[Scheduler] Simulation aborted (Sensors=%d, TimeSlots=%d)%s"),
+            Sensors.Num(), TimeSlots.Num(),
+            ShardManifest.ShardCount > 1 ? TEXT(": empty shard, the run has more shards than slots or sensors") : TEXT(""));
         RestoreViewport();
         State = ESchedulerState::Idle;
         return;
     }
 
+    // SVF traces run while SunSky / export / viewport are set up
+    EnsureSubsystem();
+    BeginSkyViewFactorPrepass(Sim, Sensors);
     PrepareSimulation(Sim, TimeSlots[0]);
 
-    PYRANO_INFO(TEXT("[Scheduler] Simulation starting: Sensors=%d, TimeSlots=%d"),
-        Sensors.Num(), TimeSlots.Num());
+    PYRANO_INFO(TEXT("[Scheduler] Simulation starting: Sensors=%d, TimeSlots=%d, FirstSlot=%d"),
+        Sensors.Num(), TimeSlots.Num(), TimeIndex);
     LaunchNextSimulationCapture(BaseSimConfig);
 }
 
@@ -86,16 +102,39 @@ void UIrradianceScheduler::ClearQueue()
     while (Queue.Dequeue(Dump))
         Count++;
 
+    // Drop captures still in the pipeline
+    if (Irr.IsValid())
+    {
+        Irr->CancelAllCaptures();
+        Irr->CancelSkyViewFactorPrepass();
+        Irr->SaveCaptureCache();
+    }
+    PrepassSensors.Reset();
+
     // Clear state
-    Current.Reset();
     TimeSlots.Reset();
+    SlotSunAngles.Reset();
     Sensors.Reset();
     TimeIndex   = 0;
     SensorIndex = 0;
+    AppliedSunTimeIndex = INDEX_NONE;
 
     State               = ESchedulerState::Idle;
-    bCaptureInFlight    = false;
+    CapturesInFlight    = 0;
     bViewportForced     = false;
+    ShardManifest       = FSimShardManifest();
+
+    // The checkpoint file stays on disk: a later run with the same config resumes from it
+    bCheckpointing      = false;
+    bResuming           = false;
+    CheckpointPath.Reset();
+    SensorIndexById.Reset();
+    PendingRowCells.Reset();
+    CheckpointedRows    = 0;
+
+    RetryRequests.Reset();
+    RetryAttempts.Reset();
+    UnsavedRetryCells.Reset();
 
     BaseSimConfig = FSimConfig();
     PYRANO_VERBOSE(TEXT("[Scheduler] Queue cleared (removed %d pending captures)"), Count);
@@ -115,6 +154,7 @@ void UIrradianceScheduler::EnsureSubsystem()
             Irr = W->GetSubsystem<UIrradianceSubsystem>();
             if (Irr.IsValid())
             {
+                Irr->OnCaptureCompleted.AddUObject(this, &UIrradianceScheduler::OnCaptureCompleted);
                 PYRANO_VERBOSE(TEXT("[Scheduler] IrradianceSubsystem acquired"));
             }
             else
@@ -134,6 +174,10 @@ void UIrradianceScheduler::ConfigureSunSkyOnce(const FSimConfig& Sim)
 {
     if (USunSkyController* Sun = GetWorld()->GetSubsystem<USunSkyController>())
     {
+        Sun->SetUseNativeEphemeris(!Sim.bUseSunSkyBlueprint);
+        PYRANO_INFO(TEXT("[Scheduler] Sun driven by %s"),
+            Sim.bUseSunSkyBlueprint ? TEXT("SunSky Blueprint") : TEXT("native ephemeris"));
+
         Sun->ApplyStaticConfig(
             Sim.Latitude,
             Sim.Longitude,
@@ -153,7 +197,15 @@ void UIrradianceScheduler::SetSunSkyUTC(const FDateTime& Utc)
 {
     if (USunSkyController* Sun = GetWorld()->GetSubsystem<USunSkyController>())
     {
-        Sun->SetUTC(Utc);
+        if (Sun->IsUsingNativeEphemeris())
+        {
+            const FSolarAngles Angles = SolarPosition::Compute(Utc, BaseSimConfig.Latitude, BaseSimConfig.Longitude);
+            Sun->SetSolarAnglesDirect(Angles.AzimuthDeg, Angles.AltitudeDeg);
+        }
+        else
+        {
+            Sun->SetUTC(Utc);
+        }
     }
     else
     {
@@ -162,6 +214,23 @@ void UIrradianceScheduler::SetSunSkyUTC(const FDateTime& Utc)
 }
 
 
+void UIrradianceScheduler::ApplySunForSlot(int32 SlotIdx)
+{
+    USunSkyController* Sun = GetWorld()->GetSubsystem<USunSkyController>();
+    if (Sun && Sun->IsUsingNativeEphemeris() && SlotSunAngles.IsValidIndex(SlotIdx))
+    {
+        const FSolarAngles& Angles = SlotSunAngles[SlotIdx];
+        Sun->SetSolarAnglesDirect(Angles.AzimuthDeg, Angles.AltitudeDeg);
+        return;
+    }
+
+    if (TimeSlots.IsValidIndex(SlotIdx))
+    {
+        SetSunSkyUTC(TimeSlots[SlotIdx]);
+    }
+}
+
+
 // -----------------------------------------------------------------------------
 //  Viewport
 // -----------------------------------------------------------------------------
@@ -176,6 +245,13 @@ void UIrradianceScheduler::ApplyViewport(const FSimConfig& Sim)
 
     }
 
+    // Off-screen captures render into their own targets: the viewport is left alone
+    if (Sim.bOffscreenCapture)
+    {
+        PYRANO_VERBOSE(TEXT("[Viewport] Off-screen capture, viewport not forced"));
+        return;
+    }
+
     const int32 Side = FMath::Max(32, Sim.ResolutionPx);
     if (Irr->ForceSquareViewportPIE(Side))
     {
@@ -216,12 +292,9 @@ void UIrradianceScheduler::RestoreViewport()
 void UIrradianceScheduler::GetActiveSensors(TArray<UPyranometerComponent*>& OutSensors) const
 {
     OutSensors.Reset();
-    for (TObjectIterator<UPyranometerComponent> It; It; ++It)
+    if (UPyranometerRegistry* Registry = GetWorld() ? GetWorld()->GetSubsystem<UPyranometerRegistry>() : nullptr)
     {
-        if (It->GetWorld() != GetWorld()) continue;
-        if (!It->IsRegistered()) continue;
-        if (!It->bEnabled) continue;            
-        OutSensors.Add(*It);
+        Registry->GetSensors(OutSensors, /*bOnlyEnabled*/ true);
     }
 
     PYRANO_VERBOSE(TEXT("[Scheduler] GetActiveSensors -> %d sensor(s)"), OutSensors.Num());
@@ -241,36 +314,52 @@ FCaptureRequest UIrradianceScheduler::MakeRequest(const FSimConfig& Sim, UPyrano
     const FDateTime WhenUTC = Sim.StartTime;
 
     // FCaptureRequest: PosWS, NormalWS, SidePx, Warmup, SensorId(Guid), Timestamp
-    return FCaptureRequest::Make(
+    FCaptureRequest Req = FCaptureRequest::Make(
         PosWS, Normal, SidePx, Warmup,
         Sensor->SensorGuid,
         Sensor->SensorName,
         WhenUTC);
+    Req.SHOrder = Sim.SHOrder;
+    return Req;
+}
+
 
+FCaptureRequest UIrradianceScheduler::MakeSimulationRequest(const FSimConfig& Sim, UPyranometerComponent* Sensor)
+{
+    FCaptureRequest Req = MakeRequest(Sim, Sensor).WithTimestamp(TimeSlots[TimeIndex]);
+    AttachSensorSkyData(Sensor, Req);
+    return Req;
 }
 
 
-bool UIrradianceScheduler::ConsumeIrradianceResult(float& OutValue)
+void UIrradianceScheduler::AttachSensorSkyData(UPyranometerComponent* Sensor, FCaptureRequest& Req)
 {
-    EnsureSubsystem();
-    if (!Irr.IsValid()) 
-        return false;
+    // Normally filled by the pre-pass; synchronous fallback otherwise
+    if (!Sensor->bSkyViewFactorValid)
+    {
+        Sensor->SkyViewFactor = Irr->ComputeSkyViewFactor(Req, IrradianceCommon::Defaults::SVFSamples);
+        Sensor->bSkyViewFactorValid = true;
+    }
+
+    // Copy to request (exporter reads it from here)
+    Req.SkyViewFactor = Sensor->SkyViewFactor;
+    Req.HorizonMap = EnsureHorizonMap(Sensor, Req);
+}
 
-    const bool bOK = Irr->ConsumeLatestIrradiance(OutValue, BaseSimConfig.MinSunAltitudeDeg);
-    if (!bOK)
-        return false;
 
-    FString SensorName = TEXT("<unknown>");
-    FString Timestamp = TEXT("<none>");
+FSensorHorizonMapPtr UIrradianceScheduler::EnsureHorizonMap(UPyranometerComponent* Sensor, const FCaptureRequest& Req)
+{
+    if (!IrradianceCommon::Settings::bUseHorizonMap)
+        return nullptr;
 
-    if (Current.IsSet())
+    // Built once per sensor pose; every time slot afterwards is a lookup
+    FSensorHorizonMapPtr Map = Sensor->GetHorizonMapCached();
+    if (!Map.IsValid())
     {
-        SensorName = Current->SensorName;
-        Timestamp = Current->TimestampUTC.ToIso8601();
+        Map = Irr->BuildHorizonMap(Req);
+        Sensor->HorizonMap = Map;
     }
-
-    PYRANO_SUCCESS(TEXT("[RESULT] Sensor='%s'  UTC=%s  Irradiance=%.2f W/m2"), *SensorName, *Timestamp, OutValue);
-	return true;
+    return Map;
 }
 
 
@@ -282,18 +371,28 @@ void UIrradianceScheduler::Tick(float DeltaTime)
 {
     if (State == ESchedulerState::Idle) 
         return;
-    if (!bCaptureInFlight) 
-        return;
 
-    // @TODO: Create Public Delegate in ConsumeLatestIrradiance (Subsystem)
-    // and replace bCaptureInFlight with it.
-    
-    float Value = 0.f;
-    if (!ConsumeIrradianceResult(Value))
-        return;
+    // Wait for the SVF pre-pass before launching anything
+    if (State == ESchedulerState::Preparing)
+    {
+        if (!TickSkyViewFactorPrepass())
+            return;
+        State = ESchedulerState::Capturing;
+    }
 
-    OnCaptureCompleted(Value);
-    
+    // Results arrive through OnCaptureCompleted; here we only keep the pipeline full
+    if (IsSimulationMode())
+    {
+        if (bCheckpointing)
+        {
+            TickCheckpoint();
+        }
+        LaunchNextSimulationCapture(BaseSimConfig);
+    }
+    else
+    {
+        LaunchNextOneShotCapture();
+    }
 }
 
 
@@ -304,16 +403,68 @@ void UIrradianceScheduler::PrepareSimulation(const FSimConfig& Sim, const FDateT
 
     // Config SunSky
     ConfigureSunSkyOnce(Sim);
-    SetSunSkyUTC(InitialTimeUTC);
+    if (TimeSlots.Num() > 0)
+    {
+        ApplySunForSlot(0);
+    }
+    else
+    {
+        SetSunSkyUTC(InitialTimeUTC);
+    }
+
+    AppliedSunTimeIndex = TimeSlots.Num() > 0 ? 0 : INDEX_NONE;
 
     EnsureSubsystem();
     if (Irr.IsValid())
     {
+        // Pipelining
+        Irr->SetPipelineDepth(Sim.CapturePipelineDepth);
+        Irr->SetMinSunAltitude(Sim.MinSunAltitudeDeg);
+        Irr->SetNormalization(Sim.Normalization);
+        Irr->SetIntegrationBatchSize(Sim.IntegrationBatchSize);
+        Irr->SetPathTracing(Sim.bPathTracing);
+        Irr->SetOffscreenCapture(Sim.bOffscreenCapture);
+        Irr->SetCaptureCacheEnabled(Sim.bUseCaptureCache);
+
         // Export
-        Irr->ConfigureExport(Sim.bExportCSV, Sim.bExportImages, Sim.OutputPath.Path);
+        FExportOptions Export;
+        Export.bExportCSV = Sim.bExportCSV;
+        Export.bExportBinary = Sim.bExportBinary;
+        Export.bExportImages = Sim.bExportImages;
+        Export.bArchiveImages = Sim.bArchiveImages;
+        Export.bCompressImages = Sim.bCompressImages;
+        Export.OutputDir.Path = Sim.OutputPath.Path;
+        Export.ShardIndex = ShardManifest.ShardIndex;
+        Export.ShardCount = ShardManifest.ShardCount;
+        if (bResuming)
+        {
+            Export.ResumeCSVFile = Checkpoint.CSVFile;
+            Export.ResumeCSVBytes = Checkpoint.CSVBytes;
+
+            // The binary file cannot be cut back to the checkpoint (rows past it, maybe no footer):
+            // the CSV is the output of a resumed run
+            if (Export.bExportBinary)
+            {
+                PYRANO_WARN(TEXT("[Scheduler] Binary export disabled while resuming; '%s' only holds the rows written before the interruption"),
+                    *FPaths::ChangeExtension(Checkpoint.CSVFile, TEXT(".pyrb")));
+                Export.bExportBinary = false;
+            }
+        }
+        Irr->ConfigureExport(Export);
+
+        if (bCheckpointing)
+        {
+            Checkpoint.CSVFile = FPaths::GetCleanFilename(Irr->GetExportCSVPath());
+        }
+
+        if (ShardManifest.ShardCount > 1 && Export.ExportsRows())
+        {
+            WriteShardManifest();
+        }
         PYRANO_VERBOSE(
-            TEXT("[Scheduler] Export configured (CSV=%s, Images=%s, Path=%s)"),
+            TEXT("[Scheduler] Export configured (CSV=%s, Binary=%s, Images=%s, Path=%s)"),
             Sim.bExportCSV ? TEXT("true") : TEXT("false"),
+            Sim.bExportBinary ? TEXT("true") : TEXT("false"),
             Sim.bExportImages ? TEXT("true") : TEXT("false"),
             *Sim.OutputPath.Path);
 
@@ -331,54 +482,290 @@ void UIrradianceScheduler::PrepareSimulation(const FSimConfig& Sim, const FDateT
     // Viewport
     ApplyViewport(Sim);
 
-    State = ESchedulerState::Capturing;
-    bCaptureInFlight = false;
+    // Captures start once the SVF pre-pass has finished
+    State = (Irr.IsValid() && Irr->IsSkyViewFactorPrepassRunning())
+        ? ESchedulerState::Preparing
+        : ESchedulerState::Capturing;
+    CapturesInFlight = 0;
 
     PYRANO_INFO(TEXT("[Scheduler] Simulation prepared (mode=%s)"),
         TimeSlots.Num() > 0 ? TEXT("Simulation") : TEXT("CaptureOnce"));
 }
 
 
-void UIrradianceScheduler::LaunchCapture(const FCaptureRequest& Req)
+bool UIrradianceScheduler::LaunchCapture(const FCaptureRequest& Req, bool* bOutCached)
 {
     EnsureSubsystem();
     if (!Irr.IsValid())
     {
         PYRANO_ERR(TEXT("[Scheduler] Cannot launch capture: IrradianceSubsystem not found"));
-        return;
+        return false;
     }
 
-    Current          = Req;
-    bCaptureInFlight = true;
+    // Same raw output already rendered: no GPU work, published in order like a capture
+    const bool bCached = Irr->SubmitCachedCapture(Req);
+    if (bOutCached)
+    {
+        *bOutCached = bCached;
+    }
+    if (bCached)
+    {
+        PYRANO_VERBOSE(TEXT("[Scheduler] Cache hit -> %s"), *Req.ToString());
+        ++CapturesInFlight;
+        return true;
+    }
 
     PYRANO_VERBOSE(TEXT("[Scheduler] StartSixFaceCapture -> %s"), *Req.ToString());
-    Irr->StartSixFaceCapture(Req); 
+    if (!Irr->StartSixFaceCapture(Req))
+    {
+        PYRANO_WARN(TEXT("[Scheduler] Capture not accepted: %s"), *Req.ToString());
+        return false;
+    }
+
+    ++CapturesInFlight;
+    return true;
+}
+
+
+void UIrradianceScheduler::OnCaptureCompleted(const FGuid& RequestId, const FCaptureResult& Result)
+{
+    if (State == ESchedulerState::Idle)
+        return;
+
+    CapturesInFlight = FMath::Max(0, CapturesInFlight - 1);
+
+    // No row was exported: the cell is captured again
+    if (Result.bFailed)
+    {
+        RetryFailedCapture(Result.Request);
+        return;
+    }
+
+    if (RetryAttempts.Num() > 0)
+    {
+        RetryAttempts.Remove(TPair<FGuid, int64>(Result.Request.SensorId, Result.Request.TimestampUTC.GetTicks()));
+    }
+
+    ++NumResults;
+
+    // Exported rows follow the launch order (the subsystem publishes in order)
+    if (bCheckpointing)
+    {
+        PendingRowCells.Add(GetResultCell(Result.Request));
+    }
+
+    if (!Result.bCaptured)
+    {
+        PYRANO_VERBOSE(TEXT("[RESULT] Sensor='%s'  UTC=%s  Sun below horizon (Alt=%.2f)"),
+            *Result.Request.SensorName, *Result.Request.TimestampUTC.ToIso8601(), Result.Sun.AltitudeDeg);
+        return;
+    }
+
+    ++NumCapturedResults;
+    PYRANO_SUCCESS(TEXT("[RESULT] Sensor='%s'  UTC=%s  Irradiance=%.2f W/m2"),
+        *Result.Request.SensorName, *Result.Request.TimestampUTC.ToIso8601(), Result.TotalIrradiance);
 }
 
 
-void UIrradianceScheduler::OnCaptureCompleted(float IrrValue)
+void UIrradianceScheduler::RetryFailedCapture(const FCaptureRequest& Req)
 {
-    bCaptureInFlight = false;
+    const TPair<FGuid, int64> Key(Req.SensorId, Req.TimestampUTC.GetTicks());
+    const int32 Cell = bCheckpointing ? GetResultCell(Req) : INDEX_NONE;
+
+    int32& Attempts = RetryAttempts.FindOrAdd(Key);
+    if (Attempts >= IrradianceCommon::Defaults::MaxCaptureRetries)
+    {
+        PYRANO_ERR(TEXT("[Scheduler] Capture failed %d times, cell left without result: %s"), Attempts + 1, *Req.ToString());
+        RetryAttempts.Remove(Key);
+        UnsavedRetryCells.Remove(Cell);
+        return;
+    }
+
+    ++Attempts;
+    PYRANO_WARN(TEXT("[Scheduler] Capture failed, taking it again (%d/%d): %s"),
+        Attempts, IrradianceCommon::Defaults::MaxCaptureRetries, *Req.ToString());
+
+    if (Cell != INDEX_NONE)
+    {
+        UnsavedRetryCells.Add(Cell);
+    }
 
     if (IsSimulationMode())
     {
-        // Simulation
-        if (SensorIndex + 1 < Sensors.Num())
+        RetryRequests.Add(Req);
+    }
+    else
+    {
+        Queue.Enqueue(Req);
+    }
+}
+
+
+// -----------------------------------------------------------------------------
+//  Sharding
+// -----------------------------------------------------------------------------
+
+void UIrradianceScheduler::ApplyShard(const FSimConfig& Sim)
+{
+    const FSimShard Shard = FSimShard::Make(Sim, TimeSlots.Num(), Sensors.Num());
+
+    ShardManifest = FSimShardManifest();
+    ShardManifest.ShardIndex   = Shard.Index;
+    ShardManifest.ShardCount   = Shard.Count;
+    ShardManifest.TimeShards   = FMath::Max(1, Sim.TimeShards);
+    ShardManifest.SensorShards = FMath::Max(1, Sim.SensorShards);
+    ShardManifest.StartUTC     = Sim.StartTime;
+    ShardManifest.EndUTC       = Sim.EndTime;
+    ShardManifest.StepTicks    = Sim.SampleInterval.GetTicks();
+    ShardManifest.TotalSlots   = TimeSlots.Num();
+    ShardManifest.TotalSensors = Sensors.Num();
+    ShardManifest.SlotBegin    = Shard.SlotBegin;
+    ShardManifest.SlotEnd      = Shard.SlotEnd;
+
+    // Slot indices stay those of the serial run: the merge maps UTC back to them
+    TimeSlots = TArray<FDateTime>(TimeSlots.GetData() + Shard.SlotBegin, Shard.SlotEnd - Shard.SlotBegin);
+    Sensors = TArray<UPyranometerComponent*>(Sensors.GetData() + Shard.SensorBegin, Shard.SensorEnd - Shard.SensorBegin);
+
+    for (const UPyranometerComponent* S : Sensors)
+    {
+        ShardManifest.Sensors.Add(S->SensorGuid);
+    }
+
+    PYRANO_INFO(TEXT("[Scheduler] Shard %d/%d: slots [%d, %d) of %d, sensors [%d, %d) of %d"),
+        Shard.Index, Shard.Count,
+        Shard.SlotBegin, Shard.SlotEnd, ShardManifest.TotalSlots,
+        Shard.SensorBegin, Shard.SensorEnd, ShardManifest.TotalSensors);
+}
+
+
+void UIrradianceScheduler::WriteShardManifest()
+{
+    const FString CSVPath = Irr.IsValid() ? Irr->GetExportCSVPath() : FString();
+    if (CSVPath.IsEmpty())
+        return;
+
+    ShardManifest.CSVFile = FPaths::GetCleanFilename(CSVPath);
+    ShardManifest.Save(FSimShardManifest::GetPath(CSVPath));
+}
+
+
+// -----------------------------------------------------------------------------
+//  Checkpoint
+// -----------------------------------------------------------------------------
+
+void UIrradianceScheduler::BeginCheckpointing(const FSimConfig& Sim)
+{
+    TArray<FGuid> SensorIds;
+    SensorIndexById.Reset();
+    for (int32 i = 0; i < Sensors.Num(); ++i)
+    {
+        SensorIds.Add(Sensors[i]->SensorGuid);
+        SensorIndexById.Add(Sensors[i]->SensorGuid, i);
+    }
+
+    // Same location and name as the exported CSV of this run
+    FExportOptions Export;
+    Export.OutputDir.Path = Sim.OutputPath.Path;
+    const FString OutputDir = UIrradianceExporter::ResolveOutputDir(Export);
+    const FString ShardSuffix = ShardManifest.ShardCount > 1
+        ? FSimShard::MakeFileSuffix(ShardManifest.ShardIndex, ShardManifest.ShardCount)
+        : FString();
+    CheckpointPath = FSimCheckpoint::GetPath(OutputDir, FPaths::GetBaseFilename(Export.CSVFilename), ShardSuffix);
+
+    const FString ConfigHash = FSimCheckpoint::MakeConfigHash(Sim, SensorIds, TimeSlots.Num());
+
+    FSimCheckpoint Saved;
+    if (Saved.Load(CheckpointPath))
+    {
+        const int64 CSVSize = IFileManager::Get().FileSize(*FPaths::Combine(OutputDir, Saved.CSVFile));
+        if (Saved.ConfigHash != ConfigHash)
+        {
+            PYRANO_INFO(TEXT("[Scheduler] Checkpoint of another configuration ignored: %s"), *CheckpointPath);
+        }
+        else if (CSVSize < Saved.CSVBytes || Saved.TimeIndex < 0 || Saved.TimeIndex > TimeSlots.Num() || !Sensors.IsValidIndex(Saved.SensorIndex))
         {
-            ++SensorIndex;
-            LaunchNextSimulationCapture(BaseSimConfig);
+            PYRANO_WARN(TEXT("[Scheduler] Checkpoint does not match its output (%s), starting over"), *Saved.CSVFile);
         }
         else
         {
-            // Last sensor in this slot -> move to the next slot or finish
-            AdvanceTimeSlotOrFinish(); 
+            TimeIndex   = Saved.TimeIndex;
+            SensorIndex = Saved.SensorIndex;
+            bResuming   = true;
+            Checkpoint  = Saved;
+            ++Checkpoint.NumResumes;
+
+            // TimeIndex == TimeSlots.Num(): every row was durable, only the end of the run was missed
+            PYRANO_INFO(TEXT("[Scheduler] Resuming at slot %d/%d, sensor %d/%d, from %s (%lld bytes)"),
+                TimeIndex, TimeSlots.Num(), SensorIndex, Sensors.Num(), *Saved.CSVFile, Saved.CSVBytes);
         }
     }
-    else 
+
+    if (!bResuming)
     {
-        // CaptureOnce
-        LaunchNextOneShotCapture();
+        Checkpoint = FSimCheckpoint();
+        Checkpoint.ConfigHash = ConfigHash;
+    }
+
+    PendingRowCells.Reset();
+    CheckpointedRows = 0;
+    bCheckpointing = true;
+}
+
+
+void UIrradianceScheduler::TickCheckpoint()
+{
+    uint64 DurableRows = 0;
+    int64 CSVBytes = 0;
+    if (!Irr.IsValid() || !Irr->GetExportDurablePoint(DurableRows, CSVBytes) || DurableRows <= CheckpointedRows)
+        return;
+
+    const int32 NewRows = (int32)FMath::Min<uint64>(DurableRows - CheckpointedRows, (uint64)PendingRowCells.Num());
+    if (NewRows <= 0)
+        return;
+
+    // Retried cells come back after later ones: keep the furthest durable cell
+    int32 LastCell = INDEX_NONE;
+    for (int32 i = 0; i < NewRows; ++i)
+    {
+        LastCell = FMath::Max(LastCell, PendingRowCells[i]);
+        if (UnsavedRetryCells.Num() > 0)
+        {
+            UnsavedRetryCells.Remove(PendingRowCells[i]);
+        }
     }
+    PendingRowCells.RemoveAt(0, NewRows, EAllowShrinking::No);
+    CheckpointedRows += NewRows;
+
+    // A resume would skip a cell still waiting for its retry
+    if (LastCell == INDEX_NONE || UnsavedRetryCells.Num() > 0)
+        return;
+
+    // Next cell after the last durable row (never moves back)
+    const int32 SavedCell = Checkpoint.TimeIndex * Sensors.Num() + Checkpoint.SensorIndex;
+    const int32 NextCell = FMath::Max(LastCell + 1, SavedCell);
+    Checkpoint.TimeIndex   = NextCell / Sensors.Num();
+    Checkpoint.SensorIndex = NextCell % Sensors.Num();
+    Checkpoint.CSVBytes    = CSVBytes;
+    Checkpoint.Save(CheckpointPath);
+}
+
+
+int32 UIrradianceScheduler::GetResultCell(const FCaptureRequest& Req) const
+{
+    const int32* Sensor = SensorIndexById.Find(Req.SensorId);
+    const int32 Slot = GetResultSlot(Req);
+    return (Sensor && Slot != INDEX_NONE) ? Slot * Sensors.Num() + *Sensor : INDEX_NONE;
+}
+
+
+int32 UIrradianceScheduler::GetResultSlot(const FCaptureRequest& Req) const
+{
+    if (TimeSlots.Num() == 0 || BaseSimConfig.SampleInterval.GetTicks() <= 0)
+        return INDEX_NONE;
+
+    const int64 SinceStart = (Req.TimestampUTC - TimeSlots[0]).GetTicks();
+    const int32 Slot = (int32)(SinceStart / BaseSimConfig.SampleInterval.GetTicks());
+    return TimeSlots.IsValidIndex(Slot) ? Slot : INDEX_NONE;
 }
 
 
@@ -390,23 +777,134 @@ void UIrradianceScheduler::LaunchNextOneShotCapture()
 {
     if (State != ESchedulerState::Capturing) 
         return;
-    if (bCaptureInFlight) 
+
+    EnsureSubsystem();
+    if (!Irr.IsValid())
         return;
 
-    FCaptureRequest Next;
-    if (Queue.Dequeue(Next))
+    if (!Queue.IsEmpty())
     {
+        if (!Irr->CanStartCapture())
+            return;
+
+        FCaptureRequest Next;
+        Queue.Dequeue(Next);
+
+        UPyranometerRegistry* Registry = GetWorld()->GetSubsystem<UPyranometerRegistry>();
+        if (UPyranometerComponent* Sensor = Registry ? Registry->FindSensor(Next.SensorId) : nullptr)
+        {
+            AttachSensorSkyData(Sensor, Next);
+        }
         LaunchCapture(Next);
+        return;
     }
-    else
+
+    // Empty queue and nothing in flight = end of CaptureOnce
+    if (CapturesInFlight > 0)
     {
-        // Empty queue = end of CaptureOnce
-        Irr->FlushExporter();
-        PYRANO_INFO(TEXT("[Scheduler] CaptureOnce completed (queue empty)"));
-        RestoreViewport();
-        State = ESchedulerState::Idle;
-        Current.Reset();
+        Irr->FlushIntegrationBatch();   // nothing else will join the batch
+        return;
     }
+
+    Irr->FlushExporter();
+    Irr->SaveCaptureCache();
+    PYRANO_INFO(TEXT("[Scheduler] CaptureOnce completed (queue empty)"));
+    RestoreViewport();
+    State = ESchedulerState::Idle;
+}
+
+
+// -----------------------------------------------------------------------------
+//  Sky View Factor pre-pass
+// -----------------------------------------------------------------------------
+
+void UIrradianceScheduler::BeginSkyViewFactorPrepass(const FSimConfig& Sim, const TArray<UPyranometerComponent*>& InSensors)
+{
+    PrepassSensors.Reset();
+    LastPrepassReportPct = 0;
+    PrepassStartTime = FPlatformTime::Seconds();
+
+    const int32 NumSamples = IrradianceCommon::Defaults::SVFSamples;
+    SVFCache.Load(FSkyViewFactorCache::GetDefaultPath(), UWorld::RemovePIEPrefix(GetWorld()->GetOutermost()->GetName()));
+
+    // Unchanged sensors reuse the previous run
+    int32 NumCached = 0;
+    TArray<FCaptureRequest> Reqs;
+    for (UPyranometerComponent* S : InSensors)
+    {
+        if (!S || S->bSkyViewFactorValid)
+            continue;
+
+        float Cached = -1.0f;
+        if (SVFCache.Find(S->SensorGuid, S->GetWorldPosition(), S->GetNormalWS(), NumSamples, Cached))
+        {
+            S->SkyViewFactor = Cached;
+            S->bSkyViewFactorValid = true;
+            ++NumCached;
+            continue;
+        }
+
+        Reqs.Add(MakeRequest(Sim, S));
+        PrepassSensors.Add(S);
+    }
+
+    if (Reqs.Num() > 0 && Irr.IsValid())
+    {
+        Irr->BeginSkyViewFactorPrepass(Reqs, NumSamples);
+    }
+
+    PYRANO_INFO(TEXT("[Scheduler] Sky view factor pre-pass: %d sensor(s) to compute, %d from cache"),
+        Reqs.Num(), NumCached);
+}
+
+
+bool UIrradianceScheduler::TickSkyViewFactorPrepass()
+{
+    if (!Irr.IsValid())
+        return true;
+
+    // Progress in 25% steps
+    const int32 Pct = FMath::FloorToInt(Irr->GetSkyViewFactorPrepassProgress() * 100.0f);
+    if (Pct / 25 > LastPrepassReportPct / 25 && Pct < 100)
+    {
+        PYRANO_INFO(TEXT("[Scheduler] Sky view factor pre-pass: %d%%"), Pct);
+        LastPrepassReportPct = Pct;
+    }
+
+    if (Irr->IsSkyViewFactorPrepassRunning())
+        return false;
+
+    const int32 NumSamples = IrradianceCommon::Defaults::SVFSamples;
+    for (const TWeakObjectPtr<UPyranometerComponent>& Weak : PrepassSensors)
+    {
+        UPyranometerComponent* S = Weak.Get();
+        float Svf = -1.0f;
+        if (S && Irr->GetSkyViewFactorPrepassResult(S->SensorGuid, Svf))
+        {
+            S->SkyViewFactor = Svf;
+            S->bSkyViewFactorValid = true;
+            SVFCache.Store(S->SensorGuid, S->GetWorldPosition(), S->GetNormalWS(), NumSamples, Svf);
+        }
+    }
+
+    if (PrepassSensors.Num() > 0)
+    {
+        SVFCache.Save(FSkyViewFactorCache::GetDefaultPath());
+        PYRANO_INFO(TEXT("[Scheduler] Sky view factor pre-pass done: %d sensor(s) in %.1f ms"),
+            PrepassSensors.Num(), (FPlatformTime::Seconds() - PrepassStartTime) * 1000.0);
+    }
+
+    PrepassSensors.Reset();
+    Irr->CancelSkyViewFactorPrepass();   // frees the jobs
+    return true;
+}
+
+
+float UIrradianceScheduler::GetPreparationProgress() const
+{
+    return (State == ESchedulerState::Preparing && Irr.IsValid())
+        ? Irr->GetSkyViewFactorPrepassProgress()
+        : 1.0f;
 }
 
 
@@ -439,54 +937,175 @@ void UIrradianceScheduler::BuildTimeSlots(const FDateTime& StartUTC, const FDate
 }
 
 
+void UIrradianceScheduler::ComputeSlotSunAngles(const FSimConfig& Sim)
+{
+    SlotSunAngles.Reset();
+    SlotSunAngles.Reserve(TimeSlots.Num());
+
+    int32 NumBelow = 0;
+    for (const FDateTime& SlotUTC : TimeSlots)
+    {
+        const FSolarAngles& Angles = SlotSunAngles.Add_GetRef(
+            SolarPosition::Compute(SlotUTC, Sim.Latitude, Sim.Longitude));
+
+        if (Angles.AltitudeDeg <= Sim.MinSunAltitudeDeg)
+        {
+            ++NumBelow;
+        }
+    }
+
+    PYRANO_INFO(TEXT("[Scheduler] %d/%d time slot(s) with sun below %.1f deg: resolved without capture"),
+        NumBelow, TimeSlots.Num(), Sim.MinSunAltitudeDeg);
+}
+
+
+bool UIrradianceScheduler::IsSlotBelowMinAltitude(int32 SlotIdx) const
+{
+    return SlotSunAngles.IsValidIndex(SlotIdx)
+        && SlotSunAngles[SlotIdx].AltitudeDeg <= BaseSimConfig.MinSunAltitudeDeg;
+}
+
+
+void UIrradianceScheduler::ResolveBelowHorizonSlot(const FSimConfig& Sim)
+{
+    const FSolarAngles& Angles = SlotSunAngles[TimeIndex];
+
+    FCaptureSunState Sun;
+    Sun.bValid = true;
+    Sun.AzimuthDeg = (float)Angles.AzimuthDeg;
+    Sun.AltitudeDeg = (float)Angles.AltitudeDeg;
+    Sun.ToSunDir = SolarPosition::DirectionFromAngles(Angles.AzimuthDeg, Angles.AltitudeDeg, Sim.NorthOffset);
+
+    for (int32 i = SensorIndex; i < Sensors.Num(); ++i)
+    {
+        Irr->SubmitResolvedCapture(MakeSimulationRequest(Sim, Sensors[i]), Sun);
+        ++CapturesInFlight;
+    }
+}
+
+
 void UIrradianceScheduler::LaunchNextSimulationCapture(const FSimConfig& Sim)
 {
     if (State != ESchedulerState::Capturing) 
         return;
-    if (bCaptureInFlight) 
+
+    EnsureSubsystem();
+    if (!Irr.IsValid())
+        return;
+
+    // Failed captures are taken again before the cursor moves on
+    if (!LaunchSimulationRetry())
         return;
 
-    if (SensorIndex < Sensors.Num())
+    // Night slots need no GPU work nor sun changes: emit their rows directly (bounded per tick).
+    // Only a resumed run can enter a night slot past its first sensor.
+    int32 ResolvedRows = 0;
+    while (TimeIndex < TimeSlots.Num() && IsSlotBelowMinAltitude(TimeIndex)
+        && ResolvedRows < IrradianceCommon::Defaults::MaxResolvedRowsPerTick)
     {
-       
-        UPyranometerComponent* S = Sensors[SensorIndex];
-        FCaptureRequest Req = MakeRequest(Sim, S).WithTimestamp(TimeSlots[TimeIndex]);
-        if (!Sensors[SensorIndex]->bSkyViewFactorValid)
+        ResolveBelowHorizonSlot(Sim);
+        ResolvedRows += Sensors.Num() - SensorIndex;
+        SensorIndex = 0;
+        ++TimeIndex;
+    }
+
+    if (TimeIndex >= TimeSlots.Num())
+    {
+        // Everything launched: wait for the pipeline to drain
+        FinishSimulationIfDrained();
+        return;
+    }
+
+    // Cache hits take no pipeline slot: keep launching until one needs the GPU (bounded per tick)
+    int32 Launched = 0;
+    while (TimeIndex < TimeSlots.Num() && !IsSlotBelowMinAltitude(TimeIndex) && Irr->CanStartCapture()
+        && Launched < IrradianceCommon::Defaults::MaxResolvedRowsPerTick)
+    {
+        // New solar time only when the cursor enters a new slot.
+        // Captures still integrating keep the sun state snapshotted at their start.
+        if (AppliedSunTimeIndex != TimeIndex)
+        {
+            ApplySunForSlot(TimeIndex);
+            AppliedSunTimeIndex = TimeIndex;
+        }
+
+        // Turned away (pipeline busy): the same cell is tried again next tick, the cursor and
+        // therefore the checkpoint stay on it. Only a request that can never be accepted is skipped.
+        bool bCached = false;
+        const FCaptureRequest Req = MakeSimulationRequest(Sim, Sensors[SensorIndex]);
+        if (!LaunchCapture(Req, &bCached))
         {
-            Sensors[SensorIndex]->SkyViewFactor = Irr->ComputeSkyViewFactor(Req, IrradianceCommon::Defaults::SVFSamples);
-            Sensors[SensorIndex]->bSkyViewFactorValid = true;
+            if (Req.IsValid())
+                break;
+
+            PYRANO_ERR(TEXT("[Scheduler] Invalid request, cell left without result: %s"), *Req.ToString());
         }
-        Req.SkyViewFactor = Sensors[SensorIndex]->SkyViewFactor;
-        LaunchCapture(Req);
+        AdvanceSimulationCursor();
+        ++Launched;
+
+        if (!bCached)
+            break;
     }
-    else
+}
+
+
+void UIrradianceScheduler::AdvanceSimulationCursor()
+{
+    ++SensorIndex;
+    if (SensorIndex >= Sensors.Num())
     {
-        // No sensors left: advance or finish
-        AdvanceTimeSlotOrFinish();
+        // Last sensor in this slot -> move to the next slot
+        SensorIndex = 0;
+        ++TimeIndex;
     }
 }
 
 
-void UIrradianceScheduler::AdvanceTimeSlotOrFinish()
+bool UIrradianceScheduler::LaunchSimulationRetry()
 {
-    TimeIndex++;
-    if (TimeIndex < TimeSlots.Num())
+    if (RetryRequests.Num() == 0)
+        return true;
+
+    if (!Irr->CanStartCapture())
+        return false;
+
+    // Same sun as the first attempt; the cursor's slot is applied again when it resumes
+    const int32 Slot = GetResultSlot(RetryRequests[0]);
+    if (Slot != INDEX_NONE && AppliedSunTimeIndex != Slot)
     {
-        // Advance time slot
-        SetSunSkyUTC(TimeSlots[TimeIndex]); // new solar time
-        SensorIndex = 0;
-        State = ESchedulerState::Capturing;
-        LaunchNextSimulationCapture(BaseSimConfig);
+        ApplySunForSlot(Slot);
+        AppliedSunTimeIndex = Slot;
     }
-    else
+
+    if (LaunchCapture(RetryRequests[0]))
     {
-        // End of simulation
-        Irr->FlushExporter();
-        PYRANO_SUCCESS(TEXT("[Scheduler] Simulation completed (TimeSlots=%d, Sensors=%d)"),
-            TimeSlots.Num(), Sensors.Num());
-        RestoreViewport();
-        State = ESchedulerState::Idle;
-        Current.Reset();
+        RetryRequests.RemoveAt(0, 1, EAllowShrinking::No);
     }
+    return false;
 }
 
+
+void UIrradianceScheduler::FinishSimulationIfDrained()
+{
+    if (CapturesInFlight > 0)
+    {
+        if (Irr.IsValid())
+        {
+            Irr->FlushIntegrationBatch();   // nothing else will join the batch
+        }
+        return;
+    }
+
+    // End of simulation: nothing left to resume
+    Irr->FlushExporter();
+    Irr->SaveCaptureCache();
+    if (bCheckpointing)
+    {
+        IFileManager::Get().Delete(*CheckpointPath, false, false, true);
+        bCheckpointing = false;
+    }
+    PYRANO_SUCCESS(TEXT("[Scheduler] Simulation completed (TimeSlots=%d, Sensors=%d)"),
+        TimeSlots.Num(), Sensors.Num());
+    RestoreViewport();
+    State = ESchedulerState::Idle;
+}
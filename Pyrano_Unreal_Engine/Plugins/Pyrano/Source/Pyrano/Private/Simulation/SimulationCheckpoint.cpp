@@ -0,0 +1,95 @@
+﻿// SimulationCheckpoint.cpp
+
+#include "Simulation/SimulationCheckpoint.h"
+#include "Simulation/SimulationConfig.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/SecureHash.h"
+#include "UObject/PropertyPortFlags.h"
+#include "Logging/IrradianceLog.h"
+
+namespace
+{
+    const TCHAR* CheckpointHeader = TEXT("# pyrano-checkpoint v1");
+}
+
+
+FString FSimCheckpoint::GetPath(const FString& OutputDir, const FString& BaseName, const FString& ShardSuffix)
+{
+    return FPaths::Combine(OutputDir, BaseName + ShardSuffix + TEXT(".checkpoint"));
+}
+
+
+FString FSimCheckpoint::MakeConfigHash(const FSimConfig& Sim, TConstArrayView<FGuid> Sensors, int32 NumSlots)
+{
+    // Settings that change how the rows are produced, not their values
+    FSimConfig Key = Sim;
+    Key.OutputPath.Path.Empty();
+    Key.CapturePipelineDepth = 0;
+    Key.IntegrationBatchSize = 0;
+    Key.bOffscreenCapture = false;
+    Key.bExportImages = false;
+    Key.bArchiveImages = false;
+    Key.bCompressImages = false;
+
+    FString Text;
+    FSimConfig::StaticStruct()->ExportText(Text, &Key, nullptr, nullptr, PPF_None, nullptr);
+    Text += FString::Printf(TEXT("|slots=%d"), NumSlots);
+    for (const FGuid& Sensor : Sensors)
+    {
+        Text += TEXT("|") + Sensor.ToString();
+    }
+
+    FSHAHash Hash;
+    FSHA1::HashBuffer(*Text, Text.Len() * sizeof(TCHAR), Hash.Hash);
+    return Hash.ToString();
+}
+
+
+bool FSimCheckpoint::Save(const FString& Path) const
+{
+    TArray<FString> Lines;
+    Lines.Add(CheckpointHeader);
+    Lines.Add(FString::Printf(TEXT("config=%s"), *ConfigHash));
+    Lines.Add(FString::Printf(TEXT("csv=%s"), *CSVFile));
+    Lines.Add(FString::Printf(TEXT("csv_bytes=%lld"), CSVBytes));
+    Lines.Add(FString::Printf(TEXT("time_index=%d"), TimeIndex));
+    Lines.Add(FString::Printf(TEXT("sensor_index=%d"), SensorIndex));
+    Lines.Add(FString::Printf(TEXT("resumes=%d"), NumResumes));
+
+    // A crash mid-write leaves the previous checkpoint intact
+    const FString TempPath = Path + TEXT(".tmp");
+    if (!FFileHelper::SaveStringArrayToFile(Lines, *TempPath) || !IFileManager::Get().Move(*Path, *TempPath, /*Replace*/ true))
+    {
+        PYRANO_WARN(TEXT("[Checkpoint] Could not write: %s"), *Path);
+        return false;
+    }
+    return true;
+}
+
+
+bool FSimCheckpoint::Load(const FString& Path)
+{
+    *this = FSimCheckpoint();
+
+    TArray<FString> Lines;
+    if (!FFileHelper::LoadFileToStringArray(Lines, *Path) || Lines.Num() == 0 || Lines[0] != CheckpointHeader)
+        return false;
+
+    for (int32 i = 1; i < Lines.Num(); ++i)
+    {
+        FString Key, Value;
+        if (!Lines[i].Split(TEXT("="), &Key, &Value))
+            continue;
+
+        if      (Key == TEXT("config"))         ConfigHash = Value;
+        else if (Key == TEXT("csv"))            CSVFile = Value;
+        else if (Key == TEXT("csv_bytes"))      CSVBytes = FCString::Atoi64(*Value);
+        else if (Key == TEXT("time_index"))     TimeIndex = FCString::Atoi(*Value);
+        else if (Key == TEXT("sensor_index"))   SensorIndex = FCString::Atoi(*Value);
+        else if (Key == TEXT("resumes"))        NumResumes = FCString::Atoi(*Value);
+    }
+
+    return !ConfigHash.IsEmpty() && !CSVFile.IsEmpty() && CSVBytes > 0;
+}
@@ -0,0 +1,359 @@
+﻿// SimulationShard.cpp
+
+#include "Simulation/SimulationShard.h"
+#include "Simulation/SimulationConfig.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Logging/IrradianceLog.h"
+
+namespace
+{
+    const TCHAR* ManifestHeader = TEXT("# pyrano-shard v1");
+
+    /** Columns of a result row that identify it (see the CSV header of IrradianceResultWriter.cpp). */
+    constexpr int32 GuidColumn = 1;
+    constexpr int32 UTCColumn = 2;
+
+    /** [Begin, End) of block Block when Num items are split into NumBlocks balanced contiguous blocks. */
+    void GetBlock(int32 Num, int32 NumBlocks, int32 Block, int32& OutBegin, int32& OutEnd)
+    {
+        OutBegin = (int32)((int64)Num * Block / NumBlocks);
+        OutEnd = (int32)((int64)Num * (Block + 1) / NumBlocks);
+    }
+}
+
+
+// -----------------------------------------------------------------------------
+//  Shard
+// -----------------------------------------------------------------------------
+
+FSimShard FSimShard::Make(const FSimConfig& Sim, int32 NumSlots, int32 NumSensors)
+{
+    const int32 TimeShards = FMath::Max(1, Sim.TimeShards);
+    const int32 SensorShards = FMath::Max(1, Sim.SensorShards);
+
+    FSimShard Shard;
+    Shard.Count = TimeShards * SensorShards;
+    Shard.Index = FMath::Clamp(Sim.ShardIndex, 0, Shard.Count - 1);
+
+    GetBlock(NumSlots, TimeShards, Shard.Index / SensorShards, Shard.SlotBegin, Shard.SlotEnd);
+    GetBlock(NumSensors, SensorShards, Shard.Index % SensorShards, Shard.SensorBegin, Shard.SensorEnd);
+    return Shard;
+}
+
+
+FString FSimShard::MakeFileSuffix(int32 Index, int32 Count)
+{
+    return FString::Printf(TEXT("_shard%03dof%03d"), Index, Count);
+}
+
+
+// -----------------------------------------------------------------------------
+//  Manifest
+// -----------------------------------------------------------------------------
+
+FString FSimShardManifest::GetPath(const FString& CSVPathAbs)
+{
+    return FPaths::ChangeExtension(CSVPathAbs, TEXT(".shard"));
+}
+
+
+bool FSimShardManifest::Save(const FString& Path) const
+{
+    TArray<FString> Lines;
+    Lines.Reserve(Sensors.Num() + 16);
+    Lines.Add(ManifestHeader);
+    Lines.Add(FString::Printf(TEXT("shard=%d"), ShardIndex));
+    Lines.Add(FString::Printf(TEXT("count=%d"), ShardCount));
+    Lines.Add(FString::Printf(TEXT("time_shards=%d"), TimeShards));
+    Lines.Add(FString::Printf(TEXT("sensor_shards=%d"), SensorShards));
+    Lines.Add(FString::Printf(TEXT("start_ticks=%lld"), StartUTC.GetTicks()));
+    Lines.Add(FString::Printf(TEXT("end_ticks=%lld"), EndUTC.GetTicks()));
+    Lines.Add(FString::Printf(TEXT("step_ticks=%lld"), StepTicks));
+    Lines.Add(FString::Printf(TEXT("total_slots=%d"), TotalSlots));
+    Lines.Add(FString::Printf(TEXT("total_sensors=%d"), TotalSensors));
+    Lines.Add(FString::Printf(TEXT("slot_begin=%d"), SlotBegin));
+    Lines.Add(FString::Printf(TEXT("slot_end=%d"), SlotEnd));
+    Lines.Add(FString::Printf(TEXT("csv=%s"), *CSVFile));
+    for (const FGuid& Sensor : Sensors)
+    {
+        Lines.Add(FString::Printf(TEXT("sensor=%s"), *Sensor.ToString()));
+    }
+
+    if (!FFileHelper::SaveStringArrayToFile(Lines, *Path))
+    {
+        PYRANO_WARN(TEXT("[Shard] Could not write manifest: %s"), *Path);
+        return false;
+    }
+    return true;
+}
+
+
+bool FSimShardManifest::Load(const FString& Path)
+{
+    *this = FSimShardManifest();
+
+    TArray<FString> Lines;
+    if (!FFileHelper::LoadFileToStringArray(Lines, *Path) || Lines.Num() == 0 || Lines[0] != ManifestHeader)
+        return false;
+
+    for (int32 i = 1; i < Lines.Num(); ++i)
+    {
+        FString Key, Value;
+        if (!Lines[i].Split(TEXT("="), &Key, &Value))
+            continue;
+
+        if      (Key == TEXT("shard"))          ShardIndex = FCString::Atoi(*Value);
+        else if (Key == TEXT("count"))          ShardCount = FCString::Atoi(*Value);
+        else if (Key == TEXT("time_shards"))    TimeShards = FCString::Atoi(*Value);
+        else if (Key == TEXT("sensor_shards"))  SensorShards = FCString::Atoi(*Value);
+        else if (Key == TEXT("start_ticks"))    StartUTC = FDateTime(FCString::Atoi64(*Value));
+        else if (Key == TEXT("end_ticks"))      EndUTC = FDateTime(FCString::Atoi64(*Value));
+        else if (Key == TEXT("step_ticks"))     StepTicks = FCString::Atoi64(*Value);
+        else if (Key == TEXT("total_slots"))    TotalSlots = FCString::Atoi(*Value);
+        else if (Key == TEXT("total_sensors"))  TotalSensors = FCString::Atoi(*Value);
+        else if (Key == TEXT("slot_begin"))     SlotBegin = FCString::Atoi(*Value);
+        else if (Key == TEXT("slot_end"))       SlotEnd = FCString::Atoi(*Value);
+        else if (Key == TEXT("csv"))            CSVFile = Value;
+        else if (Key == TEXT("sensor"))
+        {
+            FGuid Guid;
+            if (FGuid::Parse(Value, Guid))
+            {
+                Sensors.Add(Guid);
+            }
+        }
+    }
+
+    return ShardCount > 0 && StepTicks > 0 && !CSVFile.IsEmpty();
+}
+
+
+bool FSimShardManifest::IsSameRun(const FSimShardManifest& Other) const
+{
+    return ShardCount == Other.ShardCount
+        && TimeShards == Other.TimeShards
+        && SensorShards == Other.SensorShards
+        && StartUTC == Other.StartUTC
+        && EndUTC == Other.EndUTC
+        && StepTicks == Other.StepTicks
+        && TotalSlots == Other.TotalSlots
+        && TotalSensors == Other.TotalSensors;
+}
+
+
+// -----------------------------------------------------------------------------
+//  Merge
+// -----------------------------------------------------------------------------
+
+bool PyranoShardMerge::MergeCSV(const FString& Dir, const FString& BaseName, const FString& OutCSVPath,
+    bool bAllowMissing, FSimShardMergeReport& OutReport)
+{
+    OutReport = FSimShardMergeReport();
+
+    // --- Manifests ---
+
+    TArray<FString> ManifestFiles;
+    IFileManager::Get().FindFiles(ManifestFiles, *FPaths::Combine(Dir, BaseName + TEXT("_shard*.shard")), true, false);
+    ManifestFiles.Sort();
+
+    TArray<FSimShardManifest> Manifests;
+    for (const FString& File : ManifestFiles)
+    {
+        FSimShardManifest& M = Manifests.AddDefaulted_GetRef();
+        if (!M.Load(FPaths::Combine(Dir, File)))
+        {
+            OutReport.Errors.Add(FString::Printf(TEXT("Unreadable manifest '%s'"), *File));
+            Manifests.Pop();
+        }
+    }
+
+    if (Manifests.Num() == 0)
+    {
+        OutReport.Errors.Add(FString::Printf(TEXT("No shard of '%s' in '%s'"), *BaseName, *Dir));
+        return false;
+    }
+
+    const FSimShardManifest& Run = Manifests[0];
+    TArray<const FSimShardManifest*> ByIndex;
+    ByIndex.SetNumZeroed(Run.ShardCount);
+    for (const FSimShardManifest& M : Manifests)
+    {
+        if (!M.IsSameRun(Run))
+        {
+            OutReport.Errors.Add(FString::Printf(TEXT("Shard %d belongs to another run (grid or split differs)"), M.ShardIndex));
+        }
+        else if (!ByIndex.IsValidIndex(M.ShardIndex))
+        {
+            OutReport.Errors.Add(FString::Printf(TEXT("Shard index %d out of range"), M.ShardIndex));
+        }
+        else if (ByIndex[M.ShardIndex])
+        {
+            OutReport.Errors.Add(FString::Printf(TEXT("Shard %d found twice"), M.ShardIndex));
+        }
+        else
+        {
+            ByIndex[M.ShardIndex] = &M;
+        }
+    }
+
+    for (int32 i = 0; i < ByIndex.Num(); ++i)
+    {
+        if (!ByIndex[i])
+        {
+            OutReport.Errors.Add(FString::Printf(TEXT("Shard %d of %d is missing"), i, Run.ShardCount));
+        }
+    }
+
+    if (OutReport.Errors.Num() > 0)
+        return false;
+
+    OutReport.NumShards = Run.ShardCount;
+
+    // --- Expected grid: cell = slot * TotalSensors + serial sensor index ---
+
+    TArray<FGuid> SerialSensors;
+    for (const FSimShardManifest* M : ByIndex)
+    {
+        for (const FGuid& Guid : M->Sensors)
+        {
+            SerialSensors.AddUnique(Guid);
+        }
+    }
+    SerialSensors.Sort();
+
+    if (SerialSensors.Num() != Run.TotalSensors)
+    {
+        OutReport.Errors.Add(FString::Printf(TEXT("Shards list %d sensors, the run had %d"), SerialSensors.Num(), Run.TotalSensors));
+        return false;
+    }
+
+    TMap<FGuid, int32> SensorOrder;
+    for (int32 i = 0; i < SerialSensors.Num(); ++i)
+    {
+        SensorOrder.Add(SerialSensors[i], i);
+    }
+
+    const int64 NumCells = (int64)Run.TotalSlots * Run.TotalSensors;
+    TBitArray<> Expected(false, (int32)NumCells);
+    for (const FSimShardManifest* M : ByIndex)
+    {
+        for (int32 Slot = M->SlotBegin; Slot < M->SlotEnd; ++Slot)
+        {
+            for (const FGuid& Guid : M->Sensors)
+            {
+                // A cell claimed twice is harmless: its rows de-duplicate below
+                Expected[Slot * Run.TotalSensors + SensorOrder[Guid]] = true;
+            }
+        }
+    }
+
+    OutReport.ExpectedRows = Expected.CountSetBits();
+    if (OutReport.ExpectedRows != NumCells)
+    {
+        OutReport.Errors.Add(FString::Printf(TEXT("Shards cover %d of %lld cells of the grid"), OutReport.ExpectedRows, NumCells));
+        return false;
+    }
+
+    // --- Rows ---
+
+    FString Header;
+    TMap<int32, FString> Rows;     // cell -> line (the last occurrence wins)
+    Rows.Reserve(OutReport.ExpectedRows);
+
+    for (const FSimShardManifest* M : ByIndex)
+    {
+        TArray<FString> Lines;
+        const FString CSVPath = FPaths::Combine(Dir, M->CSVFile);
+        if (!FFileHelper::LoadFileToStringArray(Lines, *CSVPath))
+        {
+            OutReport.Errors.Add(FString::Printf(TEXT("Shard %d: cannot read '%s'"), M->ShardIndex, *M->CSVFile));
+            continue;
+        }
+        if (Lines.Num() == 0)
+            continue;
+
+        if (Header.IsEmpty())
+        {
+            Header = Lines[0];
+        }
+        else if (Lines[0] != Header)
+        {
+            OutReport.Errors.Add(FString::Printf(TEXT("Shard %d: CSV columns differ"), M->ShardIndex));
+            continue;
+        }
+
+        TArray<FString> HeaderCols;
+        Header.ParseIntoArray(HeaderCols, TEXT(","), /*CullEmpty*/ false);
+
+        TSet<FGuid> ShardSensors(M->Sensors);
+        for (int32 i = 1; i < Lines.Num(); ++i)
+        {
+            TArray<FString> Cols;
+            Lines[i].ParseIntoArray(Cols, TEXT(","), /*CullEmpty*/ false);
+            if (Cols.Num() < HeaderCols.Num())
+                continue;   // truncated last line of an interrupted shard
+
+            // Sensor names are written verbatim and may contain commas: locate the id columns from the end
+            const int32 Offset = Cols.Num() - HeaderCols.Num();
+            FGuid Guid;
+            FDateTime UTC;
+            if (!FGuid::Parse(Cols[GuidColumn + Offset], Guid) || !FDateTime::ParseIso8601(*Cols[UTCColumn + Offset], UTC))
+            {
+                ++OutReport.UnexpectedRows;
+                continue;
+            }
+
+            const int64 SinceStart = (UTC - Run.StartUTC).GetTicks();
+            const int32 Slot = (SinceStart >= 0 && SinceStart % Run.StepTicks == 0) ? (int32)(SinceStart / Run.StepTicks) : INDEX_NONE;
+            const int32* SensorIdx = SensorOrder.Find(Guid);
+            if (!SensorIdx || Slot < M->SlotBegin || Slot >= M->SlotEnd || !ShardSensors.Contains(Guid))
+            {
+                ++OutReport.UnexpectedRows;
+                continue;
+            }
+
+            const int32 Cell = Slot * Run.TotalSensors + *SensorIdx;
+            if (Rows.Contains(Cell))
+            {
+                ++OutReport.DuplicateRows;
+            }
+            Rows.Add(Cell, MoveTemp(Lines[i]));
+        }
+    }
+
+    OutReport.MissingRows = OutReport.ExpectedRows - Rows.Num();
+    if (OutReport.Errors.Num() > 0 || Header.IsEmpty())
+        return false;
+
+    if (OutReport.MissingRows > 0 && !bAllowMissing)
+    {
+        OutReport.Errors.Add(FString::Printf(TEXT("%d of %d rows missing"), OutReport.MissingRows, OutReport.ExpectedRows));
+        return false;
+    }
+
+    // --- Output, serial order ---
+
+    Rows.KeySort(TLess<int32>());
+
+    TArray<FString> Out;
+    Out.Reserve(Rows.Num() + 1);
+    Out.Add(MoveTemp(Header));
+    for (TPair<int32, FString>& It : Rows)
+    {
+        Out.Add(MoveTemp(It.Value));
+    }
+
+    if (!FFileHelper::SaveStringArrayToFile(Out, *OutCSVPath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM))
+    {
+        OutReport.Errors.Add(FString::Printf(TEXT("Cannot write '%s'"), *OutCSVPath));
+        return false;
+    }
+
+    OutReport.RowsWritten = Out.Num() - 1;
+    PYRANO_INFO(TEXT("[Shard] Merged %d shard(s) into '%s': rows=%d, duplicates=%d, unexpected=%d, missing=%d"),
+        OutReport.NumShards, *OutCSVPath, OutReport.RowsWritten, OutReport.DuplicateRows,
+        OutReport.UnexpectedRows, OutReport.MissingRows);
+    return true;
+}
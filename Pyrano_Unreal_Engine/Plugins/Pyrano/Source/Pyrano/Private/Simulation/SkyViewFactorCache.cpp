@@ -0,0 +1,106 @@
+﻿// SkyViewFactorCache.cpp
+
+#include "Simulation/SkyViewFactorCache.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Logging/IrradianceLog.h"
+
+namespace
+{
+    const TCHAR* MapHeaderPrefix = TEXT("# map=");
+}
+
+
+FString FSkyViewFactorCache::GetDefaultPath()
+{
+    return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Pyrano"), TEXT("SkyViewFactorCache.csv"));
+}
+
+
+bool FSkyViewFactorCache::Load(const FString& Path, const FString& InMapName)
+{
+    MapName = InMapName;
+    Entries.Reset();
+
+    TArray<FString> Lines;
+    if (!FFileHelper::LoadFileToStringArray(Lines, *Path) || Lines.Num() == 0)
+        return false;
+
+    // Geometry of another map: nothing to reuse
+    if (Lines[0] != FString(MapHeaderPrefix) + MapName)
+    {
+        PYRANO_VERBOSE(TEXT("[SkyFactor] Cache belongs to another map, ignored (%s)"), *Lines[0]);
+        return false;
+    }
+
+    // Guid,PosX,PosY,PosZ,NX,NY,NZ,Samples,SVF
+    for (int32 i = 1; i < Lines.Num(); ++i)
+    {
+        TArray<FString> Cols;
+        Lines[i].ParseIntoArray(Cols, TEXT(","), /*CullEmpty*/ true);
+
+        FGuid Guid;
+        if (Cols.Num() != 9 || !FGuid::Parse(Cols[0], Guid))
+            continue;
+
+        FEntry E;
+        E.PosWS      = FVector(FCString::Atod(*Cols[1]), FCString::Atod(*Cols[2]), FCString::Atod(*Cols[3]));
+        E.NormalWS   = FVector(FCString::Atod(*Cols[4]), FCString::Atod(*Cols[5]), FCString::Atod(*Cols[6]));
+        E.NumSamples = FCString::Atoi(*Cols[7]);
+        E.SVF        = FCString::Atof(*Cols[8]);
+        Entries.Add(Guid, E);
+    }
+
+    PYRANO_VERBOSE(TEXT("[SkyFactor] Cache loaded: %d entries"), Entries.Num());
+    return true;
+}
+
+
+bool FSkyViewFactorCache::Save(const FString& Path) const
+{
+    TArray<FString> Lines;
+    Lines.Reserve(Entries.Num() + 1);
+    Lines.Add(FString(MapHeaderPrefix) + MapName);
+
+    for (const TPair<FGuid, FEntry>& It : Entries)
+    {
+        const FEntry& E = It.Value;
+        Lines.Add(FString::Printf(TEXT("%s,%.3f,%.3f,%.3f,%.6f,%.6f,%.6f,%d,%.6f"),
+            *It.Key.ToString(),
+            E.PosWS.X, E.PosWS.Y, E.PosWS.Z,
+            E.NormalWS.X, E.NormalWS.Y, E.NormalWS.Z,
+            E.NumSamples, E.SVF));
+    }
+
+    if (!FFileHelper::SaveStringArrayToFile(Lines, *Path))
+    {
+        PYRANO_WARN(TEXT("[SkyFactor] Could not write cache: %s"), *Path);
+        return false;
+    }
+    return true;
+}
+
+
+bool FSkyViewFactorCache::Find(const FGuid& SensorId, const FVector& PosWS, const FVector& NormalWS, int32 NumSamples, float& OutSVF) const
+{
+    const FEntry* E = Entries.Find(SensorId);
+    if (!E || E->NumSamples != NumSamples)
+        return false;
+
+    // Same tolerances as the horizon map (1 cm, ~0.06 deg)
+    if (!E->PosWS.Equals(PosWS, 1.0) || !E->NormalWS.Equals(NormalWS.GetSafeNormal(), 1e-3))
+        return false;
+
+    OutSVF = E->SVF;
+    return true;
+}
+
+
+void FSkyViewFactorCache::Store(const FGuid& SensorId, const FVector& PosWS, const FVector& NormalWS, int32 NumSamples, float SVF)
+{
+    FEntry& E = Entries.FindOrAdd(SensorId);
+    E.PosWS = PosWS;
+    E.NormalWS = NormalWS.GetSafeNormal();
+    E.NumSamples = NumSamples;
+    E.SVF = SVF;
+}
\ No newline at end of file
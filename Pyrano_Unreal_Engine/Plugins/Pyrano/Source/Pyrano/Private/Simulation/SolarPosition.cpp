@@ -0,0 +1,111 @@
+﻿// SolarPosition.cpp
+
+#include "Simulation/SolarPosition.h"
+
+// -----------------------------------------------------------------------------
+//  Constants
+// -----------------------------------------------------------------------------
+
+namespace
+{
+    constexpr double Rad = UE_DOUBLE_PI / 180.0;
+    constexpr double TwoPi = 2.0 * UE_DOUBLE_PI;
+
+    // Parallax: Earth mean radius / astronomical unit (km)
+    constexpr double EarthMeanRadiusKm = 6371.01;
+    constexpr double AstronomicalUnitKm = 149597890.0;
+}
+
+
+// -----------------------------------------------------------------------------
+//  Public API
+// -----------------------------------------------------------------------------
+
+FSolarAngles SolarPosition::Compute(const FDateTime& UTC, double LatitudeDeg, double LongitudeDeg)
+{
+    FSolarAngles Out;
+
+    // 1) Time: Julian day and days elapsed since J2000.0
+    const int64 Year = UTC.GetYear();
+    const int64 Month = UTC.GetMonth();
+    const int64 Day = UTC.GetDay();
+    const double DecimalHours = UTC.GetHour()
+        + (UTC.GetMinute() + (UTC.GetSecond() + UTC.GetMillisecond() / 1000.0) / 60.0) / 60.0;
+
+    // Integer divisions are intended (Fliegel - Van Flandern)
+    const int64 Aux1 = (Month - 14) / 12;
+    const int64 Aux2 = (1461 * (Year + 4800 + Aux1)) / 4
+        + (367 * (Month - 2 - 12 * Aux1)) / 12
+        - (3 * ((Year + 4900 + Aux1) / 100)) / 4
+        + Day - 32075;
+
+    const double JulianDate = double(Aux2) - 0.5 + DecimalHours / 24.0;
+    const double n = JulianDate - 2451545.0;
+
+    // 2) Ecliptic coordinates (rad)
+    const double Omega = 2.1429 - 0.0010394594 * n;
+    const double MeanLongitude = 4.8950630 + 0.017202791698 * n;
+    const double MeanAnomaly = 6.2400600 + 0.0172019699 * n;
+    const double EclipticLongitude = MeanLongitude
+        + 0.03341607 * FMath::Sin(MeanAnomaly)
+        + 0.00034894 * FMath::Sin(2.0 * MeanAnomaly)
+        - 0.0001134
+        - 0.0000203 * FMath::Sin(Omega);
+    const double EclipticObliquity = 0.4090928 - 6.2140e-9 * n + 0.0000396 * FMath::Cos(Omega);
+
+    // 3) Celestial coordinates: right ascension and declination
+    const double SinEclipticLongitude = FMath::Sin(EclipticLongitude);
+    double RightAscension = FMath::Atan2(FMath::Cos(EclipticObliquity) * SinEclipticLongitude, FMath::Cos(EclipticLongitude));
+    if (RightAscension < 0.0)
+    {
+        RightAscension += TwoPi;
+    }
+    const double Declination = FMath::Asin(FMath::Sin(EclipticObliquity) * SinEclipticLongitude);
+
+    // 4) Local coordinates: hour angle
+    const double GreenwichMeanSiderealTime = 6.6974243242 + 0.0657098283 * n + DecimalHours;
+    const double LocalMeanSiderealTime = (GreenwichMeanSiderealTime * 15.0 + LongitudeDeg) * Rad;
+    const double HourAngle = LocalMeanSiderealTime - RightAscension;
+
+    const double LatitudeRad = LatitudeDeg * Rad;
+    const double CosLatitude = FMath::Cos(LatitudeRad);
+    const double SinLatitude = FMath::Sin(LatitudeRad);
+    const double CosHourAngle = FMath::Cos(HourAngle);
+
+    // 5) Horizontal coordinates: zenith and azimuth
+    double Zenith = FMath::Acos(FMath::Clamp(
+        CosLatitude * CosHourAngle * FMath::Cos(Declination) + FMath::Sin(Declination) * SinLatitude,
+        -1.0, 1.0));
+
+    double Azimuth = FMath::Atan2(
+        -FMath::Sin(HourAngle),
+        FMath::Tan(Declination) * CosLatitude - SinLatitude * CosHourAngle);
+    if (Azimuth < 0.0)
+    {
+        Azimuth += TwoPi;
+    }
+
+    // Parallax correction (topocentric zenith)
+    Zenith += (EarthMeanRadiusKm / AstronomicalUnitKm) * FMath::Sin(Zenith);
+
+    Out.AzimuthDeg = Azimuth / Rad;
+    Out.AltitudeDeg = 90.0 - Zenith / Rad;
+    return Out;
+}
+
+
+FVector SolarPosition::DirectionFromAngles(double AzimuthDeg, double AltitudeDeg, double NorthOffsetDeg)
+{
+    // Inverse of SunAnglesFromDirection (SunSkyController.cpp)
+    const FVector Up(0.f, 0.f, 1.f);
+
+    const double NorthRad = NorthOffsetDeg * Rad;
+    const FVector North(FMath::Cos(NorthRad), FMath::Sin(NorthRad), 0.0);
+    const FVector East = Up ^ North;
+
+    const double AzRad = AzimuthDeg * Rad;
+    const double AltRad = AltitudeDeg * Rad;
+    const FVector Horizontal = North * FMath::Cos(AzRad) + East * FMath::Sin(AzRad);
+
+    return (Horizontal * FMath::Cos(AltRad) + Up * FMath::Sin(AltRad)).GetSafeNormal();
+}
\ No newline at end of file
@@ -16,7 +16,10 @@
 
 #include "Irradiance/IrradianceCommon.h"
 #include "Irradiance/IrradianceIntegrateCS.h"
+#include "Irradiance/IrradianceKernelTuner.h"
+#include "Irradiance/IrradianceCaptureRig.h"
 #include "Subsystems/SunSkyController.h"
+#include "Subsystems/PyranometerRegistry.h"
 #include "Logging/IrradianceLog.h"
 
 #include "Slate/SceneViewport.h"
@@ -36,24 +39,60 @@ void FCaptureContext::Begin(const FCaptureRequest& InRequest)
 	{
 		FixedFaceRots = IrradianceCommon::Utils::GenerateCubemapFaceQuats();
 	}
+
+	// Face plan: only the streamed integration handles culled / smaller faces.
+	// The SH projection needs the whole sphere at full resolution.
+	const bool bCull = IrradianceCommon::Settings::bCullCubemapFaces
+		&& IrradianceCommon::Settings::FaceIntegration == IrradianceCommon::EFaceIntegration::Streamed
+		&& Request.SHOrder == 0;
+	if (bCull)
+	{
+		FaceSidePx = IrradianceCommon::Utils::PlanCubemapFaces(Request.NormalWS, Request.SidePx);
+	}
+	else
+	{
+		for (int32& Side : FaceSidePx)
+		{
+			Side = Request.SidePx;
+		}
+	}
+
+	NumPlannedFaces = 0;
+	for (int32 i = 0; i < NumFaces; ++i)
+	{
+		NumPlannedFaces += FaceSidePx[i] > 0 ? 1 : 0;
+	}
+
+	// Start at the first rendered face
+	while (FaceIndex < NumFaces && FaceSidePx[FaceIndex] == 0)
+	{
+		++FaceIndex;
+	}
 }
 
 
 void FCaptureContext::Reset()
 {
 	Request = FCaptureRequest();
+	State = ECaptureState::Idle;
+	Sequence = 0;
+	Sun = FCaptureSunState();
+	RenderKey.Reset();
 	FaceIndex = 0;
 	FacesCollected = 0;
+	for (int32& Side : FaceSidePx)
+	{
+		Side = 0;
+	}
+	NumPlannedFaces = NumFaces;
+	bRigCapture = false;
 
 	// Release stored faces
 	for (TRefCountPtr<IPooledRenderTarget>& FaceRT : FaceRTs)
 	{
 		FaceRT.SafeRelease();
 	}
-
-	ExtractedIrradianceBuffer.SafeRelease();
-	IrradianceReadback.Reset();
-	bReadbackEnqueued = false;
+	Streamed.Reset();
 }
 
 
@@ -82,12 +121,15 @@ const FQuat& FCaptureContext::GetCurrentFaceRot() const { return FixedFaceRots[F
 bool FCaptureContext::HasMoreFaces() const { return FaceIndex >= 0 && FaceIndex < NumFaces; }
 
 
-bool FCaptureContext::IsLastFace() const { return FaceIndex >= 0 && FaceIndex == (NumFaces - 1); }
+bool FCaptureContext::IsLastFace() const { return FaceIndex >= 0 && FacesCollected == (NumPlannedFaces - 1); }
 
 
 int32 FCaptureContext::GetCurrentFaceIndex() const { return FaceIndex; }
 
 
+int32 FCaptureContext::GetCurrentFaceSidePx() const { return FaceSidePx[FaceIndex]; }
+
+
 void FCaptureContext::StoreFaceRT(TRefCountPtr<IPooledRenderTarget>&& InRT)
 {
 	check(FaceIndex >= 0 && FaceIndex < NumFaces);
@@ -96,7 +138,23 @@ void FCaptureContext::StoreFaceRT(TRefCountPtr<IPooledRenderTarget>&& InRT)
 }
 
 
-void FCaptureContext::AdvanceFace() { check(FaceIndex < NumFaces); ++FaceIndex; }
+void FCaptureContext::MarkFaceStreamed()
+{
+	check(FaceIndex >= 0 && FaceIndex < NumFaces);
+	++FacesCollected;
+}
+
+
+void FCaptureContext::AdvanceFace()
+{
+	check(FaceIndex < NumFaces);
+
+	// Culled faces are skipped
+	do
+	{
+		++FaceIndex;
+	} while (FaceIndex < NumFaces && FaceSidePx[FaceIndex] == 0);
+}
 
 
 void FCaptureContext::MarkFacesDone() { FaceIndex = INDEX_NONE; }
@@ -104,9 +162,13 @@ void FCaptureContext::MarkFacesDone() { FaceIndex = INDEX_NONE; }
 
 bool FCaptureContext::AreFacesReady() const
 {
-	if (FacesCollected != NumFaces)
+	if (FacesCollected != NumPlannedFaces)
 		return false;
 
+	// Streamed: the faces are already integrated and released
+	if (Streamed.IsValid())
+		return true;
+
 	for (int32 i = 0; i < NumFaces; ++i)
 	{
 		if (!FaceRTs[i].IsValid())
@@ -116,11 +178,11 @@ bool FCaptureContext::AreFacesReady() const
 }
 
 
-void FCaptureContext::GatherFaces(TRefCountPtr<IPooledRenderTarget> OutFaces[NumFaces]) const
+void FCaptureContext::GatherFaces(TArray<TRefCountPtr<IPooledRenderTarget>>& OutFaces) const
 {
 	for (int32 i = 0; i < NumFaces; ++i)
 	{
-		OutFaces[i] = FaceRTs[i];
+		OutFaces.Add(FaceRTs[i]);
 	}
 }
 
@@ -134,14 +196,19 @@ void FCaptureContext::ArmFace(FIrradianceViewExtension* VE) const
 	const uint32 Warmup = FMath::Max<uint32>(1, Request.WarmupFrames);
 	uint32 ExtraWarmup = 0;
 
-	if (IrradianceCommon::Defaults::bUsingCesium && FaceIndex == 0)
+	if (IrradianceCommon::Defaults::bUsingCesium && FacesCollected == 0)
 	{
 		ExtraWarmup = IrradianceCommon::Defaults::CesiumWarmupFrames;
 	}
 
 	const uint32 TotalWarmup = Warmup + ExtraWarmup;
-	const uint32 SidePx = Request.SidePx;
-	VE->ArmSingleShot(TotalWarmup, SidePx);
+	const uint32 SidePx = FaceSidePx[FaceIndex];
+
+	// Face atlas: the view extension resolves the face straight into the slot's slice
+	const int32 AtlasSlice = IrradianceCommon::Settings::FaceIntegration == IrradianceCommon::EFaceIntegration::FaceAtlas
+		? RingSlot * NumFaces + FaceIndex
+		: INDEX_NONE;
+	VE->ArmSingleShot(TotalWarmup, SidePx, AtlasSlice);
 }
 
 
@@ -154,6 +221,8 @@ void UIrradianceSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 	Super::Initialize(Collection);
 	ViewExt = FSceneViewExtensions::NewExtension<FIrradianceViewExtension>();
 	Exporter = nullptr;
+	SetPipelineDepth(IrradianceCommon::Defaults::CapturePipelineDepth);
+	SetIntegrationBatchSize(IrradianceCommon::Defaults::IntegrationBatchSize);
 	if (!ClearSky)
 	{
 		ClearSky = NewObject<UClearSkyService>(this);
@@ -167,6 +236,18 @@ void UIrradianceSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 
 void UIrradianceSubsystem::Deinitialize()
 {
+	CancelAllCaptures();
+	CancelSkyViewFactorPrepass();
+	if (CaptureRig.IsValid())
+	{
+		CaptureRig->Destroy();
+		CaptureRig.Reset();
+	}
+	if (Exporter)
+	{
+		Exporter->CloseCSV();
+	}
+	SaveCaptureCache();
 	Super::Deinitialize();
 	ViewExt.Reset();
 }
@@ -180,11 +261,11 @@ bool UIrradianceSubsystem::ShouldCreateSubsystem(UObject* Outer) const
 	if (!W) 
 		return false;
 
-	// Only in PIE Worlds
-	if (W->WorldType != EWorldType::PIE) 
+	// Only in PIE Worlds, or a standalone game (e.g. -game -RenderOffscreen with off-screen captures)
+	if (W->WorldType != EWorldType::PIE && W->WorldType != EWorldType::Game) 
 		return false;
 
-	// Only client PIE (not server)
+	// Only client / standalone (not server)
 	const ENetMode NM = W->GetNetMode();
 	return (NM == NM_Client || NM == NM_Standalone);
 }
@@ -235,6 +316,7 @@ bool UIrradianceSubsystem::ForceSquareViewportPIE(int32 SidePx)
 	{
 		PC->ConsoleCommand(TEXT("r.ScreenPercentage 100"), true);
 		PC->ConsoleCommand(TEXT("r.TemporalAA.Upsampling 0"), true);
+		AppliedScreenPercentage = 100;
 	}
 
 	bForcedRes = true;
@@ -265,6 +347,8 @@ void UIrradianceSubsystem::RestoreViewportPIE()
 		}
 	}
 
+	ApplyScreenPercentage(100);
+
 	bForcedRes = false;
 	PrevPIEWindow.Reset();
 	PrevViewportSize = FIntPoint::ZeroValue;
@@ -323,40 +407,188 @@ void UIrradianceSubsystem::EndHijackView()
  *      (3) GPU integration
  *      (4) Readback
  *      (5) Publishing
+ *      (6) Post-processing (worker tasks)
  *============================================================================*/
 
  //--- (0) State Machine --------------------------------------------------------
 
 void UIrradianceSubsystem::Tick(float DeltaTime)
 {
-	// State machine:
-	//  - Capturing: waiting for a face to be delivered by the view extension.
-	//  - WaitingReadback: GPU integration finished; request readback.
-	//  - Idle: no active capture.
+	// Per-slot state machine:
+	//  - Capturing: waiting for a face to be delivered by the view extension (one slot at most).
+	//  - PendingIntegration: all faces ready; waiting for the batch to be dispatched.
+	//  - WaitingReadback: GPU integration queued; the batch requests the readback.
+	//  - Idle: free slot.
+	// Finished slots are then published in submission order.
 
 	if (!ViewExt.IsValid())
 		return;
 
-	switch (State)
+	if (ActiveSlot != INDEX_NONE)
+	{
+		FCaptureContext& Active = *CaptureRing[ActiveSlot];
+		if (Active.bRigCapture)
+		{
+			TickRigCapturing(Active);
+		}
+		else
+		{
+			TickCapturing(Active);
+		}
+	}
+
+	TickIntegrationBatch();
+
+	for (const TSharedPtr<FIntegrationBatch, ESPMode::ThreadSafe>& Batch : BatchesInFlight)
+	{
+		TickReadback(Batch);
+	}
+
+	CollectFinishedBatches();
+	PublishFinishedCaptures();
+
+	if (Exporter)
+	{
+		Exporter->TickImageReadbacks();
+	}
+}
+
+
+ //--- Pipeline slots -----------------------------------------------------------
+
+void UIrradianceSubsystem::SetPipelineDepth(int32 InDepth)
+{
+	const int32 Depth = FMath::Max(1, InDepth);
+	if (Depth == CaptureRing.Num())
+		return;
+
+	if (PublishOrder.Num() > 0)
+	{
+		PYRANO_WARN(TEXT("[Subsystem] Pipeline depth change ignored: %d capture(s) in flight"), PublishOrder.Num());
+		return;
+	}
+
+	CaptureRing.Reset();
+	CaptureRing.Reserve(Depth);
+	for (int32 i = 0; i < Depth; ++i)
+	{
+		CaptureRing.Add(MakeUnique<FCaptureContext>());
+		CaptureRing.Last()->RingSlot = i;
+	}
+
+	if (ViewExt.IsValid() && IrradianceCommon::Settings::FaceIntegration == IrradianceCommon::EFaceIntegration::FaceAtlas)
+	{
+		ViewExt->SetFaceAtlasSlices(Depth * FCaptureContext::NumFaces);
+	}
+
+	PYRANO_VERBOSE(TEXT("[Subsystem] Pipeline depth set to %d"), Depth);
+}
+
+
+void UIrradianceSubsystem::SetIntegrationBatchSize(int32 InBatchSize)
+{
+	IntegrationBatchSize = FMath::Clamp(InBatchSize, 1, IrradianceCompute::MaxBatchCaptures);
+
+	if (IntegrationBatchSize > CaptureRing.Num())
+	{
+		PYRANO_VERBOSE(TEXT("[Subsystem] Integration batch size %d is capped by pipeline depth %d"),
+			IntegrationBatchSize, CaptureRing.Num());
+	}
+}
+
+
+bool UIrradianceSubsystem::CanStartCapture() const
+{
+	return ActiveSlot == INDEX_NONE && FindFreeSlot() != INDEX_NONE;
+}
+
+
+int32 UIrradianceSubsystem::GetNumCapturesInFlight() const
+{
+	return PublishOrder.Num() + CompletedResults.Num();
+}
+
+
+int32 UIrradianceSubsystem::FindFreeSlot() const
+{
+	for (int32 i = 0; i < CaptureRing.Num(); ++i)
+	{
+		if (CaptureRing[i]->State == ECaptureState::Idle)
+			return i;
+	}
+	return INDEX_NONE;
+}
+
+
+void UIrradianceSubsystem::CancelAllCaptures()
+{
+	// Let pending render commands finish before dropping their batches
+	if (BatchesInFlight.Num() > 0)
+	{
+		FlushRenderingCommands();
+	}
+
+	for (TUniquePtr<FCaptureContext>& Slot : CaptureRing)
+	{
+		Slot->Reset();
+	}
+
+	if (ViewExt.IsValid())
+	{
+		TRefCountPtr<IPooledRenderTarget> Dropped;
+		FIntPoint DroppedSize;
+		ViewExt->TryConsumeCapturedSceneRT(Dropped, DroppedSize);
+	}
+
+	// Running post-processing tasks own their job: dropping ours discards their results
+	ActiveSlot = INDEX_NONE;
+	ApplyScreenPercentage(100);
+	if (CaptureRig.IsValid())
+	{
+		CaptureRig->CancelCapture();
+	}
+	PublishOrder.Reset();
+	PostProcessJobs.Reset();
+	CompletedResults.Reset();
+	PendingBatch.Reset();
+	PendingBatchIdleTicks = 0;
+	BatchesInFlight.Reset();
+}
+
+
+FCaptureSunState UIrradianceSubsystem::SnapshotSunState() const
+{
+	FCaptureSunState Sun;
+
+	UWorld* W = GetWorld();
+	USunSkyController* SunController = W ? W->GetSubsystem<USunSkyController>() : nullptr;
+	if (!SunController)
 	{
-	case ECaptureState::Idle:
-		// nothing to do
-		break;
+		PYRANO_WARN(TEXT("[Irradiance] SunSkyController subsystem not found"));
+		return Sun;
+	}
 
-	case ECaptureState::Capturing:
-		TickCapturing();
-		break;
+	if (!SunController->GetSolarAngles(Sun.AzimuthDeg, Sun.AltitudeDeg))
+	{
+		PYRANO_WARN(TEXT("[SunSky] SunSkyController could not provide solar angles"));
+		return Sun;
+	}
 
-	case ECaptureState::WaitingReadback:
-		TickReadback();
-		break;
+	// SunSky light, or any directional light when the native ephemeris runs without a SunSky
+	if (UDirectionalLightComponent* SunLightComp = SunController->FindSunLight())
+	{
+		Sun.IlluminanceLux = SunLightComp->Intensity;
+		Sun.ToSunDir = (-SunLightComp->GetForwardVector()).GetSafeNormal();
 	}
+
+	Sun.bValid = true;
+	return Sun;
 }
 
 
  //--- (1) Begin capture --------------------------------------------------------
 
-void UIrradianceSubsystem::StartSixFaceCapture(const FCaptureRequest& Req)
+bool UIrradianceSubsystem::StartSixFaceCapture(const FCaptureRequest& Req)
 {
 	// Begins a full 6-face cubemap capture using the parameters in Req.
 	// This only triggers the pipeline; the actual capture happens asynchronously
@@ -365,16 +597,76 @@ void UIrradianceSubsystem::StartSixFaceCapture(const FCaptureRequest& Req)
 	if (!Req.IsValid())
 	{
 		PYRANO_WARN(TEXT("[Subsystem] FCaptureRequest invalid (SidePx<=0 or NormalWS not normalized)"));
-		return;
+		return false;
+	}
+
+	if (!CanStartCapture())
+	{
+		PYRANO_WARN(TEXT("[Subsystem] Capture rejected: pipeline busy (InFlight=%d, Depth=%d)"),
+			PublishOrder.Num(), CaptureRing.Num());
+		return false;
 	}
 
+	const int32 SlotIdx = FindFreeSlot();
+	FCaptureContext& Capture = *CaptureRing[SlotIdx];
+
 	Capture.Begin(Req);
-	StartFaceCapture(Capture.GetPosWS(), Capture.GetCurrentFaceRot());
-	State = ECaptureState::Capturing;
+	Capture.Sequence = NextSequence++;
+	Capture.Sun = SnapshotSunState();
+	Capture.State = ECaptureState::Capturing;
+
+	// Settings may change while the capture is in flight: the result is cached under these
+	if (bCaptureCacheEnabled)
+	{
+		Capture.RenderKey = MakeCaptureRenderKey();
+	}
+
+	ActiveSlot = SlotIdx;
+	PublishOrder.Add(Req.RequestId);
+
+	// Raster: all faces in this frame. Path tracing (or a rig failure): one face per frame through the view.
+	Capture.bRigCapture = UsesCaptureRig() && StartRigCapture(Capture);
+	if (!Capture.bRigCapture)
+	{
+		StartFaceCapture(Capture, Capture.GetPosWS(), Capture.GetCurrentFaceRot());
+	}
+	return true;
+}
+
+
+void UIrradianceSubsystem::SubmitResolvedCapture(const FCaptureRequest& Req, const FCaptureSunState& Sun)
+{
+	FCaptureResult Result;
+	Result.Request = Req;
+	Result.Sun = Sun;
+	Result.bCaptured = false;
+
+	PublishOrder.Add(Req.RequestId);
+	LaunchPostProcess(MoveTemp(Result));
+}
+
+
+bool UIrradianceSubsystem::SubmitCachedCapture(const FCaptureRequest& Req)
+{
+	// The cache only keeps the integrated value, not the SH projection
+	if (!bCaptureCacheEnabled || !Req.IsValid() || Req.SHOrder > 0)
+		return false;
+
+	FCaptureResult Result;
+	Result.Request = Req;
+	Result.Sun = SnapshotSunState();
+
+	const FSHAHash Key = FCaptureResultCache::MakeKey(CaptureCacheSceneHash, MakeCaptureRenderKey(), Req, Result.Sun);
+	if (!CaptureCache.Find(Key, Result.RawRGBM))
+		return false;
+
+	PublishOrder.Add(Req.RequestId);
+	LaunchPostProcess(MoveTemp(Result));
+	return true;
 }
 
 
-void UIrradianceSubsystem::StartFaceCapture(const FVector& PosWS, const FQuat& RotWS)
+void UIrradianceSubsystem::StartFaceCapture(FCaptureContext& Capture, const FVector& PosWS, const FQuat& RotWS)
 {
 	EnsureCaptureCamera();
 	if (!CaptureCam.IsValid()) 
@@ -393,18 +685,82 @@ void UIrradianceSubsystem::StartFaceCapture(const FVector& PosWS, const FQuat& R
 		PC->SetViewTarget(CaptureCam.Get());
 	}
 
+	// Grazing faces: the view itself renders fewer pixels, not only the resolve
+	const int32 SidePx = FMath::Max(1, Capture.GetSidePx());
+	ApplyScreenPercentage(FMath::RoundToInt(100.f * Capture.GetCurrentFaceSidePx() / SidePx));
+
 	Capture.ArmFace(ViewExt.Get());
 }
 
 
+bool UIrradianceSubsystem::UsesCaptureRig() const
+{
+	// The face atlas is filled by the view extension, so it stays on the hijacked view
+	if (IrradianceCommon::Settings::FaceIntegration == IrradianceCommon::EFaceIntegration::FaceAtlas)
+		return false;
+
+	return bOffscreenCapture || (IrradianceCommon::Settings::bRasterCaptureRig && !bPathTracing);
+}
+
+
+void UIrradianceSubsystem::SetOffscreenCapture(bool bInOffscreen)
+{
+	bOffscreenCapture = bInOffscreen;
+
+	if (bOffscreenCapture && IrradianceCommon::Settings::FaceIntegration == IrradianceCommon::EFaceIntegration::FaceAtlas)
+	{
+		PYRANO_WARN(TEXT("[Subsystem] Off-screen capture needs the streamed or faces array integration: capturing through the view"));
+	}
+}
+
+
+bool UIrradianceSubsystem::StartRigCapture(FCaptureContext& Capture)
+{
+	if (!CaptureRig.IsValid())
+	{
+		CaptureRig = MakeShared<FIrradianceCaptureRig>();
+	}
+
+	if (!CaptureRig->Ensure(IrradianceCommon::Utils::GetGameWorldSafe(), Capture.FixedFaceRots))
+	{
+		PYRANO_WARN(TEXT("[Subsystem] Capture rig not available, capturing through the view"));
+		return false;
+	}
+
+	// The rig does not use the player view: give it back if a previous capture took it
+	if (bIsHijacked)
+	{
+		EndHijackView();
+	}
+
+	// Path tracing accumulates WarmupFrames passes per face (same sample budget as the hijacked view)
+	const int32 NumFrames = bPathTracing ? FMath::Max<int32>(1, Capture.GetWarmup()) : 1;
+	return CaptureRig->CaptureFaces(Capture.GetPosWS(), Capture.FaceSidePx, NumFrames, bPathTracing);
+}
+
+
+void UIrradianceSubsystem::ApplyScreenPercentage(int32 Percent)
+{
+	if (Percent == AppliedScreenPercentage)
+		return;
+
+	if (APlayerController* PC = UGameplayStatics::GetPlayerController(IrradianceCommon::Utils::GetGameWorldSafe(), 0))
+	{
+		PC->ConsoleCommand(FString::Printf(TEXT("r.ScreenPercentage %d"), Percent), true);
+		AppliedScreenPercentage = Percent;
+	}
+}
+
+
 //--- (2) Per-face capture ------------------------------------------------------
 
-void UIrradianceSubsystem::TickCapturing()
+void UIrradianceSubsystem::TickCapturing(FCaptureContext& Capture)
 {
 
 	// Called when the view extension produces a new captured RT (one face).
-	// Stores the RT, exports it if requested, and advances to the next face.
-	// When all 6 faces are collected, the pipeline proceeds to GPU integration.
+	// Collects it and advances to the next face.
+	// When all faces are collected, the capture joins the integration batch
+	// and the view is released for the next capture.
 
 	TRefCountPtr<IPooledRenderTarget> Extracted;
 	FIntPoint CaptSize;
@@ -419,416 +775,852 @@ void UIrradianceSubsystem::TickCapturing()
 		return;
 	}
 
-	Capture.StoreFaceRT(MoveTemp(Extracted));
-	PYRANO_VERBOSE(TEXT("[Subsystem] Face %d saved (%dx%d). Collected=%d/6"),
-		Slot, CaptSize.X, CaptSize.Y, Capture.FacesCollected);
-
-	if (Exporter && ExportOptions.bExportImages)
-	{
-		Exporter->EnqueueFaceEXR(Capture.Request, Slot, Capture.FaceRTs[Slot], CaptSize);
-	}
+	CollectFace(Capture, MoveTemp(Extracted), CaptSize);
 
 	Capture.AdvanceFace();
 	if (Capture.HasMoreFaces())
 	{
-		StartFaceCapture(Capture.GetPosWS(), Capture.GetCurrentFaceRot());
+		StartFaceCapture(Capture, Capture.GetPosWS(), Capture.GetCurrentFaceRot());
 		return;
 	}
 
-	Capture.MarkFacesDone();
-	ComputeFinalIrradiance();
-	State = ECaptureState::WaitingReadback;
+	FinishCapturing(Capture);
 }
 
 
-//--- (3) GPU integration -------------------------------------------------------
-
-void UIrradianceSubsystem::ComputeFinalIrradiance()
+void UIrradianceSubsystem::TickRigCapturing(FCaptureContext& Capture)
 {
-	if (!Capture.AreFacesReady())
-	{
-		PYRANO_ERR(TEXT("[Subsystem] Could not compute 6 faces, only %d available"), Capture.FacesCollected);
+	// The rig renders every planned face at once (path tracing: one pass per frame):
+	// once the RT has copied them out, they are all collected in this tick. A missing
+	// face leaves the capture incomplete, which publishes a zero result at integration.
+
+	if (!CaptureRig.IsValid())
 		return;
-	}
 
-	// IMPORTANT: capture by value so that TRefCountPtr keeps the textures alive
-	TRefCountPtr<IPooledRenderTarget> LocalFaces[FCaptureContext::NumFaces];  // local var to use in the lambda
-	Capture.GatherFaces(LocalFaces);
+	CaptureRig->Tick();
 
-	const int32 Size = Capture.GetSidePx();
-	const FVector3f Normal = FVector3f(Capture.GetNormalWS());
+	FIrradianceCaptureRig::FFaceRTs Faces;
+	if (!CaptureRig->ConsumeFaces(Faces))
+		return;
 
-	ENQUEUE_RENDER_COMMAND(ComputeIrradianceFromFaces)(
-		[this, LocalFaces, Size, Normal](FRHICommandListImmediate& RHICmdList) mutable
+	for (; Capture.HasMoreFaces(); Capture.AdvanceFace())
+	{
+		TRefCountPtr<IPooledRenderTarget>& FaceRT = Faces[Capture.GetCurrentFaceIndex()];
+		if (!FaceRT.IsValid())
 		{
-			FRDGBuilder GraphBuilder(RHICmdList);
-
-			PYRANO_VERBOSE(TEXT("[Subsystem] Executing compute shader with Normal=%s, Size=%d"),
-				*Normal.ToString(), Size);
-
-			for (int32 i = 0; i < FCaptureContext::NumFaces; ++i)
-			{
-				if (!LocalFaces[i].IsValid())
-				{
-					PYRANO_ERR(TEXT("[Subsystem] Face %d is not valid on Render Thread"), i);
-					return;
-				}
-			}
-
-			// The faces will be registered as external within BuildFacesArray
-			// using GraphBuilder.RegisterExternalTexture()
-			TRefCountPtr<FRDGPooledBuffer>* ExtractTarget = &this->Capture.ExtractedIrradianceBuffer;
-			IrradianceCompute::ComputeAndExtractIrradiance(
-				GraphBuilder,
-				LocalFaces,
-				Size,
-				Normal,
-				ExtractTarget);
-			GraphBuilder.Execute();
+			PYRANO_WARN(TEXT("[Subsystem] Rig face %d missing"), Capture.GetCurrentFaceIndex());
+			continue;
+		}
 
-			PYRANO_VERBOSE(TEXT("[Subsystem] Compute shader executed, preparing readback..."));
-		});
+		const FIntPoint FaceSize = FaceRT->GetDesc().Extent;
+		CollectFace(Capture, MoveTemp(FaceRT), FaceSize);
+	}
 
-	Capture.bReadbackEnqueued = true;
+	FinishCapturing(Capture);
 }
 
 
-//--- (4) Readback from GPU -----------------------------------------------------
-
-void UIrradianceSubsystem::TickReadback()
+void UIrradianceSubsystem::CollectFace(FCaptureContext& Capture, TRefCountPtr<IPooledRenderTarget>&& FaceRT, const FIntPoint& FaceSize)
 {
-	if (Capture.NeedsReadbackEnqueue())
+	// Exports the face if requested, then either integrates it right away
+	// (streamed: only the face being integrated stays resident) or stores it for the batch.
+
+	const int32 Slot = Capture.GetCurrentFaceIndex();
+
+	if (Exporter && ExportOptions.bExportImages)
 	{
-		EnqueueReadbackCopy();
+		const bool bAtlas = IrradianceCommon::Settings::FaceIntegration == IrradianceCommon::EFaceIntegration::FaceAtlas;
+		const int32 SourceSlice = bAtlas && !Capture.bRigCapture ? Capture.RingSlot * FCaptureContext::NumFaces + Slot : 0;
+		Exporter->EnqueueFaceImage(Capture.Request, Slot, FaceRT, FaceSize, SourceSlice);
 	}
 
-	if (Capture.HasActiveReadback())
+	if (IrradianceCommon::Settings::FaceIntegration == IrradianceCommon::EFaceIntegration::Streamed)
 	{
-		EnqueueReadbackPolling();
+		IntegrateStreamedFace(Capture, Slot, MoveTemp(FaceRT));
 	}
+	else
+	{
+		Capture.StoreFaceRT(MoveTemp(FaceRT));
+	}
+	PYRANO_VERBOSE(TEXT("[Subsystem] Face %d saved (%dx%d). Collected=%d/%d"),
+		Slot, FaceSize.X, FaceSize.Y, Capture.FacesCollected, Capture.NumPlannedFaces);
+}
+
+
+void UIrradianceSubsystem::FinishCapturing(FCaptureContext& Capture)
+{
+	Capture.MarkFacesDone();
+	Capture.State = ECaptureState::PendingIntegration;
+
+	const int32 SlotIdx = ActiveSlot;
+	ActiveSlot = INDEX_NONE;
+	AddToIntegrationBatch(SlotIdx);
 }
 
 
-void UIrradianceSubsystem::EnqueueReadbackCopy()
+//--- (3) GPU integration -------------------------------------------------------
+
+void UIrradianceSubsystem::IntegrateStreamedFace(FCaptureContext& Capture, int32 Face, TRefCountPtr<IPooledRenderTarget>&& FaceRT)
 {
-	// Copy buffer to a local variable for RT
-	TRefCountPtr<FRDGPooledBuffer> LocalBuf = Capture.ExtractedIrradianceBuffer;
+	if (!Capture.Streamed.IsValid())
+	{
+		Capture.Streamed = MakeShared<FStreamedIntegration, ESPMode::ThreadSafe>();
+	}
 
-	ENQUEUE_RENDER_COMMAND(EnqueueIrradianceReadback)(
-		[this, LocalBuf](FRHICommandListImmediate& RHICmdList)
+	ENQUEUE_RENDER_COMMAND(IntegrateIrradianceFace)(
+		[Streamed = Capture.Streamed, FaceRT = MoveTemp(FaceRT), Face, Size = Capture.GetSidePx(),
+		 FaceSidePx = Capture.FaceSidePx, Normal = FVector3f(Capture.GetNormalWS()),
+		 SHOrder = Capture.Request.SHOrder](FRHICommandListImmediate& RHICmdList)
 		{
-			if (!Capture.IrradianceReadback)
+			// First face at this size: benchmark the kernels (the winner serves later captures)
+			FIrradianceKernelTuner::Get().EnsureTuned(RHICmdList, Size);
+
+			FRDGBuilder GraphBuilder(RHICmdList);
+			if (!IrradianceCompute::AccumulateFace(GraphBuilder, FaceRT, Face, Size, FaceSidePx, Normal,
+				Streamed->KernelConfig, Streamed->PartialSums, Streamed->DoneCounter, Streamed->Result))
 			{
-				Capture.IrradianceReadback = MakeUnique<FRHIGPUBufferReadback>(TEXT("IrradianceReadback"));
+				Streamed->bFailed = true;
 			}
-
-			FRHIBuffer* RHIBuf = LocalBuf->GetRHI();
-			if (!RHIBuf)
+			if (SHOrder > 0)
 			{
-				PYRANO_WARN(TEXT("[Subsystem] RHIBuffer not valid for readback"));
-				return;
+				IrradianceCompute::ProjectFaceSH(GraphBuilder, FaceRT, Face, SHOrder, Streamed->SH);
 			}
+			GraphBuilder.Execute();
 
-			// Async buffer copy (1 float)
-			Capture.IrradianceReadback->EnqueueCopy(RHICmdList, RHIBuf);
-			PYRANO_VERBOSE(TEXT("[Subsystem] Readback enqueued (1 float)"));
+			// The face goes back to the pool with this lambda
 		});
+
+	Capture.MarkFaceStreamed();
 }
 
 
-void UIrradianceSubsystem::EnqueueReadbackPolling()
+void UIrradianceSubsystem::AddToIntegrationBatch(int32 SlotIdx)
 {
-	ENQUEUE_RENDER_COMMAND(ReadIrradianceIfReady)(
-		[this](FRHICommandListImmediate& RHICmdList)
-		{
-			if (!Capture.IrradianceReadback)
-				return;
-
-			if (!Capture.IrradianceReadback->IsReady())
-				return;
+	// All captures in a batch share the faces array and the SH readback layout:
+	// a new size (or face atlas, or SH order) starts a new batch
+	const bool bAtlas = IrradianceCommon::Settings::FaceIntegration == IrradianceCommon::EFaceIntegration::FaceAtlas;
+	if (PendingBatch.Num() > 0 &&
+		(CaptureRing[PendingBatch[0]]->GetSidePx() != CaptureRing[SlotIdx]->GetSidePx() ||
+		 CaptureRing[PendingBatch[0]]->Request.SHOrder != CaptureRing[SlotIdx]->Request.SHOrder ||
+		 (bAtlas && CaptureRing[PendingBatch[0]]->FaceRTs[0] != CaptureRing[SlotIdx]->FaceRTs[0])))
+	{
+		FlushIntegrationBatch();
+	}
 
-			// Read 4 float
-			const void* Ptr = Capture.IrradianceReadback->Lock(sizeof(FVector4f));
-			FVector4f Value(0, 0, 0, 0);
-			if (Ptr)
-			{
-				FMemory::Memcpy(&Value, Ptr, sizeof(FVector4f));
-			}
+	PendingBatch.Add(SlotIdx);
+	PendingBatchIdleTicks = 0;
 
-			Capture.IrradianceReadback->Unlock();
+	if (PendingBatch.Num() >= IntegrationBatchSize)
+	{
+		FlushIntegrationBatch();
+	}
+}
 
-			// Public result to GT using atomics
-			LastIrradianceR.store(Value.X, std::memory_order_relaxed);
-			LastIrradianceG.store(Value.Y, std::memory_order_relaxed);
-			LastIrradianceB.store(Value.Z, std::memory_order_relaxed);
-			LastIrradianceMean.store(Value.W, std::memory_order_relaxed);
 
-			bIrradianceValueReady.store(true, std::memory_order_release);
+void UIrradianceSubsystem::TickIntegrationBatch()
+{
+	if (PendingBatch.Num() == 0)
+		return;
 
-			// Clean GPU resources
-			Capture.IrradianceReadback.Reset();
-			Capture.ExtractedIrradianceBuffer.SafeRelease();
-			Capture.bReadbackEnqueued = false;
+	// A capture is rendering faces: it will join this batch
+	if (ActiveSlot != INDEX_NONE)
+	{
+		PendingBatchIdleTicks = 0;
+		return;
+	}
 
-			PYRANO_VERBOSE(TEXT("[Irradiance] Readback completed in RT: %.6f"), Value.W);
-		});
+	// Ring full: nothing else can join until this batch completes
+	if (FindFreeSlot() == INDEX_NONE)
+	{
+		FlushIntegrationBatch();
+		return;
+	}
+
+	// Give the caller one tick to start the next capture, then stop waiting
+	if (++PendingBatchIdleTicks > 1)
+	{
+		FlushIntegrationBatch();
+	}
 }
 
 
-//--- (5) Publish irradiance result ---------------------------------------------
+void UIrradianceSubsystem::FlushIntegrationBatch()
+{
+	if (PendingBatch.Num() == 0)
+		return;
+
+	ComputeFinalIrradiance();
+	PendingBatch.Reset();
+	PendingBatchIdleTicks = 0;
+}
 
 
-bool UIrradianceSubsystem::ConsumeLatestIrradiance(float& OutValue, float MinSunAltitude)
+void UIrradianceSubsystem::ComputeFinalIrradiance()
 {
-	if (!bIrradianceValueReady.exchange(false, std::memory_order_acq_rel))
-		return false;
+	TSharedPtr<FIntegrationBatch, ESPMode::ThreadSafe> Batch = MakeShared<FIntegrationBatch, ESPMode::ThreadSafe>();
 
-	float IrrMean = LastIrradianceMean.load(std::memory_order_relaxed);
-	float IrrR = LastIrradianceR.load(std::memory_order_relaxed);
-	float IrrG = LastIrradianceG.load(std::memory_order_relaxed);
-	float IrrB = LastIrradianceB.load(std::memory_order_relaxed);
+	// IMPORTANT: capture by value so that TRefCountPtr keeps the textures alive
+	TArray<TRefCountPtr<IPooledRenderTarget>> LocalFaces;	// 6 faces per capture, capture-major
+	TArray<FVector3f> LocalNormals;
+	TArray<TSharedPtr<FStreamedIntegration, ESPMode::ThreadSafe>> LocalStreamed;	// streamed: one per capture
+	TRefCountPtr<IPooledRenderTarget> LocalAtlas;	// face atlas: shared by the whole batch
+	TArray<int32> LocalAtlasSlots;
+	LocalFaces.Reserve(PendingBatch.Num() * FCaptureContext::NumFaces);
+	LocalNormals.Reserve(PendingBatch.Num());
+
+	for (const int32 SlotIdx : PendingBatch)
+	{
+		FCaptureContext& Capture = *CaptureRing[SlotIdx];
+		Capture.State = ECaptureState::WaitingReadback;
 
-	float AmbientIrradiance = IrrMean * IrradianceCommon::Defaults::AmbientIrradianceScale;
-	float TotalIrradiance = IrrMean;
+		if (!Capture.AreFacesReady())
+		{
+			// Publish a failed result so later slots are not blocked
+			PYRANO_ERR(TEXT("[Subsystem] Could not compute %d faces, only %d available"), Capture.NumPlannedFaces, Capture.FacesCollected);
+
+			FCaptureResult Result;
+			Result.Request = Capture.GetRequest();
+			Result.Sun = Capture.Sun;
+			Result.bFailed = true;
+			Capture.Reset();
+			LaunchPostProcess(MoveTemp(Result));
+			continue;
+		}
 
-	float DirectIrradiance = 0.0f;
-	float GeometricFactor = 0.0f;
+		LocalNormals.Add(FVector3f(Capture.GetNormalWS()));
+		Batch->Slots.Add(SlotIdx);
 
-	float AzDeg = 0.f;
-	float AltDeg = 0.f;
+		// Streamed: only the reduce is left
+		if (Capture.Streamed.IsValid())
+		{
+			LocalStreamed.Add(MoveTemp(Capture.Streamed));
+			continue;
+		}
 
-	int32 SunOccluded = -1;
-	float SunHitDistanceM = -1.0f;
-	float SunVisibility = 0.0f;
+		// Face atlas: faces are read in place from the capture's slot
+		if (IrradianceCommon::Settings::FaceIntegration == IrradianceCommon::EFaceIntegration::FaceAtlas)
+		{
+			LocalAtlas = Capture.FaceRTs[0];
+			LocalAtlasSlots.Add(Capture.RingSlot);
+		}
+		else
+		{
+			Capture.GatherFaces(LocalFaces);
+		}
 
-	FPyranoClearSkyIrradiance ClearSkyRef; 
+		// Faces are no longer needed on the game thread; the lambda keeps them alive
+		for (TRefCountPtr<IPooledRenderTarget>& FaceRT : Capture.FaceRTs)
+		{
+			FaceRT.SafeRelease();
+		}
+	}
 
-	UWorld* W = GetWorld();
-	if (W)
+	if (Batch->Slots.Num() == 0)
+		return;
+
+	const int32 Size = CaptureRing[Batch->Slots[0]]->GetSidePx();
+	Batch->Values.SetNumZeroed(Batch->Slots.Num());
+	Batch->Succeeded.Init(false, Batch->Slots.Num());
+
+	Batch->SHOrder = CaptureRing[Batch->Slots[0]]->Request.SHOrder;
+	if (Batch->SHOrder > 0)
 	{
-		USunSkyController* SunController = W->GetSubsystem<USunSkyController>();
-		if (SunController)
-		{
-			float TmpAzDeg = 0.f;
-			float TmpAltDeg = 0.f;
+		Batch->SHValues.SetNumZeroed(Batch->Slots.Num() * FCaptureContext::NumFaces * FIrradianceSH::GetNumCoeffs(Batch->SHOrder));
+	}
 
-			if (SunController->GetSolarAngles(TmpAzDeg, TmpAltDeg))
-			{
-				AzDeg = TmpAzDeg;
-				AltDeg = TmpAltDeg;
+	ENQUEUE_RENDER_COMMAND(ComputeIrradianceFromFaces)(
+		[Batch, LocalFaces = MoveTemp(LocalFaces), LocalNormals = MoveTemp(LocalNormals),
+		 LocalStreamed = MoveTemp(LocalStreamed), LocalAtlas = MoveTemp(LocalAtlas), LocalAtlasSlots = MoveTemp(LocalAtlasSlots),
+		 Size](FRHICommandListImmediate& RHICmdList)
+		{
+			FIrradianceKernelTuner::Get().EnsureTuned(RHICmdList, Size);
 
-				// Timestamp (UTC) from the capture request
-				const FDateTime WhenUTC = Capture.GetRequest().TimestampUTC; // ajusta el nombre si difiere
+			FRDGBuilder GraphBuilder(RHICmdList);
 
-				const float AltDegPhys = FMath::Clamp(AltDeg, -90.0f, 90.0f);
-				if (AltDeg != AltDegPhys)
-				{
-					PYRANO_WARN(TEXT("[SunSky] AltDeg out of range: %.3f -> %.3f"), AltDeg, AltDegPhys);
-				}
+			PYRANO_VERBOSE(TEXT("[Subsystem] Executing compute shader for %d capture(s), Size=%d"),
+				LocalNormals.Num(), Size);
 
-				if (AltDegPhys > 0.0f && ClearSky)
-				{
-					const double SolarZenithDeg = 90.0 - static_cast<double>(AltDegPhys);
-					const double SolarZenithRad = FMath::DegreesToRadians(SolarZenithDeg);
-					ClearSkyRef = ClearSky->Compute(WhenUTC, SolarZenithRad);
-				}
+			// Captures whose faces all made it to the GPU
+			TArray<bool> Integrated;
+			Integrated.Init(true, LocalNormals.Num());
 
-				// Compute SunVisibility / Occlusion
-				if (AltDeg > MinSunAltitude)
+			if (LocalStreamed.Num() > 0)
+			{
+				// Faces were integrated as they arrived: reduce the partial sums (or gather the fused results) and free them
+				TArray<TRefCountPtr<FRDGPooledBuffer>> PartialSums;
+				TArray<TRefCountPtr<FRDGPooledBuffer>> Results;
+				TArray<TRefCountPtr<FRDGPooledBuffer>> SHBuffers;
+				PartialSums.Reserve(LocalStreamed.Num());
+				for (int32 i = 0; i < LocalStreamed.Num(); ++i)
 				{
-					if (IrradianceCommon::Settings::bEnableSunVisibility)
+					const TSharedPtr<FStreamedIntegration, ESPMode::ThreadSafe>& Streamed = LocalStreamed[i];
+					if (Streamed->bFailed && Integrated.IsValidIndex(i))
 					{
-						SunVisibility = ComputeSunVisibility(
-							Capture.GetRequest(),
-							IrradianceCommon::Defaults::SunVisibilitySamples);
+						Integrated[i] = false;
 					}
-
-					else if (IrradianceCommon::Settings::bEnableSunOcclusion)
+					PartialSums.Add(MoveTemp(Streamed->PartialSums));
+					if (Streamed->Result.IsValid())
 					{
-						bool bOcc = false;
-						ComputeSunOcclusion(Capture.GetRequest(), bOcc, SunHitDistanceM);
-						SunVisibility = bOcc ? 0.0f : 1.0f;
-						SunOccluded = bOcc ? 1 : 0;
+						Results.Add(MoveTemp(Streamed->Result));
 					}
-
-					else
+					if (Streamed->SH.IsValid())
 					{
-						SunVisibility = 1.0f;
+						SHBuffers.Add(MoveTemp(Streamed->SH));
 					}
+					Streamed->DoneCounter.SafeRelease();
+				}
+
+				IrradianceCompute::ReduceAndExtractIrradianceBatch(
+					GraphBuilder,
+					PartialSums,
+					Results,
+					Size,
+					&Batch->ExtractedIrradianceBuffer);
 
-					if (SunVisibility > 0.001f)
+				if (Batch->SHOrder > 0 && SHBuffers.Num() == LocalStreamed.Num())
+				{
+					IrradianceCompute::GatherAndExtractSHBatch(GraphBuilder, SHBuffers, Batch->SHOrder, &Batch->ExtractedSHBuffer);
+				}
+			}
+			else if (LocalAtlas.IsValid())
+			{
+				IrradianceCompute::ComputeAndExtractIrradianceAtlas(
+					GraphBuilder,
+					LocalAtlas,
+					LocalAtlasSlots,
+					Size,
+					LocalNormals,
+					&Batch->ExtractedIrradianceBuffer,
+					Batch->SHOrder,
+					&Batch->ExtractedSHBuffer);
+			}
+			else
+			{
+				for (int32 i = 0; i < LocalFaces.Num(); ++i)
+				{
+					if (!LocalFaces[i].IsValid())
 					{
-						UDirectionalLightComponent* SunLightComp = nullptr;
-						if (AActor* SunActor = SunController->FindSunSkyActor(W))
-						{
-							SunLightComp = SunActor->FindComponentByClass<UDirectionalLightComponent>();
-						}
-
-						if (SunLightComp)
-						{
-							float SunLux = SunLightComp->Intensity;
-							FVector SunDir = -SunLightComp->GetForwardVector();
-
-							FVector SensorNormal = Capture.GetNormalWS();
-							float Dot = FVector::DotProduct(SensorNormal, SunDir);
-
-							if (Dot > 0.0f)
-							{
-								DirectIrradiance = SunLux * Dot * SunVisibility;
-								GeometricFactor = Dot * SunVisibility;
-							}
-						}
-						else
-						{
-							PYRANO_WARN(TEXT("[Subsystem] Could not get Directional Light"));
-						}
+						// Publish zeros so the pipeline does not stall (results are published in order)
+						PYRANO_ERR(TEXT("[Subsystem] Face %d is not valid on Render Thread"), i);
+						Batch->bReadbackDone.store(true, std::memory_order_release);
+						return;
 					}
 				}
-				// Altitude <= MinSunAltitude
+
+				// The faces will be registered as external within BuildFacesArray
+				// using GraphBuilder.RegisterExternalTexture()
+				IrradianceCompute::ComputeAndExtractIrradianceBatch(
+					GraphBuilder,
+					LocalFaces,
+					Size,
+					LocalNormals,
+					&Batch->ExtractedIrradianceBuffer,
+					Batch->SHOrder,
+					&Batch->ExtractedSHBuffer);
+			}
+			GraphBuilder.Execute();
+
+			FRHIBuffer* RHIBuf = Batch->ExtractedIrradianceBuffer.IsValid() ? Batch->ExtractedIrradianceBuffer->GetRHI() : nullptr;
+			if (!RHIBuf)
+			{
+				// Publish zeros so the pipeline does not stall
+				PYRANO_WARN(TEXT("[Subsystem] RHIBuffer not valid for readback"));
+				Batch->bReadbackDone.store(true, std::memory_order_release);
+				return;
+			}
+
+			// Async buffer copy (4 float per capture), in the same command as the dispatch
+			Batch->IrradianceReadback = MakeUnique<FRHIGPUBufferReadback>(TEXT("IrradianceReadback"));
+			Batch->IrradianceReadback->EnqueueCopy(RHICmdList, RHIBuf);
+			Batch->Succeeded = MoveTemp(Integrated);	// until the lock says otherwise
+
+			// SH projections come back with the values (6 * Order^2 float4 per capture)
+			if (Batch->ExtractedSHBuffer.IsValid())
+			{
+				Batch->SHReadback = MakeUnique<FRHIGPUBufferReadback>(TEXT("IrradianceSHReadback"));
+				Batch->SHReadback->EnqueueCopy(RHICmdList, Batch->ExtractedSHBuffer->GetRHI());
+			}
+			else
+			{
+				Batch->SHValues.Reset();
+			}
+			Batch->bCopyEnqueued.store(true, std::memory_order_release);
+
+			PYRANO_VERBOSE(TEXT("[Subsystem] Compute shader executed, readback enqueued (%d x 4 float)"), LocalNormals.Num());
+		});
+
+	BatchesInFlight.Add(Batch);
+}
+
+
+//--- (4) Readback from GPU -----------------------------------------------------
+
+void UIrradianceSubsystem::TickReadback(const TSharedPtr<FIntegrationBatch, ESPMode::ThreadSafe>& Batch)
+{
+	if (Batch->bLockEnqueued || !Batch->bCopyEnqueued.load(std::memory_order_acquire))
+		return;
+
+	// Single fence check per frame; the RT is only involved once the data is there
+	if (!Batch->IrradianceReadback->IsReady() || (Batch->SHReadback && !Batch->SHReadback->IsReady()))
+		return;
+
+	Batch->bLockEnqueued = true;
+	EnqueueReadbackLock(Batch);
+}
+
+
+void UIrradianceSubsystem::EnqueueReadbackLock(const TSharedPtr<FIntegrationBatch, ESPMode::ThreadSafe>& Batch)
+{
+	ENQUEUE_RENDER_COMMAND(ReadIrradianceReadback)(
+		[Batch](FRHICommandListImmediate& RHICmdList)
+		{
+			// Read 4 float per capture
+			const uint32 NumBytes = Batch->Values.Num() * sizeof(FVector4f);
+			const void* Ptr = Batch->IrradianceReadback->Lock(NumBytes);
+			if (Ptr)
+			{
+				FMemory::Memcpy(Batch->Values.GetData(), Ptr, NumBytes);
+			}
+			else
+			{
+				Batch->Succeeded.Init(false, Batch->Values.Num());
+			}
+
+			Batch->IrradianceReadback->Unlock();
+
+			if (Batch->SHReadback)
+			{
+				const uint32 NumSHBytes = Batch->SHValues.Num() * sizeof(FVector4f);
+				const void* SHPtr = Batch->SHReadback->Lock(NumSHBytes);
+				if (SHPtr)
+				{
+					FMemory::Memcpy(Batch->SHValues.GetData(), SHPtr, NumSHBytes);
+				}
 				else
 				{
-					AmbientIrradiance = 0.0f;
+					Batch->SHValues.Reset();
 				}
+				Batch->SHReadback->Unlock();
+			}
+
+			// Clean GPU resources
+			Batch->IrradianceReadback.Reset();
+			Batch->ExtractedIrradianceBuffer.SafeRelease();
+			Batch->SHReadback.Reset();
+			Batch->ExtractedSHBuffer.SafeRelease();
+
+			// Publish results to GT
+			Batch->bReadbackDone.store(true, std::memory_order_release);
+
+			PYRANO_VERBOSE(TEXT("[Irradiance] Readback completed in RT (%d capture(s))"), Batch->Values.Num());
+		});
+}
+
+
+//--- (5) Publish irradiance result ---------------------------------------------
 
-				float DirectLinearCoeff = IrradianceCommon::Defaults::DirectLinearCoeff;
-				float DirectQuadraticCoeff = IrradianceCommon::Defaults::DirectQuadraticCoeff;
-				float AmbientLinearCoeff = IrradianceCommon::Defaults::AmbientLinearCoeff;
+void UIrradianceSubsystem::CollectFinishedBatches()
+{
+	for (int32 b = BatchesInFlight.Num() - 1; b >= 0; --b)
+	{
+		const FIntegrationBatch& Batch = *BatchesInFlight[b];
+		if (!Batch.bReadbackDone.load(std::memory_order_acquire))
+			continue;
+
+		// Per-face SH projections of each capture (empty if not requested or not read back)
+		const int32 SHPerCapture = FCaptureContext::NumFaces * FIrradianceSH::GetNumCoeffs(Batch.SHOrder);
+		const bool bHasSH = Batch.SHOrder > 0 && Batch.SHValues.Num() == Batch.Slots.Num() * SHPerCapture;
+		if (Batch.SHOrder > 0 && !bHasSH)
+		{
+			PYRANO_WARN(TEXT("[Subsystem] SH projection (order %d) missing for %d capture(s)"), Batch.SHOrder, Batch.Slots.Num());
+		}
 
-				TotalIrradiance = (DirectLinearCoeff * DirectIrradiance)
-					+ (DirectQuadraticCoeff * FMath::Square(DirectIrradiance))
-					+ (AmbientLinearCoeff * AmbientIrradiance);
+		// The slot is free as soon as its value is back; post-processing runs on a task
+		for (int32 i = 0; i < Batch.Slots.Num(); ++i)
+		{
+			FCaptureContext& Capture = *CaptureRing[Batch.Slots[i]];
+
+			FCaptureResult Result;
+			Result.Request = Capture.GetRequest();
+			Result.Sun = Capture.Sun;
+			Result.RawRGBM = Batch.Values[i];
+			if (bHasSH)
+			{
+				Result.SH = FIrradianceSH::FromFaceSums(Batch.SHOrder, MakeArrayView(Batch.SHValues).Slice(i * SHPerCapture, SHPerCapture));
 			}
-			else
+
+			// A failed integration has no value: flagged, and never replayed by later runs
+			Result.bFailed = !Batch.Succeeded[i];
+			if (!Result.bFailed)
 			{
-				PYRANO_WARN(TEXT("[SunSky] SunSkyController could not provide solar angles"));
+				StoreInCaptureCache(Result, Capture.RenderKey);
 			}
+
+			Capture.Reset();
+			LaunchPostProcess(MoveTemp(Result));
+		}
+
+		BatchesInFlight.RemoveAt(b, 1, EAllowShrinking::No);
+	}
+}
+
+
+void UIrradianceSubsystem::PublishFinishedCaptures()
+{
+	// Tasks may finish in any order; only the oldest result may be published (reorder buffer)
+	while (PublishOrder.Num() > 0)
+	{
+		const TSharedPtr<FPostProcessJob, ESPMode::ThreadSafe>* Job = PostProcessJobs.Find(PublishOrder[0]);
+		if (!Job || !(*Job)->Task.IsCompleted())
+			break;
+
+		FCaptureResult Result = MoveTemp((*Job)->Result);
+		PostProcessJobs.Remove(PublishOrder[0]);
+		PublishOrder.RemoveAt(0, 1, EAllowShrinking::No);
+
+		ExportCaptureResult(Result);
+
+		if (OnCaptureCompleted.IsBound())
+		{
+			OnCaptureCompleted.Broadcast(Result.Request.RequestId, Result);
 		}
 		else
 		{
-			PYRANO_WARN(TEXT("[Irradiance] SunSkyController subsystem not found"));
+			CompletedResults.Add(MoveTemp(Result));
 		}
 	}
+}
 
-	OutValue = TotalIrradiance;
 
-	if (Exporter && ExportOptions.bExportCSV)
+bool UIrradianceSubsystem::ConsumeLatestIrradiance(float& OutValue, FCaptureRequest* OutRequest)
+{
+	if (CompletedResults.Num() == 0)
+		return false;
+
+	const FCaptureResult Result = CompletedResults[0];
+	CompletedResults.RemoveAt(0, 1, EAllowShrinking::No);
+
+	OutValue = Result.TotalIrradiance;
+	if (OutRequest)
 	{
-		if (!IsValid(Exporter))
+		*OutRequest = Result.Request;
+	}
+	return true;
+}
+
+
+//--- (6) Post-processing --------------------------------------------------------
+
+static bool HasUsableHorizonMap(const FCaptureRequest& Req)
+{
+	return IrradianceCommon::Settings::bUseHorizonMap
+		&& Req.HorizonMap.IsValid()
+		&& Req.HorizonMap->MatchesPose(Req.PosWS, Req.NormalWS);
+}
+
+
+void UIrradianceSubsystem::LaunchPostProcess(FCaptureResult&& Result)
+{
+	// Snapshot everything the task needs: it must not touch UObjects
+	FPostProcessSettings Settings;
+	Settings.MinSunAltitudeDeg = MinSunAltitudeDeg;
+	Settings.Normalization = Normalization;
+	Settings.bClearSky = ClearSky != nullptr;
+	if (ClearSky)
+	{
+		Settings.ClearSkyConfig = ClearSky->GetConfig();
+	}
+
+	// Traces need the world: only without a horizon map, and only here
+	Settings.bSunTermsResolved = !Result.bFailed && ResolveSunTermsOnGameThread(Result);
+
+	TSharedPtr<FPostProcessJob, ESPMode::ThreadSafe> Job = MakeShared<FPostProcessJob, ESPMode::ThreadSafe>();
+	Job->Result = MoveTemp(Result);
+
+	const FGuid RequestId = Job->Result.Request.RequestId;
+	Job->Task = UE::Tasks::Launch(UE_SOURCE_LOCATION,
+		[Job, Settings]()
 		{
-			PYRANO_WARN(TEXT("[Subsystem] Exporter invalid (GC'ed or not initialized). Skipping CSV export."));
-			return true; // irradiance is valid, only export failed
+			ComputePostProcess(Job->Result, Settings);
+		});
+
+	PostProcessJobs.Add(RequestId, MoveTemp(Job));
+}
+
+
+bool UIrradianceSubsystem::ResolveSunTermsOnGameThread(FCaptureResult& Result) const
+{
+	const FCaptureRequest& Req = Result.Request;
+	const FCaptureSunState& Sun = Result.Sun;
+
+	if (!Sun.bValid || HasUsableHorizonMap(Req))
+		return false;
+
+	float SunVisibility = 0.0f;
+	int32 SunOccluded = -1;
+	float SunHitDistanceM = -1.0f;
+
+	if (Sun.AltitudeDeg > MinSunAltitudeDeg)
+	{
+		if (IrradianceCommon::Settings::bEnableSunVisibility)
+		{
+			SunVisibility = ComputeSunVisibility(
+				Req,
+				Sun.ToSunDir,
+				IrradianceCommon::Defaults::SunVisibilitySamples);
 		}
 
-		if (SunHitDistanceM < 0.0f && IrradianceCommon::Settings::bEnableSunOcclusion)
+		else if (IrradianceCommon::Settings::bEnableSunOcclusion)
 		{
 			bool bOcc = false;
-			ComputeSunOcclusion(Capture.GetRequest(), bOcc, SunHitDistanceM);
+			ComputeSunOcclusion(Req, Sun.ToSunDir, bOcc, SunHitDistanceM);
+			SunVisibility = bOcc ? 0.0f : 1.0f;
 			SunOccluded = bOcc ? 1 : 0;
 		}
 
-		Exporter->AppendIrradianceRow(Capture.GetRequest(), TotalIrradiance,
-			IrrMean, IrrR, IrrG, IrrB, 
-			ClearSkyRef.GHI_Wm2, ClearSkyRef.DNI_Wm2, ClearSkyRef.DHI_Wm2, 
-			DirectIrradiance,
-			AzDeg, AltDeg, GeometricFactor,
-			SunOccluded, SunHitDistanceM, SunVisibility);
-		Exporter->FlushCSVIfNeeded(false);
+		else
+		{
+			SunVisibility = 1.0f;
+		}
 	}
-	Capture.Reset();
-	State = ECaptureState::Idle;
+
+	// Occlusion columns of the exported rows
+	const bool bExportRows = Exporter && ExportOptions.ExportsRows();
+	if (bExportRows && SunHitDistanceM < 0.0f && IrradianceCommon::Settings::bEnableSunOcclusion && Result.bCaptured)
+	{
+		bool bOcc = false;
+		ComputeSunOcclusion(Req, Sun.ToSunDir, bOcc, SunHitDistanceM);
+		SunOccluded = bOcc ? 1 : 0;
+	}
+
+	Result.SunVisibility = SunVisibility;
+	Result.SunOccluded = SunOccluded;
+	Result.SunHitDistanceM = SunHitDistanceM;
 	return true;
 }
 
 
-bool UIrradianceSubsystem::ComputeSunOcclusion(
-	const FCaptureRequest& Req,
-	bool& bOutSunOccluded,
-	float& OutHitDistanceM) const
+void UIrradianceSubsystem::ComputePostProcess(FCaptureResult& Result, const FPostProcessSettings& Settings)
 {
-	bOutSunOccluded = false;
-	OutHitDistanceM = -1.0f;
+	// Failed capture: no ambient term, so no direct term either (derived values stay unset)
+	if (Result.bFailed)
+		return;
 
-	UWorld* World = GetWorld();
-	if (!World)
-		return false;
+	const FCaptureRequest& Req = Result.Request;
+	const FCaptureSunState& Sun = Result.Sun;
+
+	float IrrMean = Result.RawRGBM.W;
+
+	float AmbientIrradiance = IrrMean * Settings.Normalization.AmbientIrradianceScale;
+	float TotalIrradiance = IrrMean;
+
+	float DirectIrradiance = 0.0f;
+	float GeometricFactor = 0.0f;
+
+	int32 SunOccluded = Settings.bSunTermsResolved ? Result.SunOccluded : -1;
+	float SunHitDistanceM = Settings.bSunTermsResolved ? Result.SunHitDistanceM : -1.0f;
+	float SunVisibility = 0.0f;
+
+	FPyranoClearSkyIrradiance ClearSkyRef; 
 
-	// 1) Find SunSky actor (tag "SunSky" or name contains "SunSky")
-	AActor* SunSkyActor = nullptr;
-	for (TActorIterator<AActor> It(World); It; ++It)
+	// Sun state was snapshotted when the capture started (later slots may have moved the sun)
+	if (Sun.bValid)
 	{
-		AActor* A = *It;
-		if (!A) continue;
+		const float AltDeg = Sun.AltitudeDeg;
+
+		// Timestamp (UTC) from the capture request
+		const FDateTime WhenUTC = Req.TimestampUTC;
 
-		if (A->ActorHasTag(FName("SunSky")) || A->GetName().Contains(TEXT("SunSky")))
+		const float AltDegPhys = FMath::Clamp(AltDeg, -90.0f, 90.0f);
+		if (AltDeg != AltDegPhys)
 		{
-			SunSkyActor = A;
-			break;
+			PYRANO_WARN(TEXT("[SunSky] AltDeg out of range: %.3f -> %.3f"), AltDeg, AltDegPhys);
 		}
-	}
-	if (!SunSkyActor)
-	{
-		PYRANO_WARN(TEXT("[Occlusion] SunSky not found"));
-		return false;
-	}
 
-	// 2) Get the sun directional light component from SunSky
-	UDirectionalLightComponent* SunDirComp = SunSkyActor->FindComponentByClass<UDirectionalLightComponent>();
+		if (AltDegPhys > 0.0f && Settings.bClearSky)
+		{
+			const double SolarZenithDeg = 90.0 - static_cast<double>(AltDegPhys);
+			const double SolarZenithRad = FMath::DegreesToRadians(SolarZenithDeg);
+			ClearSkyRef = UClearSkyService::ComputeWithConfig(Settings.ClearSkyConfig, WhenUTC, SolarZenithRad);
+		}
 
-	// Fallback: SunSky may own a child actor that is the directional light
-	if (!SunDirComp)
-	{
-		TArray<UChildActorComponent*> ChildActorComps;
-		SunSkyActor->GetComponents<UChildActorComponent>(ChildActorComps);
+		// Occlusion from the horizon map (the game thread traced it otherwise)
+		const bool bHorizonMap = !Settings.bSunTermsResolved && HasUsableHorizonMap(Req);
+		if (bHorizonMap && IrradianceCommon::Settings::bEnableSunOcclusion && Result.bCaptured)
+		{
+			SunHitDistanceM = Req.HorizonMap->LookupHitDistanceM(Sun.ToSunDir);
+			SunOccluded = SunHitDistanceM >= 0.0f ? 1 : 0;
+		}
 
-		for (UChildActorComponent* CAC : ChildActorComps)
+		// Compute SunVisibility / Occlusion
+		if (AltDeg > Settings.MinSunAltitudeDeg)
 		{
-			if (!CAC) continue;
+			if (Settings.bSunTermsResolved)
+			{
+				// Traced on the game thread
+				SunVisibility = Result.SunVisibility;
+			}
+
+			else if (bHorizonMap)
+			{
+				// Table lookups: same cone and seed as the traced path
+				if (IrradianceCommon::Settings::bEnableSunVisibility)
+				{
+					const int32 Seed =
+						GetTypeHash(Req.SensorId) ^
+						GetTypeHash(Req.TimestampUTC.GetTicks());
+					SunVisibility = Req.HorizonMap->SunVisibility(Sun.ToSunDir, IrradianceCommon::Defaults::SunVisibilitySamples, Seed);
+				}
+				else if (IrradianceCommon::Settings::bEnableSunOcclusion)
+				{
+					SunVisibility = SunOccluded == 1 ? 0.0f : 1.0f;
+				}
+				else
+				{
+					SunVisibility = 1.0f;
+				}
+			}
+
+			else
+			{
+				SunVisibility = 1.0f;
+			}
 
-			AActor* Child = CAC->GetChildActor();
-			if (ADirectionalLight* DL = Cast<ADirectionalLight>(Child))
+			if (SunVisibility > 0.001f)
 			{
-				SunDirComp = Cast<UDirectionalLightComponent>(DL->GetLightComponent());
-				if (SunDirComp) break;
+				if (Sun.IlluminanceLux > 0.0f)
+				{
+					float SunLux = Sun.IlluminanceLux;
+					FVector SunDir = Sun.ToSunDir;
+
+					FVector SensorNormal = Req.NormalWS;
+					float Dot = FVector::DotProduct(SensorNormal, SunDir);
+
+					if (Dot > 0.0f)
+					{
+						DirectIrradiance = SunLux * Dot * SunVisibility;
+						GeometricFactor = Dot * SunVisibility;
+					}
+				}
+				else
+				{
+					PYRANO_WARN(TEXT("[Subsystem] Could not get Directional Light"));
+				}
 			}
 		}
+		// Altitude <= MinSunAltitude
+		else
+		{
+			AmbientIrradiance = 0.0f;
+		}
+
+		TotalIrradiance = Settings.Normalization.Apply(DirectIrradiance, AmbientIrradiance);
 	}
 
-	if (!SunDirComp)
+	Result.TotalIrradiance = TotalIrradiance;
+	Result.DirectIrradiance = DirectIrradiance;
+	Result.AmbientIrradiance = AmbientIrradiance;
+	Result.GeometricFactor = GeometricFactor;
+	Result.SunVisibility = SunVisibility;
+	Result.SunOccluded = SunOccluded;
+	Result.SunHitDistanceM = SunHitDistanceM;
+	Result.ClearSky = ClearSkyRef;
+}
+
+
+void UIrradianceSubsystem::ExportCaptureResult(const FCaptureResult& Result)
+{
+	if (!Exporter || !ExportOptions.ExportsRows())
+		return;
+
+	if (!IsValid(Exporter))
 	{
-		PYRANO_WARN(TEXT("[Occlusion] Could not find Directional Light component on/under SunSky"));
-		return false;
+		PYRANO_WARN(TEXT("[Subsystem] Exporter invalid (GC'ed or not initialized). Skipping row export."));
+		return; // irradiance is valid, only export failed
 	}
 
-	// 3) Direction from point towards the sun: opposite of light forward
-	const FVector ToSunDir = (-SunDirComp->GetForwardVector()).GetSafeNormal();
-	if (ToSunDir.IsNearlyZero())
+	// No row for a failed capture: the scheduler captures it again
+	if (Result.bFailed)
 	{
-		PYRANO_WARN(TEXT("[Occlusion] Sun direction is nearly zero"));
-		return false;
+		PYRANO_WARN(TEXT("[Subsystem] Capture failed, no row exported: %s"), *Result.Request.ToString());
+		return;
 	}
 
-	// 4) Resolve sensor owner (so we can ignore self hits)
-	AActor* SensorOwner = nullptr;
-	for (TObjectIterator<UPyranometerComponent> It; It; ++It)
+	const FCaptureSunState& Sun = Result.Sun;
+	const float AzDeg = Sun.bValid ? Sun.AzimuthDeg : 0.f;
+	const float AltDeg = Sun.bValid ? Sun.AltitudeDeg : 0.f;
+
+	Exporter->AppendIrradianceRow(Result.Request, Result.TotalIrradiance,
+		Result.RawRGBM.W, Result.RawRGBM.X, Result.RawRGBM.Y, Result.RawRGBM.Z, 
+		Result.ClearSky.GHI_Wm2, Result.ClearSky.DNI_Wm2, Result.ClearSky.DHI_Wm2, 
+		Result.DirectIrradiance,
+		AzDeg, AltDeg, Result.GeometricFactor,
+		Result.SunOccluded, Result.SunHitDistanceM, Result.SunVisibility);
+
+	if (Result.SH.IsValid())
 	{
-		UPyranometerComponent* C = *It;
-		if (!C || C->GetWorld() != World) continue;
+		Exporter->AppendSHRow(Result.Request, Result.SH);
+	}
+}
+
 
-		if (C->SensorGuid == Req.SensorId)
+void UIrradianceSubsystem::AddTraceIgnoredActors(const FCaptureRequest& Req, FCollisionQueryParams& Params) const
+{
+	// Registry lookups: no global object / actor walks per capture
+	if (UPyranometerRegistry* Registry = GetWorld() ? GetWorld()->GetSubsystem<UPyranometerRegistry>() : nullptr)
+	{
+		if (AActor* SunSkyActor = Registry->GetSunSkyActor())
 		{
-			SensorOwner = C->GetOwner();
-			break;
+			Params.AddIgnoredActor(SunSkyActor);
+		}
+		if (AActor* SensorOwner = Registry->FindSensorOwner(Req.SensorId))
+		{
+			Params.AddIgnoredActor(SensorOwner);
 		}
 	}
 
-	// 5) Trace setup
+	if (CaptureCam.IsValid())
+	{
+		Params.AddIgnoredActor(CaptureCam.Get());
+	}
+}
+
+
+bool UIrradianceSubsystem::ComputeSunOcclusion(
+	const FCaptureRequest& Req,
+	const FVector& ToSunDir,
+	bool& bOutSunOccluded,
+	float& OutHitDistanceM) const
+{
+	bOutSunOccluded = false;
+	OutHitDistanceM = -1.0f;
+
+	// 0) Horizon map: table lookup instead of a trace
+	if (IrradianceCommon::Settings::bUseHorizonMap && !ToSunDir.IsNearlyZero()
+		&& Req.HorizonMap.IsValid() && Req.HorizonMap->MatchesPose(Req.PosWS, Req.NormalWS))
+	{
+		OutHitDistanceM = Req.HorizonMap->LookupHitDistanceM(ToSunDir);
+		bOutSunOccluded = OutHitDistanceM >= 0.0f;
+		return true;
+	}
+
+	UWorld* World = GetWorld();
+	if (!World)
+		return false;
+
+	// 1-3) Direction from point towards the sun, as snapshotted when the capture started
+	if (ToSunDir.IsNearlyZero())
+	{
+		PYRANO_WARN(TEXT("[Occlusion] Sun direction is nearly zero"));
+		return false;
+	}
+
+	// 4-5) Trace setup (ignores SunSky, sensor owner and capture camera)
 	FCollisionQueryParams Params(SCENE_QUERY_STAT(Pyrano_SunOcclusion), /*bTraceComplex*/ false);
 	Params.bReturnPhysicalMaterial = false;
 	Params.bFindInitialOverlaps = false;
 
-	Params.AddIgnoredActor(SunSkyActor);
-	if (SensorOwner) Params.AddIgnoredActor(SensorOwner);
-	if (CaptureCam.IsValid()) Params.AddIgnoredActor(CaptureCam.Get());
+	AddTraceIgnoredActors(Req, Params);
 
 	// Use a robust start: push along trace direction (main) + a small normal offset (secondary)
 	const FVector N = Req.NormalWS.GetSafeNormal(); // if (0,0,1) it's fine; if zero -> (0,0,0)
@@ -877,6 +1669,7 @@ bool UIrradianceSubsystem::ComputeSunOcclusion(
 
 float UIrradianceSubsystem::ComputeSunVisibility(
 	const FCaptureRequest& Req,
+	const FVector& ToSunDir,
 	int32 NumSamples) const
 {
 	if (NumSamples <= 0)
@@ -886,62 +1679,26 @@ float UIrradianceSubsystem::ComputeSunVisibility(
 	if (!World)
 		return 0.0f;
 
-	// Find SunSky
-	AActor* SunSkyActor = nullptr;
-	for (TActorIterator<AActor> It(World); It; ++It)
-	{
-		AActor* A = *It;
-		if (!A) continue;
-		if (A->ActorHasTag(FName("SunSky")) || A->GetName().Contains(TEXT("SunSky")))
-		{
-			SunSkyActor = A;
-			break;
-		}
-	}
-	if (!SunSkyActor)
-		return 0.0f;
-
-	UDirectionalLightComponent* SunDirComp = SunSkyActor->FindComponentByClass<UDirectionalLightComponent>();
-	if (!SunDirComp)
-	{
-		TArray<UChildActorComponent*> CACs;
-		SunSkyActor->GetComponents<UChildActorComponent>(CACs);
-		for (UChildActorComponent* CAC : CACs)
-		{
-			if (ADirectionalLight* DL = Cast<ADirectionalLight>(CAC->GetChildActor()))
-			{
-				SunDirComp = Cast<UDirectionalLightComponent>(DL->GetLightComponent());
-				if (SunDirComp) break;
-			}
-		}
-	}
-	if (!SunDirComp)
-		return 0.0f;
-
-	const FVector ToSunDir = (-SunDirComp->GetForwardVector()).GetSafeNormal();
 	if (ToSunDir.IsNearlyZero())
 		return 0.0f;
 
-	// Resolve sensor owner (ignore self)
-	AActor* SensorOwner = nullptr;
-	for (TObjectIterator<UPyranometerComponent> It; It; ++It)
+	// Determinist seed
+	const int32 Seed =
+		GetTypeHash(Req.SensorId) ^
+		GetTypeHash(Req.TimestampUTC.GetTicks());
+
+	// Horizon map: same cone, looked up instead of traced
+	if (IrradianceCommon::Settings::bUseHorizonMap
+		&& Req.HorizonMap.IsValid() && Req.HorizonMap->MatchesPose(Req.PosWS, Req.NormalWS))
 	{
-		UPyranometerComponent* C = *It;
-		if (!C || C->GetWorld() != World) continue;
-		if (C->SensorGuid == Req.SensorId)
-		{
-			SensorOwner = C->GetOwner();
-			break;
-		}
+		return Req.HorizonMap->SunVisibility(ToSunDir, NumSamples, Seed);
 	}
 
 	// Trace params
 	FCollisionQueryParams Params(SCENE_QUERY_STAT(Pyrano_SunVisibility), false);
 	Params.bReturnPhysicalMaterial = false;
 	Params.bFindInitialOverlaps = false;
-	Params.AddIgnoredActor(SunSkyActor);
-	if (SensorOwner) Params.AddIgnoredActor(SensorOwner);
-	if (CaptureCam.IsValid()) Params.AddIgnoredActor(CaptureCam.Get());
+	AddTraceIgnoredActors(Req, Params);
 
 	// Robust start (igual que en sun_occluded)
 	const FVector N = Req.NormalWS.GetSafeNormal();
@@ -954,11 +1711,6 @@ float UIrradianceSubsystem::ComputeSunVisibility(
 	// Cone semi-angle (0.265 degrees ≈ solar angular radius)
 	const float ConeAngleRad = FMath::DegreesToRadians(0.5f);
 
-	// Determinist seed
-	const int32 Seed =
-		GetTypeHash(Req.SensorId) ^
-		GetTypeHash(Req.TimestampUTC.GetTicks());
-
 	FRandomStream RNG(Seed);
 
 	for (int32 i = 0; i < NumSamples; ++i)
@@ -998,6 +1750,29 @@ float UIrradianceSubsystem::ComputeSunVisibility(
 }
 
 
+/** i-th SVF sample direction (Fibonacci in hemisphere around Rot * Up). OutCosTheta is its cosine weight. */
+static FVector SkyViewFactorSampleDir(int32 i, int32 NumSamples, const FQuat& Rot, double& OutCosTheta)
+{
+	const double GoldenRatio = (1.0 + FMath::Sqrt(5.0)) * 0.5;
+
+	const double u = (i + 0.5) / double(NumSamples);   // (0,1)
+	const double v = FMath::Frac(i / GoldenRatio);     // (0,1)
+
+	const double z = u;                                // cos(theta)
+	const double r = FMath::Sqrt(FMath::Max(0.0, 1.0 - z * z));
+	const double theta = 2.0 * PI * v;
+
+	const FVector LocalDir(
+		float(r * FMath::Cos(theta)),
+		float(r * FMath::Sin(theta)),
+		float(z)
+	);
+
+	OutCosTheta = z;
+	return Rot.RotateVector(LocalDir).GetSafeNormal();
+}
+
+
 float UIrradianceSubsystem::ComputeSkyViewFactor(
 	const FCaptureRequest& Req,
 	int32 NumSamples) const
@@ -1010,44 +1785,12 @@ float UIrradianceSubsystem::ComputeSkyViewFactor(
 	const FVector N = Req.NormalWS.GetSafeNormal();
 	if (N.IsNearlyZero()) return 0.0f;
 
-	// Find SunSky
-	AActor* SunSkyActor = nullptr;
-	for (TActorIterator<AActor> It(World); It; ++It)
-	{
-		AActor* A = *It;
-		if (!A) continue;
-		if (A->ActorHasTag(FName("SunSky")) || A->GetName().Contains(TEXT("SunSky")))
-		{
-			SunSkyActor = A;
-			break;
-		}
-	}
-
-	// Same as SunVisibility
-	AActor* SensorOwner = nullptr;
-	for (TObjectIterator<UPyranometerComponent> It; It; ++It)
-	{
-		UPyranometerComponent* C = *It;
-		if (!C || C->GetWorld() != World) continue;
-		if (C->SensorGuid == Req.SensorId)
-		{
-			SensorOwner = C->GetOwner();
-			break;
-		}
-	}
-
 	FCollisionQueryParams Params(SCENE_QUERY_STAT(Pyrano_SkyViewFactor), false);
 	Params.bReturnPhysicalMaterial = false;
 	Params.bFindInitialOverlaps = false;
 
-	if (SunSkyActor)   Params.AddIgnoredActor(SunSkyActor);
-	if (SensorOwner)  Params.AddIgnoredActor(SensorOwner);
-
-	// Use UIrradianceSubsystem::CaptureCam (ACameraActor)
-	if (CaptureCam.IsValid())
-	{
-		Params.AddIgnoredActor(CaptureCam.Get());
-	}
+	// SunSky, sensor owner and UIrradianceSubsystem::CaptureCam (ACameraActor)
+	AddTraceIgnoredActors(Req, Params);
 
 	// Robust start
 	const FVector Start = Req.PosWS + N * 5.0f;
@@ -1056,27 +1799,12 @@ float UIrradianceSubsystem::ComputeSkyViewFactor(
 	// UpVector to Normal rotation
 	const FQuat Rot = FQuat::FindBetweenNormals(FVector::UpVector, N);
 
-	// Fibonacci in hemisphere
-	const double GoldenRatio = (1.0 + FMath::Sqrt(5.0)) * 0.5;
-
 	double Sum = 0.0;
 
 	for (int32 i = 0; i < NumSamples; ++i)
 	{
-		const double u = (i + 0.5) / double(NumSamples);   // (0,1)
-		const double v = FMath::Frac(i / GoldenRatio);     // (0,1)
-
-		const double z = u;                                // cos(theta)
-		const double r = FMath::Sqrt(FMath::Max(0.0, 1.0 - z * z));
-		const double theta = 2.0 * PI * v;
-
-		const FVector LocalDir(
-			float(r * FMath::Cos(theta)),
-			float(r * FMath::Sin(theta)),
-			float(z)
-		);
-
-		const FVector DirWS = Rot.RotateVector(LocalDir).GetSafeNormal();
+		double z = 0.0;
+		const FVector DirWS = SkyViewFactorSampleDir(i, NumSamples, Rot, z);
 		const FVector End = Start + DirWS * TraceLenCm;
 
 		FHitResult Hit;
@@ -1091,11 +1819,166 @@ float UIrradianceSubsystem::ComputeSkyViewFactor(
 }
 
 
+void UIrradianceSubsystem::BeginSkyViewFactorPrepass(TConstArrayView<FCaptureRequest> Reqs, int32 NumSamples)
+{
+	CancelSkyViewFactorPrepass();
+
+	UWorld* World = GetWorld();
+	if (!World || NumSamples <= 0 || Reqs.Num() == 0)
+		return;
+
+	SVFSamples = NumSamples;
+	SVFTraceDelegate = FTraceDelegate::CreateUObject(this, &UIrradianceSubsystem::OnSkyViewFactorTrace, SVFPrepassSerial);
+
+	const float TraceLenCm = 10000000.0f;
+
+	for (const FCaptureRequest& Req : Reqs)
+	{
+		const FVector N = Req.NormalWS.GetSafeNormal();
+		if (N.IsNearlyZero())
+			continue;
+
+		const uint32 JobIndex = (uint32)SVFJobs.Num();
+		SVFJobs.Add({ Req.SensorId });
+
+		FCollisionQueryParams Params(SCENE_QUERY_STAT(Pyrano_SkyViewFactor), false);
+		Params.bReturnPhysicalMaterial = false;
+		Params.bFindInitialOverlaps = false;
+		AddTraceIgnoredActors(Req, Params);
+
+		// Same start and sampling as ComputeSkyViewFactor
+		const FVector Start = Req.PosWS + N * 5.0f;
+		const FQuat Rot = FQuat::FindBetweenNormals(FVector::UpVector, N);
+
+		for (int32 i = 0; i < NumSamples; ++i)
+		{
+			double z = 0.0;
+			const FVector DirWS = SkyViewFactorSampleDir(i, NumSamples, Rot, z);
+
+			World->AsyncLineTraceByChannel(
+				EAsyncTraceType::Single,
+				Start, Start + DirWS * TraceLenCm,
+				ECC_Visibility, Params, FCollisionResponseParams::DefaultResponseParam,
+				&SVFTraceDelegate,
+				JobIndex * (uint32)NumSamples + (uint32)i);
+		}
+	}
+
+	SVFTracesTotal = SVFJobs.Num() * NumSamples;
+	PYRANO_VERBOSE(TEXT("[SkyFactor] Pre-pass issued: %d sensor(s), %d async traces"), SVFJobs.Num(), SVFTracesTotal);
+}
+
+
+void UIrradianceSubsystem::CancelSkyViewFactorPrepass()
+{
+	++SVFPrepassSerial;
+	SVFTraceDelegate.Unbind();
+	SVFJobs.Reset();
+	SVFSamples = 0;
+	SVFTracesTotal = 0;
+	SVFTracesDone = 0;
+}
+
+
+float UIrradianceSubsystem::GetSkyViewFactorPrepassProgress() const
+{
+	return SVFTracesTotal > 0 ? float(SVFTracesDone) / float(SVFTracesTotal) : 1.0f;
+}
+
+
+bool UIrradianceSubsystem::GetSkyViewFactorPrepassResult(const FGuid& SensorId, float& OutSVF) const
+{
+	const FSkyViewFactorJob* Job = SVFJobs.FindByPredicate(
+		[&SensorId](const FSkyViewFactorJob& J) { return J.SensorId == SensorId; });
+
+	if (!Job || Job->Done < SVFSamples)
+		return false;
+
+	OutSVF = float(FMath::Clamp(2.0 * (Job->Sum / double(SVFSamples)), 0.0, 1.0));
+	return true;
+}
+
+
+void UIrradianceSubsystem::OnSkyViewFactorTrace(const FTraceHandle& Handle, FTraceDatum& Datum, uint32 Serial)
+{
+	if (Serial != SVFPrepassSerial || SVFSamples <= 0)
+		return;
+
+	const int32 JobIndex = int32(Datum.UserData / (uint32)SVFSamples);
+	const int32 SampleIndex = int32(Datum.UserData % (uint32)SVFSamples);
+	if (!SVFJobs.IsValidIndex(JobIndex))
+		return;
+
+	const bool bHit = Datum.OutHits.ContainsByPredicate([](const FHitResult& H) { return H.bBlockingHit; });
+
+	// Cosine weight of the sample, as in ComputeSkyViewFactor
+	FSkyViewFactorJob& Job = SVFJobs[JobIndex];
+	if (!bHit)
+	{
+		Job.Sum += (SampleIndex + 0.5) / double(SVFSamples);
+	}
+	++Job.Done;
+	++SVFTracesDone;
+}
+
+
+FSensorHorizonMapPtr UIrradianceSubsystem::BuildHorizonMap(const FCaptureRequest& Req) const
+{
+	UWorld* World = GetWorld();
+	if (!World) return nullptr;
+
+	const FVector N = Req.NormalWS.GetSafeNormal();
+	if (N.IsNearlyZero()) return nullptr;
+
+	FCollisionQueryParams Params(SCENE_QUERY_STAT(Pyrano_HorizonMap), false);
+	Params.bReturnPhysicalMaterial = false;
+	Params.bFindInitialOverlaps = false;
+
+	AddTraceIgnoredActors(Req, Params);
+
+	const FVector PosWS = Req.PosWS;
+	const float TraceLenCm = 10000000.0f;
+	const double StartTime = FPlatformTime::Seconds();
+
+	// Scene queries are read-only: safe from the ParallelFor workers while the game thread waits
+	FSensorHorizonMapPtr Map = FSensorHorizonMap::Build(PosWS, N,
+		[World, &Params, PosWS, N, TraceLenCm](const FVector& DirWS) -> float
+		{
+			// Same robust start as the sun traces
+			const FVector Start = PosWS + DirWS * 50.0f + N * 5.0f;
+			const FVector End = Start + DirWS * TraceLenCm;
+
+			FHitResult Hit;
+			if (World->LineTraceSingleByChannel(Hit, Start, End, ECC_Visibility, Params))
+			{
+				return Hit.Distance / 100.0f; // cm -> m
+			}
+			return -1.0f;
+		});
+
+	PYRANO_VERBOSE(TEXT("[Horizon] Map built for %s in %.1f ms"),
+		*Req.SensorName, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+	return Map;
+}
+
+
 // -----------------------------------------------------------------------------
 //  Export
 // -----------------------------------------------------------------------------
 
-void UIrradianceSubsystem::ConfigureExport(bool bCSV, bool bExportImages, const FString& OutputDirPath)
+void UIrradianceSubsystem::ConfigureExport(bool bCSV, bool bExportImages, const FString& OutputDirPath, bool bBinary, bool bCompressImages)
+{
+	FExportOptions Options = ExportOptions;
+	Options.bExportCSV = bCSV;
+	Options.bExportBinary = bBinary;
+	Options.OutputDir.Path = OutputDirPath;	// if empty -> Saved/Irradiance
+	Options.bExportImages = bExportImages;
+	Options.bCompressImages = bCompressImages;
+	ConfigureExport(Options);
+}
+
+
+void UIrradianceSubsystem::ConfigureExport(const FExportOptions& InOptions)
 {
 	if (!Exporter)
 	{
@@ -1106,10 +1989,7 @@ void UIrradianceSubsystem::ConfigureExport(bool bCSV, bool bExportImages, const
 			*GetNameSafe(this));
 	}
 	
-	ExportOptions.bExportCSV = bCSV;
-	ExportOptions.OutputDir.Path = OutputDirPath;	// if empty -> Saved/Irradiance
-
-	ExportOptions.bExportImages = bExportImages;
+	ExportOptions = InOptions;
 	if (Exporter) 
 	{
 		Exporter->Init(ExportOptions);
@@ -1122,9 +2002,90 @@ void UIrradianceSubsystem::FlushExporter()
 	if (Exporter)
 	{
 		Exporter->FlushCSVIfNeeded(true);
+		Exporter->CloseArchives();
+	}
+}
+
+
+// -----------------------------------------------------------------------------
+//  Capture result cache
+// -----------------------------------------------------------------------------
+
+void UIrradianceSubsystem::SetCaptureCacheEnabled(bool bEnabled)
+{
+	bCaptureCacheEnabled = bEnabled;
+	if (!bEnabled)
+		return;
+
+	if (!bCaptureCacheLoaded)
+	{
+		CaptureCache.Load(FCaptureResultCache::GetDefaultPath());
+		bCaptureCacheLoaded = true;
 	}
+
+	// Levels may have been saved or streamed since the last run
+	CaptureCacheSceneHash = FCaptureResultCache::MakeSceneHash(GetWorld());
+	CaptureCache.ResetStats();
 }
 
 
+void UIrradianceSubsystem::SaveCaptureCache()
+{
+	if (!bCaptureCacheLoaded)
+		return;
 
+	const FCaptureResultCache::FStats& Stats = CaptureCache.GetStats();
+	if (Stats.Hits + Stats.Misses > 0)
+	{
+		PYRANO_INFO(TEXT("[CaptureCache] Hits=%d, Misses=%d, HitRate=%.1f%%, Stored=%d, Evicted=%d, Entries=%d"),
+			Stats.Hits, Stats.Misses, 100.f * Stats.GetHitRate(), Stats.Stored, Stats.Evicted, CaptureCache.Num());
+	}
+	CaptureCache.ResetStats();
 
+	if (CaptureCache.IsDirty())
+	{
+		CaptureCache.Save(FCaptureResultCache::GetDefaultPath());
+	}
+}
+
+
+FString UIrradianceSubsystem::MakeCaptureRenderKey() const
+{
+	auto GetCVarInt = [](const TCHAR* Name)
+	{
+		const IConsoleVariable* CVar = IConsoleManager::Get().FindConsoleVariable(Name);
+		return CVar ? CVar->GetInt() : -1;
+	};
+
+	// integrate: revision of the integrate kernel's output (2 = full face coverage with striding)
+	return FString::Printf(TEXT("integrate=2,pt=%d,spp=%d,bounces=%d,rig=%d,cull=%d,faces=%d"),
+		bPathTracing ? 1 : 0,
+		bPathTracing ? GetCVarInt(TEXT("r.PathTracing.SamplesPerPixel")) : 0,
+		bPathTracing ? GetCVarInt(TEXT("r.PathTracing.MaxBounces")) : 0,
+		UsesCaptureRig() ? 1 : 0,
+		IrradianceCommon::Settings::bCullCubemapFaces ? 1 : 0,
+		(int32)IrradianceCommon::Settings::FaceIntegration);
+}
+
+
+void UIrradianceSubsystem::StoreInCaptureCache(const FCaptureResult& Result, const FString& RenderKey)
+{
+	if (!bCaptureCacheEnabled || Result.Request.SHOrder > 0 || RenderKey.IsEmpty())
+		return;
+
+	CaptureCache.Store(
+		FCaptureResultCache::MakeKey(CaptureCacheSceneHash, RenderKey, Result.Request, Result.Sun),
+		Result.RawRGBM);
+}
+
+
+FString UIrradianceSubsystem::GetExportCSVPath() const
+{
+	return Exporter ? Exporter->GetCSVPath() : FString();
+}
+
+
+bool UIrradianceSubsystem::GetExportDurablePoint(uint64& OutRows, int64& OutCSVBytes) const
+{
+	return Exporter && Exporter->GetDurablePoint(OutRows, OutCSVBytes);
+}
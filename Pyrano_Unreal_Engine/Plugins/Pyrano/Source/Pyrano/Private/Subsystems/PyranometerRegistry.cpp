@@ -0,0 +1,234 @@
+﻿// PyranometerRegistry.cpp
+
+#include "Subsystems/PyranometerRegistry.h"
+#include "EngineUtils.h"
+#include "Engine/DirectionalLight.h"
+#include "Components/DirectionalLightComponent.h"
+#include "Components/PyranometerComponent.h"
+#include "Logging/IrradianceLog.h"
+
+// -----------------------------------------------------------------------------
+//  Life Cycle
+// -----------------------------------------------------------------------------
+
+void UPyranometerRegistry::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	UWorld* World = GetWorld();
+	if (!World)
+		return;
+
+	// Sensors registered before the subsystem existed (one-off scan)
+	for (TObjectIterator<UPyranometerComponent> It; It; ++It)
+	{
+		if (It->GetWorld() == World && It->IsRegistered())
+		{
+			RegisterSensor(*It);
+		}
+	}
+
+	ActorSpawnedHandle = World->AddOnActorSpawnedHandler(
+		FOnActorSpawned::FDelegate::CreateUObject(this, &UPyranometerRegistry::OnActorSpawned));
+}
+
+
+void UPyranometerRegistry::Deinitialize()
+{
+	if (UWorld* World = GetWorld())
+	{
+		World->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
+	}
+	ActorSpawnedHandle.Reset();
+
+	SensorsByGuid.Reset();
+	GuidBySensor.Reset();
+	InvalidateSunCache();
+
+	Super::Deinitialize();
+}
+
+
+// -----------------------------------------------------------------------------
+//  Sensors
+// -----------------------------------------------------------------------------
+
+void UPyranometerRegistry::RegisterSensor(UPyranometerComponent* Sensor)
+{
+	if (!Sensor)
+		return;
+
+	const TWeakObjectPtr<UPyranometerComponent> Key(Sensor);
+
+	// Re-key if the GUID changed since the last registration (duplicate / import)
+	if (const FGuid* OldGuid = GuidBySensor.Find(Key))
+	{
+		if (*OldGuid == Sensor->SensorGuid)
+			return;
+		SensorsByGuid.Remove(*OldGuid);
+	}
+
+	SensorsByGuid.Add(Sensor->SensorGuid, Key);
+	GuidBySensor.Add(Key, Sensor->SensorGuid);
+}
+
+
+void UPyranometerRegistry::UnregisterSensor(UPyranometerComponent* Sensor)
+{
+	const TWeakObjectPtr<UPyranometerComponent> Key(Sensor);
+
+	FGuid Guid;
+	if (GuidBySensor.RemoveAndCopyValue(Key, Guid))
+	{
+		// Only drop the entry if it still points to this sensor
+		const TWeakObjectPtr<UPyranometerComponent>* Entry = SensorsByGuid.Find(Guid);
+		if (Entry && *Entry == Key)
+		{
+			SensorsByGuid.Remove(Guid);
+		}
+	}
+}
+
+
+UPyranometerComponent* UPyranometerRegistry::FindSensor(const FGuid& SensorGuid) const
+{
+	const TWeakObjectPtr<UPyranometerComponent>* Entry = SensorsByGuid.Find(SensorGuid);
+	UPyranometerComponent* Sensor = Entry ? Entry->Get() : nullptr;
+
+	// GUID may have changed without a re-registration
+	return (Sensor && Sensor->SensorGuid == SensorGuid) ? Sensor : nullptr;
+}
+
+
+AActor* UPyranometerRegistry::FindSensorOwner(const FGuid& SensorGuid) const
+{
+	UPyranometerComponent* Sensor = FindSensor(SensorGuid);
+	return Sensor ? Sensor->GetOwner() : nullptr;
+}
+
+
+void UPyranometerRegistry::GetSensors(TArray<UPyranometerComponent*>& OutSensors, bool bOnlyEnabled) const
+{
+	OutSensors.Reset();
+	OutSensors.Reserve(SensorsByGuid.Num());
+
+	for (const TPair<FGuid, TWeakObjectPtr<UPyranometerComponent>>& It : SensorsByGuid)
+	{
+		UPyranometerComponent* Sensor = It.Value.Get();
+		if (!Sensor || !Sensor->IsRegistered()) continue;
+		if (bOnlyEnabled && !Sensor->bEnabled) continue;
+		OutSensors.Add(Sensor);
+	}
+}
+
+
+// -----------------------------------------------------------------------------
+//  Sun
+// -----------------------------------------------------------------------------
+
+bool UPyranometerRegistry::IsSunSkyActor(const AActor* Actor)
+{
+	return Actor
+		&& (Actor->ActorHasTag(FName("SunSky")) || Actor->GetName().Contains(TEXT("SunSky")));
+}
+
+
+AActor* UPyranometerRegistry::GetSunSkyActor()
+{
+	// A stale handle (actor destroyed) triggers a new scan
+	if (!bSunResolved || CachedSunSky.IsStale())
+	{
+		ResolveSun();
+	}
+	return CachedSunSky.Get();
+}
+
+
+UDirectionalLightComponent* UPyranometerRegistry::GetSunLight()
+{
+	if (!bSunResolved || CachedSunSky.IsStale())
+	{
+		ResolveSun();
+	}
+	else if (CachedSunLight.IsStale())
+	{
+		// Construction-script reruns recreate the SunSky light: look it up again, no scan
+		if (CachedSunSky.IsValid())
+		{
+			CachedSunLight = CachedSunSky->FindComponentByClass<UDirectionalLightComponent>();
+		}
+		if (!CachedSunLight.IsValid())
+		{
+			ResolveSun();
+		}
+	}
+	return CachedSunLight.Get();
+}
+
+
+void UPyranometerRegistry::InvalidateSunCache()
+{
+	CachedSunSky.Reset();
+	CachedSunLight.Reset();
+	bSunResolved = false;
+}
+
+
+void UPyranometerRegistry::OnActorSpawned(AActor* Actor)
+{
+	if (IsSunSkyActor(Actor) || Cast<ADirectionalLight>(Actor))
+	{
+		InvalidateSunCache();
+	}
+}
+
+
+void UPyranometerRegistry::ResolveSun()
+{
+	CachedSunSky.Reset();
+	CachedSunLight.Reset();
+	bSunResolved = true;
+
+	UWorld* World = GetWorld();
+	if (!World)
+		return;
+
+	UDirectionalLightComponent* FirstLight = nullptr;
+	for (TActorIterator<AActor> It(World); It; ++It)
+	{
+		AActor* A = *It;
+		if (!A) continue;
+
+		if (IsSunSkyActor(A))
+		{
+			CachedSunSky = A;
+			break;
+		}
+
+		if (!FirstLight && Cast<ADirectionalLight>(A))
+		{
+			FirstLight = A->FindComponentByClass<UDirectionalLightComponent>();
+		}
+	}
+
+	// SunSky usually has an internal DirectionalLightComponent
+	UDirectionalLightComponent* Light = CachedSunSky.IsValid()
+		? CachedSunSky->FindComponentByClass<UDirectionalLightComponent>()
+		: nullptr;
+
+	// No SunSky (or no light in it): any directional light placed in the level
+	if (!Light && !FirstLight)
+	{
+		for (TActorIterator<ADirectionalLight> It(World); It; ++It)
+		{
+			FirstLight = It->FindComponentByClass<UDirectionalLightComponent>();
+			if (FirstLight) break;
+		}
+	}
+
+	CachedSunLight = Light ? Light : FirstLight;
+
+	PYRANO_VERBOSE(TEXT("[Registry] Sun resolved (SunSky=%s, Light=%s)"),
+		CachedSunSky.IsValid() ? *CachedSunSky->GetName() : TEXT("None"),
+		CachedSunLight.IsValid() ? *CachedSunLight->GetName() : TEXT("None"));
+}
\ No newline at end of file
@@ -3,6 +3,9 @@
 #include "Subsystems/SunSkyController.h"
 #include "EngineUtils.h"
 #include "Components/DirectionalLightComponent.h"
+#include "Engine/DirectionalLight.h"
+#include "Simulation/SolarPosition.h"
+#include "Subsystems/PyranometerRegistry.h"
 #include "Logging/IrradianceLog.h"
 
 // -----------------------------------------------------------------------------
@@ -167,12 +170,53 @@ static void SunAnglesFromDirection(
 
 AActor* USunSkyController::FindSunSkyActor(UWorld* World)
 {
+    if (!World)
+        return nullptr;
+
+    // Cached in the registry (invalidated when actors spawn / get destroyed)
+    if (UPyranometerRegistry* Registry = World->GetSubsystem<UPyranometerRegistry>())
+    {
+        return Registry->GetSunSkyActor();
+    }
+
     // Find SunSky by tag or name
     for (TActorIterator<AActor> It(World); It; ++It)
     {
-        AActor* A = *It;
-        if (A->ActorHasTag(FName("SunSky"))) return A;
-        if (A->GetName().Contains(TEXT("SunSky"))) return A;
+        if (UPyranometerRegistry::IsSunSkyActor(*It)) return *It;
+    }
+    return nullptr;
+}
+
+
+UDirectionalLightComponent* USunSkyController::FindSunLight()
+{
+    if (UWorld* World = GetWorld())
+    {
+        if (UPyranometerRegistry* Registry = World->GetSubsystem<UPyranometerRegistry>())
+        {
+            return Registry->GetSunLight();
+        }
+    }
+
+    // SunSky usually has an internal DirectionalLightComponent
+    if (AActor* SunSky = EnsureSunSky())
+    {
+        if (UDirectionalLightComponent* Light = SunSky->FindComponentByClass<UDirectionalLightComponent>())
+        {
+            return Light;
+        }
+    }
+
+    // No SunSky: any directional light placed in the level
+    if (UWorld* World = GetWorld())
+    {
+        for (TActorIterator<ADirectionalLight> It(World); It; ++It)
+        {
+            if (UDirectionalLightComponent* Light = It->FindComponentByClass<UDirectionalLightComponent>())
+            {
+                return Light;
+            }
+        }
     }
     return nullptr;
 }
@@ -197,13 +241,15 @@ AActor* USunSkyController::EnsureSunSky()
 
 void USunSkyController::ApplyStaticConfig(double Latitude, double Longitude, double Timezone, double NorthOffset, bool bUseDST)
 {
+    // Also needed by the native ephemeris, with or without a SunSky
+    TimezoneHours = Timezone;
+    NorthOffsetDeg = NorthOffset;
+    bHasNativeAngles = false;
+
     if (AActor* SunSky = EnsureSunSky())
     {
         PYRANO_SUCCESS(TEXT("[SunSky] SunSky Actor detected"));
 
-        TimezoneHours = Timezone;
-        NorthOffsetDeg = NorthOffset;
-
         SetDoubleProp(SunSky, TEXT("Latitude"), Latitude);
         SetDoubleProp(SunSky, TEXT("Longitude"), Longitude);
         SetDoubleProp(SunSky, TEXT("TimeZone"), Timezone);
@@ -243,6 +289,10 @@ void USunSkyController::ApplyStaticConfig(double Latitude, double Longitude, dou
             PYRANO_SUCCESS(TEXT("[SunSky] All reflected properties validated OK."));
         }
     }
+    else if (bNativeEphemeris)
+    {
+        PYRANO_INFO(TEXT("[SunSky] SunSky Actor not detected. Native ephemeris will drive the first directional light"));
+    }
     else
     {
         PYRANO_WARN(TEXT("[SunSky] SunSky Actor not detected. Configuration may not be applied"));
@@ -260,17 +310,47 @@ void USunSkyController::SetUTC(const FDateTime& UTC)
 }
 
 
+void USunSkyController::SetUseNativeEphemeris(bool bInNative)
+{
+    bNativeEphemeris = bInNative;
+    bHasNativeAngles = false;
+}
+
+
+bool USunSkyController::SetSolarAnglesDirect(double AzimuthDeg, double AltitudeDeg)
+{
+    NativeAzimuthDeg = AzimuthDeg;
+    NativeAltitudeDeg = AltitudeDeg;
+    bHasNativeAngles = true;
+
+    UDirectionalLightComponent* Light = FindSunLight();
+    if (!Light)
+    {
+        PYRANO_WARN(TEXT("[SunSky] No directional light found. Sun angles kept without a light"));
+        return false;
+    }
+
+    // The light shines along its +X axis, i.e. away from the sun
+    const FVector ToSun = SolarPosition::DirectionFromAngles(AzimuthDeg, AltitudeDeg, NorthOffsetDeg);
+    Light->SetWorldRotation((-ToSun).Rotation());
+    return true;
+}
+
+
 bool USunSkyController::GetSolarAngles(float& OutAzimuthDeg, float& OutAltitudeDeg) const
 {
     OutAzimuthDeg = 0.f;
     OutAltitudeDeg = 0.f;
 
-    AActor* SunSky = const_cast<USunSkyController*>(this)->EnsureSunSky();
-    if (!SunSky)
-        return false;
+    // Native mode: the analytic angles are the reference, not the light read-back
+    if (bNativeEphemeris && bHasNativeAngles)
+    {
+        OutAzimuthDeg = (float)NativeAzimuthDeg;
+        OutAltitudeDeg = (float)NativeAltitudeDeg;
+        return true;
+    }
 
-    // SunSky usually has an internal DirectionalLightComponent
-    if (UDirectionalLightComponent* Sun = SunSky->FindComponentByClass<UDirectionalLightComponent>())
+    if (UDirectionalLightComponent* Sun = const_cast<USunSkyController*>(this)->FindSunLight())
     {
         // Dir from scene to Sun
         const FVector SunDir = -Sun->GetComponentTransform().GetUnitAxis(EAxis::X);
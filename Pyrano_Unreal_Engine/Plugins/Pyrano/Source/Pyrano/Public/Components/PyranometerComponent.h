@@ -7,6 +7,7 @@
 
 #include "CoreMinimal.h"
 #include "Components/SceneComponent.h"
+#include "Simulation/HorizonMap.h"
 #include "PyranometerComponent.generated.h"
 
 /**
@@ -59,6 +60,9 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Pyranometer|Sky")
 	bool bSkyViewFactorValid = false;
 
+	/** Cached horizon map for current pose/normal (null until built). */
+	FSensorHorizonMapPtr HorizonMap;
+
 
 // --- Getters ---
 
@@ -77,9 +81,13 @@ public:
 	float GetSkyViewFactorCached() const { return SkyViewFactor; }
 	bool IsSkyViewFactorValid() const { return bSkyViewFactorValid; }
 
+	/** Horizon map, only if it was built for the current pose/normal. */
+	FSensorHorizonMapPtr GetHorizonMapCached() const;
+
 
 protected:
 	virtual void OnRegister() override;
+	virtual void OnUnregister() override;
 
 private:	
 
@@ -47,6 +47,11 @@ public:
 	/** Computes clear-sky irradiance for a given sun zenith and timestamp (UTC). */
 	FPyranoClearSkyIrradiance Compute(const FDateTime& WhenUTC, double SolarZenithRad) const;
 
+	/** Same as Compute, for an explicit configuration (no UObject access: safe on worker threads). */
+	static FPyranoClearSkyIrradiance ComputeWithConfig(const FPyranoClearSkyConfig& InConfig, const FDateTime& WhenUTC, double SolarZenithRad);
+
+	const FPyranoClearSkyConfig& GetConfig() const { return Config; }
+
 private:
 	FPyranoClearSkyConfig Config;
 
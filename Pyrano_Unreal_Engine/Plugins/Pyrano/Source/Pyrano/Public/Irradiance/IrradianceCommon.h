@@ -5,11 +5,20 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Containers/StaticArray.h"
 
 namespace IrradianceCommon
 {
 	static constexpr int32 NumFaces = 6;
 
+	/** How captured faces reach the integration shader. */
+	enum class EFaceIntegration : uint8
+	{
+		FacesArray,		// faces kept until the batch, then copied into a 6*K array
+		FaceAtlas,		// faces resolved by the view extension into a persistent array (slot * 6 + face), read in place
+		Streamed,		// each face integrated as it arrives (one face RT resident per capture)
+	};
+
 	namespace Defaults
 	{
 		/** Cesium Config */
@@ -21,6 +30,33 @@ namespace IrradianceCommon
 		constexpr int32 SamplesPerPixel				= 4096;		// if too low, this would cap the warmup frames 
 		constexpr int32 EnableReferenceAtmosphere	= 0;
 
+		/** Captures allowed in flight at once (1 = sequential) */
+		constexpr int32 CapturePipelineDepth = 3;
+
+		/** Captures integrated per compute dispatch (1 = one dispatch per capture) */
+		constexpr int32 IntegrationBatchSize = 1;
+
+		/** Integrate kernel used until (or unless) the tuner picks one: 2x2 texels per thread, 8x8 groups */
+		constexpr int32 IntegrateStride = 2;
+		constexpr int32 IntegrateGroupShape = 0;
+
+		/** Faces crossed by the sensor horizon: rendered at this fraction of the side (multiple of 8, min size) */
+		constexpr float GrazingFaceScale = 0.5f;
+		constexpr int32 MinFaceSidePx = 32;
+
+		/** PIE window side when capturing off-screen (the window does not limit the capture size) */
+		constexpr int32 OffscreenWindowPx = 512;
+
+		/** Max rows resolved without capture (night slots) per scheduler tick */
+		constexpr int32 MaxResolvedRowsPerTick = 4096;
+
+		/** Times a failed GPU capture is taken again before its cell is left without result */
+		constexpr int32 MaxCaptureRetries = 2;
+
+		/** Capture result cache: entries kept, and days an unused entry survives */
+		constexpr int32 CaptureCacheMaxEntries = 250000;
+		constexpr int32 CaptureCacheMaxAgeDays = 90;
+
 		/** Simulation time estimation */
 		constexpr float MsPerFrameRaster = 12.f;
 		constexpr float MsPerFramePath	 = 35.f;
@@ -34,6 +70,13 @@ namespace IrradianceCommon
 		/** Sky Factor samples */
 		constexpr int32 SVFSamples = 128;
 
+		/** Horizon map: fine mask near the horizon + coarse skyline profile above it */
+		constexpr int32 HorizonAzimuthBins		= 720;		// 0.5 deg
+		constexpr float HorizonMaskMinDeg		= -2.f;
+		constexpr float HorizonMaskMaxDeg		= 20.f;
+		constexpr float HorizonMaskStepDeg		= 0.5f;
+		constexpr float HorizonProfileStepDeg	= 2.f;
+
 		/** Normalization coefficients */
 		constexpr float DirectLinearCoeff = 2.401e-3f;
 		constexpr float DirectQuadraticCoeff = 5.0299205e-8f;
@@ -45,6 +88,13 @@ namespace IrradianceCommon
 		constexpr bool bApplyIrradianceConfiguration = true;  // true to apply normal config (PT, auto-exposure, etc.)
 		constexpr bool bEnableSunVisibility = true;
 		constexpr bool bEnableSunOcclusion = true;
+		constexpr bool bUseHorizonMap = true;			// sun visibility/occlusion from the per-sensor horizon map
+		constexpr EFaceIntegration FaceIntegration = EFaceIntegration::Streamed;
+		constexpr bool bFusedIrradianceReduce = false;	// single-pass integrate + reduce (last group done reduces the capture)
+		constexpr bool bAutoTuneIntegrateKernel = true;	// time stride / group shape variants on the first use of each resolution
+		constexpr bool bCullCubemapFaces = true;		// skip faces behind the sensor, grazing faces at reduced resolution (streamed only)
+		constexpr bool bRasterCaptureRig = true;		// raster: all faces of a capture rendered in one frame by six scene captures
+		constexpr bool bResumeSimulations = true;		// checkpoint simulations exporting CSV, resume them after a stop or crash
 	}
 
 	namespace Utils
@@ -52,6 +102,12 @@ namespace IrradianceCommon
 		/** Returns view rotations for the +X/-X/+Y/-Y/+Z/-Z cubemap faces */
 		TArray<FQuat> GenerateCubemapFaceQuats();
 
+		/**
+		 * Side in px of each cubemap face (+X/-X/+Y/-Y/+Z/-Z) for a sensor normal:
+		 * 0 if the face is entirely behind the sensor, reduced if the horizon crosses it, SidePx otherwise.
+		 */
+		TStaticArray<int32, NumFaces> PlanCubemapFaces(const FVector& NormalWS, int32 SidePx);
+
 		/** Returns true if the world belongs to a PIE client instance */
 		bool IsPIEClientWorld(const UWorld* W);
 
@@ -0,0 +1,123 @@
+/*=============================================================================
+    IrradianceCubemapArchive.h
+  Packed archive (.pyca) of exported cubemap faces: one file per sensor and
+  UTC day, compressed entries, indexed by (timestamp, face) for random access.
+/============================================================================*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class IFileHandle;
+
+/**
+ * .pyca layout (little-endian):
+ *
+ *  Header   (32 B)  "PYCA", uint32 Version, uint32 GUID[A,B,C,D] of the sensor, 8 B zero padding.
+ *  Entry    (xN)    "PYCE", int64 TimestampTicks (UE ticks, UTC), uint8 Face (+X,-X,+Y,-Y,+Z,-Z),
+ *                   uint8 Codec (0 = raw, 1 = zlib), uint16 reserved, int32 Width, int32 Height,
+ *                   uint32 StoredSize, uint32 RawSize, then StoredSize bytes.
+ *                   Pixels are half-float RGB (3 x uint16), rows top to bottom, no padding.
+ *                   Entry headers make the archive recoverable by a linear scan if the index is missing.
+ *  Index            per entry: int64 TimestampTicks, uint8 Face, uint8 Codec, uint16 reserved,
+ *                   int32 Width, int32 Height, uint64 DataOffset, uint32 StoredSize, uint32 RawSize.
+ *  Trailer  (16 B)  uint64 IndexOffset, uint32 NumEntries, "PYCA".
+ *
+ * Writing an existing archive appends to it (the new index overwrites the old one).
+ */
+namespace PyranoCubemapArchive
+{
+    static constexpr uint32 Version = 1;
+
+    enum class ECodec : uint8
+    {
+        Raw     = 0,
+        Zlib    = 1,
+    };
+
+    struct FEntry
+    {
+        int64   TimestampTicks  = 0;
+        uint8   Face            = 0;
+        ECodec  Codec           = ECodec::Raw;
+        int32   Width           = 0;
+        int32   Height          = 0;
+        uint64  DataOffset      = 0;
+        uint32  StoredSize      = 0;
+        uint32  RawSize         = 0;
+    };
+
+    /** Archive file name for a sensor and UTC day: {SensorGuid}_{YYYYMMDD}.pyca */
+    PYRANO_API FString MakeFileName(const FGuid& SensorId, const FDateTime& UTC);
+}
+
+
+/** Appends faces to an archive. Thread-safe: faces may come from any worker. */
+class PYRANO_API FIrradianceCubemapArchiveWriter
+{
+public:
+
+    ~FIrradianceCubemapArchiveWriter();
+
+    /** Creates the archive, or reopens an existing one to append to it. */
+    bool Open(const FString& InPathAbs, const FGuid& InSensorId);
+
+    /**
+     * Compresses (outside the lock) and appends one face.
+     * @param RGBHalf   Width * Height * 3 half floats.
+     */
+    bool AddFace(int64 TimestampTicks, uint8 Face, int32 Width, int32 Height,
+        TConstArrayView64<FFloat16> RGBHalf, bool bCompress);
+
+    /** Writes the index and the trailer and closes the file. Called by the destructor if needed. */
+    bool Close();
+
+    bool IsOpen() const { return FileHandle.IsValid(); }
+    const FString& GetPath() const { return PathAbs; }
+
+private:
+
+    bool WriteBytes(const void* Data, int64 Size);
+
+    FString                                 PathAbs;
+    FGuid                                   SensorId;
+    TUniquePtr<IFileHandle>                 FileHandle;
+    uint64                                  FileOffset = 0;
+    TArray<PyranoCubemapArchive::FEntry>    Entries;
+    FCriticalSection                        Mutex;
+};
+
+
+/** Random access to the faces of an archive. */
+class PYRANO_API FIrradianceCubemapArchiveReader
+{
+public:
+
+    ~FIrradianceCubemapArchiveReader();
+
+    /** Reads the index. With bScanIfNoIndex, an archive without trailer (interrupted run) is scanned entry by entry. */
+    bool Open(const FString& InPathAbs, bool bScanIfNoIndex = true);
+
+    void Close();
+
+    const FGuid& GetSensorId() const { return SensorId; }
+    const TArray<PyranoCubemapArchive::FEntry>& GetEntries() const { return Entries; }
+
+    /** Index of the entry for (timestamp, face), or INDEX_NONE. */
+    int32 FindEntry(const FDateTime& UTC, uint8 Face) const;
+
+    /** Decompresses one face into Width * Height * 3 half floats (RGB). */
+    bool ReadFace(int32 EntryIdx, TArray64<FFloat16>& OutRGBHalf) const;
+
+private:
+
+    bool ReadAt(uint64 Offset, void* Dst, int64 Size) const;
+    bool ScanEntries(uint64 FileSize);
+
+    FString                                 PathAbs;
+    FGuid                                   SensorId;
+    TUniquePtr<IFileHandle>                 FileHandle;
+    TArray<PyranoCubemapArchive::FEntry>    Entries;
+    TMap<TPair<int64, uint8>, int32>        Lookup;
+    mutable FCriticalSection                ReadMutex;
+};
@@ -9,6 +9,8 @@
 #include "CoreMinimal.h"
 #include "CaptureRequest.generated.h"
 
+struct FSensorHorizonMap;
+
 USTRUCT()
 struct FCaptureRequest
 {
@@ -43,6 +45,12 @@ public:
 	/** Sky View Factor of the sensor. */
 	float SkyViewFactor = -1.0f;
 
+	/** Horizon map of the sensor (null: sun visibility is traced). */
+	TSharedPtr<const FSensorHorizonMap, ESPMode::ThreadSafe> HorizonMap;
+
+	/** SH bands projected from the faces (2..4, see FIrradianceSH), 0 = none. Renders every face. */
+	int32 SHOrder = 0;
+
 
 public:
 
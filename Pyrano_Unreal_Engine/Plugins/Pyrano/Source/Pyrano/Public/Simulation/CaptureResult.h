@@ -0,0 +1,80 @@
+/*=============================================================================
+	CaptureResult.h
+  Output of a single cubemap capture, together with the scene state
+  it was taken under. Produced by the Subsystem, consumed by the Scheduler.
+/============================================================================*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Simulation/CaptureRequest.h"
+#include "Simulation/IrradianceSH.h"
+#include "IneichenPerezClearSky.h"
+
+/** Sun state snapshotted when a capture starts. */
+struct FCaptureSunState
+{
+	/** True if the sun light was found and the angles are meaningful. */
+	bool		bValid			= false;
+
+	/** Solar azimuth (deg, clockwise from North). */
+	float		AzimuthDeg		= 0.f;
+
+	/** Solar altitude above the horizon (deg). */
+	float		AltitudeDeg		= 0.f;
+
+	/** World-space direction from the scene towards the sun. */
+	FVector		ToSunDir		= FVector::UpVector;
+
+	/** Directional light intensity (lux). */
+	float		IlluminanceLux	= 0.f;
+};
+
+
+/** Result of a capture, published in submission order. */
+struct FCaptureResult
+{
+	/** Request that produced this result. */
+	FCaptureRequest		Request;
+
+	/** Sun state at the moment the capture was started. */
+	FCaptureSunState	Sun;
+
+	/** Integrated irradiance: R, G, B and spectral mean (W). */
+	FVector4f			RawRGBM				= FVector4f(0, 0, 0, 0);
+
+	/** False if the result was resolved without a GPU capture (e.g. sun below the horizon). */
+	bool				bCaptured			= true;
+
+	/** True if the GPU capture failed (faces missing, integration or readback lost): no value, not exported. */
+	bool				bFailed				= false;
+
+	/** SH projection of the radiance (Request.SHOrder > 0 only): irradiance for any other normal. */
+	FIrradianceSH		SH;
+
+// --- Derived values ---
+
+	/** Final irradiance after normalization (W/m2). */
+	float				TotalIrradiance		= 0.f;
+
+	/** Direct (beam) term before normalization. */
+	float				DirectIrradiance	= 0.f;
+
+	/** Ambient (sky) term before normalization. */
+	float				AmbientIrradiance	= 0.f;
+
+	/** cos(incidence) x sun visibility. */
+	float				GeometricFactor		= 0.f;
+
+	/** Fraction of the solar disk visible from the sensor [0..1]. */
+	float				SunVisibility		= 0.f;
+
+	/** 1 if the sun ray is blocked, 0 if clear, -1 if not evaluated. */
+	int32				SunOccluded			= -1;
+
+	/** Distance to the sun ray hit (m), -1 if none. */
+	float				SunHitDistanceM		= -1.f;
+
+	/** Clear-sky reference for the capture timestamp. */
+	FPyranoClearSkyIrradiance ClearSky;
+};
@@ -0,0 +1,77 @@
+/*=============================================================================
+	CaptureResultCache.h
+  Raw capture outputs (R, G, B, mean) persisted between runs, keyed by
+  everything that decides them, so re-running a plan skips the GPU work
+  of captures already taken.
+/============================================================================*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/SecureHash.h"
+#include "Simulation/CaptureResult.h"
+
+class UWorld;
+
+/**
+ * A key covers the scene (level files), the sensor pose, SidePx, warmup, the render setup and the
+ * sun; post-processing inputs (clear-sky, turbidity, normalization, export) are not part of it.
+ * Edits that do not change a level file (e.g. a material, or unsaved editor changes) are not
+ * detected: clear the cache or disable it in the plan. Least recently used entries are evicted.
+ */
+class PYRANO_API FCaptureResultCache
+{
+public:
+
+	struct FStats
+	{
+		int32 Hits		= 0;
+		int32 Misses	= 0;
+		int32 Stored	= 0;
+		int32 Evicted	= 0;
+
+		float GetHitRate() const { return (Hits + Misses) > 0 ? float(Hits) / float(Hits + Misses) : 0.f; }
+	};
+
+	/** Saved/Pyrano/CaptureResultCache.csv */
+	static FString GetDefaultPath();
+
+	/** Hash of the files of the levels loaded in World (PIE prefixes removed). */
+	static FString MakeSceneHash(const UWorld* World);
+
+	/** Key of a capture. RenderKey: renderer settings that change the raw output (path tracing, face layout...). */
+	static FSHAHash MakeKey(const FString& SceneHash, const FString& RenderKey, const FCaptureRequest& Req, const FCaptureSunState& Sun);
+
+	/** Loads the cache file (replaces the entries in memory). */
+	bool Load(const FString& Path);
+
+	/** Evicts, then writes every entry to the cache file. */
+	bool Save(const FString& Path);
+
+	/** Raw output of a key, if cached. Counts a hit or a miss. */
+	bool Find(const FSHAHash& Key, FVector4f& OutRawRGBM);
+
+	/** Adds or replaces the entry of a key. */
+	void Store(const FSHAHash& Key, const FVector4f& RawRGBM);
+
+	/** Drops entries unused for CaptureCacheMaxAgeDays, then the least recently used beyond CaptureCacheMaxEntries. */
+	int32 Evict();
+
+	const FStats& GetStats() const { return Stats; }
+	void ResetStats() { Stats = FStats(); }
+
+	int32 Num() const { return Entries.Num(); }
+	bool IsDirty() const { return bDirty; }
+
+private:
+
+	struct FEntry
+	{
+		FVector4f	RawRGBM			= FVector4f(0, 0, 0, 0);
+		int64		LastUsedTicks	= 0;
+	};
+
+	TMap<FSHAHash, FEntry>	Entries;
+	FStats					Stats;
+	bool					bDirty = false;
+};
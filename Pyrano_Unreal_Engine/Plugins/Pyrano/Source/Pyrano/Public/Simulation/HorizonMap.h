@@ -0,0 +1,74 @@
+/*=============================================================================
+	HorizonMap.h
+  Per-sensor obstruction map. Built once per sensor pose with parallel
+  traces, it turns sun visibility / occlusion for any time slot into a
+  table lookup.
+/============================================================================*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Obstruction map around a sensor, in the world frame (elevation above the XY plane,
+ * azimuth = atan2(Y, X)), so it does not depend on the NorthOffset.
+ *
+ *  - Fine mask:  hit distance per (azimuth bin, elevation row) in [MaskMinDeg, MaskMaxDeg].
+ *  - Profile:    highest obstructed elevation per azimuth bin (coarser rows above the mask).
+ */
+struct PYRANO_API FSensorHorizonMap
+{
+	/** Sensor pose the map was built for. */
+	FVector			PosWS					= FVector::ZeroVector;
+	FVector			NormalWS				= FVector::UpVector;
+
+	/** Layout. */
+	int32			AzimuthBins				= 0;
+	int32			MaskRows				= 0;
+	float			MaskMinDeg				= 0.f;
+	float			MaskMaxDeg				= 0.f;
+	float			MaskStepDeg				= 0.f;
+	float			ProfileStepDeg			= 0.f;
+
+	/** Hit distance (m) per [AzBin * MaskRows + Row], -1 if clear. */
+	TArray<float>	MaskHitDistanceM;
+
+	/** Highest obstructed elevation (deg) per azimuth bin, -90 if the column is clear. */
+	TArray<float>	HorizonElevationDeg;
+
+	/** Hit distance (m) at HorizonElevationDeg, -1 if the column is clear. */
+	TArray<float>	HorizonHitDistanceM;
+
+
+	/** True once the tables are filled. */
+	bool IsBuilt() const { return AzimuthBins > 0 && HorizonElevationDeg.Num() == AzimuthBins; }
+
+	/** True if the map was built for this position / normal. */
+	bool MatchesPose(const FVector& InPosWS, const FVector& InNormalWS) const;
+
+	/** Hit distance (m) along a world direction, -1 if the direction is clear. */
+	float LookupHitDistanceM(const FVector& DirWS) const;
+
+	/** True if a world direction is blocked. */
+	bool IsOccluded(const FVector& DirWS) const { return LookupHitDistanceM(DirWS) >= 0.f; }
+
+	/**
+	 * Fraction of the solar disk visible [0..1], sampling the same cone
+	 * as the traced version (UIrradianceSubsystem::ComputeSunVisibility).
+	 */
+	float SunVisibility(const FVector& ToSunDir, int32 NumSamples, int32 Seed) const;
+
+	/**
+	 * Builds a map calling TraceHitDistanceM(DirWS) for every cell, in parallel.
+	 * The callback must be thread-safe and return the hit distance (m), or -1 if clear.
+	 */
+	static TSharedPtr<const FSensorHorizonMap, ESPMode::ThreadSafe> Build(
+		const FVector& InPosWS,
+		const FVector& InNormalWS,
+		TFunctionRef<float(const FVector& DirWS)> TraceHitDistanceM);
+
+	/** World direction for an azimuth / elevation pair of this map (deg). */
+	static FVector DirectionFromAzEl(double AzDeg, double ElDeg);
+};
+
+using FSensorHorizonMapPtr = TSharedPtr<const FSensorHorizonMap, ESPMode::ThreadSafe>;
@@ -0,0 +1,62 @@
+/*=============================================================================
+	IrradianceReevaluation.h
+  Recomputes the derived columns of an exported irradiance CSV (clear-sky
+  reference, min sun altitude cutoff, normalization) from its stored raw
+  components, without rendering anything.
+/============================================================================*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IneichenPerezClearSky.h"
+#include "Simulation/SimulationConfig.h"
+
+/**
+ * What a re-evaluation applies to the stored rows. Inputs kept as stored:
+ * raw_r/g/b and their mean, the direct component, geometric factor and sun visibility.
+ */
+struct PYRANO_API FIrradianceReevaluationOptions
+{
+	FIrradianceNormalization	Normalization;
+
+	/**
+	 * Rows at or below this altitude get no direct nor ambient term. Raising it re-evaluates
+	 * exactly; lowering it below the cutoff of the original run cannot restore the direct
+	 * term of those rows (the sun was never evaluated there).
+	 */
+	float						MinSunAltitudeDeg = 0.f;
+
+	bool						bClearSky = true;
+	FPyranoClearSkyConfig		ClearSkyConfig;
+
+	/** Also writes the result as a columnar binary file (.pyrb) next to the output CSV. */
+	bool						bExportBinary = false;
+
+	/** The post-processing settings of a simulation plan. */
+	static FIrradianceReevaluationOptions FromSimConfig(const FSimConfig& Sim);
+};
+
+/** Outcome of PyranoReevaluation::ReevaluateCSV. */
+struct PYRANO_API FIrradianceReevaluationReport
+{
+	int32	Rows			= 0;
+	int32	Sensors			= 0;
+	int32	ClearSkyEvaluations = 0;	// once per UTC time run (rows of a time slot share it)
+	int32	BadRows			= 0;	// unparsable lines (dropped)
+	int32	RowsCutOff		= 0;	// at or below MinSunAltitudeDeg
+	double	ParseSeconds	= 0.0;
+	double	ComputeSeconds	= 0.0;
+	double	WriteSeconds	= 0.0;
+	TArray<FString> Errors;
+};
+
+namespace PyranoReevaluation
+{
+	/**
+	 * Reads every row of InCSVPath, recomputes the derived columns in one batch and writes
+	 * them to OutCSVPath (same columns and row order, overwritten). The input is streamed in
+	 * blocks of whole lines; each block is parsed and evaluated in parallel over column arrays.
+	 */
+	PYRANO_API bool ReevaluateCSV(const FString& InCSVPath, const FString& OutCSVPath,
+		const FIrradianceReevaluationOptions& Options, FIrradianceReevaluationReport& OutReport);
+}
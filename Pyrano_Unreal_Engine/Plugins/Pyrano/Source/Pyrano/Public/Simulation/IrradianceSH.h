@@ -0,0 +1,56 @@
+/*=============================================================================
+	IrradianceSH.h
+  Spherical-harmonic projection of the radiance seen by a capture. One
+  capture then answers the irradiance of any orientation at its position
+  (tilt / azimuth sweeps) without rendering again.
+/============================================================================*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Radiance of a capture projected on the real SH basis (world space), per RGB channel.
+ * Filled on the GPU from the six faces (see FIrradianceSHProjectCS) when the request
+ * asks for it; empty otherwise.
+ *
+ * Irradiance only needs 3 bands (the cosine lobe has no band 3); 4 bands keep more of the
+ * radiance itself. For a panel of tilt T facing azimuth A, the normal is
+ * SolarPosition::DirectionFromAngles(A, 90 - T, NorthOffset).
+ */
+struct PYRANO_API FIrradianceSH
+{
+	static constexpr int32 MinOrder		= 2;
+	static constexpr int32 MaxOrder		= 4;
+	static constexpr int32 MaxCoeffs	= MaxOrder * MaxOrder;
+
+	/** Bands of the projection (Order^2 coefficients per channel), 0 if none. */
+	int32				Order = 0;
+
+	/** Order^2 RGB coefficients, band-major (l, then m = -l..l). */
+	TArray<FVector3f>	Coeffs;
+
+	static int32 GetNumCoeffs(int32 InOrder) { return InOrder * InOrder; }
+	static bool IsValidOrder(int32 InOrder) { return InOrder >= MinOrder && InOrder <= MaxOrder; }
+	bool IsValid() const { return IsValidOrder(Order) && Coeffs.Num() == GetNumCoeffs(Order); }
+
+	/** Real SH basis at a unit direction: Order^2 values into OutBasis. Same basis as the shader. */
+	static void EvaluateBasis(const FVector3f& Dir, int32 InOrder, float* OutBasis);
+
+	/** Sums the per-face projections read back from the GPU: 6 x Order^2 float4 (rgb), face-major. */
+	static FIrradianceSH FromFaceSums(int32 InOrder, TConstArrayView<FVector4f> FaceSums);
+
+	/**
+	 * Irradiance on a surface facing NormalWS (cosine-convolved radiance), in the units of
+	 * FCaptureResult::RawRGBM: R, G, B and their mean. Zero if not valid.
+	 */
+	FVector4f EvaluateIrradiance(const FVector& NormalWS) const;
+
+	/** Same as EvaluateIrradiance for many normals (orientation sweeps). OutRGBM must be as long as NormalsWS. */
+	void EvaluateIrradiance(TConstArrayView<FVector> NormalsWS, TArrayView<FVector4f> OutRGBM) const;
+
+private:
+
+	/** Coefficients convolved with the clamped cosine lobe (band l scaled by A_l). */
+	void GetIrradianceCoeffs(FVector3f* OutCoeffs) const;
+};
@@ -10,12 +10,18 @@
 #include "Subsystems/WorldSubsystem.h"
 #include "Simulation/SimulationConfig.h"
 #include "Simulation/CaptureRequest.h"
+#include "Simulation/CaptureResult.h"
+#include "Simulation/SolarPosition.h"
+#include "Simulation/HorizonMap.h"
+#include "Simulation/SkyViewFactorCache.h"
+#include "Simulation/SimulationShard.h"
+#include "Simulation/SimulationCheckpoint.h"
 #include "IrradianceScheduler.generated.h"
 
 class UIrradianceSubsystem;
 class UPyranometerComponent;
 
-enum class ESchedulerState : uint8 { Idle, Capturing };
+enum class ESchedulerState : uint8 { Idle, Preparing, Capturing };
 
 UCLASS()
 class PYRANO_API UIrradianceScheduler : public UWorldSubsystem, public FTickableGameObject
@@ -41,6 +47,15 @@ public:
 	/** Returns the current scheduler state. */
 	ESchedulerState GetState() const { return State; }
 
+	/** Progress of the preparation pre-pass [0..1] (1 when not preparing). */
+	float GetPreparationProgress() const;
+
+	/** Results received since the last CaptureOnce / StartSimulation (captured or resolved without GPU work). */
+	int32 GetNumResults() const { return NumResults; }
+
+	/** Results of the last run that came from an actual capture. */
+	int32 GetNumCapturedResults() const { return NumCapturedResults; }
+
 // --- FTickableGameObject Interface ---
 
 	virtual void Tick(float DeltaTime) override;
@@ -58,9 +73,12 @@ private:
 	/** Applies static SunSky configuration (lat/lon/timezone/northoffset). */
 	void ConfigureSunSkyOnce(const FSimConfig& Sim);
 
-	/** Sets the SunSky UTC time. */
+	/** Sets the sun for a UTC time (native ephemeris, or the SunSky Blueprint fallback). */
 	void SetSunSkyUTC(const FDateTime& Utc);
 
+	/** Sets the sun for a time slot, reusing the angles precomputed at simulation start. */
+	void ApplySunForSlot(int32 SlotIdx);
+
 // --- Viewport ---
 
 	/** Forces a square viewport suitable for the simulation/capture. */
@@ -77,19 +95,71 @@ private:
 	/** Builds a capture request for the given sensor and simulation settings. */
 	FCaptureRequest MakeRequest(const FSimConfig& Sim, UPyranometerComponent* Sensor) const;
 
-	/** Consumes the latest irradiance value from the subsystem, if available. */
-	bool ConsumeIrradianceResult(float& OutValue);
+	/** Returns the sensor horizon map, building it on first use for the current pose. */
+	FSensorHorizonMapPtr EnsureHorizonMap(UPyranometerComponent* Sensor, const FCaptureRequest& Req);
+
+	/** Builds the request for a sensor at the current time slot (computes its SVF once). */
+	FCaptureRequest MakeSimulationRequest(const FSimConfig& Sim, UPyranometerComponent* Sensor);
+
+	/** Copies SVF and horizon map of the sensor into Req (computing them if still missing). */
+	void AttachSensorSkyData(UPyranometerComponent* Sensor, FCaptureRequest& Req);
+
+// --- Sky View Factor pre-pass ---
+
+	/** Applies cached SVFs and issues async SVF traces for the remaining sensors. */
+	void BeginSkyViewFactorPrepass(const FSimConfig& Sim, const TArray<UPyranometerComponent*>& InSensors);
+
+	/** Reports progress; once the traces are done, applies and persists the results. True when finished. */
+	bool TickSkyViewFactorPrepass();
 
 // --- Simulation flow ---
 
 	/** Builds the list of time slots between StartUTC and EndUTC (inclusive). */
 	void BuildTimeSlots(const FDateTime& StartUTC, const FDateTime& EndUTC, const FTimespan& Step);
 
-	/** Launches the next capture for the current time slot and sensor index. */
+	/** Keeps only the time slots and sensors of the shard selected by Sim, and records its manifest. */
+	void ApplyShard(const FSimConfig& Sim);
+
+	/** Writes the shard manifest next to the exported rows. */
+	void WriteShardManifest();
+
+// --- Checkpoint ---
+
+	/** Loads the checkpoint of this run; if it matches Sim, moves the cursor after its last durable row. */
+	void BeginCheckpointing(const FSimConfig& Sim);
+
+	/** Saves the checkpoint once more exported rows are durable. */
+	void TickCheckpoint();
+
+	/** Local (time slot, sensor) cell of a simulation result, INDEX_NONE if unknown. */
+	int32 GetResultCell(const FCaptureRequest& Req) const;
+
+	/** Local time slot of a simulation request, INDEX_NONE if outside the run. */
+	int32 GetResultSlot(const FCaptureRequest& Req) const;
+
+	/** Computes the analytic solar position of every time slot. */
+	void ComputeSlotSunAngles(const FSimConfig& Sim);
+
+	/** True if the sun is at or below MinSunAltitudeDeg in this slot (no capture needed). */
+	bool IsSlotBelowMinAltitude(int32 SlotIdx) const;
+
+	/** Submits zero results for every sensor of the current slot, without any GPU work. */
+	void ResolveBelowHorizonSlot(const FSimConfig& Sim);
+
+	/** Launches the next capture for the current time slot and sensor index, if the pipeline has room. */
 	void LaunchNextSimulationCapture(const FSimConfig& Sim);
 
-	/** Advances to the next time slot, or finalizes the simulation if finished. */
-	void AdvanceTimeSlotOrFinish();
+	/** Moves the launch cursor to the next sensor, or to the next time slot after the last sensor. */
+	void AdvanceSimulationCursor();
+
+	/** Launches the oldest failed capture again, under the sun of its own slot. Returns false while retries are pending. */
+	bool LaunchSimulationRetry();
+
+	/** Queues a failed capture to be taken again, or gives its cell up after MaxCaptureRetries. */
+	void RetryFailedCapture(const FCaptureRequest& Req);
+
+	/** Finalizes the simulation once every capture has been launched and completed. */
+	void FinishSimulationIfDrained();
 
 // --- CaptureOnce flow ---
 
@@ -101,11 +171,11 @@ private:
 	/** Prepares SunSky, export and viewport settings for a simulation. */
 	void PrepareSimulation(const FSimConfig& Sim, const FDateTime& InitialTimeUTC);
 
-	/** Starts a six-face capture for the given request. */
-	void LaunchCapture(const FCaptureRequest& Req);
+	/** Starts a six-face capture for the given request, or publishes its cached result. Returns false if it was not accepted. */
+	bool LaunchCapture(const FCaptureRequest& Req, bool* bOutCached = nullptr);
 
-	/** Handles a completed capture and advances the flow. */
-	void OnCaptureCompleted(float IrrValue);
+	/** Handles a completed capture (bound to UIrradianceSubsystem::OnCaptureCompleted). */
+	void OnCaptureCompleted(const FGuid& RequestId, const FCaptureResult& Result);
 
 	/** Returns true if running a multi-slot simulation. */
 	bool IsSimulationMode() const { return Sensors.Num() > 0 && TimeSlots.Num() > 0; }
@@ -115,19 +185,49 @@ private:
 	// Internal 
 	ESchedulerState State =				 ESchedulerState::Idle;
 	TQueue<FCaptureRequest>				 Queue;
-	TOptional<FCaptureRequest>			 Current;
 	TWeakObjectPtr<UIrradianceSubsystem> Irr;
 	TArray<UPyranometerComponent*>		 Sensors;
 
 	// Simulation
 	FSimConfig			BaseSimConfig;
 	TArray<FDateTime>	TimeSlots;
+	TArray<FSolarAngles> SlotSunAngles;
 	int32 TimeIndex   = 0;
 	int32 SensorIndex = 0;
 
+	/** Time slot the SunSky is currently set to (INDEX_NONE if unknown). */
+	int32 AppliedSunTimeIndex = INDEX_NONE;
+
 	/** Whether we forced the viewport and should restore it afterwards. */	
 	bool bViewportForced = false;
 
-	/** Whether there is a capture currently in flight. */
-	bool bCaptureInFlight = false;  
+	/** Number of captures launched and not yet completed. */
+	int32 CapturesInFlight = 0;
+
+	/** Part of the grid this instance runs (ShardCount 1 when not sharded). */
+	FSimShardManifest ShardManifest;
+
+	// Checkpoint
+	bool				bCheckpointing = false;
+	bool				bResuming      = false;
+	FSimCheckpoint		Checkpoint;
+	FString				CheckpointPath;
+	TMap<FGuid, int32>	SensorIndexById;
+	TArray<int32>		PendingRowCells;	// cells of the exported rows not covered by the checkpoint yet, in row order
+	uint64				CheckpointedRows = 0;
+
+	// Failed captures (FCaptureResult::bFailed), taken again
+	TArray<FCaptureRequest>				RetryRequests;		// simulation: launched before the cursor moves on
+	TMap<TPair<FGuid, int64>, int32>	RetryAttempts;		// (sensor, UTC ticks) -> retries so far
+	TSet<int32>							UnsavedRetryCells;	// retried cells without a durable row: the checkpoint waits
+
+	/** Results of the current / last run (kept after it ends, reset when a new one starts). */
+	int32 NumResults         = 0;
+	int32 NumCapturedResults = 0;
+
+	// Sky View Factor pre-pass
+	FSkyViewFactorCache SVFCache;
+	TArray<TWeakObjectPtr<UPyranometerComponent>> PrepassSensors;
+	int32  LastPrepassReportPct = 0;
+	double PrepassStartTime     = 0.0;
 };
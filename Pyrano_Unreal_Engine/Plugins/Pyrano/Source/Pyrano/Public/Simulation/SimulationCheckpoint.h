@@ -0,0 +1,39 @@
+/*=============================================================================
+	SimulationCheckpoint.h
+  Cursor of a running simulation, persisted next to its output each time
+  exported rows become durable, so a stopped or crashed run can resume.
+/============================================================================*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FSimConfig;
+
+/**
+ * The cursor is the (time slot, sensor) cell following the last durable row, and CSVBytes the
+ * size of the CSV at that row: a resumed run truncates the CSV there (dropping rows written
+ * after the checkpoint and any torn line) and appends from the cursor on. Only runs with the
+ * same ConfigHash resume. Saved through a temporary file and a rename, never half written.
+ */
+struct PYRANO_API FSimCheckpoint
+{
+	FString	ConfigHash;
+	FString	CSVFile;			// file name, relative to the checkpoint
+	int64	CSVBytes	= 0;
+	int32	TimeIndex	= 0;	// next cell to launch
+	int32	SensorIndex	= 0;
+	int32	NumResumes	= 0;	// runs that continued this output
+
+	/** <OutputDir>/<BaseName><ShardSuffix>.checkpoint */
+	static FString GetPath(const FString& OutputDir, const FString& BaseName, const FString& ShardSuffix);
+
+	/**
+	 * Hash of everything that decides the rows of a run: the config (minus output, pipelining and
+	 * image settings), the sensors in serial order and the number of time slots.
+	 */
+	static FString MakeConfigHash(const FSimConfig& Sim, TConstArrayView<FGuid> Sensors, int32 NumSlots);
+
+	bool Save(const FString& Path) const;
+	bool Load(const FString& Path);
+};
@@ -7,8 +7,47 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Irradiance/IrradianceCommon.h"
 #include "SimulationConfig.generated.h"
 
+/**
+ * Maps the simulated components (lux) to the normalized irradiance (W/m2).
+ * Applied after the GPU result: a finished run can be re-evaluated with other
+ * coefficients without rendering (see IrradianceReevaluation.h).
+ */
+USTRUCT(BlueprintType)
+struct FIrradianceNormalization
+{
+    GENERATED_BODY()
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Normalization")
+    float DirectLinearCoeff = IrradianceCommon::Defaults::DirectLinearCoeff;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Normalization")
+    float DirectQuadraticCoeff = IrradianceCommon::Defaults::DirectQuadraticCoeff;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Normalization")
+    float AmbientLinearCoeff = IrradianceCommon::Defaults::AmbientLinearCoeff;
+
+    /** Ambient component = mean of the captured cubemap x this scale. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Normalization")
+    float AmbientIrradianceScale = IrradianceCommon::Defaults::AmbientIrradianceScale;
+
+    /** Normalized total irradiance from the direct and ambient components. */
+    float Apply(float DirectLux, float AmbientLux) const
+    {
+        return DirectLinearCoeff * DirectLux
+            + DirectQuadraticCoeff * DirectLux * DirectLux
+            + AmbientLinearCoeff * AmbientLux;
+    }
+
+    bool IsValid() const
+    {
+        return FMath::IsFinite(DirectLinearCoeff) && FMath::IsFinite(DirectQuadraticCoeff)
+            && FMath::IsFinite(AmbientLinearCoeff) && FMath::IsFinite(AmbientIrradianceScale);
+    }
+};
+
 USTRUCT(BlueprintType)
 struct FSimConfig
 {
@@ -44,24 +83,89 @@ struct FSimConfig
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Capture")
     bool bPathTracing = false;
 
+    /**
+     * Renders the faces into plugin-owned render targets instead of the player view: the PIE
+     * viewport is neither resized nor hijacked, ResolutionPx may exceed the monitor, and runs
+     * work headless (-RenderOffscreen).
+     */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Capture")
+    bool bOffscreenCapture = false;
+
+    /**
+     * Reuses raw capture outputs of earlier runs with the same scene, sensor, render settings and sun
+     * (Saved/Pyrano/CaptureResultCache.csv): changing only export, clear-sky or normalization settings
+     * re-renders nothing. Disable after edits that do not touch the level files (see CaptureResultCache.h).
+     */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Capture")
+    bool bUseCaptureCache = true;
+
+    /** Captures kept in flight at once: later ones render while earlier ones integrate and read back. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Capture", meta = (ClampMin = "1", ClampMax = "64"))
+    int32 CapturePipelineDepth = 3;
+
+    /** Finished captures integrated together in one dispatch and readback. Only pays off with CapturePipelineDepth above it. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Capture", meta = (ClampMin = "1", ClampMax = "64"))
+    int32 IntegrationBatchSize = 1;
+
+    /**
+     * SH bands each capture is also projected on (0 = off, 2..4), so the irradiance of any other
+     * orientation at the sensor can be evaluated offline (see FIrradianceSH). Written next to the CSV
+     * as <name>_sh.csv. Turns off face culling and the capture cache; 3 bands are exact for irradiance.
+     */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Capture", meta = (ClampMin = "0", ClampMax = "4"))
+    int32 SHOrder = 0;
+
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Capture")
     bool bExportCSV = false;
 
+    /** Also writes the results as a columnar binary file (.pyrb) next to the CSV, for fast loading. Not written by resumed runs. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Capture")
+    bool bExportBinary = false;
+
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Output")
     FDirectoryPath OutputPath;
 
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Capture")
     bool bExportImages = false;
 
+    /** Packs exported faces into one .pyca archive per sensor and UTC day instead of six loose EXR files per capture. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Capture", meta = (EditCondition = "bExportImages"))
+    bool bArchiveImages = true;
+
+    /** Exported faces are half floats; lossless compression (zlib in archives, ZIP in EXR) when true, uncompressed otherwise. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Capture", meta = (EditCondition = "bExportImages"))
+    bool bCompressImages = true;
+
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sun")
     float MinSunAltitudeDeg = 0.f; 
 
+    /** Drives the sun through the SunSky Blueprint (reflection + construction script) instead of the native ephemeris. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sun")
+    bool bUseSunSkyBlueprint = false;
+
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ClearSky")
     float AltitudeMeters = 500.f;
 
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ClearSky")
     float LinkeTurbidity = 2.f;
 
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Normalization")
+    FIrradianceNormalization Normalization;
+
+    /** Contiguous blocks the time slots are split into, one per engine instance (see SimulationShard.h). */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sharding", meta = (ClampMin = "1"))
+    int32 TimeShards = 1;
+
+    /** Blocks the sensors (in GUID order) are split into; shards = TimeShards x SensorShards. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sharding", meta = (ClampMin = "1"))
+    int32 SensorShards = 1;
+
+    /** Shard run by this instance, in [0, GetShardCount()). */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sharding", meta = (ClampMin = "0"))
+    int32 ShardIndex = 0;
+
+    int32 GetShardCount() const { return FMath::Max(1, TimeShards) * FMath::Max(1, SensorShards); }
+
 
     bool IsValid() const
     {
@@ -70,7 +174,10 @@ struct FSimConfig
             && ResolutionPx > 0
             && WarmupFrames > 0
             && StartTime < EndTime
-            && SampleInterval.GetTotalSeconds() > 0;
+            && SampleInterval.GetTotalSeconds() > 0
+            && Normalization.IsValid()
+            && (SHOrder == 0 || (SHOrder >= 2 && SHOrder <= 4))
+            && ShardIndex >= 0 && ShardIndex < GetShardCount();
     }
 };
 
@@ -0,0 +1,90 @@
+/*=============================================================================
+	SimulationShard.h
+  Splits the (time slot, sensor) grid of a simulation across engine
+  instances, and merges their outputs back into one serial-ordered file.
+/============================================================================*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FSimConfig;
+
+/**
+ * Part of the grid run by one instance. Slots are split into TimeShards contiguous blocks and
+ * sensors (sorted by GUID, the serial order) into SensorShards blocks; shard i gets time block
+ * i / SensorShards and sensor block i % SensorShards. Every instance derives the same split.
+ */
+struct PYRANO_API FSimShard
+{
+	int32 Index			= 0;
+	int32 Count			= 1;
+	int32 SlotBegin		= 0;	// [SlotBegin, SlotEnd) in the serial time slots
+	int32 SlotEnd		= 0;
+	int32 SensorBegin	= 0;	// [SensorBegin, SensorEnd) in the GUID-sorted sensors
+	int32 SensorEnd		= 0;
+
+	/** Shard selected by Sim for a grid of NumSlots x NumSensors. */
+	static FSimShard Make(const FSimConfig& Sim, int32 NumSlots, int32 NumSensors);
+
+	bool IsSharded() const { return Count > 1; }
+
+	/** "_shard003of008", appended to the output file names. */
+	static FString MakeFileSuffix(int32 Index, int32 Count);
+};
+
+
+/**
+ * Written next to the rows of a shard (<csv>.shard): what the shard was asked to produce, so the
+ * merge can check that the shards of a run agree and cover the whole grid.
+ */
+struct PYRANO_API FSimShardManifest
+{
+	int32		ShardIndex		= 0;
+	int32		ShardCount		= 1;
+	int32		TimeShards		= 1;
+	int32		SensorShards	= 1;
+	FDateTime	StartUTC;
+	FDateTime	EndUTC;
+	int64		StepTicks		= 0;
+	int32		TotalSlots		= 0;
+	int32		TotalSensors	= 0;
+	int32		SlotBegin		= 0;
+	int32		SlotEnd			= 0;
+	FString		CSVFile;			// file name, relative to the manifest
+	TArray<FGuid> Sensors;			// sensors of this shard, serial order
+
+	/** <csv path>.shard */
+	static FString GetPath(const FString& CSVPathAbs);
+
+	bool Save(const FString& Path) const;
+	bool Load(const FString& Path);
+
+	/** True if both shards belong to the same run (same grid and split). */
+	bool IsSameRun(const FSimShardManifest& Other) const;
+};
+
+
+/** Outcome of PyranoShardMerge::MergeCSV. */
+struct PYRANO_API FSimShardMergeReport
+{
+	int32	NumShards		= 0;
+	int32	ExpectedRows	= 0;
+	int32	RowsWritten		= 0;
+	int32	DuplicateRows	= 0;	// same sensor / UTC seen more than once (the last one is kept)
+	int32	UnexpectedRows	= 0;	// outside the grid of their shard (dropped)
+	int32	MissingRows		= 0;
+	TArray<FString> Errors;
+};
+
+
+namespace PyranoShardMerge
+{
+	/**
+	 * Merges the CSVs of every shard of BaseName (e.g. "irradiance") found in Dir into OutCSVPath,
+	 * ordered like a serial run (time slot, then sensor GUID). Fails on inconsistent or missing
+	 * shards, and on missing rows unless bAllowMissing.
+	 */
+	PYRANO_API bool MergeCSV(const FString& Dir, const FString& BaseName, const FString& OutCSVPath,
+		bool bAllowMissing, FSimShardMergeReport& OutReport);
+}
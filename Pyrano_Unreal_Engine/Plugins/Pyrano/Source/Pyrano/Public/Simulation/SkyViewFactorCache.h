@@ -0,0 +1,45 @@
+/*=============================================================================
+	SkyViewFactorCache.h
+  Sky view factors persisted between runs, so sensors whose pose did not
+  change skip the SVF pre-pass.
+/============================================================================*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** SVF results keyed by sensor GUID. An entry is only reused for the same map, pose and sample count. */
+class PYRANO_API FSkyViewFactorCache
+{
+public:
+
+	/** Saved/Pyrano/SkyViewFactorCache.csv */
+	static FString GetDefaultPath();
+
+	/** Loads the cache file. Entries from another map are discarded. */
+	bool Load(const FString& Path, const FString& InMapName);
+
+	/** Writes every entry to the cache file. */
+	bool Save(const FString& Path) const;
+
+	/** Returns a cached SVF if the entry matches the given pose and sample count. */
+	bool Find(const FGuid& SensorId, const FVector& PosWS, const FVector& NormalWS, int32 NumSamples, float& OutSVF) const;
+
+	/** Adds or replaces the entry of a sensor. */
+	void Store(const FGuid& SensorId, const FVector& PosWS, const FVector& NormalWS, int32 NumSamples, float SVF);
+
+	int32 Num() const { return Entries.Num(); }
+
+private:
+
+	struct FEntry
+	{
+		FVector	PosWS		= FVector::ZeroVector;
+		FVector	NormalWS	= FVector::UpVector;
+		int32	NumSamples	= 0;
+		float	SVF			= -1.f;
+	};
+
+	FString MapName;
+	TMap<FGuid, FEntry> Entries;
+};
@@ -0,0 +1,39 @@
+/*=============================================================================
+	SolarPosition.h
+  Analytic solar ephemeris (PSA algorithm, Blanco-Muriel et al. 2001).
+  Lets the Scheduler know where the sun is without touching the SunSky.
+/============================================================================*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Topocentric solar angles, solar-standard convention. */
+struct FSolarAngles
+{
+	/** Azimuth (deg), clockwise from North (0=N, 90=E, 180=S, 270=W). */
+	double	AzimuthDeg		= 0.0;
+
+	/** Altitude above the horizon (deg), parallax-corrected, no refraction. */
+	double	AltitudeDeg		= 0.0;
+};
+
+
+namespace SolarPosition
+{
+	/**
+	 * Computes the solar position for a UTC instant and a geographic location.
+	 * Accuracy ~0.01 deg for years 1999-2015, degrading slowly outside that range.
+	 *
+	 * @param UTC            Instant in UTC.
+	 * @param LatitudeDeg    Geographic latitude (deg, North positive).
+	 * @param LongitudeDeg   Geographic longitude (deg, East positive).
+	 */
+	PYRANO_API FSolarAngles Compute(const FDateTime& UTC, double LatitudeDeg, double LongitudeDeg);
+
+	/**
+	 * World-space unit vector from the scene towards the sun.
+	 * World North is +X rotated by NorthOffsetDeg around +Z (same convention as the SunSky).
+	 */
+	PYRANO_API FVector DirectionFromAngles(double AzimuthDeg, double AltitudeDeg, double NorthOffsetDeg);
+}
@@ -9,12 +9,20 @@
 #include "CoreMinimal.h"
 #include "Subsystems/WorldSubsystem.h"
 #include "Tickable.h"
+#include "WorldCollision.h"
+#include "Tasks/Task.h"
 #include "RHIGPUReadback.h"    
+#include <atomic>
 #include "RenderGraphResources.h"
 #include "Irradiance/IrradianceViewExtension.h"
 #include "Irradiance/IrradianceExporter.h"
+#include "Irradiance/IrradianceIntegrateCS.h"
 #include "IneichenPerezClearSky.h"
 #include "Simulation/CaptureRequest.h"
+#include "Simulation/CaptureResult.h"
+#include "Simulation/HorizonMap.h"
+#include "Simulation/CaptureResultCache.h"
+#include "Simulation/SimulationConfig.h"
 #include "IrradianceSubsystem.generated.h"
 
 struct IPooledRenderTarget;
@@ -24,10 +32,34 @@ enum class ECaptureState : uint8
 {
 	Idle,
 	Capturing,
+	PendingIntegration,
 	WaitingReadback
 };
 
 
+//------ STREAMED INTEGRATION ------
+
+/** Partial sums of a capture integrated face by face. Shared with the render thread, which owns the buffer. */
+struct FStreamedIntegration
+{
+	/** GroupsX * GroupsY float4 per face (at the full side), 6 faces. Created by the first face. */
+	TRefCountPtr<FRDGPooledBuffer> PartialSums;
+
+	/** Integrate kernel picked by the first face, kept for the other ones. */
+	FIrradianceKernelConfig KernelConfig;
+
+	/** Fused reduce only: groups done so far, and the float4 result written by the last one. */
+	TRefCountPtr<FRDGPooledBuffer> DoneCounter;
+	TRefCountPtr<FRDGPooledBuffer> Result;
+
+	/** SH requested only: 6 * Order^2 float4, one projection per face. */
+	TRefCountPtr<FRDGPooledBuffer> SH;
+
+	/** Set on RT if a face could not be integrated (the sum is incomplete). */
+	bool bFailed = false;
+};
+
+
 //------ CAPTURE CONTEXT ------
 struct FCaptureContext
 {
@@ -36,26 +68,42 @@ struct FCaptureContext
 	/** Original capture request parameters. */
 	FCaptureRequest Request;
 
+	/** Pipeline state of this slot. */
+	ECaptureState State = ECaptureState::Idle;
+
+	/** Submission order, used to publish results in the same order they were requested. */
+	uint64 Sequence = 0;
+
+	/** Index of this context in the capture ring (its slot in the face atlas). Not reset. */
+	int32 RingSlot = 0;
+
+	/** Sun state at the moment the capture started. */
+	FCaptureSunState Sun;
+
+	/** Render setup the capture was started with (capture cache key, see MakeCaptureRenderKey). */
+	FString RenderKey;
+
 	/** Current face index being captured [0..NumFaces-1], or INDEX_NONE when done. */
 	int32 FaceIndex = 0;
 
 	/** Number of faces successfully collected. */
 	int32 FacesCollected = 0;
 
+	/** Side in px of each face for this capture (0 = culled, not rendered), and how many are rendered. */
+	TStaticArray<int32, NumFaces> FaceSidePx;
+	int32 NumPlannedFaces = NumFaces;
+
+	/** Faces rendered all at once by the raster capture rig instead of one per frame through the view. */
+	bool bRigCapture = false;
+
 	/** Fixed rotations for each cubemap face (world space). */
 	TArray<FQuat> FixedFaceRots;
 
-	/** Per-face render targets collected from the view extension. */
+	/** Per-face render targets collected from the view extension (faces array), or the face atlas holding them. */
 	TStaticArray<TRefCountPtr<IPooledRenderTarget>, NumFaces> FaceRTs;
 
-	/** GPU buffer containing the extracted irradiance scalar (1 float). */
-	TRefCountPtr<FRDGPooledBuffer> ExtractedIrradianceBuffer;
-
-	/** Helper object used to asynchronously read back the irradiance buffer. */
-	TUniquePtr<FRHIGPUBufferReadback> IrradianceReadback;
-
-	/** Whether a GPU readback pass has been enqueued. */
-	bool bReadbackEnqueued = false;
+	/** Faces already integrated on the render thread (streamed integration only). */
+	TSharedPtr<FStreamedIntegration, ESPMode::ThreadSafe> Streamed;
 
 // --- API ---
 
@@ -82,26 +130,85 @@ struct FCaptureContext
 	bool HasMoreFaces() const;
 	bool IsLastFace() const;
 	int32 GetCurrentFaceIndex() const;
+	int32 GetCurrentFaceSidePx() const;
 	void StoreFaceRT(TRefCountPtr<IPooledRenderTarget>&& InRT);
+	void MarkFaceStreamed();
 	void AdvanceFace();
 	void MarkFacesDone();
 	bool AreFacesReady() const;
-	void GatherFaces(TRefCountPtr<IPooledRenderTarget> OutFaces[NumFaces]) const;
+	void GatherFaces(TArray<TRefCountPtr<IPooledRenderTarget>>& OutFaces) const;
 	void ArmFace(class FIrradianceViewExtension* VE) const;
+};
+
+
+//------ INTEGRATION BATCH ------
+struct FIntegrationBatch
+{
+	/** Ring slots integrated by this batch, in output buffer order. */
+	TArray<int32> Slots;
+
+	/** GPU buffer containing one float4 (R, G, B, mean) per capture. */
+	TRefCountPtr<FRDGPooledBuffer> ExtractedIrradianceBuffer;
+
+	/** Helper object used to asynchronously read back the irradiance buffer. Created on RT. */
+	TUniquePtr<FRHIGPUBufferReadback> IrradianceReadback;
+
+	/** Set on RT once the readback copy is enqueued (IrradianceReadback may then be polled). */
+	std::atomic<bool> bCopyEnqueued{ false };
+
+	/** Whether the GT already enqueued the command that locks the readback. */
+	bool bLockEnqueued = false;
+
+	/** Values read back from the GPU, one per slot. Written on RT. */
+	TArray<FVector4f> Values;
+
+	/** SH bands of every capture in the batch (0 = none), and their per-face projections. */
+	int32 SHOrder = 0;
+	TRefCountPtr<FRDGPooledBuffer> ExtractedSHBuffer;
+	TUniquePtr<FRHIGPUBufferReadback> SHReadback;
 
-// --- Readback state helpers ---
+	/** 6 * SHOrder^2 float4 per slot, read back with Values. Written on RT, empty if the projection failed. */
+	TArray<FVector4f> SHValues;
 
-	/** True if a readback has been enqueued and the RHI readback is valid. */
-	bool HasActiveReadback() const { return bReadbackEnqueued && IrradianceReadback.IsValid(); }
-	
-	/** True if the GPU buffer exists but the readback helper has not been created. */
-	bool NeedsReadbackEnqueue() const { return bReadbackEnqueued && ExtractedIrradianceBuffer.IsValid() && !IrradianceReadback; }
-	
-	/** True if all faces are done and no readback is pending. */
-	bool IsFinished() const { return !HasMoreFaces() && !bReadbackEnqueued; }
+	/** Per slot: its value was integrated and actually read back (false = zeros published). Written on RT. */
+	TArray<bool> Succeeded;
+
+	/** Set on RT once Values holds the final results. */
+	std::atomic<bool> bReadbackDone{ false };
+};
+
+
+//------ POST-PROCESSING ------
+
+/** Inputs of a post-processing task, snapshotted on the game thread (no UObject access on workers). */
+struct FPostProcessSettings
+{
+	/** See UIrradianceSubsystem::SetMinSunAltitude. */
+	float MinSunAltitudeDeg = 0.f;
+
+	/** See UIrradianceSubsystem::SetNormalization. */
+	FIrradianceNormalization Normalization;
+
+	/** Whether a clear-sky reference is computed, and with which configuration. */
+	bool bClearSky = false;
+	FPyranoClearSkyConfig ClearSkyConfig;
+
+	/** True if sun visibility / occlusion were already traced on the game thread (no usable horizon map). */
+	bool bSunTermsResolved = false;
+};
+
+/** A capture result being post-processed on a worker task. Keyed by request id until published. */
+struct FPostProcessJob
+{
+	FCaptureResult Result;
+	UE::Tasks::FTask Task;
 };
 
 
+/** Broadcast on the game thread for every finished capture, in submission order. */
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnIrradianceCaptureCompleted, const FGuid& /*RequestId*/, const FCaptureResult& /*Result*/);
+
+
 //------ IRRADIANCE SUBSYSTEM ------
 UCLASS()
 class UIrradianceSubsystem : public UWorldSubsystem, public FTickableGameObject
@@ -125,8 +232,40 @@ public:
 
 // --- Public API --- 
 
-	/** Begin a new 6-face capture using the given request description. */
-	void StartSixFaceCapture(const FCaptureRequest& Req);
+	/** 
+	 * Begin a new 6-face capture using the given request description.
+	 * Captures already integrating or reading back keep running in parallel.
+	 *
+	 * @return True if the capture was accepted (see CanStartCapture).
+	 */
+	bool StartSixFaceCapture(const FCaptureRequest& Req);
+
+	/**
+	 * Queue a result that needs no capture (e.g. night slot). It is finalized and
+	 * published in submission order, behind the captures already in flight.
+	 */
+	void SubmitResolvedCapture(const FCaptureRequest& Req, const FCaptureSunState& Sun);
+
+	/** True if no capture is rendering faces and a pipeline slot is free. */
+	bool CanStartCapture() const;
+
+	/** Number of captures started and not yet consumed. */
+	int32 GetNumCapturesInFlight() const;
+
+	/** Sets how many captures may be in flight at once (>= 1). Ignored while captures are in flight. */
+	void SetPipelineDepth(int32 InDepth);
+
+	/** Drops every in-flight capture and pending result. */
+	void CancelAllCaptures();
+
+	/**
+	 * Sets how many finished captures are integrated together in one dispatch (>= 1).
+	 * Batches are also flushed early when the pipeline stalls or goes idle.
+	 */
+	void SetIntegrationBatchSize(int32 InBatchSize);
+
+	/** Dispatches the pending integration batch now, however many captures it holds. */
+	void FlushIntegrationBatch();
 
 	/**
 	 * Configure optional export of capture data.
@@ -134,20 +273,68 @@ public:
 	 * @param bCSV           Enable/disable CSV export of irradiance samples.
 	 * @param bExportImages  Enable/disable EXR export of cubemap faces.
 	 * @param OutputDirPath  Optional custom output directory (empty = Saved/Irradiance).
+	 * @param bBinary        Enable/disable the columnar binary export (.pyrb, next to the CSV).
+	 * @param bCompressImages  Lossless (ZIP) or uncompressed half-float EXR faces.
+	 */
+	void ConfigureExport(bool bCSV, bool bExportImages, const FString& OutputDirPath, bool bBinary = false, bool bCompressImages = true);
+
+	/** Configure export from a full set of options. */
+	void ConfigureExport(const FExportOptions& InOptions);
+
+	/**
+	 * Fired once per finished capture, in the same order the captures were started.
+	 * While bound, results are not queued for ConsumeLatestIrradiance.
 	 */
-	void ConfigureExport(bool bCSV, bool bExportImages, const FString& OutputDirPath);
+	FOnIrradianceCaptureCompleted OnCaptureCompleted;
+
+	/** Minimum sun altitude (deg); below it, the direct and ambient terms are clamped to 0. */
+	void SetMinSunAltitude(float InMinSunAltitudeDeg) { MinSunAltitudeDeg = InMinSunAltitudeDeg; }
+
+	/** Coefficients turning the direct and ambient components into the normalized irradiance. */
+	void SetNormalization(const FIrradianceNormalization& InNormalization) { Normalization = InNormalization; }
+
+	/** Path tracing keeps the single-view camera hijack (unless off-screen); raster captures use the capture rig. */
+	void SetPathTracing(bool bInPathTracing) { bPathTracing = bInPathTracing; }
+
+	/** Every capture (raster and path tracing) renders through the capture rig: the player view is never used. */
+	void SetOffscreenCapture(bool bInOffscreen);
+	bool IsOffscreenCapture() const { return bOffscreenCapture; }
 
 	/**
-	 * Consume the latest available irradiance value.
+	 * Consume the oldest queued irradiance value (polling alternative to OnCaptureCompleted).
+	 *
+	 * Results are returned in the same order the captures were started.
 	 *
 	 * @param OutValue       Output irradiance value (possibly clamped by sun altitude).
-	 * @param MinSunAltitude Minimum sun altitude (deg); below this, the value is clamped to 0.
+	 * @param OutRequest     Optional: receives the request that produced the value.
 	 * @return               True if a new value was available and consumed.
 	 */
-	bool ConsumeLatestIrradiance(float& OutValue, float MinSunAltitude = 0.f);
+	bool ConsumeLatestIrradiance(float& OutValue, FCaptureRequest* OutRequest = nullptr);
 
 	void FlushExporter();
 
+	/** Absolute path of the CSV the exporter writes to (empty before ConfigureExport). */
+	FString GetExportCSVPath() const;
+
+	/** Rows exported since ConfigureExport that are on disk for good, and the CSV size after them. */
+	bool GetExportDurablePoint(uint64& OutRows, int64& OutCSVBytes) const;
+
+// --- Capture result cache ---
+
+	/** Enables the result cache for the next captures (loaded and the scene hashed on first use). */
+	void SetCaptureCacheEnabled(bool bEnabled);
+
+	/**
+	 * If the raw output of Req under the current sun is cached, publishes it in order like a
+	 * finished capture (post-processing and export included, no rendering) and returns true.
+	 */
+	bool SubmitCachedCapture(const FCaptureRequest& Req);
+
+	/** Writes the cache if it changed, logs its hit rate since the last save and resets it. */
+	void SaveCaptureCache();
+
+	const FCaptureResultCache::FStats& GetCaptureCacheStats() const { return CaptureCache.GetStats(); }
+
 // --- Viewport management ---
 
 	/** Force the PIE client viewport and window to be square (SidePx x SidePx). */
@@ -164,6 +351,27 @@ public:
 	/** Computes SkyViewFactor using Monte Carlo sampling. */
 	float ComputeSkyViewFactor(const FCaptureRequest& Req, int32 NumSamples) const;
 
+	/** Builds the horizon map of the sensor in Req with parallel traces (blocking). */
+	FSensorHorizonMapPtr BuildHorizonMap(const FCaptureRequest& Req) const;
+
+	/**
+	 * Issues the SVF traces of every request as async traces (same sampling as ComputeSkyViewFactor).
+	 * Results arrive over the next frames, so the caller can keep preparing meanwhile.
+	 */
+	void BeginSkyViewFactorPrepass(TConstArrayView<FCaptureRequest> Reqs, int32 NumSamples);
+
+	/** Drops the running pre-pass; late trace results are ignored. */
+	void CancelSkyViewFactorPrepass();
+
+	/** True while pre-pass traces are still pending. */
+	bool IsSkyViewFactorPrepassRunning() const { return SVFTracesDone < SVFTracesTotal; }
+
+	/** Fraction of pre-pass traces completed [0..1]. */
+	float GetSkyViewFactorPrepassProgress() const;
+
+	/** SVF of a sensor from the pre-pass. False if it was not part of it or is still pending. */
+	bool GetSkyViewFactorPrepassResult(const FGuid& SensorId, float& OutSVF) const;
+
 // --- Clear Sky Service ---
 	UClearSkyService* GetClearSky() const { return ClearSky; }
 
@@ -171,56 +379,183 @@ private:
 
 // --- Internal state ---
 
-	/** Per-capture context. */
-	FCaptureContext Capture;
+	/** 
+	 * Ring of capture contexts. Slot pointers stay stable while render commands use them.
+	 * At most one slot is Capturing (faces share the view); the rest integrate or read back.
+	 */
+	TArray<TUniquePtr<FCaptureContext>> CaptureRing;
 
-	/** Current high-level capture state. */
-	ECaptureState State = ECaptureState::Idle;
+	/** Slot currently rendering faces, or INDEX_NONE. */
+	int32 ActiveSlot = INDEX_NONE;
+
+	/** Request ids in submission order, oldest first. Results are published from the head. */
+	TArray<FGuid> PublishOrder;
+
+	/** Post-processing jobs launched so far (any order); the reorder buffer behind PublishOrder. */
+	TMap<FGuid, TSharedPtr<FPostProcessJob, ESPMode::ThreadSafe>> PostProcessJobs;
+
+	/** Results ready to be consumed, oldest first (only filled while OnCaptureCompleted is unbound). */
+	TArray<FCaptureResult> CompletedResults;
+
+	/** See SetMinSunAltitude. */
+	float MinSunAltitudeDeg = 0.f;
+
+	/** See SetNormalization. */
+	FIrradianceNormalization Normalization;
+
+	/** Sequence number assigned to the next capture. */
+	uint64 NextSequence = 0;
+
+	/** Slots with all faces captured, waiting to be integrated in the next batch. */
+	TArray<int32> PendingBatch;
+
+	/** Max captures per integration dispatch. */
+	int32 IntegrationBatchSize = 1;
+
+	/** Consecutive ticks the pending batch has waited with no capture rendering. */
+	int32 PendingBatchIdleTicks = 0;
+
+	/** Batches dispatched and waiting for their readback. Shared with render commands. */
+	TArray<TSharedPtr<FIntegrationBatch, ESPMode::ThreadSafe>> BatchesInFlight;
 
 	/** View extension used to intercept the scene render target and produce cubemap faces. */
 	TSharedPtr<class FIrradianceViewExtension, ESPMode::ThreadSafe> ViewExt;
 
-	/** Atomic flag indicating a new irradiance value is available. */
-	std::atomic<bool> bIrradianceValueReady{ false };
+	/** Six scene captures rendering a whole raster cubemap in one frame. Created on first use. */
+	TSharedPtr<class FIrradianceCaptureRig> CaptureRig;
 
-	/** Last irradiance value produced by the GPU path. */
-	std::atomic<float> LastIrradianceMean{ 0.0f };
-	std::atomic<float> LastIrradianceR{ 0.0f };
-	std::atomic<float> LastIrradianceG{ 0.0f };
-	std::atomic<float> LastIrradianceB{ 0.0f };
+	/** See SetPathTracing / SetOffscreenCapture. */
+	bool bPathTracing = false;
+	bool bOffscreenCapture = false;
+
+// --- Capture result cache ---
+
+	/** Renderer settings that change the raw output of a capture. */
+	FString MakeCaptureRenderKey() const;
+
+	/** Keeps the raw output of a finished GPU capture, under the render key it was started with. */
+	void StoreInCaptureCache(const FCaptureResult& Result, const FString& RenderKey);
+
+	FCaptureResultCache	CaptureCache;
+	FString				CaptureCacheSceneHash;
+	bool				bCaptureCacheEnabled = false;
+	bool				bCaptureCacheLoaded = false;
+
+// --- Sky Factor pre-pass ---
+
+	/** Per-sensor accumulation of the async SVF traces. */
+	struct FSkyViewFactorJob
+	{
+		FGuid	SensorId;
+		double	Sum		= 0.0;
+		int32	Done	= 0;
+	};
+
+	TArray<FSkyViewFactorJob> SVFJobs;
+	int32 SVFSamples		= 0;
+	int32 SVFTracesTotal	= 0;
+	int32 SVFTracesDone		= 0;
+
+	/** Bumped on every begin / cancel; callbacks from an older pre-pass are dropped. */
+	uint32 SVFPrepassSerial = 0;
+
+	FTraceDelegate SVFTraceDelegate;
+
+	/** Async trace callback (game thread). UserData = JobIndex * SVFSamples + SampleIndex. */
+	void OnSkyViewFactorTrace(const FTraceHandle& Handle, FTraceDatum& Datum, uint32 Serial);
 
 // --- Capture - GPU Pipeline ---
 
 	/** Handle per-frame logic while faces are being captured. */
-	void TickCapturing();
+	void TickCapturing(FCaptureContext& Capture);
+
+	/** Same for a rig capture: every face arrives in the same tick. */
+	void TickRigCapturing(FCaptureContext& Capture);
+
+	/** Exports the current face if requested, then integrates it (streamed) or stores it for the batch. */
+	void CollectFace(FCaptureContext& Capture, TRefCountPtr<IPooledRenderTarget>&& FaceRT, const FIntPoint& FaceSize);
+
+	/** All faces delivered: release the capture stage and queue the slot for integration. */
+	void FinishCapturing(FCaptureContext& Capture);
+
+	/** Flush the pending batch if it is full, or nothing else can join it. */
+	void TickIntegrationBatch();
+
+	/** Check the readback fence once per frame; lock it on RT only once it is ready. */
+	void TickReadback(const TSharedPtr<FIntegrationBatch, ESPMode::ThreadSafe>& Batch);
+
+	/** Hand the values of finished batches to post-processing and free their slots. */
+	void CollectFinishedBatches();
 
-	/** Handle per-frame logic while waiting for GPU readback. */
-	void TickReadback();
+	/** Export and broadcast post-processed results at the head of the pipeline, in submission order. */
+	void PublishFinishedCaptures();
 
-	/** Enqueue a GPU readback copy of the extracted irradiance buffer. */
-	void EnqueueReadbackCopy();
+// --- Post-processing ---
 
-	/** Enqueue a polling command to read back the irradiance value when ready. */
-	void EnqueueReadbackPolling();
+	/** Launch the post-processing task of a result (traces on the game thread first if needed). */
+	void LaunchPostProcess(FCaptureResult&& Result);
+
+	/** Trace sun visibility / occlusion on the game thread. False if the horizon map makes it unnecessary. */
+	bool ResolveSunTermsOnGameThread(FCaptureResult& Result) const;
+
+	/** Compute sun, clear-sky and normalized values from the raw GPU result. Runs on a worker task. */
+	static void ComputePostProcess(FCaptureResult& Result, const FPostProcessSettings& Settings);
+
+	/** Queue the CSV / binary row of a published result (written by the exporter's background thread). */
+	void ExportCaptureResult(const FCaptureResult& Result);
+
+	/** Integrate one face into the capture's partial sums on the RT and release it (streamed integration). */
+	void IntegrateStreamedFace(FCaptureContext& Capture, int32 Face, TRefCountPtr<IPooledRenderTarget>&& FaceRT);
+
+	/** Queue a slot whose faces are ready for the next integration batch. */
+	void AddToIntegrationBatch(int32 SlotIdx);
+
+	/** Returns a free slot index, or INDEX_NONE if the ring is full. */
+	int32 FindFreeSlot() const;
+
+	/** Read the current sun angles and light from the SunSky. */
+	FCaptureSunState SnapshotSunState() const;
+
+	/** Enqueue the command that copies the irradiance values out of a ready readback. */
+	void EnqueueReadbackLock(const TSharedPtr<FIntegrationBatch, ESPMode::ThreadSafe>& Batch);
 
 	/** Ensure that the capture camera exists and is configured. */
 	void EnsureCaptureCamera();
 
 	/** Start capture of a single face at PosWS / RotWS. */
-	void StartFaceCapture(const FVector& PosWS, const FQuat& RotWS);
+	void StartFaceCapture(FCaptureContext& Capture, const FVector& PosWS, const FQuat& RotWS);
 
-	/** Dispatch the irradiance compute shader using the captured faces. */
+	/** True if new captures render through the capture rig (raster or off-screen, not face atlas). */
+	bool UsesCaptureRig() const;
+
+	/** Render every planned face of the capture in this frame with the capture rig. */
+	bool StartRigCapture(FCaptureContext& Capture);
+
+	/** Set r.ScreenPercentage (grazing faces render at reduced resolution). No-op if already applied. */
+	void ApplyScreenPercentage(int32 Percent);
+
+	/** Dispatch the irradiance compute shader over every capture in the pending batch. */
 	void ComputeFinalIrradiance();
 
-	/** Perform a single-ray solar occlusion test from the sensor towards the sun direction. */
-	bool ComputeSunOcclusion(const FCaptureRequest& Req, bool& bOutSunOccluded, float& OutHitDistanceM) const;
+	/** Ignores the SunSky, the sensor owner (from the registry) and the capture camera. */
+	void AddTraceIgnoredActors(const FCaptureRequest& Req, FCollisionQueryParams& Params) const;
+
+	/**
+	 * Perform a single-ray solar occlusion test from the sensor towards the sun direction.
+	 * Looked up in Req.HorizonMap when it matches the request pose.
+	 */
+	bool ComputeSunOcclusion(const FCaptureRequest& Req, const FVector& ToSunDir, bool& bOutSunOccluded, float& OutHitDistanceM) const;
 
-	/** Estimate solar visibility by sampling multiple rays around the sun direction. */
-	float ComputeSunVisibility(const FCaptureRequest& Req, int32 NumSamples) const;
+	/**
+	 * Estimate solar visibility by sampling multiple rays around the sun direction.
+	 * Looked up in Req.HorizonMap when it matches the request pose.
+	 */
+	float ComputeSunVisibility(const FCaptureRequest& Req, const FVector& ToSunDir, int32 NumSamples) const;
 
 // --- Viewport state ---
 
 	bool bForcedRes = false;
+	int32 AppliedScreenPercentage = 100;
 	TWeakPtr<class SWindow> PrevPIEWindow;
 	FIntPoint PrevViewportSize  = FIntPoint::ZeroValue;
 	FIntPoint PrevPIEWindowSize = FIntPoint::ZeroValue;
@@ -0,0 +1,81 @@
+/*=============================================================================
+	PyranometerRegistry.h
+  Per-world registry of pyranometer sensors and of the sun actor / light.
+  Replaces global object and actor scans on the capture hot path.
+/============================================================================*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "PyranometerRegistry.generated.h"
+
+class AActor;
+class UDirectionalLightComponent;
+class UPyranometerComponent;
+
+//------ PYRANOMETER REGISTRY ------
+UCLASS()
+class PYRANO_API UPyranometerRegistry : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+// --- Life Cycle ---
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+// --- Sensors ---
+
+	/** Adds (or re-keys, if its GUID changed) a sensor. Called from UPyranometerComponent::OnRegister. */
+	void RegisterSensor(UPyranometerComponent* Sensor);
+
+	/** Removes a sensor. Called from UPyranometerComponent::OnUnregister. */
+	void UnregisterSensor(UPyranometerComponent* Sensor);
+
+	/** Returns the registered sensor with this GUID, or null. */
+	UPyranometerComponent* FindSensor(const FGuid& SensorGuid) const;
+
+	/** Returns the actor owning the sensor with this GUID, or null. */
+	AActor* FindSensorOwner(const FGuid& SensorGuid) const;
+
+	/** Fills OutSensors with the registered sensors (optionally only the enabled ones). */
+	void GetSensors(TArray<UPyranometerComponent*>& OutSensors, bool bOnlyEnabled) const;
+
+// --- Sun ---
+
+	/** Cached SunSky actor (by tag or name), or null if the level has none. */
+	AActor* GetSunSkyActor();
+
+	/** Cached sun light: the SunSky directional light, or the first directional light in the world. */
+	UDirectionalLightComponent* GetSunLight();
+
+	/** Forces the sun handles to be resolved again on next use. */
+	void InvalidateSunCache();
+
+	/** True if the actor is a SunSky (tag "SunSky" or name containing "SunSky"). */
+	static bool IsSunSkyActor(const AActor* Actor);
+
+private:
+
+	/** Invalidates the sun cache when a candidate sun actor appears. */
+	void OnActorSpawned(AActor* Actor);
+
+	/** Resolves CachedSunSky / CachedSunLight with one actor scan. */
+	void ResolveSun();
+
+	/** GUID -> sensor. */
+	TMap<FGuid, TWeakObjectPtr<UPyranometerComponent>> SensorsByGuid;
+
+	/** GUID each sensor was registered under (to re-key on GUID changes). */
+	TMap<TWeakObjectPtr<UPyranometerComponent>, FGuid> GuidBySensor;
+
+	/** Sun handles. Null results are cached too until an invalidation. */
+	TWeakObjectPtr<AActor> CachedSunSky;
+	TWeakObjectPtr<UDirectionalLightComponent> CachedSunLight;
+	bool bSunResolved = false;
+
+	FDelegateHandle ActorSpawnedHandle;
+};
@@ -1,6 +1,7 @@
 /*=============================================================================
     SunSkyController.h
-  Manages Unreal's SunSky Actor.
+  Manages Unreal's SunSky Actor, or drives the sun light directly
+  from the native ephemeris (see SolarPosition.h).
 /============================================================================*/
 
 #pragma once
@@ -11,6 +12,7 @@
 #include "SunSkyController.generated.h"
 
 class AActor;
+class UDirectionalLightComponent;
 
 UCLASS()
 class USunSkyController : public UWorldSubsystem
@@ -42,9 +44,27 @@ public:
     UFUNCTION(BlueprintCallable, Category = "SunSky")
     bool GetSolarAngles(float& OutAzimuthDeg, float& OutAltitudeDeg) const;
 
-    /** Locates a SunSky actor in the world (by tag or name). */
+    /** Locates a SunSky actor in the world (by tag or name, cached by the sensor registry). */
     static AActor* FindSunSkyActor(UWorld* World);
 
+    /**
+     * When enabled, GetSolarAngles returns the angles given to SetSolarAnglesDirect
+     * instead of reading them back from the light.
+     */
+    void SetUseNativeEphemeris(bool bInNative);
+
+    /** True if the sun is driven from the native ephemeris. */
+    bool IsUsingNativeEphemeris() const { return bNativeEphemeris; }
+
+    /**
+     * Orients the sun light from solar angles (solar-standard convention, NorthOffset applied).
+     * No reflection nor construction-script rerun; works without a SunSky actor.
+     */
+    bool SetSolarAnglesDirect(double AzimuthDeg, double AltitudeDeg);
+
+    /** Returns the SunSky directional light, or the first directional light in the world. */
+    UDirectionalLightComponent* FindSunLight();
+
 private:
 
     /** Timezone offset in hours used to convert UTC to local solar time. */
@@ -56,6 +76,14 @@ private:
     /** Cached reference to the SunSky actor in the current world. */
     TWeakObjectPtr<AActor> CachedSunSky;
 
+    /** Native ephemeris mode (see SetUseNativeEphemeris). */
+    bool bNativeEphemeris = false;
+
+    /** Last angles applied with SetSolarAnglesDirect. */
+    bool   bHasNativeAngles   = false;
+    double NativeAzimuthDeg   = 0.0;
+    double NativeAltitudeDeg  = 0.0;
+
     /** Returns the cached SunSky actor or performs a search if missing. */
     AActor* EnsureSunSky();  
 
@@ -0,0 +1,55 @@
+﻿// PyranoMergeShardsCommandlet.cpp
+
+#include "Commandlets/PyranoMergeShardsCommandlet.h"
+
+#include "Misc/Paths.h"
+
+#include "Logging/IrradianceLog.h"
+#include "Simulation/SimulationShard.h"
+
+
+UPyranoMergeShardsCommandlet::UPyranoMergeShardsCommandlet()
+{
+    IsClient = false;
+    IsEditor = false;
+    IsServer = false;
+    LogToConsole = true;
+}
+
+
+int32 UPyranoMergeShardsCommandlet::Main(const FString& Params)
+{
+    FString Dir;
+    FString Name = TEXT("irradiance");
+    FString OutPath;
+
+    FParse::Value(*Params, TEXT("Dir="), Dir);
+    FParse::Value(*Params, TEXT("Name="), Name);
+    FParse::Value(*Params, TEXT("Out="), OutPath);
+    const bool bAllowMissing = FParse::Param(*Params, TEXT("AllowMissing"));
+
+    if (Dir.IsEmpty())
+    {
+        PYRANO_ERR(TEXT("[Commandlet] Usage: -run=PyranoMergeShards -Dir=<output dir> [-Name=irradiance] [-Out=<merged.csv>] [-AllowMissing]"));
+        return BadArguments;
+    }
+
+    Dir = FPaths::ConvertRelativePathToFull(Dir);
+    OutPath = OutPath.IsEmpty()
+        ? FPaths::Combine(Dir, Name + TEXT("_merged.csv"))
+        : FPaths::ConvertRelativePathToFull(OutPath);
+
+    FSimShardMergeReport Report;
+    const bool bOk = PyranoShardMerge::MergeCSV(Dir, Name, OutPath, bAllowMissing, Report);
+
+    for (const FString& Error : Report.Errors)
+    {
+        PYRANO_ERR(TEXT("[Commandlet] %s"), *Error);
+    }
+
+    PYRANO_INFO(TEXT("[Commandlet] Merge summary: Shards=%d, Expected=%d, Written=%d, Duplicates=%d, Unexpected=%d, Missing=%d, ExitCode=%d"),
+        Report.NumShards, Report.ExpectedRows, Report.RowsWritten, Report.DuplicateRows,
+        Report.UnexpectedRows, Report.MissingRows, bOk ? (int32)Success : (int32)MergeFailed);
+
+    return bOk ? Success : MergeFailed;
+}
@@ -0,0 +1,39 @@
+/*=============================================================================
+	PyranoMergeShardsCommandlet.h
+  Merges the CSVs of a sharded simulation into one file ordered like a
+  serial run, after checking that the shards cover the whole grid.
+/============================================================================*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+
+#include "PyranoMergeShardsCommandlet.generated.h"
+
+/**
+ * UnrealEditor-Cmd <Project> -run=PyranoMergeShards -Dir=<output dir> [-Name=irradiance]
+ *     [-Out=<merged.csv>] [-AllowMissing]
+ *
+ * Rows seen more than once (re-run shards append to their file) keep their last occurrence.
+ * Default output: <Dir>/<Name>_merged.csv.
+ */
+UCLASS()
+class UPyranoMergeShardsCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Exit codes. */
+	enum EExitCode : int32
+	{
+		Success			= 0,
+		BadArguments	= 1,
+		MergeFailed		= 2,	// inconsistent / missing shards, missing rows, I/O error
+	};
+
+	UPyranoMergeShardsCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
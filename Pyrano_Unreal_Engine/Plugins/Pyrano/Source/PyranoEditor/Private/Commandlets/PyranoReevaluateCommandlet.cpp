@@ -0,0 +1,90 @@
+﻿// PyranoReevaluateCommandlet.cpp
+
+#include "Commandlets/PyranoReevaluateCommandlet.h"
+
+#include "Misc/Paths.h"
+
+#include "Logging/IrradianceLog.h"
+#include "Simulation/IrradianceReevaluation.h"
+#include "UI/PlanStorage.h"
+
+
+UPyranoReevaluateCommandlet::UPyranoReevaluateCommandlet()
+{
+    IsClient = false;
+    IsEditor = false;
+    IsServer = false;
+    LogToConsole = true;
+}
+
+
+int32 UPyranoReevaluateCommandlet::Main(const FString& Params)
+{
+    FString InPath;
+    FString OutPath;
+    FString PlanPath;
+
+    FParse::Value(*Params, TEXT("In="), InPath);
+    FParse::Value(*Params, TEXT("Out="), OutPath);
+    FParse::Value(*Params, TEXT("Plan="), PlanPath);
+
+    if (InPath.IsEmpty())
+    {
+        PYRANO_ERR(TEXT("[Commandlet] Usage: -run=PyranoReevaluate -In=<irradiance.csv> [-Out=<out.csv>] [-Plan=<plan.json>] [-DirectLinear=] [-DirectQuadratic=] [-AmbientLinear=] [-AmbientScale=] [-MinSunAltitude=] [-Turbidity=] [-SiteAltitude=] [-NoClearSky] [-Binary]"));
+        return BadArguments;
+    }
+
+    InPath = FPaths::ConvertRelativePathToFull(InPath);
+    OutPath = OutPath.IsEmpty()
+        ? FPaths::Combine(FPaths::GetPath(InPath), FPaths::GetBaseFilename(InPath) + TEXT("_reeval.csv"))
+        : FPaths::ConvertRelativePathToFull(OutPath);
+
+    // --- Settings: plan, then explicit overrides ---
+
+    FSimConfig Sim;
+    if (!PlanPath.IsEmpty() && !FPlanStorage::LoadPlan(FPaths::ConvertRelativePathToFull(PlanPath), Sim))
+    {
+        PYRANO_ERR(TEXT("[Commandlet] Could not load plan '%s'"), *PlanPath);
+        return PlanInvalid;
+    }
+
+    FIrradianceReevaluationOptions Options = FIrradianceReevaluationOptions::FromSimConfig(Sim);
+
+    FParse::Value(*Params, TEXT("DirectLinear="), Options.Normalization.DirectLinearCoeff);
+    FParse::Value(*Params, TEXT("DirectQuadratic="), Options.Normalization.DirectQuadraticCoeff);
+    FParse::Value(*Params, TEXT("AmbientLinear="), Options.Normalization.AmbientLinearCoeff);
+    FParse::Value(*Params, TEXT("AmbientScale="), Options.Normalization.AmbientIrradianceScale);
+    FParse::Value(*Params, TEXT("MinSunAltitude="), Options.MinSunAltitudeDeg);
+    FParse::Value(*Params, TEXT("Turbidity="), Options.ClearSkyConfig.LinkeTurbidity);
+    FParse::Value(*Params, TEXT("SiteAltitude="), Options.ClearSkyConfig.AltitudeMeters);
+    if (FParse::Param(*Params, TEXT("NoClearSky")))
+    {
+        Options.bClearSky = false;
+    }
+    if (FParse::Param(*Params, TEXT("Binary")))
+    {
+        Options.bExportBinary = true;
+    }
+
+    PYRANO_INFO(TEXT("[Commandlet] Re-evaluating '%s' (Direct=%g/%g, Ambient=%g x %g, MinSunAltitude=%.2f, ClearSky=%s T=%.2f Alt=%.0fm)"),
+        *InPath,
+        Options.Normalization.DirectLinearCoeff, Options.Normalization.DirectQuadraticCoeff,
+        Options.Normalization.AmbientLinearCoeff, Options.Normalization.AmbientIrradianceScale,
+        Options.MinSunAltitudeDeg, Options.bClearSky ? TEXT("on") : TEXT("off"),
+        Options.ClearSkyConfig.LinkeTurbidity, Options.ClearSkyConfig.AltitudeMeters);
+
+    FIrradianceReevaluationReport Report;
+    const bool bOk = PyranoReevaluation::ReevaluateCSV(InPath, OutPath, Options, Report);
+
+    for (const FString& Error : Report.Errors)
+    {
+        PYRANO_ERR(TEXT("[Commandlet] %s"), *Error);
+    }
+
+    PYRANO_INFO(TEXT("[Commandlet] Re-evaluation summary: Rows=%d, Sensors=%d, BadRows=%d, CutOff=%d, ClearSkyEvaluations=%d, Time=%.2fs, ExitCode=%d"),
+        Report.Rows, Report.Sensors, Report.BadRows, Report.RowsCutOff, Report.ClearSkyEvaluations,
+        Report.ParseSeconds + Report.ComputeSeconds + Report.WriteSeconds,
+        bOk ? (int32)Success : (int32)ReevaluationFailed);
+
+    return bOk ? Success : ReevaluationFailed;
+}
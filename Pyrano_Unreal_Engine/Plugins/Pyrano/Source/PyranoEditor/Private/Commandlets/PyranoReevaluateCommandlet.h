@@ -0,0 +1,42 @@
+/*=============================================================================
+	PyranoReevaluateCommandlet.h
+  Re-evaluates an exported irradiance CSV with other post-processing settings
+  (clear-sky, min sun altitude, normalization) from its raw components, without
+  loading a map or rendering.
+/============================================================================*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+
+#include "PyranoReevaluateCommandlet.generated.h"
+
+/**
+ * UnrealEditor-Cmd <Project> -run=PyranoReevaluate -In=<irradiance.csv> [-Out=<out.csv>] [-Plan=<plan.json>]
+ *     [-DirectLinear=<c>] [-DirectQuadratic=<c>] [-AmbientLinear=<c>] [-AmbientScale=<s>]
+ *     [-MinSunAltitude=<deg>] [-Turbidity=<t>] [-SiteAltitude=<m>] [-NoClearSky] [-Binary]
+ *
+ * Settings come from the plan (defaults without one), then from the explicit arguments.
+ * Default output: <In>_reeval.csv.
+ */
+UCLASS()
+class UPyranoReevaluateCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Exit codes. */
+	enum EExitCode : int32
+	{
+		Success				= 0,
+		BadArguments		= 1,
+		PlanInvalid			= 2,
+		ReevaluationFailed	= 3,	// unreadable / foreign CSV, I/O error
+	};
+
+	UPyranoReevaluateCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,301 @@
+﻿// PyranoSimulationCommandlet.cpp
+
+#include "Commandlets/PyranoSimulationCommandlet.h"
+
+#include "Editor.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "Containers/Ticker.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Paths.h"
+#include "RenderingThread.h"
+#include "ShaderCompiler.h"
+#include "Tickable.h"
+#include "UObject/Package.h"
+
+#include "Components/PyranometerComponent.h"
+#include "Data/IrradianceConfiguration.h"
+#include "Irradiance/IrradianceCommon.h"
+#include "Logging/IrradianceLog.h"
+#include "Simulation/IrradianceScheduler.h"
+#include "Subsystems/PyranoEditorSubsystem.h"
+#include "UI/PlanStorage.h"
+
+namespace
+{
+    /** Fixed step of the headless loop (the sun comes from the plan, not from world time). */
+    constexpr float FrameDeltaSeconds = 1.f / 30.f;
+
+    /** Frames ticked before starting, so streaming and the first renders settle (PIE waits ~4 s). */
+    constexpr int32 DefaultBootFrames = 120;
+
+    /** Arguments accepted by Main (see PyranoSimulationCommandlet.h). */
+    const TCHAR* UsageText =
+        TEXT("-run=PyranoSimulation -Plan=<plan.json> -Map=<map> [-CaptureOnce] [-Output=<dir>] [-TimeoutSec=<s>] [-BootFrames=<n>] ")
+        TEXT("[-Shard=<i> -TimeShards=<t> -SensorShards=<s>]");
+}
+
+
+UPyranoSimulationCommandlet::UPyranoSimulationCommandlet()
+{
+    IsClient = false;
+    IsEditor = true;
+    IsServer = false;
+    LogToConsole = true;
+    ShowErrorCount = true;
+
+    HelpDescription = TEXT("Runs a saved simulation plan headless, with off-screen captures.");
+    HelpUsage = UsageText;
+}
+
+
+// -----------------------------------------------------------------------------
+//  Main
+// -----------------------------------------------------------------------------
+
+int32 UPyranoSimulationCommandlet::Main(const FString& Params)
+{
+    // --- Arguments ---
+
+    FString PlanPath;
+    FString MapName;
+    FString OutputDir;
+    double TimeoutSec = 0.0;
+    int32 BootFrames = DefaultBootFrames;
+
+    FParse::Value(*Params, TEXT("Plan="), PlanPath);
+    FParse::Value(*Params, TEXT("Map="), MapName);
+    FParse::Value(*Params, TEXT("Output="), OutputDir);
+    FParse::Value(*Params, TEXT("TimeoutSec="), TimeoutSec);
+    FParse::Value(*Params, TEXT("BootFrames="), BootFrames);
+    const bool bCaptureOnce = FParse::Param(*Params, TEXT("CaptureOnce"));
+
+    int32 ShardIndex = INDEX_NONE;
+    int32 TimeShards = 0;
+    int32 SensorShards = 0;
+    FParse::Value(*Params, TEXT("Shard="), ShardIndex);
+    FParse::Value(*Params, TEXT("TimeShards="), TimeShards);
+    FParse::Value(*Params, TEXT("SensorShards="), SensorShards);
+
+    if (PlanPath.IsEmpty() || MapName.IsEmpty())
+    {
+        PYRANO_ERR(TEXT("[Commandlet] Usage: %s"), UsageText);
+        return BadArguments;
+    }
+
+    if (!IsAllowCommandletRendering())
+    {
+        PYRANO_ERR(TEXT("[Commandlet] Rendering is disabled: add -AllowCommandletRendering"));
+        return BadArguments;
+    }
+
+    // --- Plan ---
+
+    FSimConfig Sim;
+    if (!FPlanStorage::LoadPlan(FPaths::ConvertRelativePathToFull(PlanPath), Sim))
+    {
+        PYRANO_ERR(TEXT("[Commandlet] Could not load plan '%s'"), *PlanPath);
+        return PlanInvalid;
+    }
+
+    Sim.bOffscreenCapture = true;
+    if (!OutputDir.IsEmpty())
+    {
+        Sim.OutputPath.Path = FPaths::ConvertRelativePathToFull(OutputDir);
+    }
+
+    if (ShardIndex != INDEX_NONE) Sim.ShardIndex = ShardIndex;
+    if (TimeShards > 0)           Sim.TimeShards = TimeShards;
+    if (SensorShards > 0)         Sim.SensorShards = SensorShards;
+
+    // Same normalization as the planner UI
+    if (UPyranoEditorSubsystem* Planner = GEditor ? GEditor->GetEditorSubsystem<UPyranoEditorSubsystem>() : nullptr)
+    {
+        const FValidationResult Validation = Planner->ValidateConfig(Sim);
+        if (!Validation.IsValid())
+        {
+            for (const FString& Error : Validation.Errors)
+            {
+                PYRANO_ERR(TEXT("[Commandlet] %s"), *Error);
+            }
+            return PlanInvalid;
+        }
+        Sim = Validation.OutNormalized;
+    }
+    else if (!Sim.IsValid())
+    {
+        PYRANO_ERR(TEXT("[Commandlet] Plan '%s' is not valid"), *PlanPath);
+        return PlanInvalid;
+    }
+
+    // --- World ---
+
+    UWorld* World = CreateGameWorld(MapName);
+    if (!World)
+    {
+        PYRANO_ERR(TEXT("[Commandlet] Could not load map '%s'"), *MapName);
+        return MapLoadFailed;
+    }
+
+    UIrradianceScheduler* Scheduler = World->GetSubsystem<UIrradianceScheduler>();
+    if (!Scheduler)
+    {
+        PYRANO_ERR(TEXT("[Commandlet] IrradianceScheduler not available in '%s'"), *MapName);
+        DestroyGameWorld(World);
+        return MapLoadFailed;
+    }
+
+    TArray<FIrradianceCVarState> SavedCVarState;
+    if (IrradianceCommon::Settings::bApplyIrradianceConfiguration)
+    {
+        FIrradianceRenderConfig::ApplyIrradianceConfig(Sim, SavedCVarState);
+    }
+
+    for (int32 i = 0; i < BootFrames; ++i)
+    {
+        TickFrame(World, FrameDeltaSeconds);
+    }
+
+    // --- Run ---
+
+    PYRANO_INFO(TEXT("[Commandlet] %s started (Plan=%s, Map=%s, Shard=%d/%d)"),
+        bCaptureOnce ? TEXT("CaptureOnce") : TEXT("Simulation"), *PlanPath, *MapName, Sim.ShardIndex, Sim.GetShardCount());
+
+    const double StartTime = FPlatformTime::Seconds();
+    if (bCaptureOnce)
+    {
+        Scheduler->CaptureOnce(Sim);
+    }
+    else
+    {
+        Scheduler->StartSimulation(Sim);
+    }
+
+    bool bTimedOut = false;
+    while (Scheduler->GetState() != ESchedulerState::Idle && !IsEngineExitRequested())
+    {
+        TickFrame(World, FrameDeltaSeconds);
+
+        if (TimeoutSec > 0.0 && FPlatformTime::Seconds() - StartTime > TimeoutSec)
+        {
+            bTimedOut = true;
+            Scheduler->ClearQueue();
+            break;
+        }
+    }
+
+    const double ElapsedSec = FPlatformTime::Seconds() - StartTime;
+    const int32 NumResults = Scheduler->GetNumResults();
+    const int32 NumCaptured = Scheduler->GetNumCapturedResults();
+
+    // --- Shutdown ---
+
+    if (IrradianceCommon::Settings::bApplyIrradianceConfiguration)
+    {
+        FIrradianceRenderConfig::RestoreIrradianceConfig(SavedCVarState);
+    }
+    DestroyGameWorld(World);
+
+    const EExitCode Code = bTimedOut ? TimedOut : (NumResults == 0 ? NothingCaptured : Success);
+    PYRANO_INFO(TEXT("[Commandlet] Summary: Results=%d, Captured=%d, Resolved=%d, Elapsed=%.1f s, Output=%s, ExitCode=%d"),
+        NumResults, NumCaptured, NumResults - NumCaptured, ElapsedSec,
+        Sim.OutputPath.Path.IsEmpty() ? TEXT("(default)") : *Sim.OutputPath.Path, (int32)Code);
+
+    return Code;
+}
+
+
+// -----------------------------------------------------------------------------
+//  World
+// -----------------------------------------------------------------------------
+
+UWorld* UPyranoSimulationCommandlet::CreateGameWorld(const FString& MapName) const
+{
+    FString PackageName = MapName;
+    if (!FPackageName::IsValidLongPackageName(PackageName))
+    {
+        if (!FPackageName::SearchForPackageOnDisk(MapName, &PackageName))
+            return nullptr;
+    }
+
+    UPackage* Package = LoadPackage(nullptr, *PackageName, LOAD_None);
+    UWorld* World = Package ? UWorld::FindWorldInPackage(Package) : nullptr;
+    if (!World)
+        return nullptr;
+
+    // Game world: the irradiance subsystem is only created for PIE / Game worlds
+    World->WorldType = EWorldType::Game;
+    World->AddToRoot();
+
+    FWorldContext& Context = GEngine->CreateNewWorldContext(EWorldType::Game);
+    Context.SetCurrentWorld(World);
+
+    World->InitWorld(UWorld::InitializationValues()
+        .AllowAudioPlayback(false)
+        .CreatePhysicsScene(true)   // sun visibility / SVF traces
+        .RequiresHitProxies(false)
+        .CreateNavigation(false)
+        .CreateAISystem(false)
+        .ShouldSimulatePhysics(false)
+        .SetTransactional(false));
+
+    World->UpdateWorldComponents(true, false);
+
+    FURL URL;
+    World->SetGameMode(URL);
+    World->InitializeActorsForPlay(URL);
+    World->BeginPlay();
+
+    int32 NumSensors = 0;
+    for (TObjectIterator<UPyranometerComponent> It; It; ++It)
+    {
+        NumSensors += (It->GetWorld() == World) ? 1 : 0;
+    }
+    PYRANO_INFO(TEXT("[Commandlet] Map '%s' loaded (%d pyranometer(s))"), *PackageName, NumSensors);
+
+    return World;
+}
+
+
+void UPyranoSimulationCommandlet::DestroyGameWorld(UWorld* World) const
+{
+    if (!World)
+        return;
+
+    FlushRenderingCommands();
+
+    World->EndPlay(EEndPlayReason::Quit);
+    GEngine->DestroyWorldContext(World);
+    World->DestroyWorld(false);
+    World->RemoveFromRoot();
+
+    CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+}
+
+
+void UPyranoSimulationCommandlet::TickFrame(UWorld* World, float DeltaSeconds) const
+{
+    // What the engine loop would do for a game frame without a viewport
+    FTSTicker::GetCoreTicker().Tick(DeltaSeconds);
+    GEngine->TickDeferredCommands();
+
+    World->Tick(LEVELTICK_All, DeltaSeconds);
+    FTickableGameObject::TickObjects(World, LEVELTICK_All, false, DeltaSeconds);
+
+    if (GShaderCompilingManager)
+    {
+        GShaderCompilingManager->ProcessAsyncResults(true, false);
+    }
+
+    // Scene captures render when requested: finish the frame's render work before the next one
+    ENQUEUE_RENDER_COMMAND(PyranoCommandletEndFrame)(
+        [](FRHICommandListImmediate& RHICmdList)
+        {
+            GRenderTargetPool.TickPoolElements();
+            RHICmdList.ImmediateFlush(EImmediateFlushType::FlushRHIThreadFlushResources);
+        });
+    FlushRenderingCommands();
+
+    ++GFrameCounter;
+}
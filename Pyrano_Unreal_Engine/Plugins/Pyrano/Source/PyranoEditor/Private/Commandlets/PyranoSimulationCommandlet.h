@@ -0,0 +1,56 @@
+/*=============================================================================
+	PyranoSimulationCommandlet.h
+  Headless simulation: loads a saved plan and a map, runs the scheduler to
+  completion with off-screen captures and exits with a status code.
+/============================================================================*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+
+#include "PyranoSimulationCommandlet.generated.h"
+
+/**
+ * UnrealEditor-Cmd <Project> -run=PyranoSimulation -Plan=<plan.json> -Map=</Game/Maps/Site>
+ *     [-CaptureOnce] [-Output=<dir>] [-TimeoutSec=<s>] [-BootFrames=<n>]
+ *     [-Shard=<i> -TimeShards=<t> -SensorShards=<s>]
+ *     -AllowCommandletRendering -RenderOffscreen -unattended
+ *
+ * The plan is an FSimConfig saved by the planner (FPlanStorage). Captures always run off-screen;
+ * -Output overrides the plan's output folder and the shard arguments its sharding, so one plan
+ * serves every instance of a sharded run (merged afterwards with -run=PyranoMergeShards).
+ */
+UCLASS()
+class UPyranoSimulationCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Exit codes, also printed in the summary. */
+	enum EExitCode : int32
+	{
+		Success			= 0,
+		BadArguments	= 1,	// missing -Plan / -Map, or rendering not allowed
+		PlanInvalid		= 2,	// plan not loaded or rejected by validation
+		MapLoadFailed	= 3,
+		NothingCaptured	= 4,	// no enabled sensor or time slot in the map / plan
+		TimedOut		= 5,
+	};
+
+	UPyranoSimulationCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+
+	/** Loads the map as a standalone game world (world subsystems included) and begins play. */
+	UWorld* CreateGameWorld(const FString& MapName) const;
+
+	/** Ends play and destroys the world created by CreateGameWorld. */
+	void DestroyGameWorld(UWorld* World) const;
+
+	/** Advances the world, the tickable objects and the render thread by one frame. */
+	void TickFrame(UWorld* World, float DeltaSeconds) const;
+};
@@ -10,6 +10,7 @@
 #include "Components/PyranometerComponent.h"
 #include "Irradiance/IrradianceCommon.h"
 #include "Simulation/IrradianceScheduler.h" 
+#include "Simulation/IrradianceSH.h"
 #include "Logging/IrradianceLog.h"
 
 #include "DesktopPlatformModule.h"
@@ -216,11 +217,16 @@ void UPyranoEditorSubsystem::StartPIEWithConfig(const FSimConfig& InConfig, bool
     bStartTriggered = false;
     const int32 SidePx = InConfig.ResolutionPx;
 
-    PYRANO_VERBOSE(TEXT("[Planner] StartPIEWithConfig (%s), res %d"),
+    // Off-screen captures do not render through the PIE window: keep it small
+    const int32 WindowPx = InConfig.bOffscreenCapture
+        ? FMath::Min(SidePx, IrradianceCommon::Defaults::OffscreenWindowPx)
+        : SidePx;
+
+    PYRANO_VERBOSE(TEXT("[Planner] StartPIEWithConfig (%s), res %d%s"),
         bIsSimulation ? TEXT("Simulation") : TEXT("CaptureOnce"),
-        SidePx);
+        SidePx, InConfig.bOffscreenCapture ? TEXT(" (off-screen)") : TEXT(""));
 
-    StartNewPIE(SidePx, SidePx, false, FIntPoint(0, 0));
+    StartNewPIE(WindowPx, WindowPx, false, FIntPoint(0, 0));
 }
 
 
@@ -635,7 +641,10 @@ FValidationResult UPyranoEditorSubsystem::ValidateConfig(const FSimConfig& InCon
         out.WarmupFrames = 8;
     }
 
-    if (!out.bExportCSV)
+    out.CapturePipelineDepth = FMath::Clamp(out.CapturePipelineDepth, 1, 64);
+    out.IntegrationBatchSize = FMath::Clamp(out.IntegrationBatchSize, 1, 64);
+
+    if (!out.bExportCSV && !out.bExportBinary)
     {
         out.OutputPath.Path.Empty(); // if export = false, ignore path
     }
@@ -647,6 +656,27 @@ FValidationResult UPyranoEditorSubsystem::ValidateConfig(const FSimConfig& InCon
         Result.AddFieldError(TEXT("EndTime"), TEXT("End time must be greater than Start time."));
     }
 
+    // Validate sharding
+    out.TimeShards = FMath::Max(1, out.TimeShards);
+    out.SensorShards = FMath::Max(1, out.SensorShards);
+    if (out.ShardIndex < 0 || out.ShardIndex >= out.GetShardCount())
+    {
+        Result.AddFieldError(TEXT("ShardIndex"), FString::Printf(TEXT("Shard index must be in [0, %d)."), out.GetShardCount()));
+    }
+
+    // Validate SH projection (one band is only the mean radiance)
+    if (out.SHOrder != 0 && !FIrradianceSH::IsValidOrder(out.SHOrder))
+    {
+        Result.AddFieldError(TEXT("SHOrder"), FString::Printf(TEXT("SH order must be 0 (off) or in [%d, %d]."),
+            FIrradianceSH::MinOrder, FIrradianceSH::MaxOrder));
+    }
+
+    // Validate normalization
+    if (!out.Normalization.IsValid())
+    {
+        Result.AddFieldError(TEXT("Normalization"), TEXT("Normalization coefficients must be finite numbers."));
+    }
+
     if (out.EndTime > out.StartTime)
     {
         const double TotalSeconds = (out.EndTime - out.StartTime).GetTotalSeconds();
@@ -664,7 +694,7 @@ FValidationResult UPyranoEditorSubsystem::ValidateConfig(const FSimConfig& InCon
     }
 
     // Validate export
-    if (out.bExportCSV)
+    if (out.bExportCSV || out.bExportBinary)
     {
         const FString RawPath = out.OutputPath.Path.TrimStartAndEnd();
 
@@ -52,7 +52,10 @@ public class PyranoEditor : ModuleRules
 				"UMGEditor",
 				"Projects",
                 "Json",
-                "JsonUtilities"
+                "JsonUtilities",
+
+                "RenderCore",
+                "RHI"
             }
             );
 